@@ -138,6 +138,32 @@ function(vp_model)
     set(VP_MODEL_NAME_OPTIM "${VP_MODEL_NAME}_optim")
     set(VP_MODEL_NAME_DEBUG "${VP_MODEL_NAME}_debug")
     set(VP_MODEL_NAME_SV "${VP_MODEL_NAME}_sv")
+    set(VP_MODEL_NAME_STATIC "${VP_MODEL_NAME}_static")
+
+    # ==================
+    # Static models
+    # ==================
+    # Models selected for the static launcher are also built as a static library, with
+    # their constructor renamed so that they can be linked together
+    if(${BUILD_OPTIMIZED} AND "${VP_MODEL_NAME}" IN_LIST GVSOC_STATIC_MODELS)
+        add_library(${VP_MODEL_NAME_STATIC} STATIC ${VP_MODEL_SOURCES})
+        target_link_libraries(${VP_MODEL_NAME_STATIC} PRIVATE gvsoc gap_archi archi_pulp)
+        target_compile_options(${VP_MODEL_NAME_STATIC} PRIVATE "-D__GVSOC__")
+        target_compile_definitions(${VP_MODEL_NAME_STATIC} PRIVATE "-Dvp_constructor=vp_constructor_${VP_MODEL_NAME}")
+        foreach(X IN LISTS VP_MODEL_ROOT_DIRS)
+            target_include_directories(${VP_MODEL_NAME_STATIC} PRIVATE ${X})
+        endforeach()
+
+        if(VP_MODEL_OUTPUT_NAME)
+            set(VP_MODEL_MODULE "${VP_MODEL_PREFIX}/${VP_MODEL_OUTPUT_NAME}")
+        else()
+            set(VP_MODEL_MODULE "${VP_MODEL_PREFIX}/${VP_MODEL_NAME}")
+        endif()
+        string(REGEX REPLACE "^/" "" VP_MODEL_MODULE "${VP_MODEL_MODULE}")
+
+        set_property(GLOBAL APPEND PROPERTY GVSOC_STATIC_MODEL_NAMES ${VP_MODEL_NAME})
+        set_property(GLOBAL APPEND PROPERTY GVSOC_STATIC_MODEL_MODULES ${VP_MODEL_MODULE})
+    endif()
 
     # ==================
     # Optimized models
@@ -239,6 +265,9 @@ function(vp_model_link_libraries)
         set(VP_MODEL_NAME_TARGET "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_link_libraries(${VP_MODEL_NAME_TARGET} PRIVATE ${VP_MODEL_LIBRARY})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_link_libraries(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_LIBRARY})
+    endif()
 endfunction()
 
 function(vp_model_link_blocks)
@@ -254,6 +283,9 @@ function(vp_model_link_blocks)
         set(VP_MODEL_NAME_TARGET "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_link_libraries(${VP_MODEL_NAME_TARGET} PRIVATE ${VP_MODEL_BLOCK}${TARGET_TYPE})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_link_libraries(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_BLOCK}_optim)
+    endif()
 endfunction()
 
 function(vp_model_compile_options)
@@ -268,6 +300,9 @@ function(vp_model_compile_options)
         set(VP_MODEL_NAME_TYPE "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_compile_options(${VP_MODEL_NAME_TYPE} PRIVATE ${VP_MODEL_OPTIONS})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_compile_options(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_OPTIONS})
+    endif()
 endfunction()
 
 function(vp_model_link_options)
@@ -282,6 +317,10 @@ function(vp_model_link_options)
         set(VP_MODEL_NAME_TYPE "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_link_options(${VP_MODEL_NAME_TYPE} PRIVATE ${VP_MODEL_OPTIONS})
     endforeach()
+    # Static models are only linked as part of the launcher, which must get their options
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_link_options(${VP_MODEL_NAME}_static INTERFACE ${VP_MODEL_OPTIONS})
+    endif()
 endfunction()
 
 function(vp_model_compile_definitions)
@@ -296,6 +335,9 @@ function(vp_model_compile_definitions)
         set(VP_MODEL_NAME_TYPE "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_compile_definitions(${VP_MODEL_NAME_TYPE} PRIVATE ${VP_MODEL_DEFINITIONS})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_compile_definitions(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_DEFINITIONS})
+    endif()
 endfunction()
 
 function(vp_model_include_directories)
@@ -310,6 +352,9 @@ function(vp_model_include_directories)
         set(VP_MODEL_NAME_TYPE "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_include_directories(${VP_MODEL_NAME_TYPE} PRIVATE ${VP_MODEL_DIRECTORY})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_include_directories(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_DIRECTORY})
+    endif()
 endfunction()
 
 function(vp_model_sources)
@@ -324,6 +369,9 @@ function(vp_model_sources)
         set(VP_MODEL_NAME_TYPE "${VP_MODEL_NAME}${TARGET_TYPE}")
         target_sources(${VP_MODEL_NAME_TYPE} PRIVATE ${VP_MODEL_SOURCES})
     endforeach()
+    if(TARGET ${VP_MODEL_NAME}_static)
+        target_sources(${VP_MODEL_NAME}_static PRIVATE ${VP_MODEL_SOURCES})
+    endif()
 endfunction()
 
 function(vp_files)
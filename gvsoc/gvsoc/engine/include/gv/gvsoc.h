@@ -49,6 +49,19 @@ void gv_start(void *instance);
 void gv_reset(void *instance, bool active);
 
 void gv_step(void *instance, int64_t timestamp);
+// Run until the specified time and wait until the engine is stopped. Return 0 if the time
+// is reached or -1 if the simulation ended before.
+int gv_run_until(void *instance, int64_t timestamp);
+// Save or restore the state of the whole platform, see vp/checkpoint.hpp.
+// The engine must be stopped. Return 0 on success or -1 on error.
+int gv_checkpoint_save(void *instance, const char *path);
+int gv_checkpoint_restore(void *instance, const char *path);
+// Fork the process while the engine is stopped, so that the child process can continue
+// the simulation from this point. Return the value returned by fork, or -1 on error.
+int gv_fork(void *instance);
+// Write the content of a file to memory at the specified address, through a component
+// handling the mem_write command like a router. Return 0 on success or -1 on error.
+int gv_mem_load(void *instance, const char *comp_path, uint64_t addr, const char *file_path);
 
 int64_t gv_time(void *instance);
 
@@ -242,6 +242,16 @@ namespace vp
              */
             inline bool get_active() { return trace.get_event_active(); }
 
+            /**
+             * @brief Register a callback called when the trace is enabled or disabled
+             *
+             * This can be used by components which need to change their behavior
+             * when the power must be accounted.
+             *
+             * @param callback Callback to be called.
+             */
+            void register_callback(std::function<void()> callback) { this->trace.register_callback(callback); }
+
             /**
              * @brief Dump the trace
              *
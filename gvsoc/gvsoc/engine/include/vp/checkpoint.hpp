@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <map>
+
+namespace vp {
+
+    class component;
+    class clock_event;
+
+    // Checkpoint of the whole platform, saved to or restored from a file.
+    // Each component saves its state as blocks of data identified by the component path
+    // and a name, which are read back by the same component of a platform built from the
+    // same configuration. Big blocks are aligned on pages in the file, so that they can be
+    // mapped copy-on-write when the checkpoint is restored instead of being copied.
+    class checkpoint
+    {
+    public:
+        ~checkpoint();
+
+        // Open the file, for writing the blocks if is_save is true, or for reading them
+        int open(std::string path, bool is_save);
+        // Write the index of the blocks when saving
+        int close();
+
+        void save(component *comp, std::string name, void *data, size_t size);
+        bool restore(component *comp, std::string name, void *data, size_t size);
+        // Return the block mapped in memory, which can be modified without modifying the
+        // file and stays valid as long as the checkpoint is not deleted
+        uint8_t *map(component *comp, std::string name, size_t size);
+
+        // Events are saved with their cycle, so that they are enqueued again to the same
+        // cycle when the checkpoint is restored. The clock engine of the component must
+        // already be restored.
+        void save_event(component *comp, std::string name, clock_event *event);
+        bool restore_event(component *comp, std::string name, clock_event *event);
+
+        // Only the first error is kept, the other ones are usually caused by it
+        void error(const char *fmt, ...);
+        std::string get_error() { return this->error_msg; }
+
+        // Events pending in the engines when saving, and number of them which were
+        // saved, to detect those which could not be saved
+        int64_t nb_pending_events = 0;
+        int64_t nb_saved_events = 0;
+
+    private:
+        struct block
+        {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        block *get_block(component *comp, std::string name, size_t size);
+
+        bool is_save;
+        FILE *file = NULL;
+        uint8_t *data = NULL;
+        size_t data_size = 0;
+        std::map<std::string, block> blocks;
+        std::string error_msg;
+    };
+};
@@ -25,12 +25,57 @@
 #include "vp/vp_data.hpp"
 #include "vp/component.hpp"
 #include "vp/time/time_engine.hpp"
+#include "vp/clock/clock_wheel.hpp"
 
 namespace vp {
 
+  #define CLOCK_EVENT_SLAB_SIZE 64
+  #define CLOCK_EVENT_STRIDE ((sizeof(clock_event) + CLOCK_EVENT_CACHE_LINE - 1) & ~(CLOCK_EVENT_CACHE_LINE - 1))
+
   class clock_event;
   class component;
 
+  // Allocates clock events from slabs of cache-aligned events and recycles the deleted
+  // ones through a free list. The slabs are only released with the allocator.
+  class clock_event_allocator
+  {
+  public:
+    ~clock_event_allocator();
+
+    // Return a free event, or NULL if a new slab must be allocated
+    inline void *alloc()
+    {
+      clock_event *event = this->free_events;
+      if (likely(event != NULL))
+      {
+        this->free_events = event->next;
+        this->nb_events++;
+      }
+      return event;
+    }
+
+    // Allocate a new slab and return its first event, or NULL if it failed
+    void *alloc_slab();
+
+    inline void free(clock_event *event)
+    {
+      event->next = this->free_events;
+      this->free_events = event;
+      this->nb_events--;
+    }
+
+    // Number of events currently allocated
+    int64_t get_nb_events() { return this->nb_events; }
+
+    int get_nb_slabs() { return this->slabs.size(); }
+
+  private:
+    // Free clock events, linked through their next field
+    clock_event *free_events = NULL;
+    std::vector<void *> slabs;
+    int64_t nb_events = 0;
+  };
+
   class clock_engine : public time_engine_client
   {
 
@@ -85,16 +130,25 @@ namespace vp {
 
     clock_event *event_new(component_clock *comp, clock_event_meth_t *meth)
     {
-      clock_event *event = new clock_event(comp, meth);
+      clock_event *event = new (this->event_alloc()) clock_event(comp, meth);
+      event->allocator = &this->event_allocator;
       return event;
     }
 
     clock_event *event_new(component_clock *comp, void *_this, clock_event_meth_t *meth)
     {
-      clock_event *event = new clock_event(comp, _this, meth);
+      clock_event *event = new (this->event_alloc()) clock_event(comp, _this, meth);
+      event->allocator = &this->event_allocator;
       return event;
     }
 
+    // Move the engine forward by the specified number of cycles on behalf of the event
+    // being executed, as if it had been reenqueued and executed after this delay.
+    // This is only possible if no other event, from this engine or from another one,
+    // is scheduled up to the target cycle, otherwise false is returned and nothing is
+    // done.
+    inline bool fast_forward(int64_t cycles);
+
     inline void retain() { engine->retain(); }
     inline void release() { engine->release(); }
 
@@ -102,9 +156,27 @@ namespace vp {
 
     void event_del(component_clock *comp, clock_event *event)
     {
-      delete event;
+      if (likely(event->allocator == &this->event_allocator))
+      {
+        event->~clock_event();
+        this->event_allocator.free(event);
+      }
+      else
+      {
+        event_del_unbound(event);
+      }
     }
 
+    // Events of components which are not yet bound to their clock, usually created
+    // during the build. They come from a global allocator, as they can't be moved to
+    // the clock engine slabs once the clock is bound.
+    static clock_event *event_new_unbound(component_clock *comp, clock_event_meth_t *meth);
+    static clock_event *event_new_unbound(component_clock *comp, void *_this, clock_event_meth_t *meth);
+    static void event_del_unbound(clock_event *event);
+
+    // Number of events currently allocated from this engine
+    int64_t get_nb_events() { return this->event_allocator.get_nb_events(); }
+
     int64_t exec();
 
     inline void sync();
@@ -125,7 +197,19 @@ namespace vp {
 
     int64_t get_frequency() { return freq; }
 
-    bool has_events() { return this->nb_enqueued_to_cycle || this->delayed_queue; }
+    bool has_events() { return this->nb_enqueued_to_cycle || !this->delayed_queue.empty(); }
+
+    void checkpoint_save(vp::checkpoint *checkpoint);
+
+    void pre_checkpoint_restore(vp::checkpoint *checkpoint);
+
+    // Enqueue an event restored from a checkpoint to its absolute cycle. The engine
+    // itself is enqueued again to the time engine when its state is restored.
+    inline void checkpoint_enqueue(clock_event *event, int64_t cycle)
+    {
+      event->enqueued = true;
+      this->delayed_queue.insert(event, cycle);
+    }
 
   protected:
 
@@ -136,7 +220,12 @@ namespace vp {
       // The position of one round of the circular buffer is always aligned
       // on the buffer size.
       int cycle = (current_cycle + cycles) & CLOCK_EVENT_QUEUE_MASK;
-      event->next = event_queue[cycle];
+      clock_event *next = event_queue[cycle];
+      event->next = next;
+      event->prev = NULL;
+      event->queue = &event_queue[cycle];
+      if (next)
+        next->prev = event;
       event_queue[cycle] = event;
       nb_enqueued_to_cycle++;
       event->cycle = cycles + get_cycles();
@@ -144,8 +233,23 @@ namespace vp {
 
     clock_event *enqueue_other(clock_event *event, int64_t cycles);
 
+    inline void *event_alloc()
+    {
+      void *event = this->event_allocator.alloc();
+      if (likely(event != NULL))
+        return event;
+
+      return this->event_alloc_slab();
+    }
+
+    void *event_alloc_slab();
+
     clock_event *event_queue[CLOCK_EVENT_QUEUE_SIZE];
-    clock_event *delayed_queue = NULL;
+    // Events which are too far to fit into the circular buffer
+    clock_wheel delayed_queue;
+    // Events moved from the delayed queue to the circular buffer, kept here to avoid
+    // allocating at each flush
+    std::vector<clock_event *> flushed_events;
     int current_cycle = 0;
     int64_t period = 0;
     int64_t freq;
@@ -171,6 +275,9 @@ namespace vp {
     bool must_flush_delayed_queue;
 
     vp::trace cycles_trace;
+
+    // Events of the components bound to this engine
+    clock_event_allocator event_allocator;
   };    
 
 };
@@ -191,6 +298,62 @@ inline vp::clock_event *vp::clock_engine::reenqueue(vp::clock_event *event, int6
   return event;
 }
 
+inline bool vp::clock_engine::fast_forward(int64_t cycles)
+{
+  int64_t target = this->cycles + cycles;
+
+  if (cycles <= 0 || this->period == 0)
+    return false;
+
+  // Events of the circular buffer only prevent moving forward if they are in the window
+  // being skipped, including the ones remaining in the current cycle, which would have
+  // been executed after the event being executed, and the ones of the target cycle, which
+  // would have been executed before it. The ones after can stay in their slot as the
+  // buffer keeps the same mapping to absolute cycles.
+  if (this->nb_enqueued_to_cycle != 0)
+  {
+    if (cycles >= CLOCK_EVENT_QUEUE_SIZE)
+      return false;
+
+    for (int64_t i = 0; i <= cycles; i++)
+    {
+      if (this->event_queue[(this->current_cycle + i) & CLOCK_EVENT_QUEUE_MASK] != NULL)
+        return false;
+    }
+  }
+
+  if (!this->delayed_queue.empty())
+  {
+    int64_t first_cycle = this->delayed_queue.get_first()->cycle;
+
+    if (first_cycle <= target)
+      return false;
+
+    // When going over the end of the circular buffer, the delayed events of the next
+    // round would have been moved to the buffer when wrapping to the first slot, before
+    // the event being executed is reenqueued, which gives them a different order in
+    // their slot. Just stop before, so that the order is the same as without moving
+    // forward.
+    if (this->current_cycle + cycles >= CLOCK_EVENT_QUEUE_SIZE)
+    {
+      int64_t wrap_cycle = target - ((this->current_cycle + cycles) & CLOCK_EVENT_QUEUE_MASK);
+      if (first_cycle < wrap_cycle + CLOCK_EVENT_QUEUE_SIZE)
+        return false;
+    }
+  }
+
+  if (!this->engine->fast_forward(this->get_time() + cycles * this->period))
+    return false;
+
+  this->cycles = target;
+
+  this->current_cycle = (this->current_cycle + cycles) & CLOCK_EVENT_QUEUE_MASK;
+
+  this->cycles_trace.event_real(this->cycles);
+
+  return true;
+}
+
 inline vp::clock_event *vp::clock_engine::reenqueue_ext(vp::clock_event *event, int64_t enqueue_cycles)
 {
   this->sync();
@@ -27,6 +27,7 @@
 namespace vp {
 
   class clock_event;
+  class clock_event_allocator;
   class component;
   class component_clock;
 
@@ -34,6 +35,7 @@ namespace vp {
   #define CLOCK_EVENT_NB_ARGS 8
   #define CLOCK_EVENT_QUEUE_SIZE 32
   #define CLOCK_EVENT_QUEUE_MASK (CLOCK_EVENT_QUEUE_SIZE - 1)
+  #define CLOCK_EVENT_CACHE_LINE 64
 
   typedef void (clock_event_meth_t)(void *, clock_event *event);
 
@@ -41,13 +43,15 @@ namespace vp {
   {
 
     friend class clock_engine;
+    friend class clock_event_allocator;
+    friend class clock_wheel;
 
   public:
 
     clock_event(component_clock *comp, clock_event_meth_t *meth);
 
     clock_event(component_clock *comp, void *_this, clock_event_meth_t *meth) 
-      : comp(comp), _this(_this), meth(meth), enqueued(false) {}
+      : meth(meth), _this(_this), enqueued(false), comp(comp) {}
 
     inline int get_payload_size() { return CLOCK_EVENT_PAYLOAD_SIZE; }
     inline uint8_t *get_payload() { return payload; }
@@ -62,15 +66,39 @@ namespace vp {
     void exec() { this->meth(this->_this, this); }
 
   private:
-    uint8_t payload[CLOCK_EVENT_PAYLOAD_SIZE];
-    void *args[CLOCK_EVENT_NB_ARGS];
-    component_clock *comp;
-    void *_this;
+    // Remove the event from the list it is enqueued to, in constant time
+    inline void unlink()
+    {
+      if (this->prev)
+        this->prev->next = this->next;
+      else
+        *this->queue = this->next;
+
+      if (this->next)
+        this->next->prev = this->prev;
+    }
+
+    // Fields used by the clock engine to schedule and execute the event come first
+    // so that they fit into the first cache line, as the clock engine allocates
+    // events aligned on cache lines.
     clock_event_meth_t *meth;
+    void *_this;
     clock_event *next;
-    bool enqueued;
+    clock_event *prev;
+    // Head of the list where the event is currently enqueued
+    clock_event **queue;
     int64_t cycle;
-  };    
+    // Insertion order, used to keep events ordered when they leave the delayed queue
+    int64_t seq;
+    bool enqueued;
+
+    // Fields only used by the models
+    component_clock *comp;
+    // Allocator the event comes from, the event goes back to it when it is deleted
+    clock_event_allocator *allocator;
+    void *args[CLOCK_EVENT_NB_ARGS];
+    uint8_t payload[CLOCK_EVENT_PAYLOAD_SIZE];
+  };
 
 };
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#ifndef __VP_CLOCK_WHEEL_HPP__
+#define __VP_CLOCK_WHEEL_HPP__
+
+#include <vector>
+#include "vp/vp_data.hpp"
+#include "vp/clock/clock_event.hpp"
+
+namespace vp {
+
+  #define CLOCK_WHEEL_BITS 6
+  #define CLOCK_WHEEL_SLOTS (1 << CLOCK_WHEEL_BITS)
+  #define CLOCK_WHEEL_MASK (CLOCK_WHEEL_SLOTS - 1)
+  // Enough levels to cover the full positive range of a 64 bits cycle count,
+  // so that there is no overflow list.
+  #define CLOCK_WHEEL_LEVELS ((63 + CLOCK_WHEEL_BITS - 1) / CLOCK_WHEEL_BITS)
+
+  // Hierarchical timing wheel holding the clock events which are too far
+  // to fit into the clock engine circular buffer.
+  // Level 0 has a granularity of 1 cycle and each level above is 64 times
+  // coarser. An event is stored in the level corresponding to the highest
+  // bit which differs between its cycle and the current wheel cycle, and is
+  // cascaded to lower levels as the wheel cycle reaches its block.
+  // Insertion and removal are O(1) and finding the first event only scans
+  // one bitmap per level plus one slot.
+  class clock_wheel
+  {
+
+  public:
+
+    clock_wheel();
+
+    // Insert an event which must be executed at the specified absolute cycle.
+    // The cycle must be greater or equal to the current wheel cycle.
+    void insert(clock_event *event, int64_t cycle);
+
+    // Remove an event from the wheel, the event must be in it.
+    void remove(clock_event *event);
+
+    // Return the event with the lowest cycle, or NULL if the wheel is empty.
+    clock_event *get_first();
+
+    // Move the wheel to the specified cycle and push to the vector all the events
+    // whose cycle is lower than limit. They are removed from the wheel and pushed
+    // from the most recently inserted one to the oldest one, so that pushing them
+    // to the head of the circular buffer lists keeps the insertion order.
+    void extract(int64_t cycle, int64_t limit, std::vector<clock_event *> &events);
+
+    // Drop all the events and move the wheel to the specified cycle, which can be
+    // lower than the current one.
+    void clear(int64_t cycle);
+
+    inline bool empty() { return this->nb_events == 0; }
+
+    inline int get_nb_events() { return this->nb_events; }
+
+    inline bool contains(clock_event *event)
+    {
+      return event->queue >= &this->slots[0][0] &&
+        event->queue < &this->slots[0][0] + CLOCK_WHEEL_LEVELS * CLOCK_WHEEL_SLOTS;
+    }
+
+  private:
+
+    static inline int get_level(int64_t cycle, int64_t base)
+    {
+      uint64_t diff = cycle ^ base;
+      if (diff == 0)
+        return 0;
+      return (63 - __builtin_clzll(diff)) / CLOCK_WHEEL_BITS;
+    }
+
+    static inline int get_slot(int64_t cycle, int level)
+    {
+      return (cycle >> (level * CLOCK_WHEEL_BITS)) & CLOCK_WHEEL_MASK;
+    }
+
+    void insert_slot(clock_event *event);
+    void advance(int64_t cycle);
+
+    // Lists of events, one per slot and per level
+    clock_event *slots[CLOCK_WHEEL_LEVELS][CLOCK_WHEEL_SLOTS];
+    // One bit per non-empty slot, to quickly find the next slot with events
+    uint64_t bitmaps[CLOCK_WHEEL_LEVELS];
+    // Current cycle of the wheel. All events have a cycle greater or equal to it.
+    int64_t cycle = 0;
+    // Incremented on each insertion to remember the insertion order
+    int64_t seq = 0;
+    int nb_events = 0;
+    // Cached event with the lowest cycle, NULL if it must be recomputed
+    clock_event *first = NULL;
+  };
+
+};
+
+#endif
@@ -67,16 +67,28 @@ inline void vp::component_clock::event_reenqueue_ext(vp::clock_event *event, int
 
 inline vp::clock_event *vp::component_clock::event_new(vp::clock_event_meth_t *meth)
 {
+  if (unlikely(clock == NULL))
+    return clock_engine::event_new_unbound(this, meth);
+
   return clock->event_new(this, meth);
 }
 
 inline vp::clock_event *vp::component_clock::event_new(void *_this, vp::clock_event_meth_t *meth)
 {
+  if (unlikely(clock == NULL))
+    return clock_engine::event_new_unbound(this, _this, meth);
+
   return clock->event_new(this, _this, meth);
 }
 
 inline void vp::component_clock::event_del(vp::clock_event *event)
 {
+  if (unlikely(clock == NULL))
+  {
+    clock_engine::event_del_unbound(event);
+    return;
+  }
+
   clock->event_del(this, event);
 }
 
@@ -57,6 +57,7 @@ namespace vp {
   class clock_engine;
   class component;
   class signal;
+  class checkpoint;
 
 
   class Notifier {
@@ -112,9 +113,17 @@ namespace vp {
     virtual void req_stop_exec() {}
     virtual void stop_exec() {}
     virtual int join() { return -1; }
+    virtual int fork() { return -1; }
 
     virtual void dump_traces(FILE *file) {}
 
+    // Save and restore the state which is not in registers or in the events created
+    // by the component, which are handled for all components, see vp/checkpoint.hpp.
+    // The engines are restored first, so that components can then enqueue their events.
+    virtual void checkpoint_save(vp::checkpoint *checkpoint) {}
+    virtual void pre_checkpoint_restore(vp::checkpoint *checkpoint) {}
+    virtual void checkpoint_restore(vp::checkpoint *checkpoint) {}
+
     void dump_traces_recursive(FILE *file);
 
     component *get_parent() { return this->parent; }
@@ -178,6 +187,12 @@ namespace vp {
 
     void reset_all(bool active, bool from_itf=false);
 
+    void checkpoint_save_all(vp::checkpoint *checkpoint);
+
+    void pre_checkpoint_restore_all(vp::checkpoint *checkpoint);
+
+    void checkpoint_restore_all(vp::checkpoint *checkpoint);
+
     void new_master_port(std::string name, master_port *port);
 
     void new_master_port(void *comp, std::string name, master_port *port);
@@ -265,11 +280,20 @@ namespace vp {
 
   vp::component *__gv_create(std::string config_path, struct gv_conf *gv_conf);
 
+  typedef component *(*component_constructor_t)(js::config *config);
+
+  // Register the constructor of a model linked into the launcher, which is then used
+  // instead of loading the module of the model. The module name is the one of the
+  // vp_component property, with slashes instead of dots.
+  void register_static_model(std::string module_name, component_constructor_t constructor);
+
   class top
   {
   public:
       component *top_instance;
       power::engine *power_engine;
+      // Last restored checkpoint, kept as the models may still use its mapped blocks
+      checkpoint *restored_checkpoint = NULL;
   private:
   };
 
@@ -38,6 +38,9 @@ namespace vp {
   typedef void (cpi_sync_cycle_meth_t)(void *, int href, int vsync, int data);
   typedef void (cpi_sync_cycle_meth_muxed_t)(void *, int href, int vsync, int data, int id);
 
+  typedef void (cpi_burst_meth_t)(void *, int href, int vsync, uint8_t *data, int size);
+  typedef void (cpi_burst_meth_muxed_t)(void *, int href, int vsync, uint8_t *data, int size, int id);
+
 
   class cpi_master : public vp::master_port
   {
@@ -57,6 +60,17 @@ namespace vp {
       return sync_cycle_meth(this->get_remote_context(), href, vsync, data);
     }
 
+    // Sends size pixel clock cycles at once, with the same href and vsync, and one data byte
+    // per cycle.
+    // If the slave does not handle bursts, they are converted into pixel clock edges.
+    inline void burst(int href, int vsync, uint8_t *data, int size)
+    {
+      if (burst_meth)
+        burst_meth(this->get_remote_context(), href, vsync, data, size);
+      else
+        burst_to_edges(href, vsync, data, size);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     bool is_bound() { return slave_port != NULL; }
@@ -65,6 +79,9 @@ namespace vp {
 
     static inline void sync_muxed_stub(cpi_master *_this, int pclk, int href, int vsync, int data);
     static inline void sync_cycle_muxed_stub(cpi_master *_this, int href, int vsync, int data);
+    static inline void burst_muxed_stub(cpi_master *_this, int href, int vsync, uint8_t *data, int size);
+
+    inline void burst_to_edges(int href, int vsync, uint8_t *data, int size);
 
     void (*sync_meth)(void *, int pclk, int href, int vsync, int data);
     void (*sync_meth_mux)(void *, int pclk, int href, int vsync, int data, int mux);
@@ -72,6 +89,9 @@ namespace vp {
     void (*sync_cycle_meth)(void *, int href, int vsync, int data);
     void (*sync_cycle_meth_mux)(void *, int href, int vsync, int data, int mux);
 
+    void (*burst_meth)(void *, int href, int vsync, uint8_t *data, int size);
+    void (*burst_meth_mux)(void *, int href, int vsync, uint8_t *data, int size, int mux);
+
     vp::component *comp_mux;
     int sync_mux;
     cpi_slave *slave_port = NULL;
@@ -95,6 +115,10 @@ namespace vp {
     inline void set_sync_cycle_meth(cpi_sync_cycle_meth_t *meth);
     inline void set_sync_cycle_meth_muxed(cpi_sync_cycle_meth_muxed_t *meth, int id);
 
+    // Optional, slaves which do not set it receive bursts as edges
+    inline void set_burst_meth(cpi_burst_meth_t *meth);
+    inline void set_burst_meth_muxed(cpi_burst_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
   private:
@@ -105,6 +129,9 @@ namespace vp {
     void (*sync_cycle_meth)(void *comp, int href, int vsync, int data);
     void (*sync_cycle_mux_meth)(void *comp, int href, int vsync, int data, int mux);
 
+    void (*burst_meth)(void *comp, int href, int vsync, uint8_t *data, int size);
+    void (*burst_mux_meth)(void *comp, int href, int vsync, uint8_t *data, int size, int mux);
+
     static inline void sync_default(cpi_slave *, int pclk, int href, int vsync, int data);
     static inline void sync_cycle_default(cpi_slave *, int href, int vsync, int data);
 
@@ -114,6 +141,7 @@ namespace vp {
 
 
   inline cpi_master::cpi_master() {
+    burst_meth = NULL;
   }
 
 
@@ -129,6 +157,21 @@ namespace vp {
     return _this->sync_cycle_meth_mux(_this->comp_mux, href, vsync, data, _this->sync_mux);
   }
 
+  inline void cpi_master::burst_muxed_stub(cpi_master *_this, int href, int vsync, uint8_t *data, int size)
+  {
+    return _this->burst_meth_mux(_this->comp_mux, href, vsync, data, size, _this->sync_mux);
+  }
+
+  inline void cpi_master::burst_to_edges(int href, int vsync, uint8_t *data, int size)
+  {
+    // Edges are used rather than cycles as some slaves only handle edges
+    for (int i=0; i<size; i++)
+    {
+      this->sync(0, href, vsync, data[i]);
+      this->sync(1, href, vsync, data[i]);
+    }
+  }
+
   inline void cpi_master::bind_to(vp::port *_port, vp::config *config)
   {
     cpi_slave *port = (cpi_slave *)_port;
@@ -136,6 +179,7 @@ namespace vp {
     {
       sync_meth = port->sync_meth;
       sync_cycle_meth = port->sync_cycle_meth;
+      burst_meth = port->burst_meth;
       set_remote_context(port->get_context());
     }
     else
@@ -146,6 +190,16 @@ namespace vp {
       sync_cycle_meth_mux = port->sync_cycle_mux_meth;
       sync_cycle_meth = (cpi_sync_cycle_meth_t *)&cpi_master::sync_cycle_muxed_stub;
 
+      if (port->burst_mux_meth)
+      {
+        burst_meth_mux = port->burst_mux_meth;
+        burst_meth = (cpi_burst_meth_t *)&cpi_master::burst_muxed_stub;
+      }
+      else
+      {
+        burst_meth = NULL;
+      }
+
       set_remote_context(this);
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
@@ -157,7 +211,7 @@ namespace vp {
     slave_port::bind_to(_port, config);
   }
 
-  inline cpi_slave::cpi_slave() : sync_meth(NULL), sync_mux_meth(NULL) {
+  inline cpi_slave::cpi_slave() : sync_meth(NULL), sync_mux_meth(NULL), burst_meth(NULL), burst_mux_meth(NULL) {
     sync_meth = (cpi_sync_meth_t *)&cpi_slave::sync_default;
     sync_cycle_meth = (cpi_sync_cycle_meth_t *)&cpi_slave::sync_cycle_default;
   }
@@ -188,6 +242,19 @@ namespace vp {
     mux_id = id;
   }
 
+  inline void cpi_slave::set_burst_meth(cpi_burst_meth_t *meth)
+  {
+    burst_meth = meth;
+    burst_mux_meth = NULL;
+  }
+
+  inline void cpi_slave::set_burst_meth_muxed(cpi_burst_meth_muxed_t *meth, int id)
+  {
+    burst_mux_meth = meth;
+    burst_meth = NULL;
+    mux_id = id;
+  }
+
   inline void cpi_slave::sync_default(cpi_slave *, int pclk, int href, int vsync, int data)
   {
   }
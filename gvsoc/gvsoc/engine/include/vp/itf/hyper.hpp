@@ -38,6 +38,9 @@ namespace vp {
   typedef void (hyper_sync_cycle_meth_muxed_t)(void *, int data, int id);
   typedef void (hyper_cs_sync_meth_muxed_t)(void *, int cs, int active, int id);
 
+  typedef void (hyper_burst_meth_t)(void *, uint8_t *data, int size, bool is_write);
+  typedef void (hyper_burst_meth_muxed_t)(void *, uint8_t *data, int size, bool is_write, int id);
+
 
   class hyper_master : public vp::master_port
   {
@@ -57,6 +60,11 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Sends size bytes at once. For writes, the bytes are taken from data, while for reads,
+    // the bytes sent back by the slave are stored into data.
+    // If the slave does not handle bursts, they are converted into cycles.
+    inline void burst(uint8_t *data, int size, bool is_write);
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_cycle_meth(hyper_sync_cycle_meth_t *meth);
@@ -68,6 +76,7 @@ namespace vp {
 
     static inline void sync_cycle_muxed_stub(hyper_master *_this, int data);
     static inline void cs_sync_muxed_stub(hyper_master *_this, int cs, int active);
+    static inline void burst_muxed_stub(hyper_master *_this, uint8_t *data, int size, bool is_write);
 
     void (*slave_sync_cycle)(void *comp, int data);
     void (*slave_sync_cycle_mux)(void *comp, int data, int mux);
@@ -76,6 +85,8 @@ namespace vp {
     void (*sync_cycle_meth_mux)(void *, int data, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    void (*burst_meth)(void *, uint8_t *data, int size, bool is_write);
+    void (*burst_meth_mux)(void *, uint8_t *data, int size, bool is_write, int mux);
 
     static inline void sync_cycle_default(void *, int data);
 
@@ -99,15 +110,31 @@ namespace vp {
 
     inline void sync_cycle(int data)
     {
-      slave_sync_cycle_meth(this->get_remote_context(), data);
+      if (rx_burst)
+      {
+        *rx_burst = data;
+        rx_burst = NULL;
+      }
+      else
+      {
+        slave_sync_cycle_meth(this->get_remote_context(), data);
+      }
     }
 
+    // Can be used by slaves handling bursts for the parts they do not handle at once.
+    // The bytes sent back with sync_cycle are then stored into the burst.
+    inline void burst_to_cycles(uint8_t *data, int size, bool is_write);
+
     inline void set_sync_cycle_meth(hyper_sync_cycle_meth_t *meth);
     inline void set_sync_cycle_meth_muxed(hyper_sync_cycle_meth_muxed_t *meth, int id);
 
     inline void set_cs_sync_meth(hyper_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(hyper_cs_sync_meth_muxed_t *meth, int id);
 
+    // Optional, slaves which do not set it receive bursts as cycles
+    inline void set_burst_meth(hyper_burst_meth_t *meth);
+    inline void set_burst_meth_muxed(hyper_burst_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
     static inline void sync_cycle_muxed_stub(hyper_slave *_this, int data);
@@ -122,6 +149,11 @@ namespace vp {
     void (*sync_cycle_mux_meth)(void *comp, int data, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    void (*burst_meth)(void *comp, uint8_t *data, int size, bool is_write);
+    void (*burst_mux_meth)(void *comp, uint8_t *data, int size, bool is_write, int mux);
+
+    // Where to store the next byte sent back when a burst is converted into cycles
+    uint8_t *rx_burst = NULL;
 
     static inline void sync_cycle_default(hyper_slave *, int data);
     static inline void cs_sync_default(hyper_slave *, int cs, int active);
@@ -137,6 +169,16 @@ namespace vp {
   inline hyper_master::hyper_master() {
     slave_sync_cycle = &hyper_master::sync_cycle_default;
     slave_sync_cycle_mux = NULL;
+    burst_meth = NULL;
+  }
+
+
+  inline void hyper_master::burst(uint8_t *data, int size, bool is_write)
+  {
+    if (burst_meth)
+      burst_meth(this->get_remote_context(), data, size, is_write);
+    else
+      slave_port->burst_to_cycles(data, size, is_write);
   }
 
 
@@ -173,6 +215,13 @@ namespace vp {
 
 
 
+  inline void hyper_master::burst_muxed_stub(hyper_master *_this, uint8_t *data, int size, bool is_write)
+  {
+    return _this->burst_meth_mux(_this->comp_mux, data, size, is_write, _this->sync_mux);
+  }
+
+
+
   inline void hyper_master::bind_to(vp::port *_port, vp::config *config)
   {
     hyper_slave *port = (hyper_slave *)_port;
@@ -180,6 +229,7 @@ namespace vp {
     {
       sync_cycle_meth = port->sync_cycle_meth;
       cs_sync_meth = port->cs_sync;
+      burst_meth = port->burst_meth;
       this->set_remote_context(port->get_context());
     }
     else
@@ -190,6 +240,16 @@ namespace vp {
       cs_sync_meth_mux = port->cs_sync_mux;
       cs_sync_meth = (hyper_cs_sync_meth_t *)&hyper_master::cs_sync_muxed_stub;
 
+      if (port->burst_mux_meth)
+      {
+        burst_meth_mux = port->burst_mux_meth;
+        burst_meth = (hyper_burst_meth_t *)&hyper_master::burst_muxed_stub;
+      }
+      else
+      {
+        burst_meth = NULL;
+      }
+
       this->set_remote_context(this);
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
@@ -222,7 +282,7 @@ namespace vp {
     }
   }
 
-  inline hyper_slave::hyper_slave() : sync_cycle_meth(NULL), sync_cycle_mux_meth(NULL) {
+  inline hyper_slave::hyper_slave() : sync_cycle_meth(NULL), sync_cycle_mux_meth(NULL), burst_meth(NULL), burst_mux_meth(NULL) {
     sync_cycle_meth = (hyper_sync_cycle_meth_t *)&hyper_slave::sync_cycle_default;
     cs_sync = (hyper_cs_sync_meth_t *)&hyper_slave::cs_sync_default;
   }
@@ -253,6 +313,33 @@ namespace vp {
     mux_id = id;
   }
 
+  inline void hyper_slave::set_burst_meth(hyper_burst_meth_t *meth)
+  {
+    burst_meth = meth;
+    burst_mux_meth = NULL;
+  }
+
+  inline void hyper_slave::set_burst_meth_muxed(hyper_burst_meth_muxed_t *meth, int id)
+  {
+    burst_mux_meth = meth;
+    burst_meth = NULL;
+    mux_id = id;
+  }
+
+  inline void hyper_slave::burst_to_cycles(uint8_t *data, int size, bool is_write)
+  {
+    // Reads send dummy bytes, and the byte sent back for each cycle is stored into the burst
+    for (int i=0; i<size; i++)
+    {
+      this->rx_burst = is_write ? NULL : &data[i];
+      if (this->sync_cycle_mux_meth)
+        this->sync_cycle_mux_meth(this->get_context(), is_write ? data[i] : 0, this->mux_id);
+      else
+        this->sync_cycle_meth(this->get_context(), is_write ? data[i] : 0);
+    }
+    this->rx_burst = NULL;
+  }
+
   inline void hyper_slave::sync_cycle_default(hyper_slave *, int data)
   {
   }
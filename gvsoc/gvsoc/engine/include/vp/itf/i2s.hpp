@@ -35,6 +35,9 @@ namespace vp {
   typedef void (i2s_sync_meth_t)(void *, int sck, int ws, int sd);
   typedef void (i2s_sync_meth_muxed_t)(void *, int sck, int ws, int sd, int id);
 
+  typedef void (i2s_frame_meth_t)(void *, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in);
+  typedef void (i2s_frame_meth_muxed_t)(void *, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in, int id);
+
 
 
   class i2s_master : public vp::master_port
@@ -52,6 +55,10 @@ namespace vp {
     inline void set_sync_meth(i2s_sync_meth_t *meth);
     inline void set_sync_meth_muxed(i2s_sync_meth_muxed_t *meth, int id);
 
+    // Optional, to receive whole frames instead of single edges, see i2s_slave::frame
+    inline void set_frame_meth(i2s_frame_meth_t *meth);
+    inline void set_frame_meth_muxed(i2s_frame_meth_muxed_t *meth, int id);
+
     bool is_bound() { return slave_port != NULL; }
 
   private:
@@ -61,6 +68,9 @@ namespace vp {
     void (*slave_sync)(void *comp, int sck, int ws, int sd);
     void (*slave_sync_mux)(void *comp, int sck, int ws, int sd, int mux);
 
+    void (*slave_frame)(void *comp, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in);
+    void (*slave_frame_mux)(void *comp, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in, int mux);
+
     void (*sync_meth)(void *, int sck, int ws, int sd);
     void (*sync_meth_mux)(void *, int sck, int ws, int sd, int mux);
 
@@ -73,6 +83,9 @@ namespace vp {
 
     int sd;
 
+    // Set while a frame is converted to edges, to capture the data driven by this master
+    bool in_frame = false;
+
   };
 
 
@@ -92,6 +105,13 @@ namespace vp {
       slave_sync_meth(this->get_remote_context(), sck, ws, sd);
     }
 
+    // Sends nb_edges clock edges at once, typically a whole WS period. The sck value
+    // alternates at each edge, starting with sck. ws and sd_out give the values driven
+    // by the clock provider for each edge. sd_in must be initialized to high-impedance
+    // (0xA) and receives for each edge the data resolved on the bus after the edge.
+    // Masters which do not implement frames receive the edges one by one.
+    inline void frame(int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in);
+
     inline void set_sync_meth(i2s_sync_meth_t *meth);
     inline void set_sync_meth_muxed(i2s_sync_meth_muxed_t *meth, int id);
 
@@ -101,13 +121,23 @@ namespace vp {
 
     inline int get_sd();
 
+    // Resolves 2 values of the data lines, with 2 for high-impedance and 3 for conflicts
+    static inline int resolve_sd(int sd0, int sd1);
+
   private:
 
     static inline void sync_muxed_stub(i2s_slave *_this, int sck, int ws, int sd);
+    static inline void frame_muxed_stub(i2s_slave *_this, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in);
+
+    inline void frame_edge(int sck, int ws, int sd);
+    inline int get_frame_sd();
 
     void (*slave_sync_meth)(void *, int sck, int ws, int sd);
     void (*slave_sync_meth_mux)(void *, int sck, int ws, int sd, int mux);
 
+    void (*slave_frame_meth)(void *, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in) = NULL;
+    void (*slave_frame_meth_mux)(void *, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in, int mux);
+
     void (*sync_meth)(void *comp, int sck, int ws, int sd);
     void (*sync_mux_meth)(void *comp, int sck, int ws, int sd, int mux);
 
@@ -125,7 +155,10 @@ namespace vp {
   inline i2s_master::i2s_master() {
     slave_sync = &i2s_master::sync_default;
     slave_sync_mux = NULL;
-    this->sd = 2;
+    slave_frame = NULL;
+    slave_frame_mux = NULL;
+    // Both data lines are in high-impedance until the master drives them
+    this->sd = 0xA;
   }
 
 
@@ -167,6 +200,18 @@ namespace vp {
     mux_id = id;
   }
 
+  inline void i2s_master::set_frame_meth(i2s_frame_meth_t *meth)
+  {
+    slave_frame = meth;
+  }
+
+  inline void i2s_master::set_frame_meth_muxed(i2s_frame_meth_muxed_t *meth, int id)
+  {
+    slave_frame_mux = meth;
+    slave_frame = NULL;
+    mux_id = id;
+  }
+
   inline void i2s_master::sync_default(void *, int sck, int ws, int sd)
   {
   }
@@ -174,6 +219,11 @@ namespace vp {
   inline void i2s_master::sync(int sck, int ws, int sd)
   {
     this->sd = sd;
+
+    // During a frame, the data is collected by the slave after each edge
+    if (this->in_frame)
+      return;
+
     return sync_meth(this->get_remote_context(), sck, ws, this->slave_port->get_sd());
   }
 
@@ -182,35 +232,96 @@ namespace vp {
     return _this->slave_sync_meth_mux(_this->comp_mux, sck, ws, sd, _this->sync_mux);
   }
 
+  inline void i2s_slave::frame_muxed_stub(i2s_slave *_this, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in)
+  {
+    return _this->slave_frame_meth_mux(_this->comp_mux, nb_edges, sck, ws, sd_out, sd_in, _this->sync_mux);
+  }
+
+  inline int i2s_slave::resolve_sd(int sd0, int sd1)
+  {
+    int result = 0;
+
+    for (int i=0; i<4; i+=2)
+    {
+      int data0 = (sd0 >> i) & 3;
+      int data1 = (sd1 >> i) & 3;
+
+      if (data0 == 2 || data1 == data0)
+        result |= data1 << i;
+      else if (data1 == 2)
+        result |= data0 << i;
+      else
+        result |= 3 << i;
+    }
+
+    return result;
+  }
+
   inline int i2s_slave::get_sd()
   {
-    int sdi = this->master_port->sd & 3;
-    int sdo = (this->master_port->sd >> 2) & 3;
+    int sd = this->master_port->sd & 0xf;
     i2s_slave *current = this->next;
 
     while(current)
     {
-      int next_sd = current->master_port->sd;
-      int next_data = next_sd & 3;
-      if (next_data != 2)
+      sd = resolve_sd(sd, current->master_port->sd);
+      current = current->next;
+    }
+
+    return sd;
+  }
+
+  inline void i2s_slave::frame(int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in)
+  {
+    bool has_edges = false;
+
+    for (i2s_slave *current = this; current; current = current->next)
+    {
+      if (current->slave_frame_meth)
       {
-        if (sdi == 2 || next_data == sdi)
-          sdi = next_data;
-        else
-          sdi = 3;
+        current->slave_frame_meth(current->get_remote_context(), nb_edges, sck, ws, sd_out, sd_in);
       }
-      next_data = (next_sd >> 2) & 3;
-      if (next_data != 2)
+      else
       {
-        if (sdo == 2 || next_data == sdo)
-          sdo = next_data;
-        else
-          sdo = 3;
+        current->master_port->in_frame = true;
+        has_edges = true;
       }
-      current = current->next;
     }
 
-    return sdi | (sdo << 2);
+    if (has_edges)
+    {
+      // Pin-level adapter, the edges are propagated in the same order as sync to keep
+      // the same behavior, and the data driven by the masters is sampled after each edge
+      for (int i=0; i<nb_edges; i++)
+      {
+        this->frame_edge(sck ^ (i & 1), ws[i], sd_out[i]);
+        sd_in[i] = resolve_sd(sd_in[i], this->get_frame_sd());
+      }
+
+      for (i2s_slave *current = this; current; current = current->next)
+      {
+        current->master_port->in_frame = false;
+      }
+    }
+  }
+
+  inline void i2s_slave::frame_edge(int sck, int ws, int sd)
+  {
+    if (next) next->frame_edge(sck, ws, sd);
+    if (this->master_port->in_frame) slave_sync_meth(this->get_remote_context(), sck, ws, sd);
+  }
+
+  inline int i2s_slave::get_frame_sd()
+  {
+    int sd = 0xA;
+
+    for (i2s_slave *current = this; current; current = current->next)
+    {
+      if (current->master_port->in_frame)
+        sd = resolve_sd(sd, current->master_port->sd);
+    }
+
+    return sd;
   }
 
   inline void i2s_slave::bind_to(vp::port *_port, vp::config *config)
@@ -233,12 +344,18 @@ namespace vp {
       if (port->slave_sync_mux == NULL)
       {
         this->slave_sync_meth = port->slave_sync;
+        this->slave_frame_meth = port->slave_frame;
         this->set_remote_context(port->get_context());
       }
       else
       {
         this->slave_sync_meth_mux = port->slave_sync_mux;
         this->slave_sync_meth = (i2s_sync_meth_t *)&i2s_slave::sync_muxed_stub;
+        if (port->slave_frame_mux)
+        {
+          this->slave_frame_meth_mux = port->slave_frame_mux;
+          this->slave_frame_meth = (i2s_frame_meth_t *)&i2s_slave::frame_muxed_stub;
+        }
 
         set_remote_context(this);
         comp_mux = (vp::component *)port->get_context();
@@ -22,6 +22,9 @@
 #ifndef __VP_ITF_IO_HPP__
 #define __VP_ITF_IO_HPP__
 
+#include <vector>
+#include <algorithm>
+#include <string.h>
 #include "vp/vp.hpp"
 #include "vp/queue.hpp"
 
@@ -29,6 +32,7 @@ namespace vp {
 
   class io_slave;
   class io_req;
+  class io_dmi;
 
   typedef enum
   {
@@ -40,7 +44,10 @@ namespace vp {
 
   typedef enum
   {
-    IO_REQ_FLAGS_DEBUG = (1<<0)
+    IO_REQ_FLAGS_DEBUG = (1<<0),
+    // Set by the slave on a read whose data comes from a plain memory, which can be
+    // read again with a debug request without any side effect
+    IO_REQ_FLAGS_MEMORY = (1<<1)
   } io_req_flags_e;
 
   #define IO_REQ_PAYLOAD_SIZE 64
@@ -52,6 +59,9 @@ namespace vp {
   typedef void (io_resp_meth_t)(void *, io_req *);
   typedef void (io_grant_meth_t)(void *, io_req *);
 
+  typedef bool (io_dmi_meth_t)(void *, io_req *, io_dmi *);
+  typedef void (io_dmi_invalidate_meth_t)(void *);
+
   class io_req : public vp::queue_elem
   {
     friend class io_master;
@@ -115,6 +125,9 @@ namespace vp {
         this->flags &= ~IO_REQ_FLAGS_DEBUG;
     }
 
+    inline bool is_memory() { return this->flags & IO_REQ_FLAGS_MEMORY; }
+    inline void set_memory() { this->flags |= IO_REQ_FLAGS_MEMORY; }
+
     inline int arg_alloc() { return current_arg++; }
     inline void arg_free() { current_arg--; }
 
@@ -148,6 +161,40 @@ namespace vp {
   };
 
 
+  // Direct memory interface grant.
+  // This describes an address range that a master can access directly through
+  // host pointers, instead of sending IO requests, until the slave which gave the
+  // grant invalidates it.
+  // All addresses are in the address space of the master which got the grant.
+  class io_dmi
+  {
+  public:
+
+    // Tell if the access is fully inside the granted range
+    inline bool contains(uint64_t addr, uint64_t size) { return addr >= this->base && addr + size <= this->base + this->size; }
+
+    // Return the host pointer of the access, or NULL if it is crossing an
+    // interleaving word
+    inline uint8_t *get_host_ptr(uint64_t addr, uint64_t size);
+
+    // First address and size of the granted range
+    uint64_t base = 0;
+    uint64_t size = 0;
+    // Address corresponding to the beginning of the host memory, or to the
+    // beginning of the banks when the memory is interleaved
+    uint64_t origin = 0;
+    // Fixed latency to be applied to every access
+    int64_t latency = 0;
+    // Host pointer of the memory, or NULL if it is interleaved
+    uint8_t *data = NULL;
+    // Host pointers of the banks when the memory is interleaved, the bank is selected
+    // by the address bits just above the word bits
+    std::vector<uint8_t *> banks;
+    int bank_bits = 0;
+    int word_bits = 0;
+  };
+
+
   /*
    * Class for IO master ports
    */
@@ -184,6 +231,25 @@ namespace vp {
     // on which port the response will be sent back by the slave.
     inline io_req_status_e req(io_req *req, io_slave *slave_port);
 
+    // Can be called by master component to get a direct memory interface grant
+    // for the range containing the request address. The request is only used
+    // to give the address and must not be considered as a real access.
+    // Return false if the slave cannot give it, in which case the normal
+    // requests must be used.
+    inline bool dmi_req(io_req *req, io_dmi *dmi);
+
+    // Same as dmi_req but the slave port is given by the caller, as for req.
+    inline bool dmi_req(io_req *req, io_dmi *dmi, io_slave *slave_port);
+
+    // Can be called by master component to do a debug access of any size, like
+    // semihosting or debuggers do. The data is directly copied when the slave can
+    // give a direct memory interface grant, otherwise it is sent as a single debug
+    // request, and as byte requests only if the slave rejects it. Interconnects
+    // must then split it if it spans several targets, as the interleavers do.
+    // The slave must handle it synchronously, a pending request is returned as
+    // is and must be considered as an error.
+    inline io_req_status_e debug_req(uint64_t addr, uint8_t *data, uint64_t size, bool is_write);
+
 
 
     /*
@@ -198,6 +264,11 @@ namespace vp {
     // an IO request response. Before being set, a default empty callback is active.
     inline void set_resp_meth(io_resp_meth_t *meth);
 
+    // Set the callback on master side called when the slave is invalidating the
+    // direct memory interface grants it gave. Before being set, a default empty
+    // callback is active.
+    inline void set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth);
+
 
 
     /*
@@ -238,6 +309,12 @@ namespace vp {
     // Default response callback, just do nothing.
     static inline void resp_default(void *, io_req *);
 
+    // Direct memory interface invalidation callback set by the user.
+    io_dmi_invalidate_meth_t *dmi_invalidate_meth;
+
+    // Default invalidation callback, just do nothing.
+    static inline void dmi_invalidate_default(void *);
+
 
     /*
      * Slave callbacks
@@ -253,6 +330,13 @@ namespace vp {
     // setup instead
     io_req_status_e (*req_meth_freq_cross)(void *, io_req *);
 
+    // Direct memory interface callback set by the user on slave port and retrieved
+    // during binding, NULL if the slave cannot give grants.
+    // It is called directly with the slave context as the slave state does not
+    // depend on the time when the grant is given.
+    io_dmi_meth_t *dmi_meth = NULL;
+    void *dmi_context = NULL;
+
 
     /*
      * Stubs
@@ -327,6 +411,11 @@ namespace vp {
     // owned back by the master which can then proceed with the request.
     inline void resp(io_req *req) { this->master_resp_meth(this->get_remote_context(), req); }
 
+    // Can be called to invalidate all the direct memory interface grants given
+    // through this port, for example when the memory content is not accessible
+    // anymore. All the masters bound to this port are notified.
+    inline void dmi_invalidate();
+
 
 
     /*
@@ -342,6 +431,10 @@ namespace vp {
     // when calling the callback, and can be used to multiplex a slave port
     inline void set_req_meth_muxed(io_req_meth_muxed_t *meth, int id);
 
+    // Set the callback on slave side called when the master is asking for a direct
+    // memory interface grant. Without it, all grants are refused.
+    inline void set_dmi_meth(io_dmi_meth_t *meth);
+
 
 
     /*
@@ -377,6 +470,9 @@ namespace vp {
     // This one gets called instead of the normal once in case it is not NULL
     io_req_status_e (*req_meth_mux)(void *context, io_req *, int mux);
 
+    // Direct memory interface callback set by the user.
+    io_dmi_meth_t *dmi_meth = NULL;
+
 
 
     /*
@@ -423,6 +519,10 @@ namespace vp {
     // Multiplexed ID set by the slave when port is multiplxed
     int req_mux_id;
 
+    // Master ports bound to this port, which must be notified when the direct
+    // memory interface grants are invalidated
+    std::vector<io_master *> dmi_masters;
+
 
     // Master context when the binding is crossing frequency domains.
     // We keep here a copy of the master context when the binding is crossing frequency
@@ -438,6 +538,7 @@ namespace vp {
     // Set default callbacks in case the user does not set them
     this->resp_meth = &io_master::resp_default;
     this->grant_meth = &io_master::grant_default;
+    this->dmi_invalidate_meth = &io_master::dmi_invalidate_default;
   }
 
 
@@ -472,6 +573,82 @@ namespace vp {
 
 
 
+  inline bool io_master::dmi_req(io_req *req, io_dmi *dmi)
+  {
+    if (this->dmi_meth == NULL)
+      return false;
+    return this->dmi_meth(this->dmi_context, req, dmi);
+  }
+
+
+
+  inline bool io_master::dmi_req(io_req *req, io_dmi *dmi, io_slave *port)
+  {
+    if (port->dmi_meth == NULL)
+      return false;
+    return port->dmi_meth(port->get_context(), req, dmi);
+  }
+
+
+
+  inline io_req_status_e io_master::debug_req(uint64_t addr, uint8_t *data, uint64_t size, bool is_write)
+  {
+    io_req req(addr, data, size, is_write);
+    io_dmi dmi;
+
+    // Copy as much as possible through host pointers, a grant usually covers the
+    // whole access
+    while (size > 0 && this->dmi_req(&req, &dmi) && dmi.contains(addr, 1))
+    {
+      uint64_t chunk = std::min(size, dmi.base + dmi.size - addr);
+      if (dmi.data == NULL)
+      {
+        uint64_t word_size = 1ULL << dmi.word_bits;
+        chunk = std::min(chunk, word_size - ((addr - dmi.origin) & (word_size - 1)));
+      }
+
+      uint8_t *host_ptr = dmi.get_host_ptr(addr, chunk);
+      if (is_write)
+        memcpy(host_ptr, data, chunk);
+      else
+        memcpy(data, host_ptr, chunk);
+
+      addr += chunk;
+      data += chunk;
+      size -= chunk;
+      req.init();
+      req.set_addr(addr);
+      req.set_data(data);
+      req.set_size(size);
+    }
+
+    if (size == 0)
+      return IO_REQ_OK;
+
+    req.set_debug(true);
+    io_req_status_e status = this->req(&req);
+    if (status != IO_REQ_INVALID)
+      return status;
+
+    // Some slaves only accept accesses of a given size, try again byte per byte
+    // so that the access is only rejected where it is really invalid
+    for (uint64_t i = 0; i < size; i++)
+    {
+      req.init();
+      req.set_debug(true);
+      req.set_addr(addr + i);
+      req.set_data(data + i);
+      req.set_size(1);
+      status = this->req(&req);
+      if (status != IO_REQ_OK)
+        return status;
+    }
+
+    return IO_REQ_OK;
+  }
+
+
+
   inline io_req *io_master::req_new(uint64_t addr, uint8_t *data, uint64_t size, bool is_write)
   {
     // For now we allocate new requests but this would be better to manage a pool of requests
@@ -503,12 +680,25 @@ namespace vp {
 
 
 
+  inline void io_master::set_dmi_invalidate_meth(io_dmi_invalidate_meth_t *meth)
+  {
+    dmi_invalidate_meth = meth;
+  }
+
+
+
   inline void io_master::resp_default(void *, io_req *)
   {
   }
 
 
 
+  inline void io_master::dmi_invalidate_default(void *)
+  {
+  }
+
+
+
   inline void io_master::grant_default(void *, io_req *)
   {
   }
@@ -523,6 +713,9 @@ namespace vp {
     vp_assert(port != NULL, this->get_owner()->get_trace(),
       "Binding to NULL slave port\n");
 
+    this->dmi_meth = port->dmi_meth;
+    this->dmi_context = port->get_context();
+
     if (port->req_meth_mux == NULL)
     {
       // Normal binding, just register the method and context into the master
@@ -618,6 +811,8 @@ namespace vp {
     port->slave_port->master_resp_meth = port->resp_meth;
     port->slave_port->master_grant_meth = port->grant_meth;
     port->slave_port->set_remote_context(port->get_context());
+
+    this->dmi_masters.push_back(port);
   }
 
 
@@ -638,6 +833,23 @@ namespace vp {
 
 
 
+  inline void io_slave::set_dmi_meth(io_dmi_meth_t *meth)
+  {
+    this->dmi_meth = meth;
+  }
+
+
+
+  inline void io_slave::dmi_invalidate()
+  {
+    for (io_master *master: this->dmi_masters)
+    {
+      master->dmi_invalidate_meth(master->get_context());
+    }
+  }
+
+
+
   inline io_req_status_e io_slave::req_default(io_slave *, io_req *)
   {
     return IO_REQ_OK;
@@ -699,6 +911,21 @@ namespace vp {
     }
   }
 
+  inline uint8_t *io_dmi::get_host_ptr(uint64_t addr, uint64_t size)
+  {
+    uint64_t offset = addr - this->origin;
+
+    if (this->data)
+      return this->data + offset;
+
+    uint64_t word_mask = (1ULL << this->word_bits) - 1;
+    if ((offset & word_mask) + size > word_mask + 1)
+      return NULL;
+
+    uint8_t *bank = this->banks[(offset >> this->word_bits) & ((1ULL << this->bank_bits) - 1)];
+    return bank + ((offset >> (this->word_bits + this->bank_bits)) << this->word_bits) + (offset & word_mask);
+  }
+
   inline void io_req::save()
   {
     arg_push((void *)(long)this->addr);
@@ -41,6 +41,9 @@ namespace vp {
   typedef void (qspim_slave_sync_meth_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
   typedef void (qspim_slave_sync_meth_muxed_t)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
 
+  typedef void (qspim_burst_meth_t)(void *, uint8_t *data, int nb_bits, int lines, bool is_rx);
+  typedef void (qspim_burst_meth_muxed_t)(void *, uint8_t *data, int nb_bits, int lines, bool is_rx, int id);
+
 
 
   class qspim_master : public vp::master_port
@@ -61,6 +64,19 @@ namespace vp {
       return cs_sync_meth(this->get_remote_context(), cs, active);
     }
 
+    // Transfer a whole phase of a transaction (command, address, data, ...) at once.
+    // The nb_bits bits are transferred on 1 or 4 data lines, MSB first. They are read from
+    // data for a TX phase, and written to data for an RX phase, as sampled by the master
+    // on each edge. The master is in charge of the phase duration.
+    // If the slave does not handle bursts, the phase is converted into edges.
+    inline void burst(uint8_t *data, int nb_bits, int lines, bool is_rx)
+    {
+      if (burst_meth)
+        burst_meth(this->burst_context, data, nb_bits, lines, is_rx);
+      else
+        burst_to_edges(data, nb_bits, lines, is_rx);
+    }
+
     void bind_to(vp::port *port, vp::config *config);
 
     inline void set_sync_meth(qspim_slave_sync_meth_t *meth);
@@ -73,6 +89,10 @@ namespace vp {
 
     static inline void sync_muxed_stub(qspim_master *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     static inline void cs_sync_muxed_stub(qspim_master *_this, int cs, int active);
+    static inline void burst_muxed_stub(qspim_master *_this, uint8_t *data, int nb_bits, int lines, bool is_rx);
+    static inline void slave_sync_stub(qspim_master *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+
+    inline void burst_to_edges(uint8_t *data, int nb_bits, int lines, bool is_rx);
 
     void (*slave_sync)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     void (*slave_sync_mux)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
@@ -81,6 +101,11 @@ namespace vp {
     void (*sync_meth_mux)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync_meth)(void *, int cs, int active);
     void (*cs_sync_meth_mux)(void *, int cs, int active, int mux);
+    void (*burst_meth)(void *, uint8_t *data, int nb_bits, int lines, bool is_rx);
+    void (*burst_meth_mux)(void *, uint8_t *data, int nb_bits, int lines, bool is_rx, int mux);
+    // The slave may bind its burst method differently from its sync methods, so the
+    // burst has its own context
+    void *burst_context;
 
     static inline void sync_default(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
 
@@ -90,6 +115,9 @@ namespace vp {
     qspim_slave *slave_port = NULL;
 
     int mux_id;
+
+    // Last data lines driven by the slave, sampled when bursts are converted into edges
+    int rx_bits = 0;
   };
 
 
@@ -114,26 +142,26 @@ namespace vp {
     inline void set_cs_sync_meth(qspim_cs_sync_meth_t *meth);
     inline void set_cs_sync_meth_muxed(qspim_cs_sync_meth_muxed_t *meth, int id);
 
+    // Optional, slaves which do not set it receive bursts as edges
+    inline void set_burst_meth(qspim_burst_meth_t *meth);
+    inline void set_burst_meth_muxed(qspim_burst_meth_muxed_t *meth, int id);
+
     inline void bind_to(vp::port *_port, vp::config *config);
 
   private:
 
-    static inline void sync_muxed_stub(qspim_slave *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
-
-
     void (*slave_sync_meth)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
-    void (*slave_sync_meth_mux)(void *, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
 
     void (*sync_meth)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     void (*sync_mux_meth)(void *comp, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int mux);
     void (*cs_sync)(void *comp, int cs, int active);
     void (*cs_sync_mux)(void *comp, int cs, int active, int mux);
+    void (*burst_meth)(void *comp, uint8_t *data, int nb_bits, int lines, bool is_rx);
+    void (*burst_mux_meth)(void *comp, uint8_t *data, int nb_bits, int lines, bool is_rx, int mux);
 
     static inline void sync_default(qspim_slave *, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
     static inline void cs_sync_default(qspim_slave *, int cs, int active);
 
-    vp::component *comp_mux;
-    int sync_mux;
     int mux_id;
 
 
@@ -143,6 +171,7 @@ namespace vp {
   inline qspim_master::qspim_master() {
     slave_sync = &qspim_master::sync_default;
     slave_sync_mux = NULL;
+    burst_meth = NULL;
   }
 
 
@@ -162,6 +191,51 @@ namespace vp {
 
 
 
+  inline void qspim_master::burst_muxed_stub(qspim_master *_this, uint8_t *data, int nb_bits, int lines, bool is_rx)
+  {
+    return _this->burst_meth_mux(_this->comp_mux, data, nb_bits, lines, is_rx, _this->sync_mux);
+  }
+
+
+
+  inline void qspim_master::slave_sync_stub(qspim_master *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+  {
+    _this->rx_bits = (data_3 << 3) | (data_2 << 2) | (data_1 << 1) | (data_0 << 0);
+
+    if (_this->slave_sync_mux)
+      _this->slave_sync_mux(_this->get_context(), sck, data_0, data_1, data_2, data_3, mask, _this->mux_id);
+    else
+      _this->slave_sync(_this->get_context(), sck, data_0, data_1, data_2, data_3, mask);
+  }
+
+
+
+  inline void qspim_master::burst_to_edges(uint8_t *data, int nb_bits, int lines, bool is_rx)
+  {
+    int lines_mask = (1 << lines) - 1;
+
+    for (int bit=0; bit<nb_bits; bit+=lines)
+    {
+      uint8_t *byte = &data[bit / 8];
+      int shift = 8 - lines - bit % 8;
+
+      if (is_rx)
+      {
+        // As on the pins, the master samples what the slave drove during the previous edge
+        int value = lines == 1 ? (this->rx_bits >> 1) & 1 : this->rx_bits & lines_mask;
+        *byte = (*byte & ~(lines_mask << shift)) | (value << shift);
+        this->sync(1, 0, 0, 0, 0, 0);
+      }
+      else
+      {
+        int value = (*byte >> shift) & lines_mask;
+        this->sync(1, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1, lines_mask);
+      }
+    }
+  }
+
+
+
   inline void qspim_master::bind_to(vp::port *_port, vp::config *config)
   {
     qspim_slave *port = (qspim_slave *)_port;
@@ -183,6 +257,20 @@ namespace vp {
       comp_mux = (vp::component *)port->get_context();
       sync_mux = port->mux_id;
     }
+
+    if (port->burst_mux_meth == NULL)
+    {
+      burst_meth = port->burst_meth;
+      burst_context = port->get_context();
+    }
+    else
+    {
+      burst_meth_mux = port->burst_mux_meth;
+      burst_meth = (qspim_burst_meth_t *)&qspim_master::burst_muxed_stub;
+      burst_context = this;
+      comp_mux = (vp::component *)port->get_context();
+      sync_mux = port->mux_id;
+    }
   }
 
   inline void qspim_master::set_sync_meth(qspim_slave_sync_meth_t *meth)
@@ -201,33 +289,19 @@ namespace vp {
   {
   }
 
-  inline void qspim_slave::sync_muxed_stub(qspim_slave *_this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
-  {
-    return _this->slave_sync_meth_mux(_this->comp_mux, sck, data_0, data_1, data_2, data_3, mask, _this->sync_mux);
-  }
-
   inline void qspim_slave::bind_to(vp::port *_port, vp::config *config)
   {
     slave_port::bind_to(_port, config);
     qspim_master *port = (qspim_master *)_port;
     port->slave_port = this;
-    if (port->slave_sync_mux == NULL)
-    {
-      this->slave_sync_meth = port->slave_sync;
-      this->set_remote_context(port->get_context());
-    }
-    else
-    {
-      this->slave_sync_meth_mux = port->slave_sync_mux;
-      this->slave_sync_meth = (qspim_slave_sync_meth_t *)&qspim_slave::sync_muxed_stub;
 
-      set_remote_context(this);
-      comp_mux = (vp::component *)port->get_context();
-      sync_mux = port->mux_id;
-    }
+    // The slave always goes through the master port so that it can sample the data lines
+    // when it converts bursts into edges. The port then calls the muxed or normal method.
+    this->slave_sync_meth = (qspim_slave_sync_meth_t *)&qspim_master::slave_sync_stub;
+    this->set_remote_context(port);
   }
 
-  inline qspim_slave::qspim_slave() : sync_meth(NULL), sync_mux_meth(NULL) {
+  inline qspim_slave::qspim_slave() : sync_meth(NULL), sync_mux_meth(NULL), burst_meth(NULL), burst_mux_meth(NULL) {
     sync_meth = (qspim_sync_meth_t *)&qspim_slave::sync_default;
     cs_sync = (qspim_cs_sync_meth_t *)&qspim_slave::cs_sync_default;
   }
@@ -258,6 +332,19 @@ namespace vp {
     mux_id = id;
   }
 
+  inline void qspim_slave::set_burst_meth(qspim_burst_meth_t *meth)
+  {
+    burst_meth = meth;
+    burst_mux_meth = NULL;
+  }
+
+  inline void qspim_slave::set_burst_meth_muxed(qspim_burst_meth_muxed_t *meth, int id)
+  {
+    burst_mux_meth = meth;
+    burst_meth = NULL;
+    mux_id = id;
+  }
+
   inline void qspim_slave::sync_default(qspim_slave *, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
   {
   }
@@ -24,6 +24,7 @@
 
 #include "vp/vp_data.hpp"
 #include "vp/component.hpp"
+#include <atomic>
 
 #ifdef __VP_USE_SYSTEMC
 #include <systemc.h>
@@ -33,6 +34,80 @@ namespace vp
 {
 
 class time_engine_client;
+class time_engine;
+
+// Maximum duration of a window in parallel mode, so that the engine regularly gets
+// back control to handle stop requests even if the partitions never interact
+#define TIME_ENGINE_MAX_WINDOW 1000000
+
+// Binary min-heap of time engine clients ordered by next event time.
+// Each client knows its position in the heap so that it can be moved
+// or removed without searching for it.
+class time_client_heap
+{
+public:
+    inline time_engine_client *first() { return this->clients.size() ? this->clients[0] : NULL; }
+
+    // Insert the client, or move it closer to the head if it is already in the heap
+    // with a later time. Return true if the client position changed.
+    inline bool enqueue(time_engine_client *client, int64_t time);
+
+    inline bool dequeue(time_engine_client *client);
+
+    void push(time_engine_client *client);
+    time_engine_client *pop();
+
+private:
+    inline bool is_before(time_engine_client *a, time_engine_client *b);
+    inline void set(int index, time_engine_client *client);
+    void sift_up(int index);
+    void sift_down(int index);
+    void remove(time_engine_client *client);
+
+    std::vector<time_engine_client *> clients;
+    // Incremented each time a client is enqueued, to order clients with the same time
+    // from the most recently enqueued one to the oldest one
+    int64_t seq = 0;
+};
+
+// Interactions between components of different time partitions, used in parallel mode.
+// Partitions are only synchronized at the end of each window, where sync is called with
+// all partitions stopped. A channel must delay what goes through it by at least its
+// lookahead, so that it is delivered to the other partition in a later window.
+class time_sync_channel
+{
+public:
+    virtual void sync() = 0;
+};
+
+// Group of clients executed by its own thread in parallel mode.
+// Clients of a partition must only interact with clients of other partitions
+// through sync channels.
+class time_partition
+{
+    friend class time_engine;
+
+public:
+    time_partition(time_engine *engine, int id) : engine(engine), id(id) {}
+
+    // Execute all the events before the end of the current window
+    void run_window();
+
+    inline bool fast_forward(int64_t time);
+
+    // Partition executed by the calling thread, or NULL if it is not a partition thread
+    static thread_local time_partition *current;
+
+    time_engine *engine;
+    int id;
+    time_client_heap clients;
+    // Time of the last executed event
+    int64_t time = 0;
+    int64_t window_end = 0;
+
+private:
+    pthread_t thread;
+};
 
 class time_engine : public component
 {
@@ -81,7 +156,17 @@ public:
 
     bool enqueue(time_engine_client *client, int64_t time);
 
-    int64_t get_time() { return time; }
+    inline int64_t get_time();
+
+    // Return the partition with this ID, creating it if needed, or NULL if the engine
+    // is not running in parallel mode
+    time_partition *get_partition(int id);
+
+    inline bool is_parallel() { return this->parallel; }
+
+    // Declare a channel between partitions, whose lookahead is the minimum delay
+    // it applies to what goes through it
+    void register_sync_channel(time_sync_channel *channel, int64_t lookahead);
 
     inline void retain() { retain_count++; }
     inline void release() { retain_count--; }
@@ -90,10 +175,42 @@ public:
 
     inline void update(int64_t time);
 
+    // Move the time forward on behalf of the client being executed, as if it had returned
+    // and been scheduled again at this time. This is only possible if no other client has
+    // something to execute before, otherwise false is returned and time is not modified.
+    inline bool fast_forward(int64_t time);
+
     void wait_ready();
 
+    // Wait until the engine is stopped, either paused or finished. Return true if it
+    // is paused.
+    bool wait_stopped();
+
+    // Fork the process while the engine is paused, and start again the engine thread
+    // in the child process. Return the value returned by fork.
+    int fork();
+
+    void checkpoint_save(vp::checkpoint *checkpoint);
+    void pre_checkpoint_restore(vp::checkpoint *checkpoint);
+
+    void stop();
+
 private:
-    time_engine_client *first_client = NULL;
+    inline time_engine_client *get_first_client() { return this->clients.first(); }
+    inline void client_push(time_engine_client *client) { this->clients.push(client); }
+    inline time_engine_client *client_pop() { return this->clients.pop(); }
+    bool has_clients();
+
+    // Parallel mode, see time_partition
+    int64_t get_partition_time();
+    bool fast_forward_partition(int64_t time);
+    bool enqueue_partition(time_engine_client *client, int64_t time);
+    void start_partitions();
+    void stop_partitions();
+    bool run_window();
+    static void *partition_routine(void *arg);
+
+    time_client_heap clients;
     bool locked = false;
     bool locked_run_req;
     bool run_req;
@@ -102,7 +219,7 @@ private:
     bool finished = false;
     bool init = false;
 
-    bool running;
+    bool running = false;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
     pthread_t run_thread;
@@ -110,7 +227,8 @@ private:
     int64_t time = 0;
     int stop_status = -1;
     bool engine_has_been_stopped = false;
-    int retain_count = 0;
+    // Atomic as it can be modified by several partitions in parallel mode
+    std::atomic<int> retain_count{0};
     bool no_exit;
     int stop_retain_count = 0;
 
@@ -119,6 +237,18 @@ private:
     bool started = false;
 #endif
 
+    bool parallel = false;
+    std::vector<time_partition *> partitions;
+    std::vector<time_sync_channel *> sync_channels;
+    int64_t lookahead = TIME_ENGINE_MAX_WINDOW;
+    // Incremented to start a new window on the partition threads
+    std::atomic<int64_t> window_id{0};
+    // Number of partition threads still executing the current window
+    std::atomic<int> nb_running_partitions{0};
+    // Set to make the partition threads exit instead of waiting for the next window
+    std::atomic<bool> partitions_end{false};
+    bool partitions_started = false;
+
 private:
     vp::component *stop_event;
     std::vector<Notifier *> exec_notifiers;
@@ -128,6 +258,8 @@ class time_engine_client : public component
 {
 
     friend class time_engine;
+    friend class time_client_heap;
+    friend class time_partition;
 
 public:
     time_engine_client(js::config *config)
@@ -147,12 +279,23 @@ public:
         return engine->dequeue(this);
     }
 
-    inline int64_t get_time() { return engine->get_time(); }
+    inline int64_t get_time() { return this->partition ? this->partition->time : engine->get_time(); }
+
+    // Attach the client to a partition of the engine, which must be set, in parallel mode
+    inline void set_partition(int id) { this->partition = this->engine->get_partition(id); }
+
+    inline void set_partition(time_partition *partition) { this->partition = partition; }
+
+    inline time_partition *get_partition() { return this->partition; }
 
     virtual int64_t exec() = 0;
 
 protected:
-    time_engine_client *next;
+    // Position of the client in the time engine heap
+    int heap_index;
+
+    // Enqueue order, used to order clients having the same next event time
+    int64_t enqueue_seq;
 
     // This gives the time of the next event.
     // It is only valid when the client is not the currently active one,
@@ -161,10 +304,82 @@ protected:
     int64_t next_event_time = 0;
 
     vp::time_engine *engine;
+    // Partition executing the client in parallel mode, NULL otherwise
+    vp::time_partition *partition = NULL;
     bool running = false;
     bool is_enqueued = false;
 };
 
+inline bool vp::time_client_heap::is_before(time_engine_client *a, time_engine_client *b)
+{
+    return a->next_event_time < b->next_event_time ||
+        (a->next_event_time == b->next_event_time && a->enqueue_seq > b->enqueue_seq);
+}
+
+inline void vp::time_client_heap::set(int index, time_engine_client *client)
+{
+    this->clients[index] = client;
+    client->heap_index = index;
+}
+
+inline bool vp::time_client_heap::enqueue(time_engine_client *client, int64_t time)
+{
+    if (client->is_running())
+        return false;
+
+    if (client->is_enqueued)
+    {
+        if (client->next_event_time <= time)
+            return false;
+
+        // The client can only move closer to the head, just update its position
+        client->next_event_time = time;
+        client->enqueue_seq = this->seq++;
+        this->sift_up(client->heap_index);
+
+        return true;
+    }
+
+    client->is_enqueued = true;
+    client->next_event_time = time;
+    this->push(client);
+
+    return true;
+}
+
+inline bool vp::time_client_heap::dequeue(time_engine_client *client)
+{
+    if (!client->is_enqueued)
+        return false;
+
+    client->is_enqueued = false;
+
+    this->remove(client);
+
+    return true;
+}
+
+inline bool vp::time_partition::fast_forward(int64_t time)
+{
+    time_engine_client *first = this->clients.first();
+
+    // The window end is never crossed as other partitions may send something for it
+    if (time >= this->window_end || (first && first->next_event_time < time))
+        return false;
+
+    this->time = time;
+
+    return true;
+}
+
+inline int64_t vp::time_engine::get_time()
+{
+    if (likely(!this->parallel))
+        return this->time;
+
+    return this->get_partition_time();
+}
+
 // This can be called from anywhere so just propagate the stop request
 // to the main python thread which will take care of stopping the engine.
 inline void vp::time_engine::stop_engine(int status, bool force, bool no_retain)
@@ -287,8 +502,37 @@ inline void vp::time_engine::fatal(const char *fmt, ...)
 
 inline void vp::time_engine::update(int64_t time)
 {
-    if (time > this->time)
+    time_partition *partition = this->parallel ? time_partition::current : NULL;
+
+    if (partition)
+    {
+        if (time > partition->time)
+            partition->time = time;
+    }
+    else if (time > this->time)
+    {
         this->time = time;
+    }
+}
+
+inline bool vp::time_engine::fast_forward(int64_t time)
+{
+#if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
+    // The external simulator must see every time step
+    return false;
+#else
+    if (unlikely(this->parallel))
+        return this->fast_forward_partition(time);
+
+    time_engine_client *first = this->get_first_client();
+
+    if (!this->run_req || (first && first->next_event_time < time))
+        return false;
+
+    this->time = time;
+
+    return true;
+#endif
 }
 
 }; // namespace vp
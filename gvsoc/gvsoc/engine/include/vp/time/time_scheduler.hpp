@@ -42,6 +42,10 @@ namespace vp {
 
         int64_t exec();
 
+        void checkpoint_save(vp::checkpoint *checkpoint);
+
+        void pre_checkpoint_restore(vp::checkpoint *checkpoint);
+
     private:
         time_event *first_event;
     };
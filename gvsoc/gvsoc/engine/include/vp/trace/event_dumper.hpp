@@ -77,6 +77,8 @@ namespace vp {
     Event_trace *get_trace_string(string trace_name, string file_name);
     void close();
     void set_vcd_user(gv::Vcd_user *user);
+    // Tell if some events are dumped to files
+    bool has_files() { return !this->event_files.empty(); }
 
     vp::component *comp;
 
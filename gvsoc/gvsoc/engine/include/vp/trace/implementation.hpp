@@ -160,10 +160,18 @@ namespace vp {
   #ifdef VP_TRACE_ACTIVE
   	if (is_active && comp->traces.get_trace_manager()->get_trace_level() >= this->level)
     {
-      dump_header();
       va_list ap;
       va_start(ap, fmt);
-      if (vfprintf(this->trace_file, fmt, ap) < 0) {}
+      trace_binary_writer *binary_writer = comp->traces.get_trace_manager()->get_binary_writer();
+      if (binary_writer)
+      {
+        binary_writer->dump_msg(this, -1, fmt, ap);
+      }
+      else
+      {
+        dump_header();
+        if (vfprintf(this->trace_file, fmt, ap) < 0) {}
+      }
       va_end(ap);  
     }
   #endif
@@ -174,6 +182,16 @@ namespace vp {
   #ifdef VP_TRACE_ACTIVE
     if (is_active && comp->traces.get_trace_manager()->get_trace_level() >= level)
     {
+      trace_binary_writer *binary_writer = comp->traces.get_trace_manager()->get_binary_writer();
+      if (binary_writer)
+      {
+        va_list ap;
+        va_start(ap, fmt);
+        binary_writer->dump_msg(this, level, fmt, ap);
+        va_end(ap);
+        return;
+      }
+
       dump_header();
       if (level == vp::trace::LEVEL_ERROR)
       {
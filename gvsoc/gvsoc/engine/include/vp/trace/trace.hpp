@@ -37,6 +37,7 @@ namespace vp {
 
     friend class component_trace;
     friend class trace_engine;
+    friend class trace_binary_writer;
 
   public:
 
@@ -46,6 +47,8 @@ namespace vp {
     static const int LEVEL_DEBUG   = 3;
     static const int LEVEL_TRACE   = 4;
 
+    // The format string must be a constant string, as binary traces only keep
+    // a reference to it and format the message later on.
     inline void msg(int level, const char *fmt, ...);
     inline void msg(const char *fmt, ...);
     inline void user_msg(const char *fmt, ...);
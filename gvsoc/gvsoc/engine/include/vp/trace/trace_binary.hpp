@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#ifndef __VP_TRACE_TRACE_BINARY_HPP__
+#define __VP_TRACE_TRACE_BINARY_HPP__
+
+#include <stdint.h>
+
+// Binary format of the trace messages.
+// This file is shared between the engine, which writes the messages, and the
+// decoder, which converts them back to text, so it must not depend on anything else.
+//
+// The file starts with a trace_binary_header_t, followed by blocks. Each block
+// starts with a trace_binary_block_t and contains records, possibly compressed
+// with LZ4. Records never cross blocks and always start with a
+// trace_binary_record_t, their size being a multiple of 8 bytes.
+// Traces and format strings are declared once with a definition record, and
+// then referenced by their ID in the message records.
+
+#define TRACE_BINARY_MAGIC "GVTRACE1"
+#define TRACE_BINARY_VERSION 1
+
+#define TRACE_BINARY_BLOCK_SIZE (1<<20)
+#define TRACE_BINARY_MAX_RECORD_SIZE 4096
+
+#define TRACE_BINARY_COMPRESSION_NONE 0
+#define TRACE_BINARY_COMPRESSION_LZ4  1
+
+typedef enum
+{
+    // Only used in the engine ring buffer to skip its end
+    TRACE_BINARY_RECORD_PADDING,
+    // Declares a trace path, followed by the path
+    TRACE_BINARY_RECORD_TRACE,
+    // Declares a format string, followed by the string
+    TRACE_BINARY_RECORD_FORMAT,
+    // Trace message, followed by the arguments
+    TRACE_BINARY_RECORD_MSG,
+} trace_binary_record_type_e;
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t max_path_len;
+} trace_binary_header_t;
+
+typedef struct
+{
+    // Size of the records once uncompressed
+    uint32_t size;
+    // Size of the data in the file, which is the same as size if not compressed
+    uint32_t compressed_size;
+    uint32_t compression;
+    uint32_t reserved;
+} trace_binary_block_t;
+
+typedef struct
+{
+    uint16_t type;
+    // Level of the message for colors, or -1 if it has none
+    int16_t level;
+    // Full size of the record, including this header
+    uint32_t size;
+} trace_binary_record_t;
+
+// Trace and format definition, followed by the null-terminated string
+typedef struct
+{
+    trace_binary_record_t header;
+    uint64_t id;
+} trace_binary_def_t;
+
+// Message, followed by one 64 bits slot per argument, except for strings
+// which are stored as a 64 bits length followed by the characters, padded
+// to 8 bytes
+typedef struct
+{
+    trace_binary_record_t header;
+    // Trace pointer in the engine, trace ID in the file
+    uint64_t trace;
+    // Format string pointer in the engine, format ID in the file
+    uint64_t format;
+    int64_t time;
+    int64_t cycles;
+} trace_binary_msg_t;
+
+typedef enum
+{
+    TRACE_BINARY_ARG_NONE,
+    TRACE_BINARY_ARG_INT,
+    TRACE_BINARY_ARG_LONG,
+    TRACE_BINARY_ARG_DOUBLE,
+    TRACE_BINARY_ARG_LONG_DOUBLE,
+    TRACE_BINARY_ARG_STRING,
+    TRACE_BINARY_ARG_POINTER,
+} trace_binary_arg_e;
+
+static inline uint32_t trace_binary_align(uint32_t size)
+{
+    return (size + 7) & ~7;
+}
+
+// Parse the printf conversion specification starting at fmt, which must point
+// to a '%'. Return the first character after it, and give the type of the
+// argument and the number of '*' width or precision arguments before it.
+static inline const char *trace_binary_parse_spec(const char *fmt, trace_binary_arg_e *type, int *nb_stars)
+{
+    int nb_l = 0;
+    bool is_L = false;
+
+    *nb_stars = 0;
+    *type = TRACE_BINARY_ARG_NONE;
+    fmt++;
+
+    // Flags, width and precision
+    while (*fmt && (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '0' ||
+        *fmt == '.' || *fmt == '*' || *fmt == '\'' || (*fmt >= '1' && *fmt <= '9')))
+    {
+        if (*fmt == '*')
+            (*nb_stars)++;
+        fmt++;
+    }
+
+    // Length modifiers
+    while (*fmt && (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'q' || *fmt == 'j' || *fmt == 'z' || *fmt == 't'))
+    {
+        if (*fmt == 'l')
+            nb_l++;
+        else if (*fmt == 'L')
+            is_L = true;
+        else if (*fmt == 'q' || *fmt == 'j' || *fmt == 'z' || *fmt == 't')
+            nb_l = 2;
+        fmt++;
+    }
+
+    switch (*fmt)
+    {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            *type = nb_l ? TRACE_BINARY_ARG_LONG : TRACE_BINARY_ARG_INT;
+            break;
+        case 'c':
+            *type = TRACE_BINARY_ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *type = is_L ? TRACE_BINARY_ARG_LONG_DOUBLE : TRACE_BINARY_ARG_DOUBLE;
+            break;
+        case 's':
+            // Wide strings are not supported and only their pointer is kept
+            *type = nb_l ? TRACE_BINARY_ARG_POINTER : TRACE_BINARY_ARG_STRING;
+            break;
+        case 'p': case 'n':
+            *type = TRACE_BINARY_ARG_POINTER;
+            break;
+        case 0:
+            return fmt;
+    }
+
+    return fmt + 1;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#ifndef __VP_TRACE_TRACE_BINARY_WRITER_HPP__
+#define __VP_TRACE_TRACE_BINARY_WRITER_HPP__
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include "vp/trace/trace_binary.hpp"
+
+namespace vp {
+
+  class trace;
+  class trace_engine;
+
+  // Size of the ring buffer between the simulation thread and the writer thread.
+  // Must be a power of 2.
+  #define TRACE_BINARY_RING_SIZE (1<<22)
+
+  // Writer of trace messages in binary format.
+  // The simulation thread only copies the message arguments into a single-producer
+  // single-consumer ring buffer. A dedicated thread converts trace and format
+  // pointers into IDs, groups the records into blocks, compresses them and
+  // writes them to the file.
+  class trace_binary_writer
+  {
+  public:
+    trace_binary_writer(trace_engine *engine, std::string path, int compression);
+
+    // Called from the simulation thread to dump a message
+    void dump_msg(vp::trace *trace, int level, const char *fmt, va_list ap);
+
+    // Flush all the messages and close the file
+    void stop();
+
+  private:
+    inline uint8_t *reserve(uint32_t size);
+    inline void commit(uint32_t size);
+
+    void writer_routine();
+    void handle_record(trace_binary_record_t *record);
+    void write_def(int type, uint64_t id, const char *str);
+    void write_record(void *record, uint32_t size);
+    void flush_block();
+
+    trace_engine *engine;
+    FILE *file;
+    int compression;
+    std::thread *thread;
+
+    // Ring buffer, with positions always incremented and masked on access
+    uint8_t *ring;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<bool> end;
+
+    // Only used by the writer thread
+    bool header_dumped = false;
+    uint8_t *block;
+    uint8_t *compressed_block;
+    uint32_t block_size = 0;
+    std::unordered_map<uint64_t, uint64_t> trace_ids;
+    std::unordered_map<uint64_t, uint64_t> format_ids;
+  };
+
+};
+
+#endif
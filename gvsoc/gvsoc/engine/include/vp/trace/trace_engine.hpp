@@ -25,6 +25,7 @@
 #include "vp/vp_data.hpp"
 #include "vp/component.hpp"
 #include "vp/trace/trace.hpp"
+#include "vp/trace/trace_binary_writer.hpp"
 #include "gv/gvsoc.hpp"
 #include <pthread.h>
 #include <thread>
@@ -36,6 +37,7 @@ namespace vp {
 
   #define TRACE_FORMAT_LONG  0
   #define TRACE_FORMAT_SHORT 1
+  #define TRACE_FORMAT_BINARY 2
 
   class trace_engine : public component
   {
@@ -51,6 +53,9 @@ namespace vp {
     virtual void set_trace_level(const char *trace_level) = 0;
 
     int get_format() { return this->trace_format; }
+
+    // Return the binary writer when messages are dumped in binary format, NULL otherwise
+    inline trace_binary_writer *get_binary_writer() { return this->binary_writer; }
     
     void set_vcd_user(gv::Vcd_user *user)
     {
@@ -80,9 +85,15 @@ namespace vp {
     virtual void check_traces() {}
 
   protected:
+    // The thread dumping the events must be stopped during a fork as it would not be in
+    // the child process
+    void start_vcd_thread();
+    void stop_vcd_thread();
+
     std::map<std::string, trace *> traces_map;
     std::vector<trace *> traces_array;
     int trace_format;
+    trace_binary_writer *binary_writer = NULL;
 
   private:
     void enqueue_pending(vp::trace *trace, int64_t timestamp, uint8_t *event);
@@ -46,7 +46,7 @@ def appendArgs(parser: argparse.ArgumentParser, runnerConfig: js.config) -> None
     parser.add_argument("--trace-format",
                         dest="trace_format",
                         default="long",
-                        help="Specify trace format")
+                        help="Specify trace format (long, short or binary)")
 
     parser.add_argument("--vcd", dest="vcd", action="store_true", help="Activate VCD traces")
 
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <vp/vp.hpp>
+#include <vp/checkpoint.hpp>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The file starts with a header giving the position of the index, which is written
+// at the end, once all the blocks are known
+#define CHECKPOINT_MAGIC "GVCKPT01"
+
+typedef struct
+{
+    char magic[8];
+    uint64_t index_offset;
+    uint64_t nb_blocks;
+} checkpoint_header_t;
+
+typedef struct
+{
+    int64_t cycle;
+    uint8_t enqueued;
+    uint8_t payload[CLOCK_EVENT_PAYLOAD_SIZE];
+} checkpoint_event_t;
+
+vp::checkpoint::~checkpoint()
+{
+    if (this->file)
+    {
+        fclose(this->file);
+    }
+
+    if (this->data)
+    {
+        munmap(this->data, this->data_size);
+    }
+}
+
+int vp::checkpoint::open(std::string path, bool is_save)
+{
+    this->is_save = is_save;
+
+    if (is_save)
+    {
+        this->file = fopen(path.c_str(), "wb");
+        if (this->file == NULL)
+        {
+            this->error("Failed to open checkpoint file (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+            return -1;
+        }
+
+        checkpoint_header_t header = {};
+        if (fwrite(&header, sizeof(header), 1, this->file) != 1)
+        {
+            this->error("Failed to write checkpoint file (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+            return -1;
+        }
+
+        return 0;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        this->error("Failed to open checkpoint file (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+        return -1;
+    }
+
+    struct stat stat;
+    if (fstat(fd, &stat) == -1 || (size_t)stat.st_size < sizeof(checkpoint_header_t))
+    {
+        ::close(fd);
+        this->error("Invalid checkpoint file (path: %s)\n", path.c_str());
+        return -1;
+    }
+
+    // The file is mapped private, so that the models can directly work on the mapped
+    // blocks, pages being copied only when they are modified
+    this->data_size = stat.st_size;
+    void *data = mmap(NULL, this->data_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        this->error("Failed to map checkpoint file (path: %s, error: %s)\n", path.c_str(), strerror(errno));
+        return -1;
+    }
+    this->data = (uint8_t *)data;
+
+    checkpoint_header_t *header = (checkpoint_header_t *)this->data;
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->index_offset > this->data_size)
+    {
+        this->error("Invalid checkpoint file (path: %s)\n", path.c_str());
+        return -1;
+    }
+
+    uint8_t *index = this->data + header->index_offset;
+    uint8_t *index_end = this->data + this->data_size;
+    for (uint64_t i=0; i<header->nb_blocks; i++)
+    {
+        uint32_t name_size;
+        block block;
+
+        if (index + sizeof(name_size) > index_end)
+            break;
+        memcpy(&name_size, index, sizeof(name_size));
+        index += sizeof(name_size);
+
+        if (index + name_size + sizeof(block) > index_end)
+            break;
+        std::string name((char *)index, name_size);
+        index += name_size;
+        memcpy(&block, index, sizeof(block));
+        index += sizeof(block);
+
+        if (block.offset + block.size > this->data_size)
+            break;
+
+        this->blocks[name] = block;
+    }
+
+    if (this->blocks.size() != header->nb_blocks)
+    {
+        this->error("Invalid checkpoint file index (path: %s)\n", path.c_str());
+        return -1;
+    }
+
+    return 0;
+}
+
+int vp::checkpoint::close()
+{
+    if (!this->is_save || this->file == NULL)
+        return 0;
+
+    checkpoint_header_t header;
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.index_offset = ftell(this->file);
+    header.nb_blocks = this->blocks.size();
+
+    for (auto &x: this->blocks)
+    {
+        uint32_t name_size = x.first.size();
+        fwrite(&name_size, sizeof(name_size), 1, this->file);
+        fwrite(x.first.c_str(), name_size, 1, this->file);
+        fwrite(&x.second, sizeof(x.second), 1, this->file);
+    }
+
+    fseek(this->file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, this->file);
+
+    int err = ferror(this->file);
+    fclose(this->file);
+    this->file = NULL;
+
+    if (err)
+    {
+        this->error("Failed to write checkpoint file\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+void vp::checkpoint::save(vp::component *comp, std::string name, void *data, size_t size)
+{
+    block block;
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    block.offset = ftell(this->file);
+    if (size >= (size_t)page_size)
+    {
+        // Skipping the padding leaves a hole in the file, which is read as zeros
+        block.offset = (block.offset + page_size - 1) & ~(page_size - 1);
+        fseek(this->file, block.offset, SEEK_SET);
+    }
+    block.size = size;
+
+    if (size && fwrite(data, size, 1, this->file) != 1)
+    {
+        this->error("Failed to write checkpoint block (path: %s, name: %s, error: %s)\n",
+            comp->get_path().c_str(), name.c_str(), strerror(errno));
+    }
+
+    this->blocks[comp->get_path() + ":" + name] = block;
+}
+
+vp::checkpoint::block *vp::checkpoint::get_block(vp::component *comp, std::string name, size_t size)
+{
+    auto it = this->blocks.find(comp->get_path() + ":" + name);
+    if (it == this->blocks.end())
+    {
+        this->error("Checkpoint block not found (path: %s, name: %s)\n", comp->get_path().c_str(), name.c_str());
+        return NULL;
+    }
+
+    if (it->second.size != size)
+    {
+        this->error("Checkpoint block has a different size (path: %s, name: %s, size: %ld, expected: %ld)\n",
+            comp->get_path().c_str(), name.c_str(), it->second.size, size);
+        return NULL;
+    }
+
+    return &it->second;
+}
+
+bool vp::checkpoint::restore(vp::component *comp, std::string name, void *data, size_t size)
+{
+    block *block = this->get_block(comp, name, size);
+    if (block == NULL)
+        return false;
+
+    memcpy(data, this->data + block->offset, size);
+    return true;
+}
+
+uint8_t *vp::checkpoint::map(vp::component *comp, std::string name, size_t size)
+{
+    block *block = this->get_block(comp, name, size);
+    if (block == NULL)
+        return NULL;
+
+    return this->data + block->offset;
+}
+
+void vp::checkpoint::save_event(vp::component *comp, std::string name, vp::clock_event *event)
+{
+    checkpoint_event_t state;
+
+    state.enqueued = event->is_enqueued();
+    state.cycle = state.enqueued ? event->get_cycle() : 0;
+    memcpy(state.payload, event->get_payload(), sizeof(state.payload));
+
+    if (state.enqueued)
+    {
+        this->nb_saved_events++;
+    }
+
+    this->save(comp, name, &state, sizeof(state));
+}
+
+bool vp::checkpoint::restore_event(vp::component *comp, std::string name, vp::clock_event *event)
+{
+    checkpoint_event_t state;
+
+    if (!this->restore(comp, name, &state, sizeof(state)))
+        return false;
+
+    memcpy(event->get_payload(), state.payload, sizeof(state.payload));
+
+    comp->event_cancel(event);
+    if (state.enqueued)
+    {
+        comp->get_clock()->checkpoint_enqueue(event, state.cycle);
+    }
+
+    return true;
+}
+
+void vp::checkpoint::error(const char *fmt, ...)
+{
+    if (this->error_msg != "")
+        return;
+
+    char msg[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    this->error_msg = msg;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <algorithm>
+#include "vp/vp.hpp"
+#include "vp/clock/clock_wheel.hpp"
+
+vp::clock_wheel::clock_wheel()
+{
+    for (int level = 0; level < CLOCK_WHEEL_LEVELS; level++)
+    {
+        this->bitmaps[level] = 0;
+        for (int slot = 0; slot < CLOCK_WHEEL_SLOTS; slot++)
+        {
+            this->slots[level][slot] = NULL;
+        }
+    }
+}
+
+void vp::clock_wheel::insert_slot(vp::clock_event *event)
+{
+    int level = get_level(event->cycle, this->cycle);
+    int slot = get_slot(event->cycle, level);
+    vp::clock_event **queue = &this->slots[level][slot];
+
+    event->queue = queue;
+    event->prev = NULL;
+    event->next = *queue;
+    if (*queue)
+        (*queue)->prev = event;
+    *queue = event;
+
+    this->bitmaps[level] |= 1ULL << slot;
+}
+
+void vp::clock_wheel::insert(vp::clock_event *event, int64_t cycle)
+{
+    vp_assert(cycle >= this->cycle, NULL, "Inserting event in the past of the clock wheel\n");
+
+    event->cycle = cycle;
+    event->seq = this->seq++;
+    this->insert_slot(event);
+
+    if (this->nb_events == 0 || (this->first && cycle < this->first->cycle))
+    {
+        this->first = event;
+    }
+
+    this->nb_events++;
+}
+
+void vp::clock_wheel::clear(int64_t cycle)
+{
+    for (int level = 0; level < CLOCK_WHEEL_LEVELS; level++)
+    {
+        this->bitmaps[level] = 0;
+        for (int slot = 0; slot < CLOCK_WHEEL_SLOTS; slot++)
+        {
+            for (vp::clock_event *event = this->slots[level][slot]; event; event = event->next)
+            {
+                event->enqueued = false;
+            }
+            this->slots[level][slot] = NULL;
+        }
+    }
+
+    this->nb_events = 0;
+    this->first = NULL;
+    this->cycle = cycle;
+}
+
+void vp::clock_wheel::remove(vp::clock_event *event)
+{
+    event->unlink();
+
+    if (*event->queue == NULL)
+    {
+        int index = event->queue - &this->slots[0][0];
+        this->bitmaps[index >> CLOCK_WHEEL_BITS] &= ~(1ULL << (index & CLOCK_WHEEL_MASK));
+    }
+
+    if (this->first == event)
+    {
+        this->first = NULL;
+    }
+
+    this->nb_events--;
+}
+
+void vp::clock_wheel::advance(int64_t cycle)
+{
+    if (cycle <= this->cycle)
+        return;
+
+    // All the levels whose current block changed must have the slot of the new block
+    // cascaded down, since its events must now be spread over the lower levels.
+    // This is done from the top so that events cascaded from one level to the next one
+    // are cascaded again if needed.
+    int top_level = get_level(cycle, this->cycle);
+
+    this->cycle = cycle;
+
+    for (int level = top_level; level > 0; level--)
+    {
+        int slot = get_slot(cycle, level);
+        vp::clock_event *event = this->slots[level][slot];
+
+        if (event)
+        {
+            this->slots[level][slot] = NULL;
+            this->bitmaps[level] &= ~(1ULL << slot);
+
+            while (event)
+            {
+                vp::clock_event *next = event->next;
+                this->insert_slot(event);
+                event = next;
+            }
+        }
+    }
+}
+
+vp::clock_event *vp::clock_wheel::get_first()
+{
+    if (this->nb_events == 0)
+        return NULL;
+
+    if (this->first)
+        return this->first;
+
+    // Events of a level are all after the events of the levels below, and inside a level,
+    // the slots are always after the current one, so the first event is in the first
+    // non-empty slot of the first non-empty level.
+    for (int level = 0; level < CLOCK_WHEEL_LEVELS; level++)
+    {
+        uint64_t bitmap = this->bitmaps[level];
+        if (bitmap)
+        {
+            vp::clock_event *event = this->slots[level][__builtin_ctzll(bitmap)];
+            vp::clock_event *first = event;
+
+            // Slots of level 0 contain events of a single cycle, others must be scanned
+            if (level > 0)
+            {
+                while (event)
+                {
+                    if (event->cycle < first->cycle)
+                        first = event;
+                    event = event->next;
+                }
+            }
+
+            this->first = first;
+            return first;
+        }
+    }
+
+    vp_assert(false, NULL, "Didn't find any event in clock wheel while it is not empty\n");
+
+    return NULL;
+}
+
+void vp::clock_wheel::extract(int64_t cycle, int64_t limit, std::vector<vp::clock_event *> &events)
+{
+    events.clear();
+
+    this->advance(cycle);
+
+    vp_assert(limit - this->cycle <= CLOCK_WHEEL_SLOTS, NULL, "Extracting too many cycles from clock wheel\n");
+
+    // Level 0 contains the events of the current block, with one cycle per slot
+    uint64_t bitmap = this->bitmaps[0];
+    while (bitmap)
+    {
+        int slot = __builtin_ctzll(bitmap);
+        if (((this->cycle & ~(int64_t)CLOCK_WHEEL_MASK) | slot) >= limit)
+            break;
+
+        vp::clock_event *event = this->slots[0][slot];
+        while (event)
+        {
+            events.push_back(event);
+            event = event->next;
+        }
+
+        this->slots[0][slot] = NULL;
+        this->bitmaps[0] &= ~(1ULL << slot);
+        bitmap &= bitmap - 1;
+    }
+
+    // The limit can go over the current block, in which case the events of the next
+    // block are still in a higher level slot and must be picked one by one.
+    int64_t next_block = (this->cycle | CLOCK_WHEEL_MASK) + 1;
+    if (limit > next_block)
+    {
+        int level = get_level(next_block, this->cycle);
+        int slot = get_slot(next_block, level);
+        vp::clock_event *event = this->slots[level][slot];
+
+        while (event)
+        {
+            vp::clock_event *next = event->next;
+            if (event->cycle < limit)
+            {
+                event->unlink();
+                events.push_back(event);
+            }
+            event = next;
+        }
+
+        if (this->slots[level][slot] == NULL)
+        {
+            this->bitmaps[level] &= ~(1ULL << slot);
+        }
+    }
+
+    if (events.size())
+    {
+        this->nb_events -= events.size();
+        this->first = NULL;
+
+        std::sort(events.begin(), events.end(),
+            [](vp::clock_event *a, vp::clock_event *b) { return a->seq > b->seq; });
+    }
+}
@@ -24,14 +24,213 @@
 #include <dlfcn.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
 
 
 
+// Continue the simulation of a test in a forked process. Each option of the test is
+// applied in the order given before the simulation is resumed.
+static int run_test(void *instance, std::vector<std::string> options)
+{
+    for (auto option: options)
+    {
+        if (option.rfind("--dir=", 0) == 0)
+        {
+            if (chdir(option.substr(6).c_str()))
+            {
+                fprintf(stderr, "Failed to enter test directory (path: %s)\n", option.substr(6).c_str());
+                return -1;
+            }
+        }
+        else if (option.rfind("--log=", 0) == 0)
+        {
+            int fd = open(option.substr(6).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd == -1)
+            {
+                fprintf(stderr, "Failed to open test log (path: %s)\n", option.substr(6).c_str());
+                return -1;
+            }
+            dup2(fd, 1);
+            dup2(fd, 2);
+            close(fd);
+        }
+        else if (option.rfind("--load=", 0) == 0)
+        {
+            // --load=<component>:<address>:<file>
+            std::string value = option.substr(7);
+            size_t addr_pos = value.find(':');
+            size_t file_pos = addr_pos == std::string::npos ? addr_pos : value.find(':', addr_pos + 1);
+            if (file_pos == std::string::npos)
+            {
+                fprintf(stderr, "Invalid load option, expecting --load=<component>:<address>:<file> (option: %s)\n",
+                    option.c_str());
+                return -1;
+            }
+
+            std::string comp = value.substr(0, addr_pos);
+            uint64_t addr = strtoull(value.substr(addr_pos + 1, file_pos - addr_pos - 1).c_str(), NULL, 0);
+
+            if (gv_mem_load(instance, comp.c_str(), addr, value.substr(file_pos + 1).c_str()))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown test option: %s\n", option.c_str());
+            return -1;
+        }
+    }
+
+    int retval = gv_run(instance);
+
+    gv_stop(instance, retval);
+
+    return retval;
+}
+
+
+
+static double get_host_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+// Fork one process per test from the current state of the simulation, which must be
+// stopped, with at most nb_jobs processes at the same time. Each line of the tests file
+// gives the options of one test.
+static int fork_tests(void *instance, const char *tests_path, int nb_jobs)
+{
+    struct test
+    {
+        int id;
+        std::string name;
+        double start_time;
+    };
+
+    std::ifstream tests_file(tests_path);
+    if (!tests_file.is_open())
+    {
+        fprintf(stderr, "Failed to open tests file (path: %s)\n", tests_path);
+        return -1;
+    }
+
+    std::vector<std::string> tests;
+    std::string line;
+    while (std::getline(tests_file, line))
+    {
+        if (line.find_first_not_of(" \t") != std::string::npos && line[line.find_first_not_of(" \t")] != '#')
+        {
+            tests.push_back(line);
+        }
+    }
+
+    std::map<int, test> running;
+    int nb_failed = 0;
+    unsigned int next_test = 0;
+    bool fork_failed = false;
+    double start_time = get_host_time();
+
+    while ((!fork_failed && next_test < tests.size()) || running.size() > 0)
+    {
+        if (!fork_failed && next_test < tests.size() && (int)running.size() < nb_jobs)
+        {
+            // The tests already running are still waited for, so that no process is
+            // left behind
+            int pid = gv_fork(instance);
+            if (pid == -1)
+            {
+                fprintf(stderr, "Failed to fork test %d: %s\n", next_test, tests[next_test].c_str());
+                fork_failed = true;
+                continue;
+            }
+
+            if (pid == 0)
+            {
+                std::istringstream stream(tests[next_test]);
+                std::vector<std::string> options;
+                std::string option;
+                while (stream >> option)
+                {
+                    options.push_back(option);
+                }
+
+                exit(run_test(instance, options));
+            }
+
+            running[pid] = { (int)next_test, tests[next_test], get_host_time() };
+            next_test++;
+            continue;
+        }
+
+        int status;
+        int pid = wait(&status);
+        if (pid == -1)
+        {
+            break;
+        }
+
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            continue;
+        }
+
+        test test = it->second;
+        running.erase(it);
+
+        bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!passed)
+        {
+            nb_failed++;
+        }
+
+        if (WIFSIGNALED(status))
+        {
+            printf("Test %d killed by signal %d in %.3fs: %s\n", test.id, WTERMSIG(status),
+                get_host_time() - test.start_time, test.name.c_str());
+        }
+        else
+        {
+            printf("Test %d %s (status: %d) in %.3fs: %s\n", test.id, passed ? "passed" : "failed",
+                WEXITSTATUS(status), get_host_time() - test.start_time, test.name.c_str());
+        }
+        fflush(stdout);
+    }
+
+    printf("Executed %d tests in %.3fs, %d passed, %d failed\n", next_test,
+        get_host_time() - start_time, next_test - nb_failed, nb_failed);
+
+    return nb_failed || fork_failed ? -1 : 0;
+}
+
+
 
 int main(int argc, char *argv[])
 {
     char *config_path = NULL;
     bool open_proxy = false;
+    char *checkpoint_save = NULL;
+    char *checkpoint_restore = NULL;
+    int64_t checkpoint_time = 0;
+    char *fork_tests_path = NULL;
+    int64_t fork_time = 0;
+    int fork_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    bool startup_time = false;
+    double start_time = get_host_time();
 
     for (int i=1; i<argc; i++)
     {
@@ -43,6 +242,34 @@ int main(int argc, char *argv[])
         {
             open_proxy = true;
         }
+        else if (strncmp(argv[i], "--checkpoint-save=", 18) == 0)
+        {
+            checkpoint_save = &argv[i][18];
+        }
+        else if (strncmp(argv[i], "--checkpoint-time=", 18) == 0)
+        {
+            checkpoint_time = atoll(&argv[i][18]);
+        }
+        else if (strncmp(argv[i], "--checkpoint-restore=", 21) == 0)
+        {
+            checkpoint_restore = &argv[i][21];
+        }
+        else if (strncmp(argv[i], "--fork-tests=", 13) == 0)
+        {
+            fork_tests_path = &argv[i][13];
+        }
+        else if (strncmp(argv[i], "--fork-time=", 12) == 0)
+        {
+            fork_time = atoll(&argv[i][12]);
+        }
+        else if (strncmp(argv[i], "--fork-jobs=", 12) == 0)
+        {
+            fork_jobs = atoi(&argv[i][12]);
+        }
+        else if (strcmp(argv[i], "--startup-time") == 0)
+        {
+            startup_time = true;
+        }
     }
 
     if (config_path == NULL)
@@ -57,6 +284,47 @@ int main(int argc, char *argv[])
     gv_reset(instance, true);
     gv_reset(instance, false);
 
+    // Everything done before the first cycle, mostly loading the models and building the
+    // platform from its configuration
+    if (startup_time)
+    {
+        printf("Platform started in %.3fs\n", get_host_time() - start_time);
+        fflush(stdout);
+    }
+
+    if (checkpoint_restore && gv_checkpoint_restore(instance, checkpoint_restore))
+    {
+        return -1;
+    }
+
+    if (checkpoint_save)
+    {
+        // Run until the checkpoint time, save the platform and stop there
+        if (gv_run_until(instance, checkpoint_time))
+        {
+            fprintf(stderr, "Simulation ended before the checkpoint time\n");
+            return -1;
+        }
+
+        int retval = gv_checkpoint_save(instance, checkpoint_save);
+
+        gv_stop(instance, retval);
+
+        return retval;
+    }
+
+    if (fork_tests_path)
+    {
+        // Run until the fork time, and continue the simulation in one process per test
+        if (gv_run_until(instance, fork_time))
+        {
+            fprintf(stderr, "Simulation ended before the fork time\n");
+            return -1;
+        }
+
+        return fork_tests(instance, fork_tests_path, fork_jobs);
+    }
+
     if (proxy_socket != -1)
     {
         printf("Opened proxy on socket %d\n", proxy_socket);
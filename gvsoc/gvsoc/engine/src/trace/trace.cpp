@@ -208,15 +208,31 @@ char *vp::trace_engine::get_event_buffer(int bytes)
     return result;
 }
 
-void vp::trace_engine::stop()
+void vp::trace_engine::start_vcd_thread()
+{
+    this->end = 0;
+    this->thread = new std::thread(&trace_engine::vcd_routine, this);
+}
+
+void vp::trace_engine::stop_vcd_thread()
 {
-    this->check_pending_events(-1);
     this->flush();
     pthread_mutex_lock(&mutex);
     this->end = 1;
     pthread_cond_broadcast(&cond);
     pthread_mutex_unlock(&mutex);
     this->thread->join();
+    delete this->thread;
+}
+
+void vp::trace_engine::stop()
+{
+    this->check_pending_events(-1);
+    this->stop_vcd_thread();
+    if (this->binary_writer)
+    {
+        this->binary_writer->stop();
+    }
     fflush(NULL);
 }
 
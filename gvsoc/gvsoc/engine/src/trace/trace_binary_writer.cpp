@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include "vp/vp.hpp"
+#include "vp/trace/trace_engine.hpp"
+#include "vp/trace/trace_binary_writer.hpp"
+#include "fst/lz4.h"
+#include <string.h>
+#include <chrono>
+
+vp::trace_binary_writer::trace_binary_writer(vp::trace_engine *engine, std::string path, int compression)
+    : engine(engine), compression(compression), head(0), tail(0), end(false)
+{
+    this->file = fopen(path.c_str(), "wb");
+    if (this->file == NULL)
+    {
+        throw std::runtime_error("Error while opening binary trace file (path: " + path + ", error: " + strerror(errno) + ")\n");
+    }
+
+    this->ring = new uint8_t[TRACE_BINARY_RING_SIZE];
+    this->block = new uint8_t[TRACE_BINARY_BLOCK_SIZE];
+    this->compressed_block = new uint8_t[LZ4_compressBound(TRACE_BINARY_BLOCK_SIZE)];
+
+    this->thread = new std::thread(&trace_binary_writer::writer_routine, this);
+}
+
+inline uint8_t *vp::trace_binary_writer::reserve(uint32_t size)
+{
+    uint64_t head = this->head.load(std::memory_order_relaxed);
+    uint64_t offset = head & (TRACE_BINARY_RING_SIZE - 1);
+
+    // Records must be contiguous, so if there is not enough room until the end of
+    // the ring, the end is skipped with a padding record.
+    if (offset + size > TRACE_BINARY_RING_SIZE)
+    {
+        uint32_t padding = TRACE_BINARY_RING_SIZE - offset;
+
+        while (head + padding - this->tail.load(std::memory_order_acquire) > TRACE_BINARY_RING_SIZE)
+        {
+            std::this_thread::yield();
+        }
+
+        trace_binary_record_t *record = (trace_binary_record_t *)&this->ring[offset];
+        record->type = TRACE_BINARY_RECORD_PADDING;
+        record->size = padding;
+
+        head += padding;
+        this->head.store(head, std::memory_order_release);
+        offset = 0;
+    }
+
+    // The writer thread is too late, wait until it frees some room
+    while (head + size - this->tail.load(std::memory_order_acquire) > TRACE_BINARY_RING_SIZE)
+    {
+        std::this_thread::yield();
+    }
+
+    return &this->ring[offset];
+}
+
+inline void vp::trace_binary_writer::commit(uint32_t size)
+{
+    this->head.store(this->head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+void vp::trace_binary_writer::dump_msg(vp::trace *trace, int level, const char *fmt, va_list ap)
+{
+    uint8_t *record = this->reserve(TRACE_BINARY_MAX_RECORD_SIZE);
+    uint8_t *record_end = record + TRACE_BINARY_MAX_RECORD_SIZE;
+    trace_binary_msg_t *msg = (trace_binary_msg_t *)record;
+
+    int64_t time = -1;
+    int64_t cycles = -1;
+    if (trace->comp->get_clock())
+    {
+        cycles = trace->comp->get_clock()->get_cycles();
+    }
+    if (trace->comp->get_time_engine())
+    {
+        time = trace->comp->get_time_engine()->get_time();
+    }
+
+    msg->header.type = TRACE_BINARY_RECORD_MSG;
+    msg->header.level = level;
+    msg->trace = (uint64_t)trace;
+    msg->format = (uint64_t)fmt;
+    msg->time = time;
+    msg->cycles = cycles;
+
+    // Only the arguments are copied, the format string is kept as a pointer
+    // as it is constant, and the message is formatted by the decoder
+    uint8_t *args = record + sizeof(trace_binary_msg_t);
+    const char *current = fmt;
+
+    while ((current = strchr(current, '%')) != NULL)
+    {
+        trace_binary_arg_e type;
+        int nb_stars;
+        current = trace_binary_parse_spec(current, &type, &nb_stars);
+
+        // Keep room for the star arguments and the argument slot or string length
+        if (args + (nb_stars + 1) * 8 > record_end)
+            break;
+
+        for (int i=0; i<nb_stars; i++)
+        {
+            *(int64_t *)args = va_arg(ap, int);
+            args += 8;
+        }
+
+        switch (type)
+        {
+            case TRACE_BINARY_ARG_NONE:
+                break;
+
+            case TRACE_BINARY_ARG_INT:
+                *(int64_t *)args = va_arg(ap, int);
+                args += 8;
+                break;
+
+            case TRACE_BINARY_ARG_LONG:
+                *(int64_t *)args = va_arg(ap, long long);
+                args += 8;
+                break;
+
+            case TRACE_BINARY_ARG_DOUBLE:
+                *(double *)args = va_arg(ap, double);
+                args += 8;
+                break;
+
+            case TRACE_BINARY_ARG_LONG_DOUBLE:
+                *(double *)args = (double)va_arg(ap, long double);
+                args += 8;
+                break;
+
+            case TRACE_BINARY_ARG_POINTER:
+                *(uint64_t *)args = (uint64_t)va_arg(ap, void *);
+                args += 8;
+                break;
+
+            case TRACE_BINARY_ARG_STRING:
+            {
+                const char *str = va_arg(ap, const char *);
+                if (str == NULL)
+                    str = "(null)";
+
+                // Strings are truncated if the message does not fit the record
+                uint64_t len = strlen(str);
+                uint64_t max_len = record_end - args - 8;
+                if (len > max_len)
+                    len = max_len;
+
+                *(uint64_t *)args = len;
+                memcpy(args + 8, str, len);
+                args += 8 + trace_binary_align(len);
+                break;
+            }
+        }
+    }
+
+    msg->header.size = trace_binary_align(args - record);
+
+    this->commit(msg->header.size);
+}
+
+void vp::trace_binary_writer::stop()
+{
+    this->end.store(true, std::memory_order_release);
+    this->thread->join();
+}
+
+void vp::trace_binary_writer::flush_block()
+{
+    if (!this->header_dumped)
+    {
+        // The header is dumped with the first block as the maximum path length
+        // is known only once all the traces are registered
+        trace_binary_header_t header;
+        memcpy(header.magic, TRACE_BINARY_MAGIC, sizeof(header.magic));
+        header.version = TRACE_BINARY_VERSION;
+        header.max_path_len = this->engine->get_max_path_len();
+        fwrite(&header, sizeof(header), 1, this->file);
+        this->header_dumped = true;
+    }
+
+    if (this->block_size == 0)
+        return;
+
+    trace_binary_block_t block_header;
+    uint8_t *data = this->block;
+
+    block_header.size = this->block_size;
+    block_header.compressed_size = this->block_size;
+    block_header.compression = TRACE_BINARY_COMPRESSION_NONE;
+    block_header.reserved = 0;
+
+    if (this->compression == TRACE_BINARY_COMPRESSION_LZ4)
+    {
+        int size = LZ4_compress_default((const char *)this->block, (char *)this->compressed_block,
+            this->block_size, LZ4_compressBound(TRACE_BINARY_BLOCK_SIZE));
+
+        // Keep the block uncompressed if it does not help
+        if (size > 0 && (uint32_t)size < this->block_size)
+        {
+            block_header.compressed_size = size;
+            block_header.compression = TRACE_BINARY_COMPRESSION_LZ4;
+            data = this->compressed_block;
+        }
+    }
+
+    fwrite(&block_header, sizeof(block_header), 1, this->file);
+    fwrite(data, 1, block_header.compressed_size, this->file);
+
+    this->block_size = 0;
+}
+
+void vp::trace_binary_writer::write_record(void *record, uint32_t size)
+{
+    if (this->block_size + size > TRACE_BINARY_BLOCK_SIZE)
+    {
+        this->flush_block();
+    }
+
+    memcpy(&this->block[this->block_size], record, size);
+    this->block_size += size;
+}
+
+void vp::trace_binary_writer::write_def(int type, uint64_t id, const char *str)
+{
+    uint8_t record[TRACE_BINARY_MAX_RECORD_SIZE];
+    trace_binary_def_t *def = (trace_binary_def_t *)record;
+    uint32_t len = strlen(str);
+
+    if (len > TRACE_BINARY_MAX_RECORD_SIZE - sizeof(trace_binary_def_t) - 1)
+        len = TRACE_BINARY_MAX_RECORD_SIZE - sizeof(trace_binary_def_t) - 1;
+
+    def->header.type = type;
+    def->header.level = -1;
+    def->header.size = trace_binary_align(sizeof(trace_binary_def_t) + len + 1);
+    def->id = id;
+
+    char *def_str = (char *)(record + sizeof(trace_binary_def_t));
+    memcpy(def_str, str, len);
+    memset(def_str + len, 0, def->header.size - sizeof(trace_binary_def_t) - len);
+
+    this->write_record(record, def->header.size);
+}
+
+void vp::trace_binary_writer::handle_record(trace_binary_record_t *record)
+{
+    if (record->type != TRACE_BINARY_RECORD_MSG)
+        return;
+
+    trace_binary_msg_t *msg = (trace_binary_msg_t *)record;
+
+    // Traces and formats are declared the first time they are seen, so that
+    // only their ID needs to be kept in the messages
+    auto trace_it = this->trace_ids.find(msg->trace);
+    if (trace_it == this->trace_ids.end())
+    {
+        uint64_t id = this->trace_ids.size();
+        this->write_def(TRACE_BINARY_RECORD_TRACE, id, ((vp::trace *)msg->trace)->path.c_str());
+        trace_it = this->trace_ids.insert({msg->trace, id}).first;
+    }
+
+    auto format_it = this->format_ids.find(msg->format);
+    if (format_it == this->format_ids.end())
+    {
+        uint64_t id = this->format_ids.size();
+        this->write_def(TRACE_BINARY_RECORD_FORMAT, id, (const char *)msg->format);
+        format_it = this->format_ids.insert({msg->format, id}).first;
+    }
+
+    msg->trace = trace_it->second;
+    msg->format = format_it->second;
+
+    this->write_record(msg, msg->header.size);
+}
+
+// This routine runs in a dedicated thread.
+// It polls the ring buffer filled by the simulation thread, so that the simulation
+// thread never has to take a lock or wake it up.
+void vp::trace_binary_writer::writer_routine()
+{
+    while (1)
+    {
+        uint64_t head = this->head.load(std::memory_order_acquire);
+        uint64_t tail = this->tail.load(std::memory_order_relaxed);
+
+        if (head == tail)
+        {
+            if (this->end.load(std::memory_order_acquire))
+            {
+                // Check again as the last messages may have been pushed just before
+                // the end was notified
+                if (this->head.load(std::memory_order_acquire) == tail)
+                    break;
+                continue;
+            }
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        while (tail != head)
+        {
+            trace_binary_record_t *record = (trace_binary_record_t *)&this->ring[tail & (TRACE_BINARY_RING_SIZE - 1)];
+            tail += record->size;
+            this->handle_record(record);
+        }
+
+        this->tail.store(tail, std::memory_order_release);
+    }
+
+    this->flush_block();
+    fclose(this->file);
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Converts a binary trace file, dumped with --trace-format=binary, to the same
+// text as the one dumped by the engine in long or short format.
+
+#include <vp/trace/trace_binary.hpp>
+#include "trace/fst/lz4.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#define TRACE_LEVEL_ERROR   0
+#define TRACE_LEVEL_WARNING 1
+
+
+static std::vector<std::string> traces;
+static std::vector<std::string> formats;
+static int max_path_len;
+static bool short_format = false;
+static FILE *out_file;
+
+
+// Print one conversion specification with its argument
+static void dump_spec(const char *spec, trace_binary_arg_e type, int nb_stars, int64_t *stars, uint8_t *arg)
+{
+    int64_t value = *(int64_t *)arg;
+
+    switch (type)
+    {
+        case TRACE_BINARY_ARG_INT:
+            if (nb_stars == 0) fprintf(out_file, spec, (int)value);
+            else if (nb_stars == 1) fprintf(out_file, spec, (int)stars[0], (int)value);
+            else fprintf(out_file, spec, (int)stars[0], (int)stars[1], (int)value);
+            break;
+
+        case TRACE_BINARY_ARG_LONG:
+            if (nb_stars == 0) fprintf(out_file, spec, (long long)value);
+            else if (nb_stars == 1) fprintf(out_file, spec, (int)stars[0], (long long)value);
+            else fprintf(out_file, spec, (int)stars[0], (int)stars[1], (long long)value);
+            break;
+
+        case TRACE_BINARY_ARG_DOUBLE:
+            if (nb_stars == 0) fprintf(out_file, spec, *(double *)arg);
+            else if (nb_stars == 1) fprintf(out_file, spec, (int)stars[0], *(double *)arg);
+            else fprintf(out_file, spec, (int)stars[0], (int)stars[1], *(double *)arg);
+            break;
+
+        case TRACE_BINARY_ARG_LONG_DOUBLE:
+            if (nb_stars == 0) fprintf(out_file, spec, (long double)*(double *)arg);
+            else if (nb_stars == 1) fprintf(out_file, spec, (int)stars[0], (long double)*(double *)arg);
+            else fprintf(out_file, spec, (int)stars[0], (int)stars[1], (long double)*(double *)arg);
+            break;
+
+        case TRACE_BINARY_ARG_POINTER:
+            // %n can not be reproduced and wide strings are not kept
+            if (spec[strlen(spec) - 1] == 'p')
+                fprintf(out_file, spec, (void *)value);
+            break;
+
+        case TRACE_BINARY_ARG_STRING:
+        {
+            std::string str((char *)arg + 8, value);
+            if (nb_stars == 0) fprintf(out_file, spec, str.c_str());
+            else if (nb_stars == 1) fprintf(out_file, spec, (int)stars[0], str.c_str());
+            else fprintf(out_file, spec, (int)stars[0], (int)stars[1], str.c_str());
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+static void dump_msg(trace_binary_msg_t *msg)
+{
+    const std::string &path = traces[msg->trace];
+    const char *fmt = formats[msg->format].c_str();
+    uint8_t *args = (uint8_t *)msg + sizeof(trace_binary_msg_t);
+    uint8_t *args_end = (uint8_t *)msg + msg->header.size;
+    int level = msg->header.level;
+
+    if (short_format)
+    {
+        fprintf(out_file, "%ldps %ld ", (long)msg->time, (long)msg->cycles);
+    }
+    else
+    {
+        fprintf(out_file, "%ld: %ld: [\033[34m%-*.*s\033[0m] ", (long)msg->time, (long)msg->cycles,
+            max_path_len, max_path_len, path.c_str());
+    }
+
+    if (level == TRACE_LEVEL_ERROR)
+    {
+        fprintf(out_file, "\033[31m");
+    }
+    else if (level == TRACE_LEVEL_WARNING)
+    {
+        fprintf(out_file, "\033[33m");
+    }
+
+    // Go through the format string as the engine did when it dumped the arguments,
+    // and print each part with its argument
+    const char *current = fmt;
+    while (*current)
+    {
+        const char *spec_start = strchr(current, '%');
+        if (spec_start == NULL)
+        {
+            fputs(current, out_file);
+            break;
+        }
+
+        fwrite(current, 1, spec_start - current, out_file);
+
+        trace_binary_arg_e type;
+        int nb_stars;
+        current = trace_binary_parse_spec(spec_start, &type, &nb_stars);
+
+        std::string spec(spec_start, current - spec_start);
+
+        if (type == TRACE_BINARY_ARG_NONE)
+        {
+            if (spec == "%%")
+                fputc('%', out_file);
+            continue;
+        }
+
+        // The message was truncated by the engine
+        if (args + (nb_stars + 1) * 8 > args_end)
+            break;
+
+        int64_t stars[2] = { 0, 0 };
+        for (int i=0; i<nb_stars; i++)
+        {
+            if (i < 2)
+                stars[i] = *(int64_t *)args;
+            args += 8;
+        }
+
+        dump_spec(spec.c_str(), type, nb_stars > 2 ? 2 : nb_stars, stars, args);
+
+        if (type == TRACE_BINARY_ARG_STRING)
+            args += 8 + trace_binary_align(*(uint64_t *)args);
+        else
+            args += 8;
+    }
+
+    if (level == TRACE_LEVEL_ERROR || level == TRACE_LEVEL_WARNING)
+    {
+        fprintf(out_file, "\033[0m");
+    }
+}
+
+
+static int decode_block(uint8_t *data, uint32_t size)
+{
+    uint8_t *current = data;
+
+    while (current < data + size)
+    {
+        trace_binary_record_t *record = (trace_binary_record_t *)current;
+
+        if (record->size < sizeof(trace_binary_record_t) || current + record->size > data + size)
+        {
+            fprintf(stderr, "Corrupted record in binary trace\n");
+            return -1;
+        }
+
+        if (record->type == TRACE_BINARY_RECORD_TRACE || record->type == TRACE_BINARY_RECORD_FORMAT)
+        {
+            trace_binary_def_t *def = (trace_binary_def_t *)record;
+            std::vector<std::string> &defs = record->type == TRACE_BINARY_RECORD_TRACE ? traces : formats;
+            if (def->id >= defs.size())
+                defs.resize(def->id + 1);
+            defs[def->id] = (char *)(current + sizeof(trace_binary_def_t));
+        }
+        else if (record->type == TRACE_BINARY_RECORD_MSG)
+        {
+            trace_binary_msg_t *msg = (trace_binary_msg_t *)record;
+            if (msg->trace >= traces.size() || msg->format >= formats.size())
+            {
+                fprintf(stderr, "Message with undeclared trace or format in binary trace\n");
+                return -1;
+            }
+            dump_msg(msg);
+        }
+
+        current += record->size;
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    char *input_path = NULL;
+    char *output_path = NULL;
+
+    for (int i=1; i<argc; i++)
+    {
+        if (strcmp(argv[i], "--short") == 0)
+        {
+            short_format = true;
+        }
+        else if (strncmp(argv[i], "--output=", 9) == 0)
+        {
+            output_path = &argv[i][9];
+        }
+        else if (argv[i][0] != '-' && input_path == NULL)
+        {
+            input_path = argv[i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--short] [--output=<path>] <binary trace file>\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (input_path == NULL)
+    {
+        fprintf(stderr, "Usage: %s [--short] [--output=<path>] <binary trace file>\n", argv[0]);
+        return -1;
+    }
+
+    FILE *file = fopen(input_path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Unable to open binary trace file: %s\n", input_path);
+        return -1;
+    }
+
+    out_file = stdout;
+    if (output_path)
+    {
+        out_file = fopen(output_path, "w");
+        if (out_file == NULL)
+        {
+            fprintf(stderr, "Unable to open output file: %s\n", output_path);
+            return -1;
+        }
+    }
+
+    trace_binary_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, TRACE_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_BINARY_VERSION)
+    {
+        fprintf(stderr, "Invalid binary trace file: %s\n", input_path);
+        return -1;
+    }
+
+    max_path_len = header.max_path_len;
+
+    std::vector<uint8_t> block(TRACE_BINARY_BLOCK_SIZE);
+    std::vector<uint8_t> compressed_block(LZ4_compressBound(TRACE_BINARY_BLOCK_SIZE));
+
+    trace_binary_block_t block_header;
+    while (fread(&block_header, sizeof(block_header), 1, file) == 1)
+    {
+        if (block_header.size > TRACE_BINARY_BLOCK_SIZE ||
+            block_header.compressed_size > compressed_block.size())
+        {
+            fprintf(stderr, "Corrupted block in binary trace\n");
+            return -1;
+        }
+
+        if (block_header.compression == TRACE_BINARY_COMPRESSION_LZ4)
+        {
+            if (fread(compressed_block.data(), 1, block_header.compressed_size, file) != block_header.compressed_size ||
+                LZ4_decompress_safe((const char *)compressed_block.data(), (char *)block.data(),
+                    block_header.compressed_size, block_header.size) != (int)block_header.size)
+            {
+                fprintf(stderr, "Corrupted block in binary trace\n");
+                return -1;
+            }
+        }
+        else
+        {
+            if (fread(block.data(), 1, block_header.size, file) != block_header.size)
+            {
+                fprintf(stderr, "Truncated block in binary trace\n");
+                return -1;
+            }
+        }
+
+        if (decode_block(block.data(), block_header.size))
+        {
+            return -1;
+        }
+    }
+
+    fclose(file);
+    if (out_file != stdout)
+    {
+        fclose(out_file);
+    }
+
+    return 0;
+}
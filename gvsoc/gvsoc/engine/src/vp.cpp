@@ -39,6 +39,7 @@
 #include <poll.h>
 #include <signal.h>
 #include <regex>
+#include <mutex>
 #include <gv/gvsoc_proxy.hpp>
 #include <gv/gvsoc.h>
 #include <sys/types.h>
@@ -48,6 +49,7 @@
 #include <vp/proxy.hpp>
 #include <vp/queue.hpp>
 #include <vp/signal.hpp>
+#include <vp/checkpoint.hpp>
 
 
 extern "C" long long int dpi_time_ps();
@@ -315,6 +317,79 @@ void vp::component::reset_all(bool active, bool from_itf)
 
 }
 
+void vp::component::checkpoint_save_all(vp::checkpoint *checkpoint)
+{
+    // Registers are saved all together as they are usually small
+    std::vector<uint8_t> regs_data;
+    for (auto reg : this->regs)
+    {
+        regs_data.insert(regs_data.end(), reg->value_bytes, reg->value_bytes + reg->nb_bytes);
+    }
+    checkpoint->save(this, "regs", regs_data.data(), regs_data.size());
+
+    // Events are identified by their creation order, which is the same from one
+    // simulation to another
+    if (this->get_clock())
+    {
+        for (unsigned int i=0; i<this->events.size(); i++)
+        {
+            checkpoint->save_event(this, "event" + std::to_string(i), this->events[i]);
+        }
+    }
+
+    this->checkpoint_save(checkpoint);
+
+    for (auto &x : this->childs)
+    {
+        x->checkpoint_save_all(checkpoint);
+    }
+}
+
+void vp::component::pre_checkpoint_restore_all(vp::checkpoint *checkpoint)
+{
+    this->pre_checkpoint_restore(checkpoint);
+
+    for (auto &x : this->childs)
+    {
+        x->pre_checkpoint_restore_all(checkpoint);
+    }
+}
+
+void vp::component::checkpoint_restore_all(vp::checkpoint *checkpoint)
+{
+    int size = 0;
+    for (auto reg : this->regs)
+    {
+        size += reg->nb_bytes;
+    }
+
+    std::vector<uint8_t> regs_data(size);
+    if (checkpoint->restore(this, "regs", regs_data.data(), size))
+    {
+        uint8_t *data = regs_data.data();
+        for (auto reg : this->regs)
+        {
+            memcpy(reg->value_bytes, data, reg->nb_bytes);
+            data += reg->nb_bytes;
+        }
+    }
+
+    if (this->get_clock())
+    {
+        for (unsigned int i=0; i<this->events.size(); i++)
+        {
+            checkpoint->restore_event(this, "event" + std::to_string(i), this->events[i]);
+        }
+    }
+
+    this->checkpoint_restore(checkpoint);
+
+    for (auto &x : this->childs)
+    {
+        x->checkpoint_restore_all(checkpoint);
+    }
+}
+
 void vp::component_clock::reset_sync(void *__this, bool active)
 {
     component *_this = (component *)__this;
@@ -338,40 +413,172 @@ void vp::component_clock::pre_build(component *comp)
 
 int64_t vp::time_engine::get_next_event_time()
 {
-    if (this->first_client)
+    if (this->parallel)
     {
-        return this->first_client->next_event_time;
+        int64_t time = -1;
+        for (time_partition *partition: this->partitions)
+        {
+            time_engine_client *first = partition->clients.first();
+            if (first && (time == -1 || first->next_event_time < time))
+            {
+                time = first->next_event_time;
+            }
+        }
+
+        return time == -1 ? this->time : time;
+    }
+
+    time_engine_client *first = this->get_first_client();
+    if (first)
+    {
+        return first->next_event_time;
     }
 
     return this->time;
 }
 
 
-bool vp::time_engine::dequeue(time_engine_client *client)
+void vp::time_client_heap::sift_up(int index)
 {
-    if (!client->is_enqueued)
-        return false;
+    time_engine_client *client = this->clients[index];
+
+    while (index > 0)
+    {
+        int parent = (index - 1) >> 1;
+        if (!this->is_before(client, this->clients[parent]))
+            break;
 
-    client->is_enqueued = false;
+        this->set(index, this->clients[parent]);
+        index = parent;
+    }
+
+    this->set(index, client);
+}
 
-    time_engine_client *current = this->first_client, *prev = NULL;
-    while (current && current != client)
+
+void vp::time_client_heap::sift_down(int index)
+{
+    int size = this->clients.size();
+    time_engine_client *client = this->clients[index];
+
+    while (1)
     {
-        prev = current;
-        current = current->next;
+        int child = 2 * index + 1;
+        if (child >= size)
+            break;
+
+        if (child + 1 < size && this->is_before(this->clients[child + 1], this->clients[child]))
+            child++;
+
+        if (!this->is_before(this->clients[child], client))
+            break;
+
+        this->set(index, this->clients[child]);
+        index = child;
     }
-    if (prev)
-        prev->next = client->next;
-    else
-        this->first_client = client->next;
 
-    return true;
+    this->set(index, client);
+}
+
+
+void vp::time_client_heap::push(time_engine_client *client)
+{
+    client->enqueue_seq = this->seq++;
+    this->clients.push_back(client);
+    this->sift_up(this->clients.size() - 1);
+}
+
+
+vp::time_engine_client *vp::time_client_heap::pop()
+{
+    time_engine_client *first = this->clients[0];
+    time_engine_client *last = this->clients.back();
+
+    this->clients.pop_back();
+
+    if (this->clients.size())
+    {
+        this->clients[0] = last;
+        this->sift_down(0);
+    }
+
+    return first;
+}
+
+
+void vp::time_client_heap::remove(time_engine_client *client)
+{
+    int index = client->heap_index;
+    time_engine_client *last = this->clients.back();
+
+    this->clients.pop_back();
+
+    if (last != client)
+    {
+        this->clients[index] = last;
+        if (index > 0 && this->is_before(last, this->clients[(index - 1) >> 1]))
+            this->sift_up(index);
+        else
+            this->sift_down(index);
+    }
+}
+
+
+bool vp::time_engine::wait_stopped()
+{
+    pthread_mutex_lock(&this->mutex);
+    while (!this->finished && !this->stop_req && (this->run_req || this->running))
+    {
+        pthread_cond_wait(&this->cond, &this->mutex);
+    }
+    bool paused = !this->finished && !this->stop_req;
+    pthread_mutex_unlock(&this->mutex);
+    return paused;
+}
+
+void vp::time_engine::checkpoint_save(vp::checkpoint *checkpoint)
+{
+    if (this->parallel)
+    {
+        checkpoint->error("Checkpoints are not supported in parallel mode\n");
+        return;
+    }
+
+    checkpoint->save(this, "time", &this->time, sizeof(this->time));
+}
+
+void vp::time_engine::pre_checkpoint_restore(vp::checkpoint *checkpoint)
+{
+    if (this->parallel)
+    {
+        checkpoint->error("Checkpoints are not supported in parallel mode\n");
+        return;
+    }
+
+    checkpoint->restore(this, "time", &this->time, sizeof(this->time));
+
+    // Clients are enqueued again when the events of the checkpoint are restored
+    while (this->get_first_client())
+    {
+        this->client_pop()->is_enqueued = false;
+    }
+}
+
+bool vp::time_engine::dequeue(time_engine_client *client)
+{
+    if (unlikely(client->partition != NULL))
+        return client->partition->clients.dequeue(client);
+
+    return this->clients.dequeue(client);
 }
 
 bool vp::time_engine::enqueue(time_engine_client *client, int64_t time)
 {
     vp_assert(time >= 0, NULL, "Time must be positive\n");
 
+    if (unlikely(this->parallel))
+        return this->enqueue_partition(client, time);
+
     int64_t full_time = this->get_time() + time;
 
 #ifdef __VP_USE_SYSTEMC
@@ -385,32 +592,81 @@ bool vp::time_engine::enqueue(time_engine_client *client, int64_t time)
     dpi_raise_event();
 #endif
 
-    if (client->is_running())
-        return false;
+    return this->clients.enqueue(client, full_time);
+}
+
 
-    if (client->is_enqueued)
+thread_local vp::time_partition *vp::time_partition::current = NULL;
+
+vp::time_partition *vp::time_engine::get_partition(int id)
+{
+    if (!this->parallel)
+        return NULL;
+
+    while ((int)this->partitions.size() <= id)
     {
-        if (client->next_event_time <= full_time)
-            return false;
-        this->dequeue(client);
+        this->partitions.push_back(new time_partition(this, this->partitions.size()));
     }
 
-    client->is_enqueued = true;
+    return this->partitions[id];
+}
 
-    time_engine_client *current = first_client, *prev = NULL;
-    client->next_event_time = full_time;
-    while (current && current->next_event_time < client->next_event_time)
+void vp::time_engine::register_sync_channel(time_sync_channel *channel, int64_t lookahead)
+{
+    if (lookahead <= 0)
     {
-        prev = current;
-        current = current->next;
+        this->fatal("Sync channels between partitions must have a positive latency\n");
+        return;
     }
-    if (prev)
-        prev->next = client;
-    else
-        first_client = client;
-    client->next = current;
 
-    return true;
+    this->sync_channels.push_back(channel);
+
+    if (lookahead < this->lookahead)
+    {
+        this->lookahead = lookahead;
+    }
+}
+
+int64_t vp::time_engine::get_partition_time()
+{
+    time_partition *partition = time_partition::current;
+    return partition ? partition->time : this->time;
+}
+
+bool vp::time_engine::fast_forward_partition(int64_t time)
+{
+    time_partition *partition = time_partition::current;
+    return partition && partition->fast_forward(time);
+}
+
+bool vp::time_engine::enqueue_partition(time_engine_client *client, int64_t time)
+{
+    time_partition *current = time_partition::current;
+    time_partition *partition = client->partition;
+
+    // Clients which were not explicitly attached belong to the partition which
+    // first enqueues them
+    if (partition == NULL)
+    {
+        partition = current ? current : this->partitions[0];
+        client->partition = partition;
+    }
+
+    vp_assert(current == NULL || current == partition, NULL,
+        "Client enqueued from another partition, partitions must only interact through sync channels\n");
+
+    return partition->clients.enqueue(client, partition->time + time);
+}
+
+bool vp::time_engine::has_clients()
+{
+    for (time_partition *partition: this->partitions)
+    {
+        if (partition->clients.first())
+            return true;
+    }
+
+    return this->get_first_client() != NULL;
 }
 
 bool vp::clock_engine::dequeue_from_engine()
@@ -485,6 +741,76 @@ void vp::clock_engine::update()
     }
 }
 
+typedef struct
+{
+    int64_t cycles;
+    int64_t stop_time;
+    int64_t period;
+    int64_t freq;
+    int64_t next_event_time;
+    int current_cycle;
+    uint8_t is_enqueued;
+} clock_engine_checkpoint_t;
+
+void vp::clock_engine::checkpoint_save(vp::checkpoint *checkpoint)
+{
+    clock_engine_checkpoint_t state = {};
+
+    state.cycles = this->cycles;
+    state.stop_time = this->stop_time;
+    state.period = this->period;
+    state.freq = this->freq;
+    state.current_cycle = this->current_cycle;
+    state.next_event_time = this->next_event_time;
+    state.is_enqueued = this->is_enqueued;
+
+    // The stop time is only updated when the engine has no more event in the circular
+    // buffer. Otherwise the cycles are the ones of the next execution, which gives
+    // the time to resynchronize from.
+    if (this->nb_enqueued_to_cycle)
+    {
+        state.stop_time = this->next_event_time;
+    }
+
+    checkpoint->save(this, "engine", &state, sizeof(state));
+
+    checkpoint->nb_pending_events += this->nb_enqueued_to_cycle + this->delayed_queue.get_nb_events();
+}
+
+void vp::clock_engine::pre_checkpoint_restore(vp::checkpoint *checkpoint)
+{
+    clock_engine_checkpoint_t state;
+
+    if (!checkpoint->restore(this, "engine", &state, sizeof(state)))
+        return;
+
+    // Pending events are dropped, the components enqueue again the ones they saved
+    for (int i=0; i<CLOCK_EVENT_QUEUE_SIZE; i++)
+    {
+        for (clock_event *event = this->event_queue[i]; event; event = event->next)
+        {
+            event->enqueued = false;
+        }
+        this->event_queue[i] = NULL;
+    }
+    this->nb_enqueued_to_cycle = 0;
+    this->delayed_queue.clear(state.cycles);
+
+    this->cycles = state.cycles;
+    this->stop_time = state.stop_time;
+    this->period = state.period;
+    this->freq = state.freq;
+    this->current_cycle = state.current_cycle;
+
+    // Restored events are all put in the delayed queue, and moved to the circular
+    // buffer on the next execution, which is done at the same time as before
+    this->must_flush_delayed_queue = true;
+    if (state.is_enqueued)
+    {
+        this->enqueue_to_engine(state.next_event_time - this->get_time());
+    }
+}
+
 vp::clock_event *vp::clock_engine::enqueue_other(vp::clock_event *event, int64_t cycle)
 {
     // Slow case where the engine is not running or we must enqueue out of the
@@ -518,19 +844,7 @@ vp::clock_event *vp::clock_engine::enqueue_other(vp::clock_event *event, int64_t
             enqueue_to_engine(cycle * period);
         }
 
-        vp::clock_event *current = delayed_queue, *prev = NULL;
-        int64_t full_cycle = cycle + get_cycles();
-        while (current && current->cycle < full_cycle)
-        {
-            prev = current;
-            current = current->next;
-        }
-        if (prev)
-            prev->next = event;
-        else
-            delayed_queue = event;
-        event->next = current;
-        event->cycle = full_cycle;
+        this->delayed_queue.insert(event, cycle + get_cycles());
     }
     return event;
 }
@@ -555,7 +869,7 @@ vp::clock_event *vp::clock_engine::get_next_event()
         vp_assert(false, 0, "Didn't find any event in circular buffer while it is not empty\n");
     }
 
-    return this->delayed_queue;
+    return this->delayed_queue.get_first();
 }
 
 void vp::clock_engine::cancel(vp::clock_event *event)
@@ -563,54 +877,17 @@ void vp::clock_engine::cancel(vp::clock_event *event)
     if (!event->is_enqueued())
         return;
 
-    // There is no way to know if the event is enqueued into the circular buffer
-    // or in the delayed queue so first go through the delayed queue and if it is
-    // not found, look in the circular buffer
-
-    // First the delayed queue
-    vp::clock_event *current = delayed_queue, *prev = NULL;
-    while (current)
+    // Events know the list they are enqueued to, so they can be removed directly
+    if (this->delayed_queue.contains(event))
     {
-        if (current == event)
-        {
-            if (prev)
-                prev->next = event->next;
-            else
-                delayed_queue = event->next;
-
-            goto end;
-        }
-
-        prev = current;
-        current = current->next;
+        this->delayed_queue.remove(event);
     }
-
-    // Then in the circular buffer
-    for (int i = 0; i < CLOCK_EVENT_QUEUE_SIZE; i++)
+    else
     {
-        vp::clock_event *current = event_queue[i], *prev = NULL;
-        while (current)
-        {
-            if (current == event)
-            {
-                if (prev)
-                    prev->next = event->next;
-                else
-                    event_queue[i] = event->next;
-
-                this->nb_enqueued_to_cycle--;
-
-                goto end;
-            }
-
-            prev = current;
-            current = current->next;
-        }
+        event->unlink();
+        this->nb_enqueued_to_cycle--;
     }
 
-    vp_assert(0, NULL, "Didn't find event in any queue while canceling event\n");
-
-end:
     event->enqueued = false;
 
     if (!this->has_events())
@@ -619,23 +896,19 @@ end:
 
 void vp::clock_engine::flush_delayed_queue()
 {
-    clock_event *event = delayed_queue;
     this->must_flush_delayed_queue = false;
-    while (event)
-    {
-        if (nb_enqueued_to_cycle == 0)
-            cycles = event->cycle;
 
-        uint64_t cycle_diff = event->cycle - get_cycles();
-        if (cycle_diff >= CLOCK_EVENT_QUEUE_SIZE)
-            break;
+    if (this->delayed_queue.empty())
+        return;
 
-        clock_event *next = event->next;
+    if (nb_enqueued_to_cycle == 0)
+        cycles = this->delayed_queue.get_first()->cycle;
 
-        enqueue_to_cycle(event, cycle_diff);
+    this->delayed_queue.extract(get_cycles(), get_cycles() + CLOCK_EVENT_QUEUE_SIZE, this->flushed_events);
 
-        event = next;
-        delayed_queue = event;
+    for (clock_event *event: this->flushed_events)
+    {
+        enqueue_to_cycle(event, event->cycle - get_cycles());
     }
 }
 
@@ -664,7 +937,10 @@ int64_t vp::clock_engine::exec()
 
     while (likely(current != NULL))
     {
-        event_queue[current_cycle] = current->next;
+        clock_event *next = current->next;
+        event_queue[current_cycle] = next;
+        if (next)
+            next->prev = NULL;
         current->enqueued = false;
         nb_enqueued_to_cycle--;
 
@@ -698,9 +974,9 @@ int64_t vp::clock_engine::exec()
         // in case we enqueue and event from another engine.
         this->stop_time = this->get_time();
 
-        if (delayed_queue)
+        if (!delayed_queue.empty())
         {
-            return (delayed_queue->cycle - get_cycles()) * period;
+            return (delayed_queue.get_first()->cycle - get_cycles()) * period;
         }
         else
         {
@@ -712,11 +988,117 @@ int64_t vp::clock_engine::exec()
 }
 
 vp::clock_event::clock_event(component_clock *comp, clock_event_meth_t *meth)
-    : comp(comp), _this((void *)static_cast<vp::component *>((vp::component_clock *)(comp))), meth(meth), enqueued(false)
+    : meth(meth), _this((void *)static_cast<vp::component *>((vp::component_clock *)(comp))), enqueued(false), comp(comp)
 {
     comp->add_clock_event(this);
 }
 
+void *vp::clock_event_allocator::alloc_slab()
+{
+    // Events are allocated by slabs aligned on cache lines, and each event is
+    // rounded to a multiple of cache lines so that the scheduling fields
+    // of all events fit into a single cache line.
+    size_t size = CLOCK_EVENT_STRIDE * CLOCK_EVENT_SLAB_SIZE;
+    uint8_t *slab = (uint8_t *)aligned_alloc(CLOCK_EVENT_CACHE_LINE, size);
+    if (slab == NULL)
+    {
+        return NULL;
+    }
+
+    this->slabs.push_back(slab);
+
+    // Keep the first one for the caller and put the others in the free list
+    for (int i = CLOCK_EVENT_SLAB_SIZE - 1; i > 0; i--)
+    {
+        clock_event *event = (clock_event *)(slab + i * CLOCK_EVENT_STRIDE);
+        event->next = this->free_events;
+        this->free_events = event;
+    }
+
+    this->nb_events++;
+
+    return slab;
+}
+
+vp::clock_event_allocator::~clock_event_allocator()
+{
+    for (void *slab: this->slabs)
+    {
+        ::free(slab);
+    }
+}
+
+void *vp::clock_engine::event_alloc_slab()
+{
+    void *event = this->event_allocator.alloc_slab();
+    if (event == NULL)
+    {
+        this->get_trace()->fatal("Failed to allocate clock events\n");
+        return NULL;
+    }
+
+    this->get_trace()->msg(vp::trace::LEVEL_DEBUG, "Allocated clock event slab (nb_slabs: %d, nb_events: %ld)\n",
+        this->event_allocator.get_nb_slabs(), this->event_allocator.get_nb_events());
+
+    return event;
+}
+
+// Events of unbound components are allocated during the build, which is sequential, but
+// they can be deleted by any partition thread in parallel mode
+static std::mutex unbound_events_mutex;
+
+static vp::clock_event_allocator *get_unbound_event_allocator()
+{
+    // Never destroyed, as components can still delete their events at exit
+    static vp::clock_event_allocator *allocator = new vp::clock_event_allocator();
+    return allocator;
+}
+
+static void *unbound_event_alloc(vp::component *comp)
+{
+    vp::clock_event_allocator *allocator = get_unbound_event_allocator();
+    void *event = allocator->alloc();
+    if (event == NULL)
+    {
+        event = allocator->alloc_slab();
+        if (event == NULL)
+        {
+            throw std::bad_alloc();
+        }
+
+        // Reported like the slabs of the clock engines, so that the traces give the number
+        // of events of the whole platform
+        comp->get_trace()->msg(vp::trace::LEVEL_DEBUG,
+            "Allocated build-time clock event slab (nb_slabs: %d, nb_events: %ld)\n",
+            allocator->get_nb_slabs(), allocator->get_nb_events());
+    }
+    return event;
+}
+
+vp::clock_event *vp::clock_engine::event_new_unbound(component_clock *comp, clock_event_meth_t *meth)
+{
+    std::lock_guard<std::mutex> lock(unbound_events_mutex);
+    clock_event *event = new (unbound_event_alloc(static_cast<vp::component *>(comp))) clock_event(comp, meth);
+    event->allocator = get_unbound_event_allocator();
+    return event;
+}
+
+vp::clock_event *vp::clock_engine::event_new_unbound(component_clock *comp, void *_this, clock_event_meth_t *meth)
+{
+    std::lock_guard<std::mutex> lock(unbound_events_mutex);
+    clock_event *event = new (unbound_event_alloc(static_cast<vp::component *>(comp))) clock_event(comp, _this, meth);
+    event->allocator = get_unbound_event_allocator();
+    return event;
+}
+
+void vp::clock_engine::event_del_unbound(clock_event *event)
+{
+    std::lock_guard<std::mutex> lock(unbound_events_mutex);
+    clock_event_allocator *allocator = event->allocator;
+    event->~clock_event();
+    allocator->free(event);
+}
+
 void vp::component_clock::add_clock_event(clock_event *event)
 {
     this->events.push_back(event);
@@ -1104,7 +1486,7 @@ vp::component *vp::component::get_component(std::vector<std::string> path_list)
 
     for (auto x:this->childs)
     {
-        vp::component *comp;
+        vp::component *comp = NULL;
         if (name == x->get_name())
         {
             comp = x->get_component({ path_list.begin() + name_pos + 1, path_list.end() });
@@ -1364,43 +1746,79 @@ void vp::component::build_instance(std::string name, vp::component *parent)
 }
 
 
-vp::component *vp::component::new_component(std::string name, js::config *config, std::string module_name)
+// Models linked into the launcher, registered from static constructors, so the map
+// is created on first use
+static std::map<std::string, vp::component_constructor_t> &get_static_models()
 {
-    if (module_name == "")
-    {
-        module_name = config->get_child_str("vp_component");
+    static std::map<std::string, vp::component_constructor_t> models;
+    return models;
+}
 
-        if (module_name == "")
-        {
-            module_name = "utils.composite_impl";
-        }
-    }
+void vp::register_static_model(std::string module_name, vp::component_constructor_t constructor)
+{
+    get_static_models()[module_name] = constructor;
+}
 
-    if (this->get_vp_config()->get_child_bool("sv-mode"))
+// Return the constructor of a model, from the models linked into the launcher, or
+// otherwise from its module. The model name is adapted to the sv and debug modes.
+// Return NULL and set the error if the module cannot be loaded.
+static vp::component_constructor_t get_model_constructor(js::config *gv_config, std::string module_name,
+    std::string &error)
+{
+    if (gv_config->get_child_bool("sv-mode"))
     {
         module_name = "sv." + module_name;
     }
-    else if (this->get_vp_config()->get_child_bool("debug-mode"))
+    else if (gv_config->get_child_bool("debug-mode"))
     {
         module_name = "debug." + module_name;
     }
 
-    this->get_trace()->msg(vp::trace::LEVEL_DEBUG, "New component (name: %s, module: %s)\n", name.c_str(), module_name.c_str());
-
     std::replace(module_name.begin(), module_name.end(), '.', '/');
 
+    auto static_model = get_static_models().find(module_name);
+    if (static_model != get_static_models().end())
+    {
+        return static_model->second;
+    }
+
     std::string path = std::string(getenv("GVSOC_PATH")) + "/" + module_name + ".so";
 
     void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL | RTLD_DEEPBIND);
     if (module == NULL)
     {
-        this->throw_error("ERROR, Failed to open periph model (module: " + module_name + ", error: " + std::string(dlerror()) + ")");
+        error = "ERROR, Failed to open periph model (module: " + module_name + ", error: " + std::string(dlerror()) + ")";
+        return NULL;
     }
 
-    vp::component *(*constructor)(js::config *) = (vp::component * (*)(js::config *)) dlsym(module, "vp_constructor");
+    vp::component_constructor_t constructor = (vp::component_constructor_t) dlsym(module, "vp_constructor");
     if (constructor == NULL)
     {
-        this->throw_error("ERROR, couldn't find vp_constructor in loaded module (module: " + module_name + ")");
+        error = "ERROR, couldn't find vp_constructor in loaded module (module: " + module_name + ")";
+    }
+
+    return constructor;
+}
+
+vp::component *vp::component::new_component(std::string name, js::config *config, std::string module_name)
+{
+    if (module_name == "")
+    {
+        module_name = config->get_child_str("vp_component");
+
+        if (module_name == "")
+        {
+            module_name = "utils.composite_impl";
+        }
+    }
+
+    this->get_trace()->msg(vp::trace::LEVEL_DEBUG, "New component (name: %s, module: %s)\n", name.c_str(), module_name.c_str());
+
+    std::string error;
+    vp::component_constructor_t constructor = get_model_constructor(this->get_vp_config(), module_name, error);
+    if (constructor == NULL)
+    {
+        this->throw_error(error);
     }
 
     vp::component *instance = constructor(config);
@@ -1623,32 +2041,11 @@ vp::component *vp::__gv_create(std::string config_path, struct gv_conf *gv_conf)
 
     js::config *gv_config = js_config->get("**/gvsoc");
 
-    std::string module_name = "vp.trace_domain_impl";
-
-    if (gv_config->get_child_bool("sv-mode"))
-    {
-        module_name = "sv." + module_name;
-    }
-    else if (gv_config->get_child_bool("debug-mode"))
-    {
-        module_name = "debug." + module_name;
-    }
-
-
-    std::replace(module_name.begin(), module_name.end(), '.', '/');
-
-    std::string path = std::string(getenv("GVSOC_PATH")) + "/" + module_name + ".so";
-
-    void *module = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL | RTLD_DEEPBIND);
-    if (module == NULL)
-    {
-        throw std::invalid_argument("ERROR, Failed to open periph model (module: " + module_name + ", error: " + std::string(dlerror()) + ")");
-    }
-
-    vp::component *(*constructor)(js::config *) = (vp::component * (*)(js::config *)) dlsym(module, "vp_constructor");
+    std::string error;
+    vp::component_constructor_t constructor = get_model_constructor(gv_config, "vp.trace_domain_impl", error);
     if (constructor == NULL)
     {
-        throw std::invalid_argument("ERROR, couldn't find vp_constructor in loaded module (module: " + module_name + ")");
+        throw std::invalid_argument(error);
     }
 
     vp::component *instance = constructor(js_config);
@@ -1731,6 +2128,131 @@ extern "C" int64_t gv_time(void *arg)
 }
 
 
+extern "C" int gv_run_until(void *arg, int64_t timestamp)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+    vp::time_engine *engine = instance->get_time_engine();
+
+    if (timestamp > engine->get_time())
+    {
+        instance->step(timestamp - engine->get_time());
+    }
+
+    return engine->wait_stopped() ? 0 : -1;
+}
+
+
+extern "C" int gv_checkpoint_save(void *arg, const char *path)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+    vp::checkpoint checkpoint;
+
+    if (checkpoint.open(path, true) == 0)
+    {
+        instance->checkpoint_save_all(&checkpoint);
+        checkpoint.close();
+    }
+
+    if (checkpoint.get_error() != "")
+    {
+        fprintf(stderr, "Failed to save checkpoint: %s", checkpoint.get_error().c_str());
+        return -1;
+    }
+
+    // Events like the ones of requests being processed can't be saved, the platform
+    // would not continue the same way after the checkpoint is restored
+    if (checkpoint.nb_saved_events != checkpoint.nb_pending_events)
+    {
+        fprintf(stderr, "Some pending events could not be saved to the checkpoint (pending: %ld, saved: %ld)\n",
+            checkpoint.nb_pending_events, checkpoint.nb_saved_events);
+    }
+
+    return 0;
+}
+
+
+extern "C" int gv_checkpoint_restore(void *arg, const char *path)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+    vp::checkpoint *checkpoint = new vp::checkpoint();
+
+    if (checkpoint->open(path, false) == 0)
+    {
+        instance->pre_checkpoint_restore_all(checkpoint);
+        instance->checkpoint_restore_all(checkpoint);
+    }
+
+    if (checkpoint->get_error() != "")
+    {
+        fprintf(stderr, "Failed to restore checkpoint: %s", checkpoint->get_error().c_str());
+        delete checkpoint;
+        return -1;
+    }
+
+    delete top->restored_checkpoint;
+    top->restored_checkpoint = checkpoint;
+
+    return 0;
+}
+
+
+extern "C" int gv_fork(void *arg)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+
+    // The proxy threads would not be in the child process
+    if (proxy)
+    {
+        fprintf(stderr, "Forking is not supported with the proxy\n");
+        return -1;
+    }
+
+    return instance->fork();
+}
+
+
+extern "C" int gv_mem_load(void *arg, const char *comp_path, uint64_t addr, const char *file_path)
+{
+    vp::top *top = (vp::top *)arg;
+    vp::component *instance = (vp::component *)top->top_instance;
+
+    vp::component *comp = instance->get_component(split_name(comp_path, '/'));
+    if (comp == NULL)
+    {
+        fprintf(stderr, "Component not found (path: %s)\n", comp_path);
+        return -1;
+    }
+
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open file (path: %s, error: %s)\n", file_path, strerror(errno));
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // Same command as the one used by the proxy to write the memory
+    std::string result = comp->handle_command(NULL, file, NULL,
+        {"mem_write", std::to_string(addr), std::to_string(size)}, "");
+
+    fclose(file);
+
+    if (result != "err=0")
+    {
+        fprintf(stderr, "Failed to load file to memory (component: %s, file: %s)\n", comp_path, file_path);
+        return -1;
+    }
+
+    return 0;
+}
+
 extern "C" void *gv_open(const char *config_path, bool open_proxy, int *proxy_socket, int req_pipe, int reply_pipe)
 {
     struct gv_conf gv_conf;
@@ -1939,6 +2461,21 @@ int64_t vp::time_scheduler::exec()
 }
 
 
+void vp::time_scheduler::checkpoint_save(vp::checkpoint *checkpoint)
+{
+    // Time events can't be saved, they are only counted to report them
+    for (vp::time_event *event = this->first_event; event; event = event->next)
+    {
+        checkpoint->nb_pending_events++;
+    }
+}
+
+void vp::time_scheduler::pre_checkpoint_restore(vp::checkpoint *checkpoint)
+{
+    this->first_event = NULL;
+}
+
+
 vp::time_event::time_event(time_scheduler *comp, time_event_meth_t *meth)
     : comp(comp), _this((void *)static_cast<vp::component *>((vp::time_scheduler *)(comp))), meth(meth), enqueued(false)
 {
@@ -83,6 +83,10 @@ int clock_domain::build()
 
   this->set_time_engine((vp::time_engine*)this->get_service("time"));
 
+  // In parallel mode, the clock domain, and thus all the components it clocks, is
+  // executed by the thread of its partition
+  this->set_partition(this->get_js_config()->get_child_int("partition"));
+
   return 0;
 }
 
@@ -95,7 +99,6 @@ void clock_domain::pre_start()
 vp::clock_engine::clock_engine(js::config *config)
   : vp::time_engine_client(config), cycles(0), period(0), freq(0), must_flush_delayed_queue(true)
 {
-  delayed_queue = NULL;
   for (int i=0; i<CLOCK_EVENT_QUEUE_SIZE; i++)
   {
     event_queue[i] = NULL;
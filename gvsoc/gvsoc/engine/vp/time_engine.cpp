@@ -24,6 +24,8 @@
 #include "vp/time/time_scheduler.hpp"
 #include <pthread.h>
 #include <signal.h>
+#include <sched.h>
+#include <unistd.h>
 
 extern "C" void dpi_wait_event();
 extern "C" void dpi_wait_event_timeout_ps(long long int delay);
@@ -173,7 +175,7 @@ static void *engine_routine(void *arg)
 }
 
 vp::time_engine::time_engine(js::config *config)
-    : vp::component(config), first_client(NULL)
+    : vp::component(config)
 {
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
@@ -182,6 +184,16 @@ vp::time_engine::time_engine(js::config *config)
     run_req = false;
     stop_req = false;
     pause_req = false;
+
+#if !defined(__VP_USE_SYSTEMC) && !defined(__VP_USE_SYSTEMV)
+    // Partitions are created when clock domains are attached to them, the first one
+    // always exists to get all the other clients
+    this->parallel = config->get_child_bool("**/gvsoc/parallel");
+    if (this->parallel)
+    {
+        this->get_partition(0);
+    }
+#endif
 }
 
 
@@ -297,6 +309,11 @@ void vp::time_engine::start()
 
     this->stop_event = new Time_engine_stop_event(this);
 
+    if (this->parallel)
+    {
+        this->start_partitions();
+    }
+
     if (sa_mode)
     {
     #ifdef __VP_USE_SYSTEMV
@@ -309,9 +326,40 @@ void vp::time_engine::start()
     }
 }
 
+int vp::time_engine::fork()
+{
+    // The partition threads would not be in the child process
+    if (this->parallel)
+    {
+        fprintf(stderr, "Forking is not supported in parallel mode\n");
+        return -1;
+    }
+
+    // Buffered outputs would be written by both processes
+    fflush(NULL);
+
+    int pid = ::fork();
+    if (pid == 0)
+    {
+        // Only the calling thread exists in the child, the mutex and the condition
+        // may have been left in any state by the other ones
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+        pthread_mutex_lock(&mutex);
+        this->running = false;
+
+        if (this->get_js_config()->get_child_bool("**/gvsoc/sa-mode"))
+        {
+            pthread_create(&run_thread, NULL, engine_routine, (void *)this);
+        }
+    }
+
+    return pid;
+}
+
 void vp::time_engine::wait_ready()
 {
-    while (!first_client)
+    while (!this->get_first_client())
     {
     }
 }
@@ -395,11 +443,17 @@ void vp::time_engine::run_loop()
 
         pthread_mutex_unlock(&mutex);
 
-        time_engine_client *current = first_client;
+        // In parallel mode, all the clients are in the partitions and the main heap
+        // stays empty, so that the sequential loop below is skipped
+        while (this->parallel && run_req && this->run_window())
+        {
+        }
+
+        time_engine_client *current = this->get_first_client();
 
         if (current)
         {
-            first_client = current->next;
+            this->client_pop();
             current->is_enqueued = false;
 
 #if defined(__VP_USE_SYSTEMC) || defined(__VP_USE_SYSTEMV)
@@ -446,19 +500,7 @@ void vp::time_engine::run_loop()
                 {
                     time += this->time;
                     current->next_event_time = time;
-                    time_engine_client *client = first_client, *prev = NULL;
-
-                    while (client && client->next_event_time < time)
-                    {
-                        prev = client;
-                        client = client->next;
-                    }
-                    if (prev)
-                        prev->next = current;
-                    else
-                        first_client = current;
-
-                    current->next = client;
+                    this->client_push(current);
                     current->is_enqueued = true;
                 }
 
@@ -470,6 +512,8 @@ void vp::time_engine::run_loop()
                 // enqueues a new event.
                 while (1)
                 {
+                    time_engine_client *first_client = this->get_first_client();
+
                     if (!first_client)
                     {
                         if (stop_req || locked)
@@ -515,12 +559,12 @@ void vp::time_engine::run_loop()
                     }
                 }
 
-                current = first_client;
+                current = this->get_first_client();
                 if (current)
                 {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+                    vp_assert(current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
 
-                    first_client = current->next;
+                    this->client_pop();
                     current->is_enqueued = false;
                 }
 
@@ -528,7 +572,7 @@ void vp::time_engine::run_loop()
 
                 int64_t time = current->exec();
 
-                time_engine_client *next = first_client;
+                time_engine_client *next = this->get_first_client();
 
                 // Shortcut to quickly continue with the same client
                 if (likely(time > 0))
@@ -543,9 +587,10 @@ void vp::time_engine::run_loop()
                         }
                         else
                         {
-                            current->next = first_client;
-                            first_client = current;
+                            // The client is pushed as the most recent one so it stays
+                            // ahead of clients with the same time
                             current->next_event_time = time;
+                            this->client_push(current);
                             current->is_enqueued = true;
                             current->running = false;
                             break;
@@ -553,21 +598,12 @@ void vp::time_engine::run_loop()
                     }
                 }
 
-                // Otherwise remove it, reenqueue it and continue with the next one.
-                // We can optimize a bit the operation as we already know
-                // who to schedule next.
+                // Otherwise reenqueue it and continue with the next one.
 
                 if (time > 0)
                 {
                     current->next_event_time = time;
-                    time_engine_client *client = next->next, *prev = next;
-                    while (client && client->next_event_time < time)
-                    {
-                        prev = client;
-                        client = client->next;
-                    }
-                    current->next = client;
-                    prev->next = current;
+                    this->client_push(current);
                     current->is_enqueued = true;
                 }
 
@@ -576,12 +612,12 @@ void vp::time_engine::run_loop()
                 if (!run_req)
                     break;
 
-                current = first_client;
+                current = this->get_first_client();
                 if (current)
                 {
-                    vp_assert(first_client->next_event_time >= get_time(), NULL, "event time is before vp time\n");
+                    vp_assert(current->next_event_time >= get_time(), NULL, "event time is before vp time\n");
 
-                    first_client = current->next;
+                    this->client_pop();
                     current->is_enqueued = false;
                 }
 
@@ -599,7 +635,7 @@ void vp::time_engine::run_loop()
 
         running = false;
 
-        while (!first_client && retain_count && !locked)
+        while (!this->has_clients() && retain_count && !locked)
         {
 #if defined(__VP_USE_SYSTEMV)
             pthread_mutex_unlock(&mutex);
@@ -614,9 +650,7 @@ void vp::time_engine::run_loop()
 #endif
         }
 
-        current = first_client;
-
-        if (first_client == NULL && !locked && !retain_count)
+        if (!this->has_clients() && !locked && !retain_count)
         {
 #ifdef __VP_USE_SYSTEMC
             sc_stop();
@@ -628,6 +662,175 @@ void vp::time_engine::run_loop()
     }
 }
 
+// Active wait between the engine thread and the partition threads, as windows are
+// usually very short. The thread still sleeps once it has been waiting for long, to
+// not keep the host busy while the engine is stopped.
+static inline void partition_wait(int64_t &count)
+{
+    count++;
+    if (count > 100000)
+        usleep(100);
+    else if (count > 1000)
+        sched_yield();
+}
+
+void vp::time_partition::run_window()
+{
+    time_engine_client *current;
+
+    while ((current = this->clients.first()) && current->next_event_time < this->window_end)
+    {
+        this->clients.pop();
+        current->is_enqueued = false;
+        this->time = current->next_event_time;
+
+        while (1)
+        {
+            current->running = true;
+
+            int64_t time = current->exec();
+
+            current->running = false;
+
+            if (time <= 0)
+                break;
+
+            time += this->time;
+
+            // Shortcut to quickly continue with the same client, as in the sequential loop
+            time_engine_client *next = this->clients.first();
+            if (time < this->window_end && (!next || next->next_event_time >= time))
+            {
+                this->time = time;
+                continue;
+            }
+
+            current->next_event_time = time;
+            this->clients.push(current);
+            current->is_enqueued = true;
+            break;
+        }
+    }
+}
+
+void *vp::time_engine::partition_routine(void *arg)
+{
+    time_partition *partition = (time_partition *)arg;
+    time_engine *engine = partition->engine;
+    int64_t window_id = 0;
+
+    time_partition::current = partition;
+
+    while (1)
+    {
+        int64_t count = 0;
+        while (engine->window_id.load(std::memory_order_acquire) == window_id)
+        {
+            if (engine->partitions_end.load(std::memory_order_acquire))
+                return NULL;
+
+            partition_wait(count);
+        }
+        window_id++;
+
+        partition->run_window();
+
+        engine->nb_running_partitions.fetch_sub(1, std::memory_order_release);
+    }
+
+    return NULL;
+}
+
+void vp::time_engine::start_partitions()
+{
+    // The first partition is executed by the engine thread
+    for (unsigned int i=1; i<this->partitions.size(); i++)
+    {
+        pthread_create(&this->partitions[i]->thread, NULL, partition_routine, (void *)this->partitions[i]);
+    }
+
+    this->partitions_started = true;
+}
+
+void vp::time_engine::stop_partitions()
+{
+    // The engine thread is not running a window anymore, so the partition threads
+    // are all waiting for the next one
+    this->partitions_end.store(true, std::memory_order_release);
+
+    for (unsigned int i=1; i<this->partitions.size(); i++)
+    {
+        pthread_join(this->partitions[i]->thread, NULL);
+    }
+
+    this->partitions_started = false;
+}
+
+void vp::time_engine::stop()
+{
+    if (this->partitions_started)
+    {
+        this->stop_partitions();
+    }
+}
+
+// Conservative synchronization of the partitions. A window starts at the first event
+// of all partitions and lasts the minimum latency of the sync channels, so that
+// whatever goes through a channel during a window is for a later window. The
+// partitions can then execute the window independently, and the channels deliver
+// what they got once all partitions are done.
+bool vp::time_engine::run_window()
+{
+    int64_t start = -1;
+
+    for (time_partition *partition: this->partitions)
+    {
+        time_engine_client *first = partition->clients.first();
+        if (first && (start == -1 || first->next_event_time < start))
+        {
+            start = first->next_event_time;
+        }
+    }
+
+    if (start == -1)
+        return false;
+
+    int64_t end = start + this->lookahead;
+
+    this->time = start;
+
+    for (time_partition *partition: this->partitions)
+    {
+        partition->window_end = end;
+    }
+
+    this->nb_running_partitions.store(this->partitions.size() - 1, std::memory_order_relaxed);
+    this->window_id.fetch_add(1, std::memory_order_release);
+
+    time_partition::current = this->partitions[0];
+    this->partitions[0]->run_window();
+    time_partition::current = NULL;
+
+    int64_t count = 0;
+    while (this->nb_running_partitions.load(std::memory_order_acquire) != 0)
+    {
+        partition_wait(count);
+    }
+
+    for (time_sync_channel *channel: this->sync_channels)
+    {
+        channel->sync();
+    }
+
+    for (time_partition *partition: this->partitions)
+    {
+        if (partition->time > this->time)
+            this->time = partition->time;
+    }
+
+    return true;
+}
+
 void vp::time_engine::req_stop_exec()
 {
     this->pause();
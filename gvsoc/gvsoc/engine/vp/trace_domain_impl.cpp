@@ -65,6 +65,8 @@ public:
 
     int join();
 
+    int fork();
+
     int64_t step(int64_t timestamp);
 
     void check_traces();
@@ -111,7 +113,7 @@ vp::trace_engine::trace_engine(js::config *config)
     current_buffer_size = 0;
     this->first_pending_event = NULL;
 
-    thread = new std::thread(&trace_engine::vcd_routine, this);
+    this->start_vcd_thread();
 }
 
 
@@ -167,6 +169,28 @@ int trace_domain::join()
     return this->time_engine->join();
 }
 
+int trace_domain::fork()
+{
+    // Both processes would write to the same trace files
+    if (this->binary_writer)
+    {
+        fprintf(stderr, "Forking is not supported with binary traces\n");
+        return -1;
+    }
+
+    if (this->event_dumper.has_files())
+    {
+        fprintf(stderr, "Forking is not supported with event traces\n");
+        return -1;
+    }
+
+    this->stop_vcd_thread();
+    int pid = this->time_engine->fork();
+    this->start_vcd_thread();
+
+    return pid;
+}
+
 void trace_domain::check_trace_active(vp::trace *trace, int event)
 {
     std::string full_path = trace->get_full_path();
@@ -323,6 +347,20 @@ int trace_domain::build()
     {
         this->trace_format = TRACE_FORMAT_SHORT;
     }
+    else if (format == "binary")
+    {
+        this->trace_format = TRACE_FORMAT_BINARY;
+
+        std::string path = this->get_vp_config()->get_child_str("traces/binary_file");
+        if (path == "")
+        {
+            path = "trace_file.bin";
+        }
+        std::string compression = this->get_vp_config()->get_child_str("traces/compression");
+
+        this->binary_writer = new vp::trace_binary_writer(this, path,
+            compression == "lz4" ? TRACE_BINARY_COMPRESSION_LZ4 : TRACE_BINARY_COMPRESSION_NONE);
+    }
     else
     {
         this->trace_format = TRACE_FORMAT_LONG;
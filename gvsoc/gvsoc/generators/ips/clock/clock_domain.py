@@ -18,13 +18,14 @@ import gsystree as st
 
 class Clock_domain(st.Component):
 
-    def __init__(self, parent, name, frequency, factor=1):
+    def __init__(self, parent, name, frequency, factor=1, partition=0):
         super(Clock_domain, self).__init__(parent, name)
 
         self.add_properties({
             'vp_component': "vp.clock_domain_impl",
             'frequency': frequency,
-            'factor': factor
+            'factor': factor,
+            'partition': partition
         })
 
     def gen_gtkw(self, tree, comp_traces):
@@ -59,6 +59,8 @@ class Gvsoc(st.Component):
             "traces": {
                 "level": "debug",
                 "format": "long",
+                "binary_file": "trace_file.bin",
+                "compression": "lz4",
                 "enabled": False,
                 "include_regex": [],
                 "exclude_regex": []
@@ -26,4 +26,10 @@ int insn_cache_init(iss_t *iss);
 void iss_cache_flush(iss_t *iss);
 iss_insn_t *insn_cache_get(iss_t *iss, iss_addr_t pc);
 
+// Return the decode cache shared by all the cores opened with the same name
+iss_decode_cache_t *iss_decode_cache_get_shared(std::string name);
+// Return the entry of the decode cache for this address. The entry is only valid
+// if it has an item and the same opcode.
+iss_decode_cache_entry_t *iss_decode_cache_get(iss_decode_cache_t *cache, iss_addr_t pc);
+
 #endif
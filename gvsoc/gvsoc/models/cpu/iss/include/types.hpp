@@ -256,6 +256,8 @@ typedef struct iss_decoder_item_s {
       iss_insn_t *(*handler)(iss_t *, iss_insn_t*);
       iss_insn_t *(*fast_handler)(iss_t *, iss_insn_t*);
       void (*decode)(iss_t *, iss_insn_t*);
+      // Generated function decoding the arguments, with the fields known at compile-time
+      void (*decode_args)(iss_t *, iss_insn_t*, iss_opcode_t);
       char *label;
       int size;
       int nb_args;
@@ -272,6 +274,9 @@ typedef struct iss_decoder_item_s {
       int width;
       int nb_groups;
       iss_decoder_item_t **groups;
+      // Generated function selecting the instruction from the opcode, returns NULL
+      // if there is none
+      iss_decoder_item_t *(*select)(iss_opcode_t);
     } group;
   } u;
 
@@ -367,6 +372,32 @@ typedef struct iss_insn_cache_s {
   iss_insn_block_t *blocks[ISS_INSN_NB_BLOCKS];
 } iss_insn_cache_t;
 
+// Part of the decoded instruction which only depends on the opcode, and can then be
+// shared between the cores executing the same code
+typedef struct iss_decode_cache_entry_s {
+  iss_opcode_t opcode;
+  iss_decoder_item_t *item;    // NULL if nothing was decoded yet for this address
+  int nb_out_reg;
+  int nb_in_reg;
+  int out_regs[ISS_MAX_NB_OUT_REGS];
+  int in_regs[ISS_MAX_NB_IN_REGS];
+  iss_uim_t uim[ISS_MAX_IMMEDIATES];
+  iss_sim_t sim[ISS_MAX_IMMEDIATES];
+  iss_insn_arg_t args[ISS_MAX_DECODE_ARGS];
+} iss_decode_cache_entry_t;
+
+typedef struct iss_decode_cache_block_s iss_decode_cache_block_t;
+
+typedef struct iss_decode_cache_block_s {
+  iss_addr_t pc;
+  iss_decode_cache_entry_t entries[ISS_INSN_BLOCK_SIZE];
+  iss_decode_cache_block_t *next;
+} iss_decode_cache_block_t;
+
+typedef struct iss_decode_cache_s {
+  iss_decode_cache_block_t *blocks[ISS_INSN_NB_BLOCKS];
+} iss_decode_cache_t;
+
 typedef struct iss_regfile_s {
   iss_reg_t regs[ISS_NB_REGS + ISS_NB_FREGS];
 } iss_regfile_t;
@@ -497,6 +528,7 @@ typedef struct iss_cpu_s {
   iss_prefetcher_t decode_prefetcher;
   iss_prefetcher_t prefetcher;
   iss_insn_cache_t insn_cache;
+  iss_decode_cache_t *decode_cache;    // Decode cache shared with other cores, or NULL
   iss_insn_t *current_insn;
   iss_insn_t *prev_insn;
   iss_insn_t *stall_insn;
@@ -40,6 +40,40 @@ def dump(isaFile, str, level=0):
         isaFile.write('  ')
     isaFile.write(str)
 
+# Generate the expression extracting a value from the opcode, which gives the same
+# result as the table-driven decoding but with all the ranges known at compile-time
+def gen_ranges_extract(ranges, is_signed):
+    fields = []
+    bits = 0
+    for range in ranges:
+        fields.append('(uint64_t)(iss_get_field(opcode, %d, %d) << %d)' % (range.first, range.width, range.shift))
+        bits = max(bits, range.width + range.shift)
+    result = '(%s)' % ' | '.join(fields)
+    if is_signed:
+        result = '(uint64_t)iss_get_signed_value(%s, %d)' % (result, bits)
+    return result
+
+
+# Generate the code decoding a register into the instruction, as done by the
+# table-driven decoding. Registers of indirect arguments are only input registers
+# which are never floating-point ones
+def gen_reg_decode(isaFile, field, index_expr, is_out, is_reg_arg):
+    dump(isaFile, '  %s = (int)%s;\n' % (index_expr, field.ranges.gen_extract()))
+    if 'ISS_DECODER_ARG_FLAG_COMPRESSED' in field.flags:
+        dump(isaFile, '  %s += 8;\n' % index_expr)
+    if is_reg_arg and 'ISS_DECODER_ARG_FLAG_FREG' in field.flags:
+        dump(isaFile, '#ifndef ISS_SINGLE_REGFILE\n')
+        dump(isaFile, '  %s += ISS_NB_REGS;\n' % index_expr)
+        dump(isaFile, '#endif\n')
+    dump(isaFile, '  insn->%s[%d] = %s;\n' % ('out_regs' if is_out else 'in_regs', field.id, index_expr))
+    if is_reg_arg and is_out and field.latency != 0:
+        dump(isaFile, '  {\n')
+        dump(isaFile, '    iss_insn_t *next = insn_cache_get(iss, insn->addr + insn->size);\n')
+        dump(isaFile, '    next->input_latency_reg = %s;\n' % index_expr)
+        dump(isaFile, '    next->input_latency = %d;\n' % field.latency)
+        dump(isaFile, '  }\n')
+
+
 class Const(object):
     def __init__(self, val):
         self.val = val
@@ -56,6 +90,9 @@ class Const(object):
     def gen(self, isaFile):
         pass
 
+    def gen_extract(self, is_signed=False):
+        return '%d' % self.val
+
 class Range(object):
     def __init__(self, first, width=1, shift=0):
         self.first = first
@@ -74,6 +111,9 @@ class Range(object):
     def len(self):
         return 1
 
+    def gen_extract(self, is_signed=False):
+        return gen_ranges_extract([self], is_signed)
+
 class Ranges(object):
     def __init__(self, fieldsList):
         self.ranges = []
@@ -91,6 +131,9 @@ class Ranges(object):
     def len(self):
         return len(self.ranges)
 
+    def gen_extract(self, is_signed=False):
+        return gen_ranges_extract(self.ranges, is_signed)
+
 
 class OpcodeField(object):
     def __init__(self, id, ranges, dumpName=True, flags=[]):
@@ -136,6 +179,30 @@ class Indirect(OpcodeField):
         else:
             dump(isaFile, level, '  %s(pc, %s, 0);\n' % (funcName, self.base.genTraceIndirect()))
 
+    def get_regs(self):
+        if self.offset.is_reg():
+            return [self.base, self.offset]
+        return [self.base]
+
+    def gen_decode(self, isaFile, index):
+        flags = ['ISS_DECODER_ARG_FLAG_NONE']
+        if self.postInc:
+            flags.append('ISS_DECODER_ARG_FLAG_POSTINC')
+        if self.preInc:
+            flags.append('ISS_DECODER_ARG_FLAG_PREINC')
+        arg = 'insn->args[%d]' % index
+        if self.offset.is_reg():
+            dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_INDIRECT_REG;\n' % arg)
+            dump(isaFile, '  %s.flags = (iss_decoder_arg_flag_e)(%s);\n' % (arg, ' | '.join(flags)))
+            gen_reg_decode(isaFile, self.base, '%s.u.indirect_reg.base_reg_index' % arg, False, False)
+            gen_reg_decode(isaFile, self.offset, '%s.u.indirect_reg.offset_reg_index' % arg, False, False)
+        else:
+            dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_INDIRECT_IMM;\n' % arg)
+            dump(isaFile, '  %s.flags = (iss_decoder_arg_flag_e)(%s);\n' % (arg, ' | '.join(flags)))
+            gen_reg_decode(isaFile, self.base, '%s.u.indirect_imm.reg_index' % arg, False, False)
+            dump(isaFile, '  %s.u.indirect_imm.imm = (int)%s;\n' % (arg, self.offset.ranges.gen_extract(self.offset.isSigned)))
+            dump(isaFile, '  insn->sim[%d] = %s.u.indirect_imm.imm;\n' % (self.offset.id, arg))
+
     def gen(self, isaFile, indent=0):
         if self.postInc:
             self.flags.append('ISS_DECODER_ARG_FLAG_POSTINC')
@@ -189,6 +256,16 @@ class SignedImm(OpcodeField):
         self.ranges.gen_info(isaFile)
         dump(isaFile, '}, ')
 
+    def get_regs(self):
+        return []
+
+    def gen_decode(self, isaFile, index):
+        arg = 'insn->args[%d]' % index
+        dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_SIMM;\n' % arg)
+        dump(isaFile, '  %s.flags = ISS_DECODER_ARG_FLAG_NONE;\n' % arg)
+        dump(isaFile, '  %s.u.sim.value = %s;\n' % (arg, self.ranges.gen_extract(self.isSigned)))
+        dump(isaFile, '  insn->sim[%d] = %s.u.sim.value;\n' % (self.id, arg))
+
     def gen(self, isaFile, indent=0):
         dump(isaFile, '%s{\n' % (' '*indent))
         dump(isaFile, '%s  .type=ISS_DECODER_ARG_TYPE_SIMM,\n' % (' '*indent))
@@ -220,6 +297,16 @@ class UnsignedImm(OpcodeField):
         self.ranges.gen_info(isaFile)
         dump(isaFile, '}, ')
 
+    def get_regs(self):
+        return []
+
+    def gen_decode(self, isaFile, index):
+        arg = 'insn->args[%d]' % index
+        dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_UIMM;\n' % arg)
+        dump(isaFile, '  %s.flags = ISS_DECODER_ARG_FLAG_NONE;\n' % arg)
+        dump(isaFile, '  %s.u.uim.value = %s;\n' % (arg, self.ranges.gen_extract(self.isSigned)))
+        dump(isaFile, '  insn->uim[%d] = %s.u.uim.value;\n' % (self.id, arg))
+
     def gen(self, isaFile, indent=0):
         dump(isaFile, '%s{\n' % (' '*indent))
         dump(isaFile, '%s  .type=ISS_DECODER_ARG_TYPE_UIMM,\n' % (' '*indent))
@@ -248,6 +335,15 @@ class OutReg(OpcodeField):
         self.ranges.gen_info(isaFile)
         dump(isaFile, '}, ')
 
+    def get_regs(self):
+        return [self]
+
+    def gen_decode(self, isaFile, index):
+        arg = 'insn->args[%d]' % index
+        dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_OUT_REG;\n' % arg)
+        dump(isaFile, '  %s.flags = (iss_decoder_arg_flag_e)(%s);\n' % (arg, ' | '.join(self.flags)))
+        gen_reg_decode(isaFile, self, '%s.u.reg.index' % arg, True, True)
+
     def gen(self, isaFile, indent=0):
         dump(isaFile, '%s{\n' % (' '*indent))
         dump(isaFile, '%s  .type=ISS_DECODER_ARG_TYPE_OUT_REG,\n' % (' '*indent))
@@ -304,6 +400,15 @@ class InReg(OpcodeField):
         self.ranges.gen_info(isaFile)
         dump(isaFile, '}, ')
 
+    def get_regs(self):
+        return [self]
+
+    def gen_decode(self, isaFile, index):
+        arg = 'insn->args[%d]' % index
+        dump(isaFile, '  %s.type = ISS_DECODER_ARG_TYPE_IN_REG;\n' % arg)
+        dump(isaFile, '  %s.flags = (iss_decoder_arg_flag_e)(%s);\n' % (arg, ' | '.join(self.flags)))
+        gen_reg_decode(isaFile, self, '%s.u.reg.index' % arg, False, True)
+
     def gen(self, isaFile, indent=0):
         dump(isaFile, '%s{\n' % (' '*indent))
         dump(isaFile, '%s  .type=ISS_DECODER_ARG_TYPE_IN_REG,\n' % (' '*indent))
@@ -367,6 +472,9 @@ class DecodeLeaf(object):
     def get_name(self):
         return self.instr.get_full_name()
 
+    def get_select(self):
+        return '&%s' % self.get_name()
+
 class DecodeTree(object):
     def __init__(self, isaFile, instrs, mask, opcode):
         self.opcode = opcode
@@ -515,6 +623,30 @@ class DecodeTree(object):
         else:
             return list(self.subtrees.values())[0].get_name()
 
+    def get_select(self):
+        if self.needTree:
+            return '%s_select(opcode)' % self.get_name()
+        else:
+            return list(self.subtrees.values())[0].get_select()
+
+    # Generate the function selecting the instruction of this group, which follows the
+    # same rules as the table-driven decoding, but as nested switches
+    def gen_select(self):
+        others = None
+        self.dump('static iss_decoder_item_t *%s_select(iss_opcode_t opcode)\n' % self.get_name())
+        self.dump('{\n')
+        self.dump('  switch ((opcode >> %d) & 0x%x)\n' % (self.firstBit, (1 << self.opcode_width) - 1))
+        self.dump('  {\n')
+        for opcode, subtree in self.subtrees.items():
+            if opcode == 'OTHERS':
+                others = subtree
+            else:
+                self.dump('    case 0b%s: return %s;\n' % (opcode, subtree.get_select()))
+        self.dump('    default: return %s;\n' % ('NULL' if others is None else others.get_select()))
+        self.dump('  }\n')
+        self.dump('}\n')
+        self.dump('\n')
+
 
     def gen(self, isa, is_top=False):
 
@@ -540,6 +672,9 @@ class DecodeTree(object):
                     self.dump(' &%s,' % subtree.get_name())
              
                 self.dump(' };\n')
+                self.dump('\n')
+
+                self.gen_select()
 
                 self.dump('%siss_decoder_item_t %s = {\n' % ('' if is_top else 'static ', self.get_name()))
                 self.dump('  .is_insn=false,\n')
@@ -551,7 +686,8 @@ class DecodeTree(object):
                 self.dump('      .bit=%d,\n' % self.firstBit)
                 self.dump('      .width=%d,\n' % self.opcode_width)
                 self.dump('      .nb_groups=%d,\n' % len(self.subtrees))
-                self.dump('      .groups=%s_groups\n' % self.get_name())
+                self.dump('      .groups=%s_groups,\n' % self.get_name())
+                self.dump('      .select=%s_select\n' % self.get_name())
                 self.dump('    }\n')
                 self.dump('  }\n')
                 self.dump('};\n')
@@ -1037,10 +1173,37 @@ class Instr(object):
     def genCall(self, isaFile, level):
         self.dump(isaFile, '%s(cpu, pc);\n' % (self.decodeFunc), level)
 
+    # Generate the function decoding the arguments, which does the same as the
+    # table-driven decoding, but with everything known at compile-time
+    def gen_decode_args(self, isaFile):
+        name = self.get_full_name()
+        nb_in_reg = 0
+        nb_out_reg = 0
+
+        self.dump(isaFile, 'static void %s_decode_args(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode)\n' % (name))
+        self.dump(isaFile, '{\n')
+        if len(self.args) > 0:
+            self.dump(isaFile, '  for (int i=0; i<%d && i<ISS_MAX_NB_OUT_REGS; i++) insn->out_regs[i] = -1;\n' % len(self.args))
+            self.dump(isaFile, '  for (int i=0; i<%d && i<ISS_MAX_NB_IN_REGS; i++) insn->in_regs[i] = -1;\n' % len(self.args))
+        for i in range(0, len(self.args)):
+            arg = self.args[i]
+            arg.gen_decode(isaFile, i)
+            for reg in arg.get_regs():
+                if reg.is_out():
+                    nb_out_reg = max(nb_out_reg, reg.id + 1)
+                else:
+                    nb_in_reg = max(nb_in_reg, reg.id + 1)
+        self.dump(isaFile, '  insn->nb_out_reg = %d;\n' % nb_out_reg)
+        self.dump(isaFile, '  insn->nb_in_reg = %d;\n' % nb_in_reg)
+        self.dump(isaFile, '}\n')
+        self.dump(isaFile, '\n')
+
     def gen(self, isa, isaFile, opcode, others=False):
 
         name = self.get_full_name()
 
+        self.gen_decode_args(isaFile)
+
         self.dump(isaFile, 'static iss_decoder_item_t %s = {\n' % (name))
         self.dump(isaFile, '  .is_insn=true,\n')
         self.dump(isaFile, '  .is_active=false,\n')
@@ -1051,6 +1214,7 @@ class Instr(object):
         self.dump(isaFile, '      .handler=%s,\n' % self.execFunc)
         self.dump(isaFile, '      .fast_handler=%s,\n' % self.quick_execFunc)
         self.dump(isaFile, '      .decode=%s,\n' % ('NULL' if self.decode is None else self.decode))
+        self.dump(isaFile, '      .decode_args=%s_decode_args,\n' % (name))
         self.dump(isaFile, '      .label=(char *)"%s",\n' % (self.getLabel()))
         self.dump(isaFile, '      .size=%d,\n' % (self.len/8))
         self.dump(isaFile, '      .nb_args=%d,\n' % (len(self.args)))
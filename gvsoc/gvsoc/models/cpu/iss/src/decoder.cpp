@@ -24,7 +24,7 @@
 
 extern iss_isa_tag_t __iss_isa_tags[];
 
-static int decode_item(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item);
+static iss_decoder_item_t *select_item(iss_opcode_t opcode, iss_decoder_item_t *item);
 
 static uint64_t decode_ranges(iss_t *iss, iss_opcode_t opcode, iss_decoder_range_set_t *range_set, bool is_signed)
 {
@@ -62,37 +62,10 @@ static int decode_info(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
   return 0;
 }
 
-static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+static void decode_args(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
 {
-  if (!item->is_active) return -1;
-
-  insn->latency = 0;
-  insn->fast_handler = item->u.insn.fast_handler;
-  insn->handler = item->u.insn.handler;
-  insn->resource_id = item->u.insn.resource_id;
-  insn->resource_latency = item->u.insn.resource_latency;
-  insn->resource_bandwidth = item->u.insn.resource_bandwidth;
-
-  if (insn->hwloop_handler != NULL)
-  {
-      iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*) = insn->hwloop_handler;
-      insn->hwloop_handler = insn->handler;
-      insn->handler = hwloop_handler;
-      insn->fast_handler = hwloop_handler;
-  }
-
-  if (item->u.insn.resource_id != -1)
-  {
-    insn->resource_handler = insn->handler;
-    insn->fast_handler = iss_resource_offload;
-    insn->handler = iss_resource_offload;
-  }
-
-  insn->decoder_item = item;
-  insn->size = item->u.insn.size;
   insn->nb_out_reg = 0;
   insn->nb_in_reg = 0;
-  insn->latency = item->u.insn.latency;
 
   for (int i=0; i<item->u.insn.nb_args; i++)
   {
@@ -181,6 +154,103 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
         break;
     }
   }
+}
+
+// Get the arguments from the decode cache shared with other cores, only the effect
+// on the next instruction, which belongs to this core, is applied again
+static void decode_args_from_cache(iss_t *iss, iss_insn_t *insn, iss_decode_cache_entry_t *entry)
+{
+  iss_decoder_item_t *item = entry->item;
+
+  insn->nb_out_reg = entry->nb_out_reg;
+  insn->nb_in_reg = entry->nb_in_reg;
+  memcpy(insn->out_regs, entry->out_regs, sizeof(entry->out_regs));
+  memcpy(insn->in_regs, entry->in_regs, sizeof(entry->in_regs));
+  memcpy(insn->uim, entry->uim, sizeof(entry->uim));
+  memcpy(insn->sim, entry->sim, sizeof(entry->sim));
+  memcpy(insn->args, entry->args, sizeof(entry->args));
+
+  for (int i=0; i<item->u.insn.nb_args; i++)
+  {
+    iss_decoder_arg_t *darg = &item->u.insn.args[i];
+    if (darg->type == ISS_DECODER_ARG_TYPE_OUT_REG && darg->u.reg.latency != 0)
+    {
+      iss_insn_t *next = insn_cache_get(iss, insn->addr + insn->size);
+
+      next->input_latency_reg = insn->args[i].u.reg.index;
+      next->input_latency = darg->u.reg.latency;
+    }
+  }
+}
+
+static void decode_cache_store(iss_decode_cache_entry_t *entry, iss_insn_t *insn, iss_opcode_t opcode)
+{
+  entry->opcode = opcode;
+  entry->item = insn->decoder_item;
+  entry->nb_out_reg = insn->nb_out_reg;
+  entry->nb_in_reg = insn->nb_in_reg;
+  memcpy(entry->out_regs, insn->out_regs, sizeof(entry->out_regs));
+  memcpy(entry->in_regs, insn->in_regs, sizeof(entry->in_regs));
+  memcpy(entry->uim, insn->uim, sizeof(entry->uim));
+  memcpy(entry->sim, insn->sim, sizeof(entry->sim));
+  memcpy(entry->args, insn->args, sizeof(entry->args));
+}
+
+static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item,
+  iss_decode_cache_entry_t *entry)
+{
+  if (!item->is_active) return -1;
+
+  insn->latency = 0;
+  insn->fast_handler = item->u.insn.fast_handler;
+  insn->handler = item->u.insn.handler;
+  insn->resource_id = item->u.insn.resource_id;
+  insn->resource_latency = item->u.insn.resource_latency;
+  insn->resource_bandwidth = item->u.insn.resource_bandwidth;
+
+  if (insn->hwloop_handler != NULL)
+  {
+      iss_insn_t *(*hwloop_handler)(iss_t *, iss_insn_t*) = insn->hwloop_handler;
+      insn->hwloop_handler = insn->handler;
+      insn->handler = hwloop_handler;
+      insn->fast_handler = hwloop_handler;
+  }
+
+  if (item->u.insn.resource_id != -1)
+  {
+    insn->resource_handler = insn->handler;
+    insn->fast_handler = iss_resource_offload;
+    insn->handler = iss_resource_offload;
+  }
+
+  insn->decoder_item = item;
+  insn->size = item->u.insn.size;
+  insn->latency = item->u.insn.latency;
+
+  // Generated decoders extract the arguments with constant fields, the tables
+  // are only interpreted for the others
+  if (entry != NULL && entry->item == item && entry->opcode == opcode)
+  {
+    decode_args_from_cache(iss, insn, entry);
+  }
+  else
+  {
+    if (item->u.insn.decode_args != NULL)
+    {
+      item->u.insn.decode_args(iss, insn, opcode);
+    }
+    else
+    {
+      decode_args(iss, insn, opcode, item);
+    }
+
+    // The arguments are saved before the instruction decode callback, which may
+    // modify them depending on the address
+    if (entry != NULL)
+    {
+      decode_cache_store(entry, insn, opcode);
+    }
+  }
 
   if (insn->input_latency_reg != -1)
   {
@@ -227,7 +297,7 @@ static int decode_insn(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_de
   return 0;
 }
 
-static int decode_opcode_group(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+static iss_decoder_item_t *select_opcode_group(iss_opcode_t opcode, iss_decoder_item_t *item)
 {
   iss_opcode_t group_opcode = (opcode >> item->u.group.bit) & ((1ULL << item->u.group.width) - 1);
   iss_decoder_item_t *group_item_other = NULL;
@@ -235,13 +305,13 @@ static int decode_opcode_group(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode
   for (int i=0; i<item->u.group.nb_groups; i++)
   {
     iss_decoder_item_t *group_item = item->u.group.groups[i];
-    if (group_opcode == group_item->opcode && !group_item->opcode_others) return decode_item(iss, insn, opcode, group_item);
+    if (group_opcode == group_item->opcode && !group_item->opcode_others) return select_item(opcode, group_item);
     if (group_item->opcode_others) group_item_other = group_item;
   }
 
-  if (group_item_other) return decode_item(iss, insn, opcode, group_item_other);
+  if (group_item_other) return select_item(opcode, group_item_other);
 
-  return -1;
+  return NULL;
 }
 
 
@@ -261,18 +331,36 @@ iss_decoder_item_t *iss_isa_get(iss_t *iss, const char *name)
 }
 
 
-static int decode_item(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+// Return the instruction matching the opcode, or NULL if there is none
+static iss_decoder_item_t *select_item(iss_opcode_t opcode, iss_decoder_item_t *item)
 {
-  if (item->is_insn) return decode_insn(iss, insn, opcode, item);
-  else return decode_opcode_group(iss, insn, opcode, item);
+  if (item->is_insn) return item;
+
+  // Generated decoders directly select the instruction through nested switches
+  if (item->u.group.select != NULL) return item->u.group.select(opcode);
+
+  return select_opcode_group(opcode, item);
 }
 
 static int decode_opcode(iss_t *iss, iss_insn_t *insn, iss_opcode_t opcode)
 {
+  iss_decode_cache_entry_t *entry = NULL;
+
+  if (iss->cpu.decode_cache)
+  {
+    // Another core may have already decoded the same opcode at this address
+    entry = iss_decode_cache_get(iss->cpu.decode_cache, insn->addr);
+    if (entry->item && entry->opcode == opcode)
+    {
+      return decode_insn(iss, insn, opcode, entry->item, entry);
+    }
+  }
+
   for (int i=0; i<__iss_isa_set.nb_isa; i++)
   {
     iss_isa_t *isa = &__iss_isa_set.isa_set[i];
-    if (decode_item(iss, insn, opcode, isa->tree) == 0) return 0;
+    iss_decoder_item_t *item = select_item(opcode, isa->tree);
+    if (item && decode_insn(iss, insn, opcode, item, entry) == 0) return 0;
   }
 
   iss_decoder_msg(iss, "Unknown instruction\n");
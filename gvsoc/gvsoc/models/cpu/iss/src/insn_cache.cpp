@@ -21,6 +21,7 @@
 
 #include "iss.hpp"
 #include <string.h>
+#include <map>
 
 
 static void insn_block_init(iss_insn_block_t *b, iss_addr_t pc);
@@ -197,3 +198,48 @@ iss_insn_t *insn_cache_get(iss_t *iss, iss_addr_t pc)
 
   return &b->insns[insn_id];
 }
+
+
+
+// Decode caches are created while the cores are built, and are then only used by
+// cores of the same cluster, which are executed by the same thread
+static std::map<std::string, iss_decode_cache_t *> shared_decode_caches;
+
+iss_decode_cache_t *iss_decode_cache_get_shared(std::string name)
+{
+  iss_decode_cache_t *cache = shared_decode_caches[name];
+  if (cache == NULL)
+  {
+    cache = (iss_decode_cache_t *)calloc(1, sizeof(iss_decode_cache_t));
+    shared_decode_caches[name] = cache;
+  }
+  return cache;
+}
+
+
+
+iss_decode_cache_entry_t *iss_decode_cache_get(iss_decode_cache_t *cache, iss_addr_t pc)
+{
+  iss_addr_t pc_base = pc & ~((1 << (ISS_INSN_BLOCK_SIZE_LOG2 + ISS_INSN_PC_BITS)) - 1);
+  unsigned insn_id = (pc >> ISS_INSN_PC_BITS) & (ISS_INSN_BLOCK_SIZE - 1);
+  unsigned int block_id = pc_base & (ISS_INSN_NB_BLOCKS - 1);
+  iss_decode_cache_block_t *block = cache->blocks[block_id];
+
+  while (block)
+  {
+    if (block->pc == pc_base)
+    {
+      return &block->entries[insn_id];
+    }
+    block = block->next;
+  }
+
+  // Entries are never invalidated, as they are checked against the fetched opcode,
+  // so they stay valid when the code is modified and the cores flush their cache
+  block = (iss_decode_cache_block_t *)calloc(1, sizeof(iss_decode_cache_block_t));
+  block->pc = pc_base;
+  block->next = cache->blocks[block_id];
+  cache->blocks[block_id] = block;
+
+  return &block->entries[insn_id];
+}
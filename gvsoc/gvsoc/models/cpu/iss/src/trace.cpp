@@ -426,9 +426,9 @@ void iss_trace_dump(iss_t *iss, iss_insn_t *insn)
 
   iss_trace_save_args(iss, insn, iss->cpu.state.saved_args, true);
   
-  iss_trace_dump_insn(iss, insn, buffer, 1024, iss->cpu.state.saved_args, iss_trace_format(iss) == TRACE_FORMAT_LONG, 3, 0);
+  iss_trace_dump_insn(iss, insn, buffer, 1024, iss->cpu.state.saved_args, iss_trace_format(iss) != TRACE_FORMAT_SHORT, 3, 0);
 
-  iss_insn_msg(iss, buffer);
+  iss_insn_msg(iss, "%s", buffer);
 }
 
 void iss_event_dump(iss_t *iss, iss_insn_t *insn)
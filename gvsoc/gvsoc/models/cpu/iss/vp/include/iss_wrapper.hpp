@@ -41,6 +41,29 @@ typedef struct
 } iss_wrapper_pcer_info_t;
 
 
+// Number of entries of the direct memory interface TLB, and size of the pages it maps
+#define ISS_DMI_TLB_BITS 4
+#define ISS_DMI_TLB_SIZE (1 << ISS_DMI_TLB_BITS)
+#define ISS_DMI_PAGE_BITS 12
+#define ISS_DMI_PAGE_SIZE (1 << ISS_DMI_PAGE_BITS)
+
+typedef struct
+{
+    // Page number of the entry, or -1 if the entry is empty
+    iss_addr_t tag;
+    // Grant covering the whole page, only NULL when the entry is empty
+    vp::io_dmi *dmi;
+} iss_dmi_tlb_entry_t;
+
+
+// Maximum size in bytes of the loops which can be detected as spin loops, and number of
+// identical iterations after which the next ones are skipped
+#define ISS_SPIN_LOOP_MAX_SIZE 32
+#define ISS_SPIN_LOOP_MIN_ITER 2
+// Maximum number of loads done by each iteration of a spin loop
+#define ISS_SPIN_LOOP_MAX_LOADS 4
+
+
 class iss_wrapper : public vp::component, vp::Gdbserver_core
 {
 
@@ -52,6 +75,8 @@ public:
   void start();
   void pre_reset();
   void reset(bool active);
+  void checkpoint_save(vp::checkpoint *checkpoint);
+  void checkpoint_restore(vp::checkpoint *checkpoint);
 
   virtual void target_open();
 
@@ -62,6 +87,7 @@ public:
   static void fetch_response(void *_this, vp::io_req *req);
 
   static void exec_instr(void *__this, vp::clock_event *event);
+  static void exec_instr_superblock(void *__this, vp::clock_event *event);
   static void exec_first_instr(void *__this, vp::clock_event *event);
   void exec_first_instr(vp::clock_event *event);
   static void exec_instr_check_all(void *__this, vp::clock_event *event);
@@ -74,6 +100,12 @@ public:
   inline int data_req(iss_addr_t addr, uint8_t *data, int size, bool is_write);
   inline int data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write);
   int data_misaligned_req(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write);
+  void dmi_refill(iss_dmi_tlb_entry_t *entry, iss_addr_t addr);
+  void dmi_flush();
+  static void dmi_invalidate(void *__this);
+  inline void spin_loop_check(vp::clock_event *event);
+  void spin_loop_iteration();
+  inline void spin_loop_load(uint8_t *host_ptr, iss_addr_t addr, uint8_t *data, int size);
 
   bool user_access(iss_addr_t addr, uint8_t *data, iss_addr_t size, bool is_write);
   std::string read_user_string(iss_addr_t addr, int len=-1);
@@ -91,7 +123,9 @@ public:
 
   void dump_debug_traces();
 
-  inline void trigger_check_all() { current_event = check_all_event; }
+  // Also called for CSR writes and returns from handlers, which are not something a
+  // spinning loop can do
+  inline void trigger_check_all() { current_event = check_all_event; spin_loop_pure = false; }
 
   void insn_trace_callback();
 
@@ -184,6 +218,34 @@ private:
   vp::clock_event *misaligned_event;
   vp::clock_event *irq_sync_event;
 
+  int superblock_size;
+
+  // Direct memory interface, used to access memories without IO requests when
+  // they grant it
+  bool dmi_enabled;
+  iss_dmi_tlb_entry_t dmi_tlb[ISS_DMI_TLB_SIZE];
+  std::vector<vp::io_dmi *> dmi_grants;
+  vp::io_req dmi_query_req;
+
+  // Spin loop detection, used to skip the iterations of loops which are only waiting
+  // for something to happen in the platform
+  bool spin_loop_enabled;
+  // Cleared by anything done by the current iteration which is not a memory load
+  bool spin_loop_pure;
+  iss_addr_t spin_loop_head;
+  int64_t spin_loop_cycles;
+  int64_t spin_loop_period;
+  int spin_loop_count;
+  iss_regfile_t spin_loop_regfile;
+  iss_reg_t spin_loop_hwloop_regs[PULPV2_HWLOOP_NB_REGS];
+  iss_addr_t spin_loop_prefetcher_addr;
+  iss_reg_t spin_loop_pccr[32];
+  int spin_loop_nb_loads;
+  uint8_t *spin_loop_load_ptr[ISS_SPIN_LOOP_MAX_LOADS];
+  iss_addr_t spin_loop_load_addr[ISS_SPIN_LOOP_MAX_LOADS];
+  uint64_t spin_loop_load_value[ISS_SPIN_LOOP_MAX_LOADS];
+  int spin_loop_load_size[ISS_SPIN_LOOP_MAX_LOADS];
+
   int irq_req;
   int irq_req_value;
 
@@ -260,6 +322,39 @@ void iss_wrapper::exec_misaligned(void *__this, vp::clock_event *event)
 inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write)
 {
   decode_trace.msg("Data request (addr: 0x%lx, size: 0x%x, is_write: %d)\n", addr, size, is_write);
+
+  if (this->dmi_enabled)
+  {
+    iss_dmi_tlb_entry_t *entry = &this->dmi_tlb[(addr >> ISS_DMI_PAGE_BITS) & (ISS_DMI_TLB_SIZE - 1)];
+
+    if (unlikely(entry->tag != (addr >> ISS_DMI_PAGE_BITS)))
+      this->dmi_refill(entry, addr);
+
+    if (entry->dmi)
+    {
+      uint8_t *host_ptr = entry->dmi->get_host_ptr(addr, size);
+      if (likely(host_ptr != NULL))
+      {
+        if (is_write)
+        {
+          memcpy(host_ptr, data_ptr, size);
+          this->spin_loop_pure = false;
+        }
+        else
+        {
+          memcpy(data_ptr, host_ptr, size);
+          if (this->spin_loop_enabled)
+            this->spin_loop_load(host_ptr, addr, data_ptr, size);
+        }
+
+        // The latency is also read from the request by the misaligned accesses
+        this->io_req.set_latency(entry->dmi->latency);
+        this->cpu.state.insn_cycles += entry->dmi->latency;
+        return vp::IO_REQ_OK;
+      }
+    }
+  }
+
   vp::io_req *req = &io_req;
   req->init();
   req->set_addr(addr);
@@ -267,6 +362,15 @@ inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int
   req->set_is_write(is_write);
   req->set_data(data_ptr);
   int err = data.req(req);
+
+  // Normal requests may have side effects, the loop doing them is not just spinning,
+  // except for reads of plain memories, like the TCDM banks which never give direct
+  // accesses
+  if (this->spin_loop_enabled && err == vp::IO_REQ_OK && !is_write && req->is_memory())
+    this->spin_loop_load(NULL, addr, data_ptr, size);
+  else
+    this->spin_loop_pure = false;
+
   if (err == vp::IO_REQ_OK) 
   {
     this->cpu.state.insn_cycles += req->get_latency();
@@ -278,6 +382,42 @@ inline int iss_wrapper::data_req_aligned(iss_addr_t addr, uint8_t *data_ptr, int
   return err;
 }
 
+inline void iss_wrapper::spin_loop_load(uint8_t *host_ptr, iss_addr_t addr, uint8_t *data, int size)
+{
+  // Remember the loaded values, so that they can be checked again before skipping
+  // iterations, through the host pointer for direct accesses, or otherwise through a
+  // debug request
+  int index = this->spin_loop_nb_loads;
+  if (index == ISS_SPIN_LOOP_MAX_LOADS || size > (int)sizeof(uint64_t))
+  {
+    this->spin_loop_pure = false;
+  }
+  else
+  {
+    this->spin_loop_load_ptr[index] = host_ptr;
+    this->spin_loop_load_addr[index] = addr;
+    this->spin_loop_load_size[index] = size;
+    memcpy(&this->spin_loop_load_value[index], data, size);
+    this->spin_loop_nb_loads++;
+  }
+}
+
+inline void iss_wrapper::spin_loop_check(vp::clock_event *event)
+{
+  if (this->spin_loop_enabled)
+  {
+    // Only short backward jumps are considered, and only when the core keeps executing
+    // instructions from the same handler
+    iss_addr_t head = this->cpu.current_insn->addr;
+    iss_addr_t tail = this->cpu.prev_insn->addr;
+    if (head <= tail && tail - head < ISS_SPIN_LOOP_MAX_SIZE && !this->stalled.get() &&
+      this->is_active_reg.get() && this->current_event == event)
+    {
+      this->spin_loop_iteration();
+    }
+  }
+}
+
 #define ADDR_MASK (~(ISS_REG_WIDTH/8 - 1))
 
 inline int iss_wrapper::data_req(iss_addr_t addr, uint8_t *data_ptr, int size, bool is_write)
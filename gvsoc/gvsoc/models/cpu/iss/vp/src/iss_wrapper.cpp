@@ -21,6 +21,7 @@
 
 #include <vp/vp.hpp>
 #include <vp/itf/io.hpp>
+#include <vp/checkpoint.hpp>
 #include "iss.hpp"
 #include <algorithm>
 #include <sys/types.h>
@@ -86,7 +87,7 @@ static inline void trdb_record_instruction(iss_wrapper *_this, iss_insn_t *insn)
 #endif
 
 
-#define EXEC_INSTR_COMMON(_this, event, func) \
+#define EXEC_INSTR_STEP(_this, func, cycles) \
 do { \
   \
   _this->trace.msg("Executing instruction\n"); \
@@ -108,12 +109,16 @@ do { \
   } \
  \
   iss_insn_t *insn = _this->cpu.current_insn; \
-  int cycles = func(_this); \
+  cycles = func(_this); \
   if (_this->power.get_power_trace()->get_active()) \
   { \
   _this->insn_groups_power[insn->decoder_item->u.insn.power_group].account_energy_quantum(); \
  } \
   trdb_record_instruction(_this, insn); \
+} while(0)
+
+#define EXEC_INSTR_ENQUEUE(_this, cycles) \
+do { \
   if (!_this->stalled.get()) \
   { \
     _this->enqueue_next_instr(cycles); \
@@ -131,6 +136,13 @@ do { \
   } \
 } while(0)
 
+#define EXEC_INSTR_COMMON(_this, event, func) \
+do { \
+  int cycles; \
+  EXEC_INSTR_STEP(_this, func, cycles); \
+  EXEC_INSTR_ENQUEUE(_this, cycles); \
+} while(0)
+
 void iss_wrapper::dump_debug_traces()
 {
   const char *func, *inline_func, *file;
@@ -148,8 +160,37 @@ void iss_wrapper::dump_debug_traces()
 void iss_wrapper::exec_instr(void *__this, vp::clock_event *event)
 {
   iss_t *_this = (iss_t *)__this;
+  int cycles;
+
+  EXEC_INSTR_STEP(_this, iss_exec_step_nofetch, cycles);
+  _this->spin_loop_check(event);
+  EXEC_INSTR_ENQUEUE(_this, cycles);
+}
+
+void iss_wrapper::exec_instr_superblock(void *__this, vp::clock_event *event)
+{
+  iss_t *_this = (iss_t *)__this;
+  int cycles;
+
+  // Execute several instructions in a row as long as nothing else in the platform
+  // is scheduled before the next one. Instead of reenqueueing the event after each
+  // instruction, the clock engine is moved forward by the instruction cycles, so that
+  // everything the instruction interacts with sees the same time as in step mode.
+  for (int nb_insn = 1; ; nb_insn++)
+  {
+    EXEC_INSTR_STEP(_this, iss_exec_step_nofetch, cycles);
+    _this->spin_loop_check(event);
+
+    // Stop as soon as the core leaves the fast path, which is the case for stalls,
+    // interrupts, debug requests or when the core is put to sleep
+    if (nb_insn == _this->superblock_size || _this->stalled.get() || !_this->is_active_reg.get() ||
+      _this->current_event != event || !_this->get_clock()->fast_forward(cycles))
+    {
+      break;
+    }
+  }
 
-  EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch);
+  EXEC_INSTR_ENQUEUE(_this, cycles);
 }
 
 void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
@@ -164,8 +205,12 @@ void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
   }
 
   int debug_mode = _this->cpu.state.debug_mode;
+  int cycles;
+
+  EXEC_INSTR_STEP(_this, iss_exec_step_nofetch_perf, cycles);
+  _this->spin_loop_check(event);
+  EXEC_INSTR_ENQUEUE(_this, cycles);
 
-  EXEC_INSTR_COMMON(_this, event, iss_exec_step_nofetch_perf);
   if (_this->step_mode.get() && !debug_mode)
   {
     _this->do_step.set(false);
@@ -186,7 +231,10 @@ void iss_wrapper::exec_instr_check_all(void *__this, vp::clock_event *event)
 
 void iss_wrapper::exec_first_instr(vp::clock_event *event)
 {
-  current_event = event_new(iss_wrapper::exec_instr);
+  // Continue with the instruction event created at build time, which is also the one
+  // used when switching back from the slow handler, so that the core only has build
+  // time events, which are the ones a checkpoint can save
+  current_event = this->instr_event;
   iss_start(this);
   exec_instr((void *)this, event);
 }
@@ -550,6 +598,161 @@ int iss_wrapper::data_misaligned_req(iss_addr_t addr, uint8_t *data_ptr, int siz
   }
 }
 
+void iss_wrapper::dmi_refill(iss_dmi_tlb_entry_t *entry, iss_addr_t addr)
+{
+  iss_addr_t page = addr >> ISS_DMI_PAGE_BITS;
+  iss_addr_t page_base = page << ISS_DMI_PAGE_BITS;
+
+  // Refusals are not kept, as the slave may grant the page later on without
+  // notifying it, so the entry stays empty until a grant is received
+  entry->tag = -1;
+  entry->dmi = NULL;
+
+  // Grants usually cover many pages, so first check the ones we already got
+  for (vp::io_dmi *dmi: this->dmi_grants)
+  {
+    if (dmi->contains(page_base, ISS_DMI_PAGE_SIZE))
+    {
+      entry->tag = page;
+      entry->dmi = dmi;
+      return;
+    }
+  }
+
+  vp::io_dmi *dmi = new vp::io_dmi();
+  vp::io_req *req = &this->dmi_query_req;
+  req->init();
+  req->set_addr(addr);
+  req->set_size(1);
+  req->set_is_write(false);
+  req->set_data(NULL);
+
+  // Pages only partially covered are kept on the normal path so that a TLB hit
+  // never needs to check the range
+  if (this->data.dmi_req(req, dmi) && dmi->contains(page_base, ISS_DMI_PAGE_SIZE))
+  {
+    this->trace.msg("Got direct memory access (base: 0x%lx, size: 0x%lx, latency: %ld)\n",
+      dmi->base, dmi->size, dmi->latency);
+    this->dmi_grants.push_back(dmi);
+    entry->tag = page;
+    entry->dmi = dmi;
+  }
+  else
+  {
+    delete dmi;
+  }
+}
+
+void iss_wrapper::dmi_flush()
+{
+  for (int i=0; i<ISS_DMI_TLB_SIZE; i++)
+  {
+    this->dmi_tlb[i].tag = -1;
+    this->dmi_tlb[i].dmi = NULL;
+  }
+
+  for (vp::io_dmi *dmi: this->dmi_grants)
+  {
+    delete dmi;
+  }
+  this->dmi_grants.clear();
+}
+
+void iss_wrapper::dmi_invalidate(void *__this)
+{
+  iss_t *_this = (iss_t *)__this;
+  _this->trace.msg("Invalidating direct memory accesses\n");
+  _this->dmi_flush();
+}
+
+void iss_wrapper::spin_loop_iteration()
+{
+  iss_addr_t head = this->cpu.current_insn->addr;
+  int64_t cycles = this->get_cycles();
+  int64_t period = cycles - this->spin_loop_cycles;
+
+  // The core is spinning if the last iteration took as many cycles as the previous one,
+  // only did memory loads and left the core in the same state. If the loaded
+  // values are still the same, the next iterations will do exactly the same as long as
+  // nothing else happens in the platform, so they can be skipped by moving the clock
+  // forward, which stops before the next event of any other component, like a write to
+  // the polled location, an interrupt or a timer.
+  bool spinning = this->spin_loop_pure && head == this->spin_loop_head &&
+    period == this->spin_loop_period && !this->step_mode.get() &&
+    this->spin_loop_prefetcher_addr == this->cpu.prefetcher.addr &&
+    memcmp(&this->spin_loop_regfile, &this->cpu.regfile, sizeof(iss_regfile_t)) == 0 &&
+    memcmp(this->spin_loop_hwloop_regs, this->cpu.pulpv2.hwloop_regs, sizeof(this->spin_loop_hwloop_regs)) == 0;
+
+  // The memory may have been modified by another component after the loads
+  for (int i=0; spinning && i<this->spin_loop_nb_loads; i++)
+  {
+    uint8_t *ptr = this->spin_loop_load_ptr[i];
+    uint64_t value;
+    if (ptr == NULL)
+    {
+      ptr = (uint8_t *)&value;
+      spinning = this->data.debug_req(this->spin_loop_load_addr[i], ptr,
+        this->spin_loop_load_size[i], false) == vp::IO_REQ_OK;
+    }
+
+    spinning = spinning && memcmp(ptr, &this->spin_loop_load_value[i],
+      this->spin_loop_load_size[i]) == 0;
+  }
+
+  if (spinning)
+  {
+    if (++this->spin_loop_count >= ISS_SPIN_LOOP_MIN_ITER)
+    {
+      // Find the number of iterations by doubling it until the clock refuses to move
+      // forward, and then by halving it
+      int64_t nb_iter = 0;
+      int64_t step = 1;
+      bool grow = true;
+      while (step > 0)
+      {
+        if (this->get_clock()->fast_forward(step * period))
+        {
+          nb_iter += step;
+          step = grow ? step * 2 : step / 2;
+        }
+        else
+        {
+          grow = false;
+          step /= 2;
+        }
+      }
+
+      if (nb_iter)
+      {
+        this->trace.msg("Skipped spin loop iterations (head: 0x%lx, period: %ld, iterations: %ld)\n",
+          head, period, nb_iter);
+        cycles = this->get_cycles();
+
+        // Each skipped iteration would have incremented the performance counters as
+        // much as the last one
+        for (int i=0; i<32; i++)
+        {
+          this->cpu.csr.pccr[i] += nb_iter * (this->cpu.csr.pccr[i] - this->spin_loop_pccr[i]);
+        }
+      }
+    }
+  }
+  else
+  {
+    this->spin_loop_head = head;
+    this->spin_loop_count = 0;
+    this->spin_loop_prefetcher_addr = this->cpu.prefetcher.addr;
+    memcpy(&this->spin_loop_regfile, &this->cpu.regfile, sizeof(iss_regfile_t));
+    memcpy(this->spin_loop_hwloop_regs, this->cpu.pulpv2.hwloop_regs, sizeof(this->spin_loop_hwloop_regs));
+  }
+
+  memcpy(this->spin_loop_pccr, this->cpu.csr.pccr, sizeof(this->spin_loop_pccr));
+  this->spin_loop_nb_loads = 0;
+  this->spin_loop_cycles = cycles;
+  this->spin_loop_period = period;
+  this->spin_loop_pure = true;
+}
+
 void iss_wrapper::irq_check()
 {
   current_event = check_all_event;
@@ -596,65 +799,63 @@ void iss_wrapper::debug_req()
 
 bool iss_wrapper::user_access(iss_addr_t addr, uint8_t *buffer, iss_addr_t size, bool is_write)
 {
-  vp::io_req *req = &io_req;
-  std::string str = "";
-  while(size != 0)
+  int err = data.debug_req(addr, buffer, size, is_write);
+  if (err != vp::IO_REQ_OK) 
   {
-    req->init();
-    req->set_debug(true);
-    req->set_addr(addr);
-    req->set_size(1);
-    req->set_is_write(is_write);
-    req->set_data(buffer);
-    int err = data.req(req);
-    if (err != vp::IO_REQ_OK) 
-    {
-      if (err == vp::IO_REQ_INVALID)
-        this->warning.fatal("Invalid IO response during debug request\n");
-      else
-        this->warning.fatal("Pending IO response during debug request\n");
-
-      return true;
-    }
+    if (err == vp::IO_REQ_INVALID)
+      this->warning.fatal("Invalid IO response during debug request\n");
+    else
+      this->warning.fatal("Pending IO response during debug request\n");
 
-    addr++;
-    size--;
-    buffer++;
+    return true;
   }
-    
+
   return false;
 }
 
 std::string iss_wrapper::read_user_string(iss_addr_t addr, int size)
 {
-  vp::io_req *req = &io_req;
   std::string str = "";
+  // Strings are read by blocks which do not cross an aligned boundary, so that a
+  // string located at the end of a memory is still read correctly
+  const int block_size = 64;
+  uint8_t buffer[block_size];
+
   while(size != 0)
   {
-    uint8_t buffer;
-    req->init();
-    req->set_debug(true);
-    req->set_addr(addr);
-    req->set_size(1);
-    req->set_is_write(false);
-    req->set_data(&buffer);
-    int err = data.req(req);
+    int iter_size = block_size - (addr & (block_size - 1));
+    if (size > 0 && iter_size > size)
+      iter_size = size;
+
+    int err = data.debug_req(addr, buffer, iter_size, false);
+    if (err == vp::IO_REQ_INVALID && iter_size > 1)
+    {
+      // The string may end before the invalid part, read it byte per byte
+      iter_size = 1;
+      err = data.debug_req(addr, buffer, iter_size, false);
+    }
+
     if (err != vp::IO_REQ_OK) 
     {
-      if (err == vp::IO_REQ_INVALID)
-        return "";
-      else
+      if (err != vp::IO_REQ_INVALID)
         this->warning.fatal("Pending IO response during debug request\n");
+
+      // The buffer was not filled
+      return "";
     }
 
-    if (buffer == 0)
-      return str;
+    for (int i=0; i<iter_size; i++)
+    {
+      if (buffer[i] == 0)
+        return str;
+
+      str += buffer[i];
+    }
 
-    str += buffer;
-    addr++;
+    addr += iter_size;
 
     if (size > 0)
-      size--;
+      size -= iter_size;
   }
 
   return str;
@@ -677,6 +878,9 @@ static const int open_modeflags[12] = {
 
 void iss_wrapper::handle_riscv_ebreak()
 {
+  // Semihosting calls have side effects on the host
+  this->spin_loop_pure = false;
+
   int id = this->cpu.regfile.regs[10];
 
   switch (id)
@@ -1136,6 +1340,8 @@ void iss_wrapper::handle_riscv_ebreak()
 
 void iss_wrapper::handle_ebreak()
 {
+  this->spin_loop_pure = false;
+
   int id = this->cpu.regfile.regs[10];
 
   switch (id)
@@ -1388,6 +1594,7 @@ int iss_wrapper::build()
 
   data.set_resp_meth(&iss_wrapper::data_response);
   data.set_grant_meth(&iss_wrapper::data_grant);
+  data.set_dmi_invalidate_meth(&iss_wrapper::dmi_invalidate);
   new_master_port("data", &data);
 
   fetch.set_resp_meth(&iss_wrapper::fetch_response);
@@ -1430,8 +1637,30 @@ int iss_wrapper::build()
     this->pcer_info[i].name  = "";
   }
 
+  // Maximum number of instructions executed in a row by the fast path when nothing
+  // else is scheduled, 0 or 1 to execute one instruction per event
+  js::config *superblock_config = this->get_vp_config()->get("iss_superblock_size");
+  this->superblock_size = superblock_config ? superblock_config->get_int() : 0;
+
+  js::config *dmi_config = this->get_vp_config()->get("iss_dmi");
+  this->dmi_enabled = dmi_config && dmi_config->get_bool();
+  this->dmi_flush();
+
+  js::config *spin_loop_config = this->get_vp_config()->get("iss_spin_loop");
+  this->spin_loop_enabled = spin_loop_config && spin_loop_config->get_bool();
+
+  // Cores of the same cluster usually execute the same code, they can then share
+  // the decoding of their instructions
+  js::config *decode_cache_config = this->get_vp_config()->get("iss_shared_decode_cache");
+  this->cpu.decode_cache = NULL;
+  if (decode_cache_config && decode_cache_config->get_bool())
+  {
+    this->cpu.decode_cache = iss_decode_cache_get_shared(get_config_str("isa") + ":" +
+      std::to_string(get_config_int("cluster_id")));
+  }
+
   current_event = event_new(iss_wrapper::exec_first_instr);
-  instr_event = event_new(iss_wrapper::exec_instr);
+  instr_event = event_new(this->superblock_size > 1 ? iss_wrapper::exec_instr_superblock : iss_wrapper::exec_instr);
   check_all_event = event_new(iss_wrapper::exec_instr_check_all);
   misaligned_event = event_new(iss_wrapper::exec_misaligned);
   irq_sync_event = event_new(iss_wrapper::irq_req_sync_handler);
@@ -1514,6 +1743,15 @@ void iss_wrapper::reset(bool active)
     this->irq_req = -1;
     this->wakeup_latency = 0;
 
+    this->dmi_flush();
+
+    this->spin_loop_pure = false;
+    this->spin_loop_head = -1;
+    this->spin_loop_cycles = 0;
+    this->spin_loop_period = 0;
+    this->spin_loop_count = 0;
+    this->spin_loop_nb_loads = 0;
+
     for (int i=0; i<32; i++)
     {
       this->pcer_trace_event[i].event(NULL);
@@ -1561,6 +1799,168 @@ void iss_wrapper::reset(bool active)
 }
 
 
+// Instructions are only pointers to the instruction cache, they are saved with their
+// address and taken again from the cache when restored
+#define ISS_CHECKPOINT_NO_INSN ((iss_addr_t)-1)
+
+typedef struct
+{
+  iss_regfile_t regfile;
+  iss_csr_t csr;
+  iss_pulpv2_t pulpv2;
+  iss_prefetcher_t prefetcher;
+  iss_fcsr_t fcsr;
+  iss_reg_t fprec;
+  iss_reg_t vf0;
+  iss_reg_t vf1;
+  int insn_cycles;
+  int fetch_cycles;
+  int elw_interrupted;
+  bool do_fetch;
+  bool debug_mode;
+  int irq_enable;
+  int saved_irq_enable;
+  int debug_saved_irq_enable;
+  int req_irq;
+  bool req_debug;
+  uint32_t vector_base;
+  iss_addr_t current_insn;
+  iss_opcode_t current_opcode;
+  iss_addr_t prev_insn;
+  iss_addr_t hwloop_start_insn[2];
+  iss_addr_t hwloop_end_insn[2];
+  // 0 for the first instruction event, 1 for the normal one and 2 for the one checking
+  // everything
+  int current_event;
+  int irq_req;
+  int irq_req_value;
+  int wakeup_latency;
+} iss_checkpoint_t;
+
+static inline iss_addr_t iss_checkpoint_insn_addr(iss_insn_t *insn)
+{
+  return insn ? insn->addr : ISS_CHECKPOINT_NO_INSN;
+}
+
+void iss_wrapper::checkpoint_save(vp::checkpoint *checkpoint)
+{
+  iss_checkpoint_t state;
+
+  // Requests being processed are lost, the core would stay stalled after the restore
+  if (this->stalled.get())
+  {
+    this->warning.force_warning("Saving checkpoint while the core is stalled\n");
+  }
+
+  memset(&state, 0, sizeof(state));
+
+  state.regfile = this->cpu.regfile;
+  state.csr = this->cpu.csr;
+  state.pulpv2 = this->cpu.pulpv2;
+  state.prefetcher = this->cpu.prefetcher;
+  state.fcsr = this->cpu.state.fcsr;
+  state.fprec = this->cpu.state.fprec;
+  state.vf0 = this->cpu.state.vf0;
+  state.vf1 = this->cpu.state.vf1;
+  state.insn_cycles = this->cpu.state.insn_cycles;
+  state.fetch_cycles = this->cpu.state.fetch_cycles;
+  state.elw_interrupted = this->cpu.state.elw_interrupted;
+  state.do_fetch = this->cpu.state.do_fetch;
+  state.debug_mode = this->cpu.state.debug_mode;
+  state.irq_enable = this->cpu.irq.irq_enable;
+  state.saved_irq_enable = this->cpu.irq.saved_irq_enable;
+  state.debug_saved_irq_enable = this->cpu.irq.debug_saved_irq_enable;
+  state.req_irq = this->cpu.irq.req_irq;
+  state.req_debug = this->cpu.irq.req_debug;
+  state.vector_base = this->cpu.irq.vector_base;
+  state.current_insn = iss_checkpoint_insn_addr(this->cpu.current_insn);
+  state.current_opcode = this->cpu.current_insn ? this->cpu.current_insn->opcode : 0;
+  state.prev_insn = iss_checkpoint_insn_addr(this->cpu.prev_insn);
+  for (int i=0; i<2; i++)
+  {
+    state.hwloop_start_insn[i] = iss_checkpoint_insn_addr(this->cpu.state.hwloop_start_insn[i]);
+    state.hwloop_end_insn[i] = iss_checkpoint_insn_addr(this->cpu.state.hwloop_end_insn[i]);
+  }
+  state.current_event = this->current_event == this->instr_event ? 1 :
+    this->current_event == this->check_all_event ? 2 : 0;
+  state.irq_req = this->irq_req;
+  state.irq_req_value = this->irq_req_value;
+  state.wakeup_latency = this->wakeup_latency;
+
+  checkpoint->save(this, "state", &state, sizeof(state));
+}
+
+void iss_wrapper::checkpoint_restore(vp::checkpoint *checkpoint)
+{
+  iss_checkpoint_t state;
+
+  if (!checkpoint->restore(this, "state", &state, sizeof(state)))
+    return;
+
+  this->cpu.regfile = state.regfile;
+  this->cpu.csr = state.csr;
+  this->cpu.pulpv2 = state.pulpv2;
+  this->cpu.prefetcher = state.prefetcher;
+  this->cpu.state.fcsr = state.fcsr;
+  this->cpu.state.fprec = state.fprec;
+  this->cpu.state.vf0 = state.vf0;
+  this->cpu.state.vf1 = state.vf1;
+  this->cpu.state.insn_cycles = state.insn_cycles;
+  this->cpu.state.fetch_cycles = state.fetch_cycles;
+  this->cpu.state.elw_interrupted = state.elw_interrupted;
+  this->cpu.state.do_fetch = state.do_fetch;
+  this->cpu.state.debug_mode = state.debug_mode;
+  this->cpu.irq.irq_enable = state.irq_enable;
+  this->cpu.irq.saved_irq_enable = state.saved_irq_enable;
+  this->cpu.irq.debug_saved_irq_enable = state.debug_saved_irq_enable;
+  this->cpu.irq.req_irq = state.req_irq;
+  this->cpu.irq.req_debug = state.req_debug;
+  this->cpu.irq.vector_base = state.vector_base;
+  iss_irq_flush(this);
+
+  // The current instruction is already fetched, it must be decoded again as it may
+  // not be in the cache
+  if (state.current_insn != ISS_CHECKPOINT_NO_INSN)
+  {
+    this->cpu.current_insn = insn_cache_get(this, state.current_insn);
+    this->cpu.current_insn->opcode = state.current_opcode;
+    this->cpu.current_insn->fetched = true;
+    iss_decode_pc_noexec(this, this->cpu.current_insn);
+  }
+  this->cpu.prev_insn = state.prev_insn != ISS_CHECKPOINT_NO_INSN ?
+    insn_cache_get(this, state.prev_insn) : NULL;
+  for (int i=0; i<2; i++)
+  {
+    this->cpu.state.hwloop_start_insn[i] = state.hwloop_start_insn[i] != ISS_CHECKPOINT_NO_INSN ?
+      insn_cache_get(this, state.hwloop_start_insn[i]) : NULL;
+    this->cpu.state.hwloop_end_insn[i] = NULL;
+    if (state.hwloop_end_insn[i] != ISS_CHECKPOINT_NO_INSN)
+    {
+      this->cpu.state.hwloop_end_insn[i] = insn_cache_get(this, state.hwloop_end_insn[i]);
+      hwloop_set_insn_end(this, this->cpu.state.hwloop_end_insn[i]);
+    }
+  }
+
+  if (state.current_event == 1)
+  {
+    this->current_event = this->instr_event;
+  }
+  else if (state.current_event == 2)
+  {
+    this->current_event = this->check_all_event;
+  }
+
+  this->irq_req = state.irq_req;
+  this->irq_req_value = state.irq_req_value;
+  this->wakeup_latency = state.wakeup_latency;
+
+  // The memories may have been restored with new data
+  this->dmi_flush();
+  this->spin_loop_pure = false;
+  this->spin_loop_head = -1;
+}
+
+
 iss_wrapper::iss_wrapper(js::config *config)
 : vp::component(config)
 {
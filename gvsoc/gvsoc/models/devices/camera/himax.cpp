@@ -24,6 +24,12 @@
 #include <vp/itf/i2c.hpp>
 #include <unistd.h>
 #include <byteswap.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
 
 #include <stdint.h>
 #ifdef __MAGICK__
@@ -67,6 +73,9 @@ public:
     void set_image_size(int width, int height, int pixel_size);
 
   private:
+    bool map_raw_frames();
+    uint8_t *map_raw_file(const char *path, int *nb_frames);
+
     Himax *top;
     string stream_path;
     int frame_index;
@@ -85,6 +94,8 @@ public:
     bool is_raw;
     uint8_t *raw_image;
     int little;
+    // Raw frames are mapped once and reused when the stream loops
+    std::vector<uint8_t *> frames;
 };
 
 
@@ -100,7 +111,10 @@ public:
 
 protected:
 
+    void step();
+    int idle_steps();
     static void clock_handler(void *__this, vp::clock_event *event);
+    static void burst_handler(void *__this, vp::clock_event *event);
     static void i2c_sync(void *__this, int scl, int sda);
 
     vp::cpi_master cpi_itf;
@@ -141,6 +155,11 @@ protected:
     int pixel_bytes;
 
     Camera_stream *stream;
+
+    // Frame streaming mode, where cycles with the same href and vsync are sent as bursts
+    bool burst_mode;
+    bool has_pending_cycle;
+    std::vector<uint8_t> burst_data;
 };
 
 
@@ -153,6 +172,12 @@ Camera_stream::Camera_stream(Himax *top, string path, int color_mode, int little
     image_buffer = NULL;
 #endif
     raw_image = NULL;
+
+    // The stream can be a directory of raw images, a raw file containing several images or
+    // a path with a %d for the image index
+    struct stat path_stat;
+    this->is_raw = strstr(path.c_str(), ".raw") != NULL ||
+        (stat(path.c_str(), &path_stat) == 0 && S_ISDIR(path_stat.st_mode));
 }
 
 
@@ -165,58 +190,137 @@ void Camera_stream::set_image_size(int width, int height, int pixel_size)
 }
 
 
-bool Camera_stream::fetch_image()
+uint8_t *Camera_stream::map_raw_file(const char *path, int *nb_frames)
 {
-    char path[strlen(stream_path.c_str()) + 100];
-    while(1)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
-        sprintf(path, stream_path.c_str(), frame_index);
-        this->is_raw = strstr(path, ".raw") != NULL;
+        return NULL;
+    }
 
-        if (this->is_raw)
-        {
-            FILE *file = fopen(path, "r");
-            if (file)
-            {
-                int size = this->width * this->height * this->pixel_size;
-                int read_size;
+    struct stat file_stat;
+    int frame_size = this->width * this->height * this->pixel_size;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < frame_size)
+    {
+        close(fd);
+        this->top->trace.fatal("Image file is too short(%s)\n", path);
+        return NULL;
+    }
 
-                this->raw_image = new uint8_t[size];
-                if ((read_size = ::fread(this->raw_image, 1, size, file)) == size)
-                {
-                    fclose(file);
-                    break;
-                }
+    uint8_t *data = (uint8_t *)mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        this->top->trace.fatal("Unable to map image file (%s)\n", path);
+        return NULL;
+    }
+
+    *nb_frames = file_stat.st_size / frame_size;
+    return data;
+}
+
+
+bool Camera_stream::map_raw_frames()
+{
+    int frame_size = this->width * this->height * this->pixel_size;
+    std::vector<std::string> paths;
+    struct stat path_stat;
 
-                delete this->raw_image;
-                this->raw_image = NULL;
-                fclose(file);
-                this->top->trace.fatal("Image file is too short(%s)\n", path);
-                return false;
+    if (stat(stream_path.c_str(), &path_stat) == 0 && S_ISDIR(path_stat.st_mode))
+    {
+        DIR *dir = opendir(stream_path.c_str());
+        if (dir == NULL)
+        {
+            this->top->trace.fatal("Unable to open image directory (%s)\n", stream_path.c_str());
+            return false;
+        }
+
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".raw") == 0)
+            {
+                paths.push_back(stream_path + "/" + name);
             }
+        }
+        closedir(dir);
 
-            if (frame_index == 0)
+        std::sort(paths.begin(), paths.end());
+    }
+    else
+    {
+        // Images are taken until one is missing, and a single file can contain several images
+        char path[strlen(stream_path.c_str()) + 100];
+        for (int index=0;; index++)
+        {
+            sprintf(path, stream_path.c_str(), index);
+            if (access(path, F_OK) != 0 || (index > 0 && paths[0] == path))
             {
-              this->top->trace.fatal("Unable to open image file (%s)\n", path);
-              return false;
+                break;
             }
+            paths.push_back(path);
         }
-        else
+    }
+
+    for (std::string &path: paths)
+    {
+        int nb_frames;
+        uint8_t *data = this->map_raw_file(path.c_str(), &nb_frames);
+        if (data == NULL)
+        {
+            return false;
+        }
+
+        for (int i=0; i<nb_frames; i++)
+        {
+            this->frames.push_back(data + i * frame_size);
+        }
+    }
+
+    if (this->frames.size() == 0)
+    {
+        this->top->trace.fatal("Unable to open image file (%s)\n", stream_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+bool Camera_stream::fetch_image()
+{
+    if (this->is_raw)
+    {
+        if (this->frames.size() == 0 && !this->map_raw_frames())
         {
+            return false;
+        }
+
+        this->raw_image = this->frames[frame_index];
+        frame_index = (frame_index + 1) % this->frames.size();
+        return true;
+    }
+
+    char path[strlen(stream_path.c_str()) + 100];
+    while(1)
+    {
+        sprintf(path, stream_path.c_str(), frame_index);
+
 #ifdef __MAGICK__
-          try {
-              image.read(path);
-              break;
-          }
-          catch( Exception &error_ ) {
-              if (frame_index == 0) {
-                  throw;
-              }
-          }
+        try {
+            image.read(path);
+            break;
+        }
+        catch( Exception &error_ ) {
+            if (frame_index == 0) {
+                throw;
+            }
+        }
 #else
-          this->top->trace.fatal("Trying to open image file while ImageMagick has not been installed, use a raw image instead (with.raw extension) (%s)\n", path);
+        this->top->trace.fatal("Trying to open image file while ImageMagick has not been installed, use a raw image instead (with.raw extension) (%s)\n", path);
+        return false;
 #endif
-        }
 
         frame_index = 0;
     }
@@ -224,22 +328,19 @@ bool Camera_stream::fetch_image()
     //dpi_print(top->handle, ("Opened image (path: " + string(path) + ")").c_str());
     frame_index++;
 
-    if (!this->is_raw)
-    {
 #ifdef __MAGICK__
-        image.extent(Geometry(width, height));
+    image.extent(Geometry(width, height));
 
-        if (color_mode == COLOR_MODE_GRAY)
-        {
-            image.quantizeColorSpace( GRAYColorspace );
-            image.quantizeColors( 256 );
-            image.quantize( );
-        }
+    if (color_mode == COLOR_MODE_GRAY)
+    {
+        image.quantizeColorSpace( GRAYColorspace );
+        image.quantizeColors( 256 );
+        image.quantize( );
+    }
 
 
-        image_buffer = (PixelPacket*) image.getPixels(0, 0, width, height);
+    image_buffer = (PixelPacket*) image.getPixels(0, 0, width, height);
 #endif
-    }
 
     return true;
 }
@@ -254,9 +355,10 @@ unsigned int Camera_stream::get_pixel()
 
     if (this->is_raw)
     {
-        unsigned int result;
+        unsigned int result = 0;
 
-        result = (*(uint32_t *)&(this->raw_image[current_pixel*this->pixel_size])) & ((1<<(this->pixel_size*8)) - 1);
+        // Frames are mapped, so only the pixel bytes can be read
+        memcpy(&result, &this->raw_image[current_pixel*this->pixel_size], this->pixel_size);
 
         if (!this->little)
         {
@@ -274,7 +376,6 @@ unsigned int Camera_stream::get_pixel()
         if (current_pixel == nb_pixel)
         {
             current_pixel = 0;
-            delete this->raw_image;
             this->raw_image = NULL;
         }
         return result;
@@ -314,187 +415,258 @@ void Himax::i2c_sync(void *__this, int scl, int sda)
 }
 
 
-void Himax::clock_handler(void *__this, vp::clock_event *event)
+void Himax::step()
 {
-    Himax *_this = (Himax *)__this;
-
-    _this->event_enqueue(_this->clock_event, 1);
-
-    _this->pclk_value ^= 1;
-
-    if (!_this->pclk_value)
+    switch (this->state)
     {
-        switch (_this->state)
-        {
-            case STATE_INIT:
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State INIT\n");
-                _this->cnt = 0;
-                _this->targetcnt = 3*TLINE(_this->width);
-                _this->state = STATE_SOF;
-                _this->bytesel = 0;
-                _this->framesel = 0;
-                break;
-
-            case STATE_SOF:
-                if (_this->cnt == 0)
-                    _this->trace.msg(vp::trace::LEVEL_DEBUG, "Starting frame\n");
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State SOF (cnt: %d, targetcnt: %d)\n", _this->cnt, _this->targetcnt);
-                _this->vsync = _this->vsync_polarity;
-                _this->cnt++;
-                if (_this->cnt == _this->targetcnt)
-                {
-                    _this->cnt = 0;
-                    _this->targetcnt = 17*TLINE(_this->width);
-                    _this->state = STATE_WAIT_SOF;
-                    _this->vsync = !_this->vsync_polarity;
-                }
-                break;
+        case STATE_INIT:
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "State INIT\n");
+            this->cnt = 0;
+            this->targetcnt = 3*TLINE(this->width);
+            this->state = STATE_SOF;
+            this->bytesel = 0;
+            this->framesel = 0;
+            break;
+
+        case STATE_SOF:
+            if (this->cnt == 0)
+                this->trace.msg(vp::trace::LEVEL_DEBUG, "Starting frame\n");
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "State SOF (cnt: %d, targetcnt: %d)\n", this->cnt, this->targetcnt);
+            this->vsync = this->vsync_polarity;
+            this->cnt++;
+            if (this->cnt == this->targetcnt)
+            {
+                this->cnt = 0;
+                this->targetcnt = 17*TLINE(this->width);
+                this->state = STATE_WAIT_SOF;
+                this->vsync = !this->vsync_polarity;
+            }
+            break;
 
-            case STATE_WAIT_SOF:
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_SOF (cnt: %d, targetcnt: %d)\n", _this->cnt, _this->targetcnt);
-                _this->cnt++;
-                if (_this->cnt == _this->targetcnt)
-                {
-                    _this->state = STATE_SEND_LINE;
-                    _this->lineptr = 0;
-                    _this->colptr = 0;
-                }
-                break;
+        case STATE_WAIT_SOF:
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_SOF (cnt: %d, targetcnt: %d)\n", this->cnt, this->targetcnt);
+            this->cnt++;
+            if (this->cnt == this->targetcnt)
+            {
+                this->state = STATE_SEND_LINE;
+                this->lineptr = 0;
+                this->colptr = 0;
+            }
+            break;
 
-            case STATE_SEND_LINE: {
-                int last_byte = 0;
+        case STATE_SEND_LINE: {
+            int last_byte = 0;
 
-                _this->href = _this->hsync_polarity;
+            this->href = this->hsync_polarity;
 
-                if (_this->color_mode == COLOR_MODE_CUSTOM)
+            if (this->color_mode == COLOR_MODE_CUSTOM)
+            {
+                last_byte = this->pixel_size - 1;
+                if (this->stream)
                 {
-                    last_byte = _this->pixel_size - 1;
-                    if (_this->stream)
+                    if (this->pixel_bytes == 0)
                     {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
+                        this->pixel = this->stream->get_pixel();
+                        this->pixel_bytes = this->pixel_size;
                     }
-
-                    _this->data = _this->pixel & 0xFF;
-                    _this->pixel >>= 8;
+                    this->pixel_bytes--;
                 }
-                else if (_this->color_mode == COLOR_MODE_GRAY)
+
+                this->data = this->pixel & 0xFF;
+                this->pixel >>= 8;
+            }
+            else if (this->color_mode == COLOR_MODE_GRAY)
+            {
+                if (this->stream)
                 {
-                    if (_this->stream)
+                    if (this->pixel_bytes == 0)
                     {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->data = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
+                        this->data = this->stream->get_pixel();
+                        this->pixel_bytes = this->pixel_size;
                     }
+                    this->pixel_bytes--;
+                }
 
-                    //if (stimImg != NULL) {
-                    //  pixel = ((uint32_t *)stimImg[framesel])[(lineptr*width)+2*colptr+offset];
-                    //}
+                //if (stimImg != NULL) {
+                //  pixel = ((uint32_t *)stimImg[framesel])[(lineptr*width)+2*colptr+offset];
+                //}
 
-                    //data = 0.2989 * ((pixel >> 16) & 0xff) +
-                    //       0.5870 * ((pixel >>  8) & 0xff) +
-                    //       0.1140 * ((pixel >>  0) & 0xff);
-                }
-                else if (_this->color_mode == COLOR_MODE_RAW)
+                //data = 0.2989 * ((pixel >> 16) & 0xff) +
+                //       0.5870 * ((pixel >>  8) & 0xff) +
+                //       0.1140 * ((pixel >>  0) & 0xff);
+            }
+            else if (this->color_mode == COLOR_MODE_RAW)
+            {
+              if (this->stream)
                 {
-                  if (_this->stream)
+                    if (this->pixel_bytes == 0)
                     {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
-                  }
-
-                  // Raw bayer mode. Line 0: BGBG, Line 1: GRGR
-                  int line = _this->width - _this->lineptr -1;
-                  if (line & 1)
-                  {
-                      if (_this->colptr & 1)
-                          _this->data = (_this->pixel >> 16) & 0xff;
-                      else
-                          _this->data = (_this->pixel >> 8) & 0xff;
-                  }
+                        this->pixel = this->stream->get_pixel();
+                        this->pixel_bytes = this->pixel_size;
+                    }
+                    this->pixel_bytes--;
+              }
+
+              // Raw bayer mode. Line 0: BGBG, Line 1: GRGR
+              int line = this->width - this->lineptr -1;
+              if (line & 1)
+              {
+                  if (this->colptr & 1)
+                      this->data = (this->pixel >> 16) & 0xff;
                   else
-                  {
-                    if (_this->colptr & 1)
-                        _this->data = (_this->pixel >> 8) & 0xff;
-                    else
-                        _this->data = (_this->pixel >> 0) & 0xff;
-                  }
-                }
+                      this->data = (this->pixel >> 8) & 0xff;
+              }
+              else
+              {
+                if (this->colptr & 1)
+                    this->data = (this->pixel >> 8) & 0xff;
                 else
+                    this->data = (this->pixel >> 0) & 0xff;
+              }
+            }
+            else
+            {
+                if (this->stream)
                 {
-                    if (_this->stream)
+                    if (this->pixel_bytes == 0)
                     {
-                        if (_this->pixel_bytes == 0)
-                        {
-                            _this->pixel = _this->stream->get_pixel();
-                            _this->pixel_bytes = _this->pixel_size;
-                        }
-                        _this->pixel_bytes--;
+                        this->pixel = this->stream->get_pixel();
+                        this->pixel_bytes = this->pixel_size;
                     }
+                    this->pixel_bytes--;
+                }
 
-                    //if (stimImg != NULL) {
-                    //  ((uint32_t *)stimImg[framesel])[(lineptr*width)+colptr];
-                    //}
+                //if (stimImg != NULL) {
+                //  ((uint32_t *)stimImg[framesel])[(lineptr*width)+colptr];
+                //}
 
-                    // Coded with RGB565
-                    if (_this->bytesel) _this->data = (((_this->pixel >> 10) & 0x7) << 5) | (((_this->pixel >> 3) & 0x1f) << 0);
-                    else         _this->data = (((_this->pixel >> 19) & 0x1f) << 3) | (((_this->pixel >> 13) & 0x7) << 0);
-                }
+                // Coded with RGB565
+                if (this->bytesel) this->data = (((this->pixel >> 10) & 0x7) << 5) | (((this->pixel >> 3) & 0x1f) << 0);
+                else         this->data = (((this->pixel >> 19) & 0x1f) << 3) | (((this->pixel >> 13) & 0x7) << 0);
+            }
 
-                if (_this->bytesel == last_byte) {
-                    _this->bytesel = 0;
-                    if(_this->colptr == (_this->width-1)) {
-                        _this->colptr = 0;
-                        if(_this->lineptr == (_this->height-1)) {
-                            _this->state = STATE_WAIT_EOF;
-                            _this->cnt = 0;
-                            _this->targetcnt = 10*TLINE(_this->width);
-                            _this->lineptr = 0;
-                        } else {
-                            _this->lineptr = _this->lineptr + 1;
-                        }
+            if (this->bytesel == last_byte) {
+                this->bytesel = 0;
+                if(this->colptr == (this->width-1)) {
+                    this->colptr = 0;
+                    if(this->lineptr == (this->height-1)) {
+                        this->state = STATE_WAIT_EOF;
+                        this->cnt = 0;
+                        this->targetcnt = 10*TLINE(this->width);
+                        this->lineptr = 0;
                     } else {
-                        _this->colptr = _this->colptr + 1;
+                        this->lineptr = this->lineptr + 1;
                     }
-
                 } else {
-                    _this->bytesel++;
+                    this->colptr = this->colptr + 1;
                 }
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State SEND_LINE (data: 0x%x)\n", _this->data);
-                break;
-            }
 
-            case STATE_WAIT_EOF:
-                _this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_EOF (cnt: %d, targetcnt: %d)\n", _this->cnt, _this->targetcnt);
-                _this->href = !_this->hsync_polarity;
-                _this->data = 0;
-                _this->cnt++;
-                if (_this->cnt == _this->targetcnt) {
-                  _this->state = STATE_SOF;
-                  _this->cnt = 0;
-                  _this->targetcnt = 3*TLINE(_this->width);
-                  _this->framesel++;
-                  if (_this->framesel == _this->nb_images) _this->framesel = 0;
-                }
-                break;
+            } else {
+                this->bytesel++;
+            }
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "State SEND_LINE (data: 0x%x)\n", this->data);
+            break;
         }
+
+        case STATE_WAIT_EOF:
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "State WAIT_EOF (cnt: %d, targetcnt: %d)\n", this->cnt, this->targetcnt);
+            this->href = !this->hsync_polarity;
+            this->data = 0;
+            this->cnt++;
+            if (this->cnt == this->targetcnt) {
+              this->state = STATE_SOF;
+              this->cnt = 0;
+              this->targetcnt = 3*TLINE(this->width);
+              this->framesel++;
+              if (this->framesel == this->nb_images) this->framesel = 0;
+            }
+            break;
+    }
+}
+
+
+int Himax::idle_steps()
+{
+    // Waiting states only count cycles until the last one, which changes the state.
+    // The cycles before it do not change the pins once the state has set them.
+    switch (this->state)
+    {
+        case STATE_SOF:
+            return this->vsync == this->vsync_polarity ? this->targetcnt - 1 - this->cnt : 0;
+
+        case STATE_WAIT_SOF:
+            return this->targetcnt - 1 - this->cnt;
+
+        case STATE_WAIT_EOF:
+            return this->href == !this->hsync_polarity && this->data == 0 ? this->targetcnt - 1 - this->cnt : 0;
+    }
+
+    return 0;
+}
+
+
+void Himax::clock_handler(void *__this, vp::clock_event *event)
+{
+    Himax *_this = (Himax *)__this;
+
+    _this->event_enqueue(_this->clock_event, 1);
+
+    _this->pclk_value ^= 1;
+
+    if (!_this->pclk_value)
+    {
+        _this->step();
     }
 
     _this->cpi_itf.sync(_this->pclk_value, _this->href, _this->vsync, _this->data);
 }
 
 
+void Himax::burst_handler(void *__this, vp::clock_event *event)
+{
+    Himax *_this = (Himax *)__this;
+
+    // The first cycle may have been computed by the previous burst, when it found
+    // that href or vsync changed
+    if (!_this->has_pending_cycle)
+    {
+        _this->step();
+    }
+    _this->has_pending_cycle = false;
+
+    int href = _this->href;
+    int vsync = _this->vsync;
+
+    _this->burst_data.clear();
+    _this->burst_data.push_back(_this->data);
+
+    // Extend the burst until href or vsync changes, or until the end of the line, so that
+    // pixels are received at most one line in advance
+    while (_this->state != STATE_SEND_LINE || _this->colptr != 0 || _this->bytesel != 0)
+    {
+        int nb_idle = _this->idle_steps();
+        if (nb_idle > 0)
+        {
+            _this->cnt += nb_idle;
+            _this->burst_data.insert(_this->burst_data.end(), nb_idle, _this->data);
+        }
+
+        _this->step();
+        if (_this->href != href || _this->vsync != vsync)
+        {
+            _this->has_pending_cycle = true;
+            break;
+        }
+        _this->burst_data.push_back(_this->data);
+    }
+
+    _this->cpi_itf.burst(href, vsync, _this->burst_data.data(), _this->burst_data.size());
+
+    // Each cycle takes 2 clock cycles, one for each pixel clock edge
+    _this->event_enqueue(_this->clock_event, 2 * _this->burst_data.size());
+}
+
+
 
 
 int Himax::build()
@@ -506,7 +678,17 @@ int Himax::build()
     this->i2c_itf.set_sync_meth(&Himax::i2c_sync);
     this->new_slave_port("i2c", &this->i2c_itf);
 
-    this->clock_event = this->event_new(this, Himax::clock_handler);
+    js::config *burst_config = this->get_vp_config()->get("cpi_burst");
+    this->burst_mode = burst_config && burst_config->get_bool();
+
+    if (this->burst_mode)
+    {
+        this->clock_event = this->event_new(this, Himax::burst_handler);
+    }
+    else
+    {
+        this->clock_event = this->event_new(this, Himax::clock_handler);
+    }
 
 #ifdef __MAGICK__
     InitializeMagick(NULL);
@@ -575,6 +757,7 @@ void Himax::start()
     this->href = !this->hsync_polarity;
     this->data = 0;
     this->pixel_bytes = 0;
+    this->has_pending_cycle = false;
 }
 
 
@@ -80,6 +80,7 @@ public:
   int setup_writeback_file(const char *path);
 
   static void sync_cycle(void *_this, int data);
+  static void burst(void *_this, uint8_t *data, int size, bool is_write);
   static void cs_sync(void *__this, bool value);
 
   int get_nb_word() {return nb_word;}
@@ -456,6 +457,27 @@ void Hyperflash::sync_cycle(void *__this, int data)
   }
 }
 
+void Hyperflash::burst(void *__this, uint8_t *data, int size, bool is_write)
+{
+  Hyperflash *_this = (Hyperflash *)__this;
+
+  // Only array reads are handled at once, commands and programming go through the
+  // state machine cycle per cycle
+  if (_this->hyper_state == HYPERBUS_STATE_DATA && _this->ca.read && !is_write &&
+    _this->state != HYPERFLASH_STATE_GET_STATUS_REG &&
+    _this->current_address >= 0 && _this->current_address + size <= _this->size)
+  {
+    _this->trace.msg(vp::trace::LEVEL_TRACE, "Handling read burst (address: 0x%x, size: 0x%x)\n", _this->current_address, size);
+
+    memcpy(data, &_this->data[_this->current_address], size);
+    _this->current_address += size;
+  }
+  else
+  {
+    _this->in_itf.burst_to_cycles(data, size, is_write);
+  }
+}
+
 void Hyperflash::cs_sync(void *__this, bool value)
 {
   Hyperflash *_this = (Hyperflash *)__this;
@@ -491,6 +513,7 @@ int Hyperflash::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperflash::sync_cycle);
+  in_itf.set_burst_meth(&Hyperflash::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperflash::cs_sync);
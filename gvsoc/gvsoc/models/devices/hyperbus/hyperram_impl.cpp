@@ -54,6 +54,7 @@ public:
   int build();
 
   static void sync_cycle(void *_this, int data);
+  static void burst(void *_this, uint8_t *data, int size, bool is_write);
   static void cs_sync(void *__this, bool value);
 
 protected:
@@ -149,6 +150,29 @@ void Hyperram::sync_cycle(void *__this, int data)
   }
 }
 
+void Hyperram::burst(void *__this, uint8_t *data, int size, bool is_write)
+{
+  Hyperram *_this = (Hyperram *)__this;
+
+  // Data phases are handled at once, everything else is handled cycle per cycle
+  if (_this->state == HYPERBUS_STATE_DATA && _this->ca.read == !is_write &&
+    _this->current_address >= 0 && _this->current_address + size <= _this->size)
+  {
+    _this->trace.msg(vp::trace::LEVEL_TRACE, "Handling data burst (addr: 0x%x, size: 0x%x, read: %d)\n", _this->current_address, size, _this->ca.read);
+
+    if (is_write)
+      memcpy(&_this->data[_this->current_address], data, size);
+    else
+      memcpy(data, &_this->data[_this->current_address], size);
+
+    _this->current_address += size;
+  }
+  else
+  {
+    _this->in_itf.burst_to_cycles(data, size, is_write);
+  }
+}
+
 void Hyperram::cs_sync(void *__this, bool value)
 {
   Hyperram *_this = (Hyperram *)__this;
@@ -163,6 +187,7 @@ int Hyperram::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in_itf.set_sync_cycle_meth(&Hyperram::sync_cycle);
+  in_itf.set_burst_meth(&Hyperram::burst);
   new_slave_port("input", &in_itf);
 
   cs_itf.set_sync_meth(&Hyperram::cs_sync);
@@ -28,13 +28,13 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
-#ifdef USE_SNDFILE
-#include <sndfile.hh>
-#endif
 
 
 class Stim_txt;
@@ -101,11 +101,14 @@ class Stim_txt : public Stim
 {
 
 public:
-  Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw=false, bool use_libsnd=false);
+  Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw=false, bool is_wav=false);
   long long get_data(int64_t timestamp);
   long long get_data_from_file();
 
 private:
+  int map_wav(std::string file);
+  long long get_data_from_wav();
+
   Microphone *top;
   int width;
   FILE *stim_file;
@@ -116,32 +119,24 @@ private:
   int64_t next_data_time;
   long long next_data;
   bool raw;
-  bool use_libsnd;
-#ifdef USE_SNDFILE
-  SndfileHandle sndfile;
-#endif
+  bool is_wav;
+  uint8_t *wav_samples;     // First sample of the data chunk, inside the mapped file
+  int64_t wav_nb_samples;   // Number of samples of the data chunk, all channels included
+  int64_t wav_index;        // Index of the next sample to be read
+  int wav_sample_bits;      // Number of bits of each sample in the file
 };
 
 
-Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw, bool use_libsnd)
-: top(top), width(width), file_path(file), raw(raw), use_libsnd(use_libsnd)
+Stim_txt::Stim_txt(Microphone *top, std::string file, int width, int freq, bool raw, bool is_wav)
+: top(top), width(width), file_path(file), raw(raw), is_wav(is_wav)
 {
-    if (use_libsnd)
+    if (is_wav)
     {
-
-    #ifdef USE_SNDFILE
-
-        unsigned int pcm_width = width == 16 ? SF_FORMAT_PCM_16 : SF_FORMAT_PCM_32;
-        this->sndfile = SndfileHandle (file, SFM_READ, SF_FORMAT_WAV | pcm_width) ;
-        freq = sndfile.samplerate ();
-
-    #else
-
-        this->top->get_trace()->fatal("Unable to open file (%s), libsndfile support is not active\n", file.c_str());
-        return;
-
-    #endif
-
+        freq = this->map_wav(file);
+        if (freq < 0)
+        {
+            return;
+        }
     }
     else
     {
@@ -168,32 +163,142 @@ static inline int get_signed_value(unsigned long long val, int bits)
 }
 
 
-long long Stim_txt::get_data_from_file()
+// Maps the whole WAV file in memory, so that the samples are directly read from there while
+// the stream is played, and returns the sample rate.
+int Stim_txt::map_wav(std::string file)
 {
-    if (use_libsnd)
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        this->top->get_trace()->fatal("Failed to open stimuli file: %s: %s\n", file.c_str(), strerror(errno));
+        return -1;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size < 12)
     {
+        close(fd);
+        this->top->get_trace()->fatal("Invalid WAV file: %s\n", file.c_str());
+        return -1;
+    }
 
-    #ifdef USE_SNDFILE
+    uint8_t *data = (uint8_t *)mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
 
-        int32_t result;
-        if (this->width <= 16)
+    if (data == MAP_FAILED)
+    {
+        this->top->get_trace()->fatal("Failed to map stimuli file: %s: %s\n", file.c_str(), strerror(errno));
+        return -1;
+    }
+
+    if (memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        this->top->get_trace()->fatal("Invalid WAV file: %s\n", file.c_str());
+        return -1;
+    }
+
+    // Go through the chunks to find the format and the samples
+    int sample_rate = -1;
+    uint8_t *current = data + 12;
+    uint8_t *end = data + file_stat.st_size;
+
+    this->wav_samples = NULL;
+
+    while (current + 8 <= end)
+    {
+        uint32_t chunk_size;
+        memcpy(&chunk_size, current + 4, 4);
+        uint8_t *chunk = current + 8;
+
+        if (chunk_size > (uint32_t)(end - chunk))
         {
-            int16_t sample;
-            sndfile.read (&sample, 1);
-            result = (int32_t)sample;
+            chunk_size = end - chunk;
         }
-        else if (this->width <= 32)
+
+        if (memcmp(current, "fmt ", 4) == 0 && chunk_size >= 16)
+        {
+            uint16_t format, bits;
+            uint32_t rate;
+            memcpy(&format, chunk, 2);
+            memcpy(&rate, chunk + 4, 4);
+            memcpy(&bits, chunk + 14, 2);
+
+            // Only PCM, possibly described with the extensible format
+            if ((format != 1 && format != 0xFFFE) || bits == 0 || bits > 32 || bits % 8 != 0)
+            {
+                this->top->get_trace()->fatal("Unsupported WAV format, only 8 to 32 bits PCM is supported: %s\n", file.c_str());
+                return -1;
+            }
+
+            sample_rate = rate;
+            this->wav_sample_bits = bits;
+        }
+        else if (memcmp(current, "data", 4) == 0)
         {
-            int32_t sample;
-            sndfile.read (&sample, 1);
-            result = (int32_t)sample;
+            this->wav_samples = chunk;
+            this->wav_nb_samples = chunk_size;
         }
 
-        return result;
-    #else
-        return 0;
-    #endif
+        // Chunks are aligned on 2 bytes
+        current = chunk + chunk_size + (chunk_size & 1);
+    }
 
+    if (sample_rate == -1 || this->wav_samples == NULL)
+    {
+        this->top->get_trace()->fatal("Invalid WAV file, missing format or data: %s\n", file.c_str());
+        return -1;
+    }
+
+    this->wav_nb_samples /= this->wav_sample_bits / 8;
+    this->wav_index = 0;
+
+    if (this->wav_nb_samples == 0)
+    {
+        this->top->get_trace()->fatal("WAV file does not contain any sample: %s\n", file.c_str());
+        return -1;
+    }
+
+    return sample_rate;
+}
+
+
+long long Stim_txt::get_data_from_wav()
+{
+    // The stream restarts from the beginning once the end is reached, as for other files
+    if (this->wav_index == this->wav_nb_samples)
+    {
+        this->wav_index = 0;
+    }
+
+    int sample_bytes = this->wav_sample_bits / 8;
+    uint8_t *sample_data = this->wav_samples + this->wav_index * sample_bytes;
+    uint32_t data = 0;
+
+    this->wav_index++;
+
+    memcpy(&data, sample_data, sample_bytes);
+
+    // Left-align the sample on 32 bits, 8 bits samples are unsigned in WAV files
+    int32_t sample = data << (32 - this->wav_sample_bits);
+    if (this->wav_sample_bits == 8)
+    {
+        sample ^= 0x80000000;
+    }
+
+    // Samples are normalized on 16 bits or 32 bits depending on the microphone width
+    int32_t result = this->width <= 16 ? sample >> 16 : sample;
+
+    this->top->trace.msg(vp::trace::LEVEL_TRACE, "Got new sample (value: 0x%x)", result);
+
+    return result;
+}
+
+
+long long Stim_txt::get_data_from_file()
+{
+    if (is_wav)
+    {
+        return this->get_data_from_wav();
     }
     else if (raw)
     {
@@ -459,7 +564,12 @@ void Microphone::sync(void *__this, int sck, int ws, int sdio)
 
     _this->trace.msg(vp::trace::LEVEL_TRACE, "I2S edge (sck: %d, ws: %d, sdo: %d)\n", sck, ws, sd);
 
-    if (_this->prev_sck != sck)
+    // Updated before driving the data, since the padframe sends the resolved data back to
+    // all devices, so the same edge can come back here before this one is done
+    int prev_sck = _this->prev_sck;
+    _this->prev_sck = sck;
+
+    if (prev_sck != sck)
     {
         if (sck)
         {
@@ -533,8 +643,6 @@ void Microphone::sync(void *__this, int sck, int ws, int sdio)
             }
         }
     }
-
-    _this->prev_sck = sck;
 }
 
 
@@ -114,12 +114,14 @@ protected:
 private:
 
   static void sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+  static void burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx);
   static void cs_sync(void *__this, bool active);
 
   void handle_data(int data_0, int data_1, int data_2, int data_3);
   void start_command();
   void enqueue_bits(int data_0, int data_1, int data_2, int data_3);
   void send_bits();
+  bool read_burst(uint8_t *data, int nb_bits, int lines);
 
   
   vp::trace     trace;
@@ -143,6 +145,9 @@ private:
   bool read;
   bool waiting_command;
 
+  bool in_burst;       // True while handling a burst, the data is then returned in the burst
+  int sent_bits;       // Last bits driven on the data lines
+
   unsigned int current_addr;
 
   vp::clock_event *sector_erase_event;
@@ -344,15 +349,19 @@ void spiflash::send_bits()
     {
       unsigned int value = (this->pending_word >> 7) & 0x1;
       this->pending_word <<= 1;
+      this->sent_bits = value;
       this->trace.msg(vp::trace::LEVEL_TRACE, "Sending single data (data_0: %d)\n", value);
-      this->in_itf.sync(2, 0, value, 0, 0, 2);
+      if (!this->in_burst)
+        this->in_itf.sync(2, 0, value, 0, 0, 2);
     }
     else
     {
       unsigned int value = (this->pending_word >> 4) & 0xf;
       this->pending_word <<= 4;
+      this->sent_bits = value;
       this->trace.msg(vp::trace::LEVEL_TRACE, "Sending quad data (data_0: %d, data_1: %d, data_2: %d, data_3: %d)\n", (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1);
-      this->in_itf.sync(2, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1, 0xf);
+      if (!this->in_burst)
+        this->in_itf.sync(2, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1, 0xf);
     }
   }
 }
@@ -431,6 +440,73 @@ void spiflash::sync(void *__this, int sck, int data_0, int data_1, int data_2, i
 }
 
 
+bool spiflash::read_burst(uint8_t *data, int nb_bits, int lines)
+{
+  // Read data can be copied at once when the previous edge started sending a new byte,
+  // which is the case after the address and then every 8 bits
+  int data_start;
+  if (this->pending_command->handler == &spiflash::single_read && lines == 1)
+    data_start = 24;
+  else if (this->pending_command->handler == &spiflash::quad_read && lines == 4 && this->quad)
+    data_start = 40;
+  else
+    return false;
+
+  int size = nb_bits / 8;
+
+  if (!this->read || this->pending_bits < data_start || this->pending_bits % 8 != 0 || nb_bits % 8 != 0 ||
+    this->current_addr + size > (unsigned int)this->size)
+    return false;
+
+  this->trace.msg(vp::trace::LEVEL_DEBUG, "Reading burst (address: 0x%x, size: 0x%x)\n", this->current_addr - 1, size);
+
+  memcpy(data, &this->mem_data[this->current_addr - 1], size);
+
+  // Leave the flash in the same state as after the same number of edges, i.e. having
+  // started sending the following byte
+  this->pending_bits += nb_bits;
+  this->current_addr += size;
+  this->pending_word = this->mem_data[this->current_addr - 1];
+  this->send_bits();
+
+  return true;
+}
+
+
+void spiflash::burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx)
+{
+  spiflash *_this = (spiflash *)__this;
+  _this->trace.msg(vp::trace::LEVEL_TRACE, "Received burst (nb_bits: %d, lines: %d, is_rx: %d)\n", nb_bits, lines, is_rx);
+
+  _this->in_burst = true;
+
+  if (!is_rx || _this->waiting_command || !_this->read_burst(data, nb_bits, lines))
+  {
+    // Other phases are short, they are handled edge per edge as with the pins
+    int lines_mask = (1 << lines) - 1;
+
+    for (int bit=0; bit<nb_bits; bit+=lines)
+    {
+      uint8_t *byte = &data[bit / 8];
+      int shift = 8 - lines - bit % 8;
+
+      if (is_rx)
+      {
+        *byte = (*byte & ~(lines_mask << shift)) | ((_this->sent_bits & lines_mask) << shift);
+        _this->handle_data(0, 0, 0, 0);
+      }
+      else
+      {
+        int value = (*byte >> shift) & lines_mask;
+        _this->handle_data((value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1);
+      }
+    }
+  }
+
+  _this->in_burst = false;
+}
+
+
 void spiflash::cs_sync(void *__this, bool active)
 {
   spiflash *_this = (spiflash *)__this;  
@@ -449,6 +525,7 @@ int spiflash::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   this->in_itf.set_sync_meth(&spiflash::sync);
+  this->in_itf.set_burst_meth(&spiflash::burst);
   this->new_slave_port("input", &this->in_itf);
 
   this->cs_itf.set_sync_meth(&spiflash::cs_sync);
@@ -470,6 +547,8 @@ int spiflash::build()
 
   this->cr1.raw = 0;
   this->quad = false;
+  this->in_burst = false;
+  this->sent_bits = 0;
 
   this->sector_erase_event = event_new(spiflash::sector_erase_done);
 
@@ -153,6 +153,18 @@ int Gdb_server::io_access(uint32_t addr, int size, uint8_t *data, bool is_write)
 }
 
 
+// Contrary to io_access, this one is not timed and is done in one step, whatever
+// the size, which is what the debugger expects for memory dumps
+int Gdb_server::debug_access(uint32_t addr, int size, uint8_t *data, bool is_write)
+{
+    this->get_time_engine()->lock();
+    int err = this->out.debug_req(addr, data, size, is_write);
+    this->get_time_engine()->unlock();
+
+    return err != vp::IO_REQ_OK;
+}
+
+
 extern "C" vp::component *vp_constructor(js::config *config)
 {
   return new Gdb_server(config);
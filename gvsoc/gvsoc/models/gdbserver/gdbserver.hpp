@@ -39,6 +39,7 @@ public:
     void start();
 
     int io_access(uint32_t addr, int size, uint8_t *data, bool is_write);
+    int debug_access(uint32_t addr, int size, uint8_t *data, bool is_write);
 
     int register_core(vp::Gdbserver_core *core);
     void signal(vp::Gdbserver_core *core);
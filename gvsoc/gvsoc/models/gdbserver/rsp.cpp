@@ -24,6 +24,7 @@
 #include <sys/socket.h>
 #include <sys/prctl.h>
 #include <netinet/in.h>
+#include <vector>
 
 #define DEFAULT_THREAD 9
 
@@ -536,6 +537,74 @@ bool Rsp::regs_send()
 }
 
 
+bool Rsp::mem_read(char *data, size_t)
+{
+    uint32_t addr;
+    unsigned int length;
+
+    if (sscanf(data, "%x,%x", &addr, &length) != 2)
+    {
+        this->top->trace.msg(vp::trace::LEVEL_INFO, "Could not parse packet\n");
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(length);
+
+    if (this->top->debug_access(addr, length, buffer.data(), false))
+        return send_str("E03");
+
+    std::vector<char> reply(length * 2 + 1);
+    for (unsigned int i = 0; i < length; i++)
+    {
+        snprintf(&reply[i * 2], 3, "%02x", buffer[i]);
+    }
+    reply[length * 2] = 0;
+
+    return send(reply.data(), length * 2);
+}
+
+
+bool Rsp::mem_write_ascii(char *data, size_t len)
+{
+    uint32_t addr;
+    unsigned int length;
+    size_t i;
+
+    if (sscanf(data, "%x,%x:", &addr, &length) != 2)
+    {
+        this->top->trace.msg(vp::trace::LEVEL_INFO, "Could not parse packet\n");
+        return false;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if (data[i] == ':')
+        {
+            break;
+        }
+    }
+
+    if (i == len || len - i - 1 < length * 2)
+        return false;
+
+    // align to hex data
+    data = &data[i + 1];
+
+    std::vector<uint8_t> buffer(length);
+    for (unsigned int j = 0; j < length; j++)
+    {
+        unsigned int value;
+        if (sscanf(&data[j * 2], "%2x", &value) != 1)
+            return false;
+        buffer[j] = value;
+    }
+
+    if (this->top->debug_access(addr, length, buffer.data(), true))
+        return send_str("E03");
+
+    return send_str("OK");
+}
+
 bool Rsp::decode(char* data, size_t len)
 {
     this->top->trace.msg(vp::trace::LEVEL_TRACE, "Received packet (text: '%s', len: %ld)\n", data, len);
@@ -560,6 +629,12 @@ bool Rsp::decode(char* data, size_t len)
         case 'X':
             return this->mem_write(&data[1], len-1);
 
+        case 'm':
+            return this->mem_read(&data[1], len-1);
+
+        case 'M':
+            return this->mem_write_ascii(&data[1], len-1);
+
         case 'p':
             return this->reg_read(&data[1], len-1);
 
@@ -585,12 +660,6 @@ bool Rsp::decode(char* data, size_t len)
         case 'S':
         return step(&data[0], len);
 
-        case 'm':
-        return mem_read(&data[1], len-1);
-
-        case 'M':
-        return mem_write_ascii(&data[1], len-1);
-
         case 'z':
         return bp_remove(&data[0], len);
 
@@ -48,6 +48,8 @@ private:
     bool multithread(char *data, size_t len);
     bool regs_send();
     bool mem_write(char *data, size_t len);
+    bool mem_read(char *data, size_t len);
+    bool mem_write_ascii(char *data, size_t len);
     bool reg_read(char *data, size_t);
     bool reg_write(char *data, size_t);
 
@@ -56,7 +56,6 @@ public:
 class MapEntry {
 public:
   MapEntry() {}
-  MapEntry(unsigned long long base, MapEntry *left, MapEntry *right);
 
   void insert(router *router);
 
@@ -64,14 +63,11 @@ public:
   MapEntry *next = NULL;
   int id = -1;
   unsigned long long base = 0;
-  unsigned long long lowestBase = 0;
   unsigned long long size = 0;
   unsigned long long remove_offset = 0;
   unsigned long long add_offset = 0;
   uint32_t latency = 0;
   int64_t next_packet_time = 0;
-  MapEntry *left = NULL;
-  MapEntry *right = NULL;
   vp::io_slave *port = NULL;
   vp::io_master *itf = NULL;
 };
@@ -96,6 +92,8 @@ public:
   std::string handle_command(Gv_proxy *proxy, FILE *req_file, FILE *reply_file, std::vector<std::string> args, std::string req);
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi);
+  static void dmi_invalidate(void *__this);
 
 
   static void grant(void *_this, vp::io_req *req);
@@ -110,10 +108,14 @@ private:
   bool init = false;
 
   void init_entries();
+  MapEntry *get_entry(uint64_t offset, uint64_t size);
   MapEntry *firstMapEntry = NULL;
+  // Bases of the entries of firstMapEntry sorted by address, and the
+  // corresponding entries, used for the lookup
+  std::vector<uint64_t> entry_bases;
+  std::vector<MapEntry *> entries;
   MapEntry *defaultMapEntry = NULL;
   MapEntry *errorMapEntry = NULL;
-  MapEntry *topMapEntry = NULL;
   MapEntry *externalBindingMapEntry = NULL;
 
   std::map<int, Perf_counter *> counters;
@@ -129,13 +131,8 @@ router::router(js::config *config)
 
 }
 
-MapEntry::MapEntry(unsigned long long base, MapEntry *left, MapEntry *right) : next(NULL), base(base), lowestBase(left->lowestBase), left(left), right(right) {
-}
-
 void MapEntry::insert(router *router)
 {
-  lowestBase = base;
-
   if (size != 0) {
     if (port != NULL || itf != NULL) {    
       MapEntry *current = router->firstMapEntry;
@@ -182,33 +179,12 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   int count = 0;
   while (size)
   {
-    MapEntry *entry = _this->topMapEntry;
     bool isRead = !req->get_is_write();
 
     _this->trace.msg(vp::trace::LEVEL_TRACE, "Received IO req (offset: 0x%llx, size: 0x%llx, isRead: %d, bandwidth: %d)\n",
         offset, size, isRead, _this->bandwidth);
 
-    if (entry)
-    {
-      while(1) {
-      // The entry does not have any child, this means we are at a final entry
-        if (entry->left == NULL) break;
-
-        if (offset >= entry->base) entry = entry->right;
-        else entry = entry->left;
-      }
-
-      if (entry && (offset < entry->base || offset > entry->base + entry->size - 1)) {
-        entry = NULL;
-      }
-    }
-
-    if (!entry) {
-      if (_this->errorMapEntry && offset >= _this->errorMapEntry->base && offset + size - 1 <= _this->errorMapEntry->base + _this->errorMapEntry->size - 1) {
-      } else {
-        entry = _this->defaultMapEntry;
-      }
-    }
+    MapEntry *entry = _this->get_entry(offset, size);
 
     if (!entry) {
       //_this->trace.msg(&warning, "Invalid access (offset: 0x%llx, size: 0x%llx, isRead: %d)\n", offset, size, isRead);
@@ -329,6 +305,102 @@ vp::io_req_status_e router::req(void *__this, vp::io_req *req)
   return result;
 }
 
+MapEntry *router::get_entry(uint64_t offset, uint64_t size)
+{
+  MapEntry *entry = NULL;
+  int nb_entries = this->entry_bases.size();
+
+  if (nb_entries)
+  {
+    // Branchless binary search of the last entry whose base is lower or equal
+    // to the offset, the loop only depends on the number of entries
+    const uint64_t *bases = this->entry_bases.data();
+    const uint64_t *base = bases;
+    while (nb_entries > 1) {
+      int half = nb_entries / 2;
+      base = base[half] <= offset ? base + half : base;
+      nb_entries -= half;
+    }
+
+    if (*base <= offset) {
+      entry = this->entries[base - bases];
+      if (offset > entry->base + entry->size - 1) entry = NULL;
+    }
+  }
+
+  if (!entry) {
+    if (this->errorMapEntry && offset >= this->errorMapEntry->base && offset + size - 1 <= this->errorMapEntry->base + this->errorMapEntry->size - 1) {
+    } else {
+      entry = this->defaultMapEntry;
+    }
+  }
+
+  return entry;
+}
+
+bool router::dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi)
+{
+  router *_this = (router *)__this;
+
+  if (!_this->init)
+  {
+    _this->init = true;
+    _this->init_entries();
+  }
+
+  uint64_t offset = req->get_addr();
+  MapEntry *entry = _this->get_entry(offset, 1);
+
+  // Only give grants for normal entries with a fixed latency and no counters,
+  // everything else needs the request to go through the router.
+  // The default entry is also excluded as the granted range could overlap
+  // other entries.
+  if (!entry || entry == _this->defaultMapEntry || _this->bandwidth != 0 || entry->id != -1)
+    return false;
+
+  uint64_t target_offset = offset;
+  if (entry->remove_offset) target_offset = offset - entry->remove_offset;
+  if (entry->add_offset) target_offset = offset + entry->add_offset;
+
+  req->set_addr(target_offset);
+  bool granted = false;
+  if (entry->port)
+  {
+    granted = _this->out.dmi_req(req, dmi, entry->port);
+  }
+  else if (entry->itf && entry->itf->is_bound())
+  {
+    granted = entry->itf->dmi_req(req, dmi);
+  }
+  req->set_addr(offset);
+
+  if (!granted)
+    return false;
+
+  // Move the grant back to our address space and restrict it to the entry
+  int64_t delta = offset - target_offset;
+  int64_t base = dmi->base + delta;
+  int64_t end = base + dmi->size;
+  if (base < (int64_t)entry->base) base = entry->base;
+  if (end > (int64_t)(entry->base + entry->size)) end = entry->base + entry->size;
+
+  dmi->base = base;
+  dmi->size = end - base;
+  dmi->origin += delta;
+  dmi->latency += entry->latency + _this->latency;
+
+  _this->trace.msg(vp::trace::LEVEL_DEBUG, "Granting direct memory access (base: 0x%llx, size: 0x%llx, target: %s)\n",
+    dmi->base, dmi->size, entry->target_name.c_str());
+
+  return true;
+}
+
+void router::dmi_invalidate(void *__this)
+{
+  router *_this = (router *)__this;
+  _this->in.dmi_invalidate();
+}
+
 void router::grant(void *__this, vp::io_req *req)
 {
   router *_this = (router *)__this;
@@ -398,10 +470,12 @@ int router::build()
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&router::req);
+  in.set_dmi_meth(&router::dmi_req);
   new_slave_port("input", &in);
 
   out.set_resp_meth(&router::response);
   out.set_grant_meth(&router::grant);
+  out.set_dmi_invalidate_meth(&router::dmi_invalidate);
   new_master_port("out", &out);
 
   bandwidth = get_config_int("bandwidth");
@@ -425,6 +499,7 @@ int router::build()
 
       itf->set_resp_meth(&router::response);
       itf->set_grant_meth(&router::grant);
+      itf->set_dmi_invalidate_meth(&router::dmi_invalidate);
       new_master_port(mapping.first, itf);
 
       if (mapping.first == "error")
@@ -503,52 +578,14 @@ void router::init_entries() {
     trace.msg(vp::trace::LEVEL_INFO, "       -     :      -     -> %s\n", defaultMapEntry->target_name.c_str());
   }
 
-  MapEntry *firstInLevel = firstMapEntry;
-
-  // Loop until we merged everything into a single entry
-  // Start with the routing table entries
-  current = firstMapEntry;
-
-  // The first loop is here to loop until we have merged everything to a single entry
-  while(1) {
-
-    // Gives the map entry that should be on the left side of the next created entry
-    MapEntry *left = NULL;
-
-    // Gives the last allocated entry where the entry should be inserted
-    MapEntry *currentInLevel=NULL;
-
-    // The second loop is iterating on a single level to merge entries 2 by 2
-    while(current) {
-      if (left == NULL) left = current;
-      else {
-
-        MapEntry *entry = new MapEntry(current->lowestBase, left, current);
-
-        left = NULL;
-        if (currentInLevel) {
-          currentInLevel->next = entry;
-        } else {
-          firstInLevel = entry;
-        }
-        currentInLevel = entry;
-      }
-
-      current = current->next;
-    }
-
-    current = firstInLevel;
-
-    // Stop in case we got a single entry
-    if (currentInLevel == NULL) break;
-
-    // In case an entry is alone, insert it at the end, it will be merged with an upper entry
-    if (left != NULL) {
-      currentInLevel->next = left;
-    }
+  // Flatten the sorted list of entries into arrays so that the lookup is a
+  // binary search over contiguous bases
+  this->entry_bases.clear();
+  this->entries.clear();
+  for (current = firstMapEntry; current; current = current->next) {
+    this->entry_bases.push_back(current->base);
+    this->entries.push_back(current);
   }
-
-  topMapEntry = firstInLevel;
 }
 
 inline void io_master_map::bind_to(vp::port *_port, vp::config *config)
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/time/time_scheduler.hpp>
+#include <stdio.h>
+
+// Bridge between components which may be executed by different time partitions
+// in parallel mode.
+// The input side is clocked by the bridge clock and the output side by the out_clock
+// one, and each side is executed by the partition of its clock.
+// Requests and responses are always delivered to the other side after a fixed
+// latency, in picoseconds, which gives the lookahead used to synchronize the
+// partitions. The same latency is applied when the engine is not in parallel mode,
+// so that the timing is the same in both modes.
+
+class sync_bridge;
+
+// One side of the bridge, executed by the partition of the components connected
+// on this side
+class sync_bridge_side : public vp::time_scheduler
+{
+public:
+  sync_bridge_side(sync_bridge *top, std::string name, vp::time_event_meth_t *meth);
+
+  // Called from the other side to get the request delivered on this side at the
+  // specified time
+  void send(vp::io_req *req, int64_t time);
+
+  // Called once partitions are synchronized to deliver the requests received
+  // during the window
+  void flush();
+
+private:
+  void deliver(vp::io_req *req, int64_t time);
+
+  sync_bridge *top;
+  vp::time_event_meth_t *meth;
+  // Requests sent during the current window in parallel mode, with their delivery time
+  std::vector<std::pair<vp::io_req *, int64_t>> mailbox;
+};
+
+
+class sync_bridge : public vp::component, public vp::time_sync_channel
+{
+  friend class sync_bridge_side;
+
+public:
+
+  sync_bridge(js::config *config);
+
+  int build();
+
+  void start();
+
+  void sync();
+
+private:
+
+  static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static void grant(void *__this, vp::io_req *req);
+  static void response(void *__this, vp::io_req *req);
+
+  static void out_clk_reg(vp::component *__this, vp::component *clock);
+
+  static void req_handler(void *__this, vp::time_event *event);
+  static void resp_handler(void *__this, vp::time_event *event);
+
+  void send_resp(vp::io_req *req, vp::io_req_status_e status);
+
+  vp::trace trace;
+
+  vp::io_slave in;
+  vp::io_master out;
+  vp::clk_slave out_clock_itf;
+
+  vp::component *out_clock;
+
+  int64_t latency;
+  bool parallel;
+
+  sync_bridge_side *in_side;
+  sync_bridge_side *out_side;
+};
+
+
+sync_bridge_side::sync_bridge_side(sync_bridge *top, std::string name, vp::time_event_meth_t *meth)
+  : vp::time_scheduler(NULL), top(top), meth(meth)
+{
+  this->engine = (vp::time_engine*)top->get_service("time");
+
+  this->build_instance(name, top);
+}
+
+void sync_bridge_side::deliver(vp::io_req *req, int64_t time)
+{
+  vp::time_event *event = new vp::time_event(this, this->top, this->meth);
+  event->get_args()[0] = req;
+  this->enqueue(event, time - this->get_time());
+}
+
+void sync_bridge_side::send(vp::io_req *req, int64_t time)
+{
+  // In parallel mode, this side may be executing in another thread, the request
+  // is just kept until the partitions are synchronized
+  if (this->top->parallel)
+  {
+    this->mailbox.push_back(std::make_pair(req, time));
+  }
+  else
+  {
+    this->deliver(req, time);
+  }
+}
+
+void sync_bridge_side::flush()
+{
+  for (auto &item: this->mailbox)
+  {
+    this->deliver(item.first, item.second);
+  }
+  this->mailbox.clear();
+}
+
+
+sync_bridge::sync_bridge(js::config *config)
+: vp::component(config)
+{
+}
+
+vp::io_req_status_e sync_bridge::req(void *__this, vp::io_req *req)
+{
+  sync_bridge *_this = (sync_bridge *)__this;
+
+  _this->trace.msg("Received IO req (req: %p, offset: 0x%llx, size: 0x%llx, is_write: %d)\n",
+    req, req->get_addr(), req->get_size(), req->get_is_write());
+
+  // Debug requests are only done while the engine is stopped, they can directly
+  // go to the other side
+  if (req->is_debug())
+  {
+    return _this->out.req_forward(req);
+  }
+
+  req->arg_push(req->resp_port);
+  _this->out_side->send(req, _this->in_side->get_time() + _this->latency);
+
+  return vp::IO_REQ_PENDING;
+}
+
+void sync_bridge::req_handler(void *__this, vp::time_event *event)
+{
+  sync_bridge *_this = (sync_bridge *)__this;
+  vp::io_req *req = (vp::io_req *)event->get_args()[0];
+
+  _this->out_side->time_event_del(event);
+
+  _this->trace.msg("Forwarding IO req (req: %p)\n", req);
+
+  // The request is not sent from a clock engine, the one of the target may have
+  // been left behind
+  _this->out_side->get_clock()->sync();
+
+  vp::io_req_status_e status = _this->out.req(req);
+
+  // Otherwise the response comes later through the response callback
+  if (status == vp::IO_REQ_OK || status == vp::IO_REQ_INVALID)
+  {
+    _this->send_resp(req, status);
+  }
+}
+
+void sync_bridge::send_resp(vp::io_req *req, vp::io_req_status_e status)
+{
+  req->status = status;
+  this->in_side->send(req, this->out_side->get_time() + this->latency);
+}
+
+void sync_bridge::grant(void *__this, vp::io_req *req)
+{
+}
+
+void sync_bridge::response(void *__this, vp::io_req *req)
+{
+  sync_bridge *_this = (sync_bridge *)__this;
+  _this->send_resp(req, vp::IO_REQ_OK);
+}
+
+void sync_bridge::resp_handler(void *__this, vp::time_event *event)
+{
+  sync_bridge *_this = (sync_bridge *)__this;
+  vp::io_req *req = (vp::io_req *)event->get_args()[0];
+
+  _this->in_side->time_event_del(event);
+
+  _this->trace.msg("Sending IO resp (req: %p)\n", req);
+
+  _this->in_side->get_clock()->sync();
+
+  vp::io_slave *port = (vp::io_slave *)req->arg_pop();
+  port->resp(req);
+}
+
+void sync_bridge::out_clk_reg(vp::component *__this, vp::component *clock)
+{
+  sync_bridge *_this = (sync_bridge *)__this;
+  _this->out_clock = clock;
+}
+
+void sync_bridge::sync()
+{
+  this->in_side->flush();
+  this->out_side->flush();
+}
+
+int sync_bridge::build()
+{
+  traces.new_trace("trace", &trace, vp::DEBUG);
+
+  in.set_req_meth(&sync_bridge::req);
+  new_slave_port("input", &in);
+
+  out.set_resp_meth(&sync_bridge::response);
+  out.set_grant_meth(&sync_bridge::grant);
+  new_master_port("out", &out);
+
+  out_clock_itf.set_reg_meth(&sync_bridge::out_clk_reg);
+  new_slave_port("out_clock", &out_clock_itf);
+
+  this->latency = get_config_int("latency");
+
+  this->in_side = new sync_bridge_side(this, "in_side", &sync_bridge::resp_handler);
+  this->out_side = new sync_bridge_side(this, "out_side", &sync_bridge::req_handler);
+
+  // The output port belongs to the output side, so that the frequency domain crossing
+  // with the target is computed with the output clock
+  this->out.set_owner(this->out_side);
+
+  vp::time_engine *engine = this->get_time_engine();
+  this->parallel = engine->is_parallel();
+  if (this->parallel)
+  {
+    engine->register_sync_channel(this, this->latency);
+  }
+
+  return 0;
+}
+
+void sync_bridge::start()
+{
+  // The bridge clock has been propagated to both sides, the output side must now be
+  // moved to its own clock
+  vp::component_clock::clk_reg(this->out_side, this->out_clock);
+
+  this->in_side->set_partition(this->get_clock()->get_partition());
+  this->out_side->set_partition(this->out_side->get_clock()->get_partition());
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+  return new sync_bridge(config);
+}
@@ -22,6 +22,7 @@
 #include <vp/vp.hpp>
 #include <vp/itf/io.hpp>
 #include <vp/itf/wire.hpp>
+#include <vp/checkpoint.hpp>
 #include <stdio.h>
 #include <string.h>
 
@@ -35,12 +36,16 @@ public:
   int build();
   void start();
   void reset(bool active);
+  void checkpoint_save(vp::checkpoint *checkpoint);
+  void checkpoint_restore(vp::checkpoint *checkpoint);
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
+  static bool dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi);
 
 private:
 
   static void power_ctrl_sync(void *__this, bool value);
+  void power_trace_callback();
 
   vp::trace     trace;
   vp::io_slave in;
@@ -51,6 +56,8 @@ private:
 
   uint8_t *mem_data;
   uint8_t *check_mem;
+  // True when the data is mapped from a checkpoint instead of being allocated
+  bool mem_data_mapped = false;
 
   int64_t next_packet_start;
 
@@ -176,11 +183,40 @@ vp::io_req_status_e memory::req(void *__this, vp::io_req *req)
     }
     if (data)
       memcpy((void *)data, (void *)&_this->mem_data[offset], size);
+    req->set_memory();
   }
 
   return vp::IO_REQ_OK;
 }
 
+bool memory::dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi)
+{
+  memory *_this = (memory *)__this;
+
+  // Direct accesses bypass everything done in req, so the grant is only given
+  // when the accesses have no side effect apart from the copy.
+  // Memories with bandwidth modeling, like the TCDM banks, never grant as the
+  // accesses would not be delayed anymore.
+  if (!_this->powered_up || _this->check_mem || _this->width_bits != 0 || _this->power_trigger ||
+    _this->power.get_power_trace()->get_active())
+  {
+    return false;
+  }
+
+  _this->trace.msg("Granting direct memory access (size: 0x%x)\n", _this->size);
+
+  dmi->base = 0;
+  dmi->size = _this->size;
+  dmi->origin = 0;
+  dmi->latency = 0;
+  dmi->data = _this->mem_data;
+  dmi->banks.clear();
+  dmi->bank_bits = 0;
+  dmi->word_bits = 0;
+
+  return true;
+}
+
 void memory::reset(bool active)
 {
   if (active)
@@ -188,12 +224,62 @@ void memory::reset(bool active)
     this->next_packet_start = 0;
     this->powered_up = true;
   }
+
+  // Masters must ask again for direct accesses, as the memory may have been down
+  this->in.dmi_invalidate();
+}
+
+void memory::checkpoint_save(vp::checkpoint *checkpoint)
+{
+  checkpoint->save(this, "data", this->mem_data, this->size);
+  if (this->check_mem)
+  {
+    checkpoint->save(this, "check", this->check_mem, (this->size + 7) / 8);
+  }
+  checkpoint->save(this, "next_packet_start", &this->next_packet_start, sizeof(this->next_packet_start));
+  checkpoint->save(this, "powered_up", &this->powered_up, sizeof(this->powered_up));
+}
+
+void memory::checkpoint_restore(vp::checkpoint *checkpoint)
+{
+  // The data is used directly from the checkpoint file mapping, so that only the pages
+  // modified by the simulation are copied
+  uint8_t *data = checkpoint->map(this, "data", this->size);
+  if (data)
+  {
+    if (!this->mem_data_mapped)
+    {
+      delete[] this->mem_data;
+    }
+    this->mem_data = data;
+    this->mem_data_mapped = true;
+  }
+
+  if (this->check_mem)
+  {
+    checkpoint->restore(this, "check", this->check_mem, (this->size + 7) / 8);
+  }
+  checkpoint->restore(this, "next_packet_start", &this->next_packet_start, sizeof(this->next_packet_start));
+  checkpoint->restore(this, "powered_up", &this->powered_up, sizeof(this->powered_up));
+
+  // Direct accesses were granted on the previous data
+  this->in.dmi_invalidate();
 }
 
 void memory::power_ctrl_sync(void *__this, bool value)
 {
     memory *_this = (memory *)__this;
     _this->powered_up = value;
+    // Direct accesses must stop while the memory is down, and must be asked again
+    // after it is up
+    _this->in.dmi_invalidate();
+}
+
+void memory::power_trace_callback()
+{
+  // Direct accesses would not account power, so they must stop as soon as the
+  // power trace is enabled, and can be asked again once it is disabled
+  this->in.dmi_invalidate();
 }
 
 
@@ -201,6 +287,7 @@ int memory::build()
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
   in.set_req_meth(&memory::req);
+  in.set_dmi_meth(&memory::dmi_req);
   new_slave_port("input", &in);
 
   this->power_ctrl_itf.set_sync_meth(&memory::power_ctrl_sync);
@@ -217,6 +304,8 @@ int memory::build()
   power.new_power_source("write_16", &write_16_power, this->get_js_config()->get("**/write_16"));
   power.new_power_source("write_32", &write_32_power, this->get_js_config()->get("**/write_32"));
 
+  this->power.get_power_trace()->register_callback(std::bind(&memory::power_trace_callback, this));
+
   return 0;
 }
 
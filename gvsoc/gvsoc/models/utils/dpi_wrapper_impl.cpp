@@ -649,12 +649,7 @@ extern "C" void dpi_cpi_edge(void *handle, int pclk, int href, int vsync, int da
 extern "C" void dpi_print(void *data, const char *msg)
 {
   dpi_wrapper *_this = (dpi_wrapper *)data;
-  int len = strlen(msg);
-  char buff[len + 2];
-  strcpy(buff, msg);
-  buff[len] = '\n';
-  buff[len + 1] = 0;
-  _this->get_trace()->msg(buff);
+  _this->get_trace()->msg("%s\n", msg);
 }
 
 extern "C" void *dpi_trace_new(void *data, const char *name)
@@ -35,9 +35,12 @@ public:
 
   static vp::io_req_status_e req(void *__this, vp::io_req *req);
   static vp::io_req_status_e req_ts(void *__this, vp::io_req *req);
-
+  static bool dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi);
+  static void dmi_invalidate(void *__this);
 
 private:
+  vp::io_req_status_e req_split(vp::io_req *req);
+
   vp::trace     trace;
 
   vp::io_master **out;
@@ -51,6 +54,7 @@ private:
   int stage_bits;
   uint64_t bank_mask;
   vp::io_req ts_req;
+  vp::io_dmi bank_dmi;
 };
 
 interleaver::interleaver(js::config *config)
@@ -69,6 +73,11 @@ vp::io_req_status_e interleaver::req(void *__this, vp::io_req *req)
 
   _this->trace.msg("Received IO req (offset: 0x%llx, size: 0x%llx, is_write: %d)\n", offset, size, is_write);
  
+  if ((offset & 0x3) + size > 4)
+  {
+    return _this->req_split(req);
+  }
+
   int bank_id = (offset >> 2) & _this->bank_mask;
   uint64_t bank_offset = ((offset >> (_this->stage_bits + 2)) << 2) + (offset & 0x3);
 
@@ -76,6 +85,55 @@ vp::io_req_status_e interleaver::req(void *__this, vp::io_req *req)
   return _this->out[bank_id]->req_forward(req);
 }
 
+// Requests crossing a word boundary, like debug accesses, are split into one
+// request per word, each one going to its own bank
+vp::io_req_status_e interleaver::req_split(vp::io_req *req)
+{
+  uint64_t offset = req->get_addr();
+  uint64_t size = req->get_size();
+  uint8_t *data = req->get_data();
+
+  uint64_t init_offset = offset;
+  uint64_t init_size = size;
+  uint8_t *init_data = data;
+
+  while (size)
+  {
+    uint64_t loop_size = 4 - (offset & 0x3);
+    if (loop_size > size) loop_size = size;
+
+    int bank_id = (offset >> 2) & this->bank_mask;
+    uint64_t bank_offset = ((offset >> (this->stage_bits + 2)) << 2) + (offset & 0x3);
+
+    this->trace.msg("Forwarding word (bank: %d, offset: 0x%llx, size: 0x%llx)\n", bank_id, bank_offset, loop_size);
+
+    req->set_addr(bank_offset);
+    req->set_size(loop_size);
+    req->set_data(data);
+
+    // The banks reply synchronously, a pending reply can only be handled for the
+    // last word
+    vp::io_req_status_e err = this->out[bank_id]->req_forward(req);
+    if (err != vp::IO_REQ_OK)
+    {
+      if (err == vp::IO_REQ_PENDING && size == loop_size)
+        return vp::IO_REQ_PENDING;
+      return vp::IO_REQ_INVALID;
+    }
+
+    size -= loop_size;
+    offset += loop_size;
+    if (data)
+      data += loop_size;
+  }
+
+  req->set_addr(init_offset);
+  req->set_size(init_size);
+  req->set_data(init_data);
+
+  return vp::IO_REQ_OK;
+}
+
 vp::io_req_status_e interleaver::req_ts(void *__this, vp::io_req *req)
 {
   interleaver *_this = (interleaver *)__this;
@@ -109,12 +167,73 @@ vp::io_req_status_e interleaver::req_ts(void *__this, vp::io_req *req)
   return _this->out[bank_id]->req_forward(req);
 }
 
+bool interleaver::dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi)
+{
+  interleaver *_this = (interleaver *)__this;
+  uint64_t offset = req->get_addr();
+
+  if (_this->nb_slaves != (1 << _this->stage_bits))
+    return false;
+
+  // The grant covers all the banks, so every bank must give a grant for its
+  // whole memory, with the same size and latency, so that the address can be
+  // converted to a bank pointer without going through the banks.
+  dmi->banks.resize(_this->nb_slaves);
+
+  for (int i=0; i<_this->nb_slaves; i++)
+  {
+    vp::io_dmi *bank_dmi = &_this->bank_dmi;
+
+    req->set_addr(0);
+    bool granted = _this->out[i]->dmi_req(req, bank_dmi);
+    req->set_addr(offset);
+
+    if (!granted || bank_dmi->data == NULL || bank_dmi->base != 0 || bank_dmi->origin != 0)
+      return false;
+
+    if (i == 0)
+    {
+      dmi->size = bank_dmi->size;
+      dmi->latency = bank_dmi->latency;
+    }
+    else if (bank_dmi->size != dmi->size || bank_dmi->latency != dmi->latency)
+    {
+      return false;
+    }
+
+    dmi->banks[i] = bank_dmi->data;
+  }
+
+  dmi->base = 0;
+  dmi->size *= _this->nb_slaves;
+  dmi->origin = 0;
+  dmi->data = NULL;
+  dmi->bank_bits = _this->stage_bits;
+  dmi->word_bits = 2;
+
+  _this->trace.msg("Granting direct memory access (size: 0x%llx)\n", dmi->size);
+
+  return true;
+}
+
+void interleaver::dmi_invalidate(void *__this)
+{
+  interleaver *_this = (interleaver *)__this;
+
+  _this->in.dmi_invalidate();
+  for (int i=0; i<_this->nb_masters; i++)
+  {
+    _this->masters_in[i]->dmi_invalidate();
+  }
+}
+
 int interleaver::build()
 {
 
   traces.new_trace("trace", &trace, vp::DEBUG);
 
   in.set_req_meth(&interleaver::req);
+  in.set_dmi_meth(&interleaver::dmi_req);
   new_slave_port("in", &in);
 
   nb_slaves = get_config_int("nb_slaves");
@@ -132,6 +251,7 @@ int interleaver::build()
   for (int i=0; i<nb_slaves; i++)
   {
     out[i] = new vp::io_master();
+    out[i]->set_dmi_invalidate_meth(&interleaver::dmi_invalidate);
     new_master_port("out_" + std::to_string(i), out[i]);
   }
 
@@ -141,6 +261,7 @@ int interleaver::build()
   {
     masters_in[i] = new vp::io_slave();
     masters_in[i]->set_req_meth(&interleaver::req);
+    masters_in[i]->set_dmi_meth(&interleaver::dmi_req);
     new_slave_port("in_" + std::to_string(i), masters_in[i]);
 
     masters_ts_in[i] = new vp::io_slave();
@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -203,6 +204,9 @@ private:
   void send_req_to_ext(Mchan_cmd *cmd, vp::io_req *req);
   void handle_ext_write_req_end(Mchan_cmd *cmd, vp::io_req *req);
   void cmd_start(int cmd_id);
+  void loc_transfer_fast();
+  void loc_copy(uint32_t addr, uint8_t *data, uint32_t size, bool is_write);
+  int64_t loc_duration(uint32_t addr, uint32_t size, int nb_ports);
 
   // Can be called after an external request has been done in order to schedule the next step
   // depending on request latency
@@ -220,6 +224,12 @@ private:
   int nb_loc_ports;
   int tcdm_addr_width;
 
+  // In fast mode, transfers are done per line instead of per burst, and the local part is
+  // done in one shot instead of word per word
+  bool fast_mode;
+  // Maximum size of requests sent to the external interface
+  int burst_length;
+
   int nb_pending_ext_read_req;
   int nb_pending_ext_write_req;
   uint32_t free_counter_mask;
@@ -636,36 +646,6 @@ mchan::mchan(js::config *config)
   loc_itf = new vp::io_master[nb_loc_ports];
   loc_port_ready_cycle = new int64_t[nb_loc_ports];
 
-  for (int i=0; i<max_nb_ext_read_req; i++)
-  {
-    vp::io_req *req = new vp::io_req();
-    // Allocate 3 arguments to store local port address, command, size done and timestamp
-    req->init();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->set_data(new uint8_t[max_burst_length]);
-    req->set_is_write(false);
-    req->set_next(first_ext_read_req);
-    first_ext_read_req = req;
-  }
-
-  for (int i=0; i<max_nb_ext_write_req; i++)
-  {
-    vp::io_req *req = new vp::io_req();
-    // Allocate 3 arguments to store local port address, command, size done and timestamp
-    req->init();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->arg_alloc();
-    req->set_data(new uint8_t[max_burst_length]);
-    req->set_is_write(true);
-    req->set_next(first_ext_write_req);
-    first_ext_write_req = req;
-  }
-
   ext_itf.set_resp_meth(&mchan::ext_response);
   ext_itf.set_grant_meth(&mchan::ext_grant);
   new_master_port("ext_itf", &ext_itf);
@@ -803,6 +783,8 @@ void mchan::move_to_global_queue(bool read_queue)
 
 void mchan::push_req_to_loc(vp::io_req *req)
 {
+  // Keep when the request was received for the fast mode
+  *(int64_t *)req->arg_get(3) = this->get_cycles();
   pending_write_reqs->push(req);
 }
 
@@ -892,8 +874,8 @@ void mchan::send_loc_read_req()
   Mchan_cmd *cmd = current_ext_write_cmd;
 
   int size = cmd->is_2d ? cmd->line_size_to_read : cmd->size_to_read;
-  if (size > max_burst_length)
-    size = max_burst_length;
+  if (size > burst_length)
+    size = burst_length;
 
   nb_pending_ext_write_req++;
 
@@ -939,8 +921,8 @@ void mchan::send_req()
   Mchan_cmd *cmd = current_ext_read_cmd;
 
   int size = cmd->is_2d ? cmd->line_size_to_read : cmd->size_to_read;
-  if (size > max_burst_length)
-    size = max_burst_length;
+  if (size > burst_length)
+    size = burst_length;
 
   nb_pending_ext_read_req++;
 
@@ -1124,10 +1106,150 @@ void mchan::ext_req_handler(void *__this, vp::clock_event *event)
   _this->check_queue();
 }
 
+// Transfer data with the local memory in one shot, with direct accesses when the memory allows
+// it, otherwise with one request per word
+void mchan::loc_copy(uint32_t addr, uint8_t *data, uint32_t size, bool is_write)
+{
+  vp::io_req *req = &this->loc_req[0];
+  vp::io_dmi dmi;
+
+  req->init();
+  req->set_addr(addr);
+  req->set_size(size);
+  req->set_is_write(is_write);
+  bool use_dmi = this->loc_itf[0].dmi_req(req, &dmi) && dmi.contains(addr, size);
+
+  while (size > 0)
+  {
+    uint32_t chunk = 4 - (addr & 0x3);
+    if (use_dmi && dmi.data != NULL) chunk = size;
+    if (chunk > size) chunk = size;
+
+    uint8_t *host_ptr = use_dmi ? dmi.get_host_ptr(addr, chunk) : NULL;
+    if (host_ptr)
+    {
+      if (is_write)
+        memcpy(host_ptr, data, chunk);
+      else
+        memcpy(data, host_ptr, chunk);
+    }
+    else
+    {
+      req->init();
+      req->set_addr(addr);
+      req->set_size(chunk);
+      req->set_is_write(is_write);
+      req->set_data(data);
+
+      // As for the cycle-level mode, the local memory is assumed to be synchronous
+      vp::io_req_status_e err = this->loc_itf[0].req(req);
+      if (err != vp::IO_REQ_OK)
+      {
+        this->trace.force_warning("Got error during local transfer (addr: 0x%x, size: 0x%x, status: %d)\n", addr, chunk, err);
+      }
+    }
+
+    addr += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+// Number of cycles taken by the local ports to transfer data word per word
+int64_t mchan::loc_duration(uint32_t addr, uint32_t size, int nb_ports)
+{
+  int64_t nb_words = ((addr & 0x3) + size + 3) / 4;
+  return (nb_words + nb_ports - 1) / nb_ports;
+}
+
+// Fast mode version of the local transfers. Each request is handled in 2 steps, first the data
+// is copied and the ports are kept busy for the time they would take to transfer it word per word,
+// then once they are available again, the request goes to the next step as in the cycle-level mode.
+void mchan::loc_transfer_fast()
+{
+  int64_t cycles = this->get_cycles();
+
+  // As for the cycle-level mode, the first 2 ports are writing data coming from the external
+  // interface and the other ones are reading data going to it
+  for (int is_write=1; is_write>=0; is_write--)
+  {
+    int first_port = is_write ? 0 : 2;
+    int nb_ports = is_write ? 2 : this->nb_loc_ports - 2;
+    vp::io_req *ext_req = is_write ? this->pending_write_reqs->get_first() : this->pending_loc_read_req;
+
+    if (ext_req == NULL || this->loc_port_ready_cycle[first_port] > cycles)
+      continue;
+
+    uint32_t size = ext_req->get_size();
+    uint32_t done_size = *(uint32_t *)ext_req->arg_get(2);
+    Mchan_cmd *cmd = (Mchan_cmd *)*ext_req->arg_get(0);
+
+    if (done_size == 0)
+    {
+      uint32_t addr = *(uint32_t *)ext_req->arg_get(1);
+
+      this->trace.msg(vp::trace::LEVEL_TRACE, "Transferring %s local data (addr: 0x%x, size: 0x%x)\n",
+        is_write ? "write" : "read", addr, size);
+
+      this->loc_copy(addr, ext_req->get_data(), size, is_write);
+
+      int64_t end_cycle = cycles + this->loc_duration(addr, size, nb_ports);
+
+      if (is_write)
+      {
+        // As the request is as big as a line instead of a burst, the cycle-level mode would
+        // have already written the bursts received during the external request duration, only
+        // the last one is left.
+        int64_t start_cycle = std::max(*(int64_t *)ext_req->arg_get(3) - (int64_t)ext_req->get_duration(),
+          this->loc_port_ready_cycle[first_port]);
+        int64_t burst_size = std::min(size, (uint32_t)this->max_burst_length);
+
+        end_cycle = std::max(start_cycle + this->loc_duration(addr, size, nb_ports),
+          cycles + this->loc_duration(addr + size - burst_size, burst_size, nb_ports));
+      }
+
+      for (int i=first_port; i<first_port + nb_ports; i++)
+      {
+        this->loc_port_ready_cycle[i] = end_cycle;
+      }
+
+      *(uint32_t *)ext_req->arg_get(2) = size;
+    }
+    else if (is_write)
+    {
+      cmd->size_to_write -= size;
+      this->trace.msg(vp::trace::LEVEL_TRACE, "Updating command (size_to_write: %d)\n", cmd->size_to_write);
+      this->account_transfered_bytes(cmd, size);
+      if (cmd->size_to_write == 0)
+      {
+        this->handle_cmd_termination(cmd);
+      }
+
+      this->pending_write_reqs->pop();
+      ext_req->set_next(this->first_ext_read_req);
+      this->first_ext_read_req = ext_req;
+      this->nb_pending_ext_read_req--;
+    }
+    else
+    {
+      this->trace.msg(vp::trace::LEVEL_TRACE, "Finished request\n");
+      this->pending_loc_read_req = NULL;
+      this->send_req_to_ext(cmd, ext_req);
+    }
+  }
+}
+
 void mchan::check_loc_transfer_handler(void *__this, vp::clock_event *event)
 {
   mchan *_this = (mchan *)__this;
 
+  if (_this->fast_mode)
+  {
+    _this->loc_transfer_fast();
+    _this->check_queue();
+    return;
+  }
+
   // Go through the local ports to see if we can send a request from
   // pending commands
   int64_t min_ready_cycle = -1;
@@ -1311,16 +1433,24 @@ void mchan::check_queue()
     }
   }
 
-  if (!pending_write_reqs->is_empty() || pending_loc_read_req != NULL)
+  bool loc_write_pending = !pending_write_reqs->is_empty();
+  bool loc_read_pending = pending_loc_read_req != NULL;
+
+  if (loc_write_pending || loc_read_pending)
   {
     if (!check_loc_transfer_event->is_enqueued())
     {
-      // Go through the port availabilities to see when we can enqueue the event
+      // Go through the port availabilities to see when we can enqueue the event.
+      // Only the ports which have something to transfer are considered, so that we don't
+      // wake-up while they are busy.
       int64_t min_ready_cycle = -1;
       int64_t cycles = get_cycles();
 
       for (int i=0; i<nb_loc_ports; i++)
       {
+        if (i < 2 ? !loc_write_pending : !loc_read_pending)
+          continue;
+
         if ((min_ready_cycle == -1 || loc_port_ready_cycle[i] < min_ready_cycle))
         {
           min_ready_cycle = loc_port_ready_cycle[i];
@@ -1342,6 +1472,41 @@ int mchan::build()
   traces.new_trace("trace", &this->trace, vp::DEBUG);
   new_master_port("busy", &this->busy_itf);
 
+  // The gvsoc options are only reachable once the component is in the hierarchy
+  js::config *fast_mode_config = this->get_vp_config()->get("mchan_fast_mode");
+  fast_mode = get_config_bool("fast_mode") || (fast_mode_config && fast_mode_config->get_bool());
+  burst_length = fast_mode ? MCHAN_CMD_CMD_LEN_MASK + 1 : max_burst_length;
+
+  for (int i=0; i<max_nb_ext_read_req; i++)
+  {
+    vp::io_req *req = new vp::io_req();
+    // Allocate 3 arguments to store local port address, command, size done and timestamp
+    req->init();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->set_data(new uint8_t[burst_length]);
+    req->set_is_write(false);
+    req->set_next(first_ext_read_req);
+    first_ext_read_req = req;
+  }
+
+  for (int i=0; i<max_nb_ext_write_req; i++)
+  {
+    vp::io_req *req = new vp::io_req();
+    // Allocate 3 arguments to store local port address, command, size done and timestamp
+    req->init();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->arg_alloc();
+    req->set_data(new uint8_t[burst_length]);
+    req->set_is_write(true);
+    req->set_next(first_ext_write_req);
+    first_ext_write_req = req;
+  }
+
   for (int i=0; i<nb_channels; i++)
   {
     channels.push_back(new Mchan_channel(i, this));
@@ -107,6 +107,7 @@ class Ne16StreamAccess {
     void reset_iteration();
     int iterate();
     void print_config();
+    void bulk_access(int addr, uint8_t *data, int size, bool is_write);
     int get_base_addr();
     int get_d0_length();
     int get_d0_stride();
@@ -193,6 +194,8 @@ public:
     vp::reg_1 busy;
     Ne16TraceLevel trace_level;
     int trace_format;
+    // jobs are executed in a single event, with one memory request per streamer access
+    bool fast_mode;
 
 private:
 
@@ -240,6 +243,7 @@ private:
     // MAIN FSM and LOOP
     int  fsm();
     void fsm_loop();
+    void fsm_fast_loop();
     //Ne16State state;
 
     // REGISTER FILE member functions
@@ -366,6 +370,7 @@ private:
     void weightoffs();
     void matrixvec_setup();
     int  matrixvec_cycle(uint8_t *, uint32_t, int, int, uint32_t);
+    void matrixvec_fast(uint8_t *);
     void acc_reduction(uint32_t, uint32_t);
     int  fill_weight_buffer(uint8_t *, uint32_t);
     bool matrixvec_exit_idx();
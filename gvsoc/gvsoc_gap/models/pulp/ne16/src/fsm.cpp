@@ -79,7 +79,12 @@ void Ne16::fsm_start_handler(void *__this, vp::clock_event *event) {
     }
 
     omp_set_dynamic(0);
-    _this->fsm_loop();
+    if(_this->fast_mode) {
+        _this->fsm_fast_loop();
+    }
+    else {
+        _this->fsm_loop();
+    }
 }
 
 void Ne16::fsm_handler(void *__this, vp::clock_event *event) {
@@ -118,6 +123,16 @@ void Ne16::fsm_loop() {
   }
 }
 
+// In fast mode, the whole job is executed at once and its end is scheduled after
+// the sum of the latencies of all the FSM steps
+void Ne16::fsm_fast_loop() {
+    int64_t latency = 0;
+    do {
+        latency += this->fsm();
+    } while(state.get() != END);
+    this->event_enqueue(this->fsm_end_event, latency);
+}
+
 int Ne16::fsm() {
     auto state_next = this->state.get();
     auto latency = 0;
@@ -314,16 +329,21 @@ int Ne16::fsm() {
       }
       latency += (iter+((!this->depthwise) ? 6:0));
 
-      N = (iter >= 8) ? 4 : 1;
-
-      #pragma omp parallel for num_threads(N)
-      for (uint16_t i=0; i<iter; i++) {
-          this->matrixvec_cycle(w_buffer, (i<<5), (i % this->mv_qw_lim), (i / this->mv_qw_lim), i*9);
-          if(this->psum_block_traces) {
-              this->debug_psum_block();
-          }
-          if(this->accum_traces) {
-              this->debug_accum();
+      if(this->fast_mode && !this->mode_linear) {
+          this->matrixvec_fast(w_buffer);
+      }
+      else {
+          N = (iter >= 8) ? 4 : 1;
+
+          #pragma omp parallel for num_threads(N) if(!this->fast_mode)
+          for (uint16_t i=0; i<iter; i++) {
+              this->matrixvec_cycle(w_buffer, (i<<5), (i % this->mv_qw_lim), (i / this->mv_qw_lim), i*9);
+              if(this->psum_block_traces) {
+                  this->debug_psum_block();
+              }
+              if(this->accum_traces) {
+                  this->debug_accum();
+              }
           }
       }
 
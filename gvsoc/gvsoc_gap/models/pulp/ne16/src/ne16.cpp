@@ -199,6 +199,9 @@ int Ne16::build()
     this->trace_level = L0_CONFIG;
     this->trace_format = 1;
 
+    js::config *fast_mode_config = this->get_vp_config()->get("ne16_fast_mode");
+    this->fast_mode = fast_mode_config && fast_mode_config->get_bool();
+
     return 0;
 }
 
@@ -374,6 +374,52 @@ int Ne16::matrixvec_cycle(uint8_t *w_buf, uint32_t offset, int mv_qw_iter, int m
     return (int) cycles;
 }
 
+// Fast mode version of the matrix-vector products of the non-linear modes. Instead of
+// going through the weight bits one by one, the bit planes of each output channel are
+// first combined into integer weights, so that each column is a plain dot product
+// between the input bytes and these weights. The result of an output channel is stored
+// in the accumulator buffer slot of its first bit plane and the other slots are cleared,
+// which gives the same sums after the reduction.
+void Ne16::matrixvec_fast(uint8_t *w_buf) {
+    for (auto k=0; k<this->mv_k_out_lim; k++) {
+        int32_t w[9*16] = {0};
+        for (auto q=0; q<this->mv_qw_lim; q++) {
+            uint8_t *src = &w_buf[(k*this->mv_qw_lim+q)<<5];
+            for (auto r=0; r<this->COLUMN_SIZE; r++) {
+                if(this->row_enable[r] == 0) {
+                    continue;
+                }
+                // in 1x1 mode, each row holds one bit plane of the weights
+                auto shift = (this->fs == 1) ? r : q;
+                uint32_t bits = this->mode16 ? src[r] : (src[r*2] | (src[r*2+1] << 8));
+                for (auto j=0; j<16; j++) {
+                    // in 16-bit mode, each weight bit applies to both bytes of an input
+                    auto idx = this->mode16 ? (j >> 1) : j;
+                    auto byte_shift = (this->mode16 && (j & 1)) ? 8 : 0;
+                    w[r*16+j] += ((bits >> idx) & this->mac_enable[idx] & 1) << (shift + byte_shift);
+                }
+            }
+        }
+
+        auto thread_idx = k*this->mv_qw_lim*this->COLUMN_SIZE;
+        for (auto c=0; c<this->NR_COLUMN; c++) {
+            uint8_t *x = &this->x_array[c*this->COLUMN_SIZE*this->TP_IN];
+            int64_t psum_column = 0;
+            for (auto r=0; r<this->COLUMN_SIZE; r++) {
+                int32_t sum = 0;
+                for (auto j=0; j<16; j++) {
+                    sum += w[r*16+j] * x[r*16+j];
+                }
+                psum_column += sum;
+            }
+            this->accum_buffer[thread_idx+c] = psum_column;
+        }
+        for (auto c=this->COLUMN_SIZE; c<this->mv_qw_lim*this->COLUMN_SIZE; c++) {
+            this->accum_buffer[thread_idx+c] = 0;
+        }
+    }
+}
+
 bool Ne16::matrixvec_exit_idx() {
     if((this->mv_k_out_iter == (this->mv_k_out_lim-1)) && (this->mv_qw_iter == (this->mv_qw_lim-1))) {
         return true;
@@ -86,6 +86,30 @@ void Ne16StreamAccess::print_config() {
     // std::cout << "[STREAMER] d2_stride="  << this->d2_stride << std::endl;
 }
 
+// Accesses the whole vector without events, with one request per 4-byte word, as each word of
+// the L1 lives in a different bank. This also never crosses the end of the L1 range.
+void Ne16StreamAccess::bulk_access(int addr, uint8_t *data, int size, bool is_write) {
+    while(size > 0) {
+        auto offset = addr & NE16_STREAM_L1_MASK;
+        int chunk = 4 - (offset & 0x3);
+        if(chunk > size) {
+            chunk = size;
+        }
+        this->ne16->io_req.init();
+        this->ne16->io_req.set_addr(offset);
+        this->ne16->io_req.set_size(chunk);
+        this->ne16->io_req.set_data(data);
+        this->ne16->io_req.set_is_write(is_write);
+        int err = this->ne16->out.req(&this->ne16->io_req);
+        if (err != vp::IO_REQ_OK) {
+            this->ne16->trace.fatal("Unsupported asynchronous reply\n");
+        }
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
 void Ne16StreamAccess::reset_iteration() {
     this->wa = 0;
     this->la = 0;
@@ -153,44 +177,53 @@ Ne16VectorLoad<T>::Ne16VectorLoad() : Ne16StreamAccess((Ne16 *) NULL, 0, 0, 0, 0
     template <class T>
     void Ne16VectorLoad<T>::ex(int width, T* x, int64_t& cycles) {
         auto addr = this->iterate();
-        uint8_t load_data[STREAM_MAX_WIDTH_BYTES];
-        auto width_padded = width + 4;
-        auto addr_padded = addr & ~0x3;
-        auto width_words = width_padded*sizeof(T)/4;
-        auto width_rem   = width_padded*sizeof(T)%4;
         int64_t max_latency = 0;
-        for(auto i=0; i<width_words; i++) {
-            this->ne16->io_req.init();
-            this->ne16->io_req.set_addr(addr_padded+i*4 & NE16_STREAM_L1_MASK);
-            this->ne16->io_req.set_size(4);
-            this->ne16->io_req.set_data(load_data+i*4);
-            this->ne16->io_req.set_is_write(false);
-            int err = this->ne16->out.req(&this->ne16->io_req);
-            if (err == vp::IO_REQ_OK) {
-                int64_t latency = this->ne16->io_req.get_latency();
-                if (latency > max_latency) {
-                    max_latency = latency;
+        if(this->ne16->fast_mode) {
+            // the memory latency is not modeled in fast mode, each access takes one cycle
+            this->bulk_access(addr, (uint8_t *)x, width*sizeof(T), false);
+        }
+        else {
+            uint8_t load_data[STREAM_MAX_WIDTH_BYTES];
+            auto width_padded = width + 4;
+            auto addr_padded = addr & ~0x3;
+            auto width_words = width_padded*sizeof(T)/4;
+            auto width_rem   = width_padded*sizeof(T)%4;
+            for(auto i=0; i<width_words; i++) {
+                this->ne16->io_req.init();
+                this->ne16->io_req.set_addr(addr_padded+i*4 & NE16_STREAM_L1_MASK);
+                this->ne16->io_req.set_size(4);
+                this->ne16->io_req.set_data(load_data+i*4);
+                this->ne16->io_req.set_is_write(false);
+                int err = this->ne16->out.req(&this->ne16->io_req);
+                if (err == vp::IO_REQ_OK) {
+                    int64_t latency = this->ne16->io_req.get_latency();
+                    if (latency > max_latency) {
+                        max_latency = latency;
+                    }
+                }
+                else {
+                    this->ne16->trace.fatal("Unsupported asynchronous reply\n");
                 }
             }
-            else {
-                this->ne16->trace.fatal("Unsupported asynchronous reply\n");
-            }
-        }
-        if(width_rem) {
-            this->ne16->io_req.init();
-            this->ne16->io_req.set_addr(addr_padded+width_words*4 & NE16_STREAM_L1_MASK);
-            this->ne16->io_req.set_size(width_rem);
-            this->ne16->io_req.set_data(load_data+width_words*4);
-            this->ne16->io_req.set_is_write(false);
-            int err = this->ne16->out.req(&this->ne16->io_req);
-            if (err == vp::IO_REQ_OK) {
-                int64_t latency = this->ne16->io_req.get_latency();
-                if (latency > max_latency) {
-                  max_latency = latency;
+            if(width_rem) {
+                this->ne16->io_req.init();
+                this->ne16->io_req.set_addr(addr_padded+width_words*4 & NE16_STREAM_L1_MASK);
+                this->ne16->io_req.set_size(width_rem);
+                this->ne16->io_req.set_data(load_data+width_words*4);
+                this->ne16->io_req.set_is_write(false);
+                int err = this->ne16->out.req(&this->ne16->io_req);
+                if (err == vp::IO_REQ_OK) {
+                    int64_t latency = this->ne16->io_req.get_latency();
+                    if (latency > max_latency) {
+                      max_latency = latency;
+                    }
+                }
+                else {
+                    this->ne16->trace.fatal("Unsupported asynchronous reply\n");
                 }
             }
-            else {
-                this->ne16->trace.fatal("Unsupported asynchronous reply\n");
+            for(auto i=0; i<width; i++) {
+                x[i] = *(T *)(load_data + (addr & 0x3) + i*sizeof(T));
             }
         }
         std::ostringstream stringStream;
@@ -198,9 +231,6 @@ Ne16VectorLoad<T>::Ne16VectorLoad() : Ne16StreamAccess((Ne16 *) NULL, 0, 0, 0, 0
         if (this->ne16->trace_level == L3_ALL) {
             this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "Issuing read request (addr=0x%08x, size=%dB, latency=%d)\n", addr & NE16_STREAM_L1_MASK, width*sizeof(T), cycles+1);
         }
-        for(auto i=0; i<width; i++) {
-            x[i] = *(T *)(load_data + (addr & 0x3) + i*sizeof(T));
-        }
         if (this->ne16->trace_level == L3_ALL) {
             printf ("Read data: \n");
             for (auto i=0; i<width; i++) {
@@ -210,7 +240,7 @@ Ne16VectorLoad<T>::Ne16VectorLoad() : Ne16StreamAccess((Ne16 *) NULL, 0, 0, 0, 0
         }
         string s = stringStream.str();
         if (this->ne16->trace_level == L3_ALL) {
-            this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, s.c_str());
+            this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "%s", s.c_str());
         }
         cycles += max_latency + 1;
 }
@@ -246,7 +276,10 @@ T* Ne16VectorStore<T>::ex(T* data, int width, int64_t& cycles, int32_t enable) {
     }
     auto width_bytes = width*sizeof(T);
     int64_t max_latency = 0;
-    if(enable) {
+    if(enable && this->ne16->fast_mode) {
+        this->bulk_access(addr, store_data, width_bytes, true);
+    }
+    else if(enable) {
         for(auto i=0; i<width_bytes; i++) {
             this->ne16->io_req.init();
             this->ne16->io_req.set_addr(addr+i & NE16_STREAM_L1_MASK);
@@ -289,7 +322,7 @@ T* Ne16VectorStore<T>::ex(T* data, int width, int64_t& cycles, int32_t enable) {
         stringStream << "Write disabled" << "\n";
         string s = stringStream.str();
         if (this->ne16->trace_level == L3_ALL) {
-            this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, s.c_str());
+            this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "%s", s.c_str());
         }
     }
     cycles += max_latency + 1;
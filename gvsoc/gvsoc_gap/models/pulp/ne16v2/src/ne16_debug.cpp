@@ -25,13 +25,13 @@ void Ne16::debug_x_buffer() {
     std::ostringstream stringStream;
     stringStream << "x_buffer[32,16] = \n" << (this->trace_format?std::hex:std::dec) << this->x_buffer_linear << std::dec << "\n";
     std::string copyOfStr = stringStream.str();
-    this->trace.msg(vp::trace::LEVEL_DEBUG, copyOfStr.c_str());
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "%s", copyOfStr.c_str());
   }
   else {
     std::ostringstream stringStream;
     stringStream << "x_buffer[5,5,16] = \n" << (this->trace_format?std::hex:std::dec) << this->x_buffer << std::dec << "\n";
     std::string copyOfStr = stringStream.str();
-    this->trace.msg(vp::trace::LEVEL_DEBUG, copyOfStr.c_str());
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "%s", copyOfStr.c_str());
   }
 }
 
@@ -49,7 +49,7 @@ void Ne16::debug_x_array() {
     std::ostringstream stringStream;
     stringStream << "x_array[9,9,16] = \n" << xt::print_options::threshold(10000) << (this->trace_format?std::hex:std::dec) << this->x_array << std::dec << "\n";
     std::string copyOfStr = stringStream.str();
-    this->trace.msg(vp::trace::LEVEL_DEBUG, copyOfStr.c_str());
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "%s", copyOfStr.c_str());
   // }
 }
 
@@ -57,7 +57,7 @@ void Ne16::debug_accum(){
   std::ostringstream stringStream;
   stringStream << "accum[9,32] = \n" << (this->trace_format?std::hex:std::dec) << xt::cast<int32_t>(this->accum) << std::dec << "\n";
   std::string copyOfStr = stringStream.str();
-  this->trace.msg(vp::trace::LEVEL_DEBUG, copyOfStr.c_str());
+  this->trace.msg(vp::trace::LEVEL_DEBUG, "%s", copyOfStr.c_str());
 }
 
 // void Ne16::debug_psum_column(){
@@ -71,5 +71,5 @@ void Ne16::debug_psum_block(){
   std::ostringstream stringStream;
   stringStream << "psum_block[9,9] = \n" << (this->trace_format?std::hex:std::dec) << xt::cast<int32_t>(this->psum_block) << std::dec << "\n";
   std::string copyOfStr = stringStream.str();
-  this->trace.msg(vp::trace::LEVEL_DEBUG, copyOfStr.c_str());
+  this->trace.msg(vp::trace::LEVEL_DEBUG, "%s", copyOfStr.c_str());
 }
@@ -212,7 +212,7 @@ xt::xarray<T> Ne16VectorLoad<T>::ex(int width, int64_t& cycles) {
   stringStream << "Read data: " << (this->ne16->trace_format?std::hex:std::dec) << x << std::dec << "\n";
   string s = stringStream.str();
   if (this->ne16->trace_level == L3_ALL) {
-    this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, s.c_str());
+    this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "%s", s.c_str());
   }
   cycles += max_latency + 1;
   return x;
@@ -278,14 +278,14 @@ xt::xarray<T> Ne16VectorStore<T>::ex(xt::xarray<T> data, int width, int64_t& cyc
     stringStream << "Write data: " << (this->ne16->trace_format?std::hex:std::dec) << data << std::dec << "\n";
     string s = stringStream.str();
     if (this->ne16->trace_level == L3_ALL) {
-      this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, s.c_str());
+      this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "%s", s.c_str());
     }
   }
   else {
     stringStream << "Write disabled" << "\n";
     string s = stringStream.str();
     if (this->ne16->trace_level == L3_ALL) {
-      this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, s.c_str());
+      this->ne16->trace.msg(vp::trace::LEVEL_DEBUG, "%s", s.c_str());
     }
   }
   cycles += max_latency + 1;
@@ -172,6 +172,7 @@ private:
 
   static void qspim_master_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
   static void qspim_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
+  static void qspim_burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx, int id);
   static void qspim_cs_sync(void *__this, int cs, int active, int id);
 
   static void jtag_pad_slave_sync(void *__this, int tck, int tdi, int tms, int trst, int id);
@@ -184,6 +185,7 @@ private:
 
   static void cpi_sync(void *__this, int pclk, int href, int vsync, int data, int id);
   static void cpi_sync_cycle(void *__this, int href, int vsync, int data, int id);
+  static void cpi_burst(void *__this, int href, int vsync, uint8_t *data, int size, int id);
 
   static void uart_chip_sync(void *__this, int data, int id);
   static void uart_chip_sync_full(void *__this, int data, int sck, int rts, int id);
@@ -192,12 +194,14 @@ private:
 
   static void i2s_internal_edge(void *__this, int sck, int ws, int sd, int id);
   static void i2s_external_edge(void *__this, int sck, int ws, int sd, int id);
+  static void i2s_frame(void *__this, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in, int id);
 
   static void i2c_chip_sync(void *__this, int scl, int sda, int id);
   static void i2c_master_sync(void *__this, int scl, int data, int id);
 
   static void hyper_master_sync_cycle(void *__this, int data, int id);
   static void hyper_sync_cycle(void *__this, int data, int id);
+  static void hyper_burst(void *__this, uint8_t *data, int size, bool is_write, int id);
   static void hyper_cs_sync(void *__this, int cs, int active, int id);
 
   static void master_wire_sync(void *__this, int value, int id);
@@ -291,6 +295,27 @@ void padframe::qspim_sync(void *__this, int sck, int data_0, int data_1, int dat
 }
 
 
+void padframe::qspim_burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx, int id)
+{
+  padframe *_this = (padframe *)__this;
+  Qspim_group *group = static_cast<Qspim_group *>(_this->groups[id]);
+
+  // Bursts are forwarded as they are, the data traces only show edges
+  if (group->active_cs == -1)
+  {
+    vp_warning_always(&_this->warning, "Trying to send QSPIM stream while no cs is active\n");
+  }
+  else if (!group->master[group->active_cs]->is_bound())
+  {
+    vp_warning_always(&_this->warning, "Trying to send QSPIM stream while pad is not connected (interface: %s)\n", group->name.c_str());
+  }
+  else
+  {
+    group->master[group->active_cs]->burst(data, nb_bits, lines, is_rx);
+  }
+}
+
+
 void padframe::qspim_cs_sync(void *__this, int cs, int active, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -412,6 +437,19 @@ void padframe::cpi_sync_cycle(void *__this, int href, int vsync, int data, int i
 }
 
 
+void padframe::cpi_burst(void *__this, int href, int vsync, uint8_t *data, int size, int id)
+{
+  padframe *_this = (padframe *)__this;
+  Cpi_group *group = static_cast<Cpi_group *>(_this->groups[id]);
+
+  // Bursts are forwarded as they are, the data traces only show single cycles
+  group->href_trace.event((uint8_t *)&href);
+  group->vsync_trace.event((uint8_t *)&vsync);
+
+  group->master.burst(href, vsync, data, size);
+}
+
+
 void padframe::uart_chip_sync(void *__this, int data, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -538,6 +576,44 @@ void padframe::i2s_external_edge(void *__this, int sck, int ws, int sd, int id)
 
 
 
+void padframe::i2s_frame(void *__this, int nb_edges, int sck, uint8_t *ws, uint8_t *sd_out, uint8_t *sd_in, int id)
+{
+  padframe *_this = (padframe *)__this;
+  I2s_group *group = static_cast<I2s_group *>(_this->groups[id]);
+
+  if (nb_edges == 0 || !group->slave.is_bound())
+  {
+    return;
+  }
+
+  group->slave.frame(nb_edges, sck, ws, sd_out, sd_in);
+
+  // The data seen by the chip is resolved between internal and external state, as for single edges
+  for (int i=0; i<nb_edges; i++)
+  {
+    sd_in[i] = vp::i2s_slave::resolve_sd(sd_out[i], sd_in[i]);
+  }
+
+  // Frames are forwarded as they are, the traces only show the last edge
+  int last = nb_edges - 1;
+  int last_sck = sck ^ (last & 1);
+  int last_ws = ws[last];
+  int sdi = sd_in[last] & 0x3;
+  int sdo = sd_in[last] >> 2;
+
+  group->sck_in = last_sck;
+  group->ws_in = last_ws;
+  group->sdi_in = sd_out[last] & 0x3;
+  group->sdo_in = sd_out[last] >> 2;
+
+  group->sck_trace.event((uint8_t *)&last_sck);
+  group->ws_trace.event((uint8_t *)&last_ws);
+  group->sdi_trace.event((uint8_t *)&sdi);
+  group->sdo_trace.event((uint8_t *)&sdo);
+}
+
+
+
 void padframe::i2c_chip_sync(void *__this, int scl, int sda, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -593,6 +669,23 @@ void padframe::hyper_sync_cycle(void *__this, int data, int id)
 }
 
 
+void padframe::hyper_burst(void *__this, uint8_t *data, int size, bool is_write, int id)
+{
+  padframe *_this = (padframe *)__this;
+  Hyper_group *group = static_cast<Hyper_group *>(_this->groups[id]);
+
+  // Bursts are forwarded as they are, the data traces only show single cycles
+  if (!group->master[group->active_cs]->is_bound())
+  {
+    vp_warning_always(&_this->warning, "Trying to send HYPER stream while pad is not connected (interface: %s)\n", group->name.c_str());
+  }
+  else
+  {
+    group->master[group->active_cs]->burst(data, size, is_write);
+  }
+}
+
+
 void padframe::hyper_cs_sync(void *__this, int cs, int active, int id)
 {
   padframe *_this = (padframe *)__this;
@@ -708,6 +801,7 @@ int padframe::build()
         group->active_cs = -1;
         group->slave.set_sync_meth_muxed(&padframe::qspim_sync, nb_itf);
         group->slave.set_cs_sync_meth_muxed(&padframe::qspim_cs_sync, nb_itf);
+        group->slave.set_burst_meth_muxed(&padframe::qspim_burst, nb_itf);
         this->groups.push_back(group);
 
         traces.new_trace_event(name + "/data_0", &group->data_0_trace, 1);
@@ -764,6 +858,7 @@ int padframe::build()
         new_slave_port(name + "_pad", &group->slave);
         group->slave.set_sync_meth_muxed(&padframe::cpi_sync, nb_itf);
         group->slave.set_sync_cycle_meth_muxed(&padframe::cpi_sync_cycle, nb_itf);
+        group->slave.set_burst_meth_muxed(&padframe::cpi_burst, nb_itf);
         this->groups.push_back(group);
         traces.new_trace_event(name + "/pclk", &group->pclk_trace, 1);
         traces.new_trace_event(name + "/href", &group->href_trace, 1);
@@ -796,6 +891,7 @@ int padframe::build()
         new_slave_port(name + "_pad", &group->slave);
         new_master_port(name, &group->master);
         group->master.set_sync_meth_muxed(&padframe::i2s_internal_edge, nb_itf);
+        group->master.set_frame_meth_muxed(&padframe::i2s_frame, nb_itf);
         group->slave.set_sync_meth_muxed(&padframe::i2s_external_edge, nb_itf);
         group->sck_in = 2;
         group->ws_in = 2;
@@ -830,6 +926,7 @@ int padframe::build()
         new_slave_port(name, &group->slave);
         group->slave.set_sync_cycle_meth_muxed(&padframe::hyper_sync_cycle, nb_itf);
         group->slave.set_cs_sync_meth_muxed(&padframe::hyper_cs_sync, nb_itf);
+        group->slave.set_burst_meth_muxed(&padframe::hyper_burst, nb_itf);
         this->groups.push_back(group);
         traces.new_trace_event(name + "/data", &group->data_trace, 8);
         js::config *nb_cs_config = config->get("nb_cs");
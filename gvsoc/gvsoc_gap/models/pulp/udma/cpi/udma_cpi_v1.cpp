@@ -39,6 +39,7 @@ Cpi_periph::Cpi_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
 
   cpi_itf.set_sync_meth(&Cpi_periph::sync);
   cpi_itf.set_sync_cycle_meth(&Cpi_periph::sync_cycle);
+  cpi_itf.set_burst_meth(&Cpi_periph::burst);
 }
  
 
@@ -292,6 +293,19 @@ void Cpi_periph::sync_cycle(void *__this, int href, int vsync, int data)
 
 
 
+void Cpi_periph::burst(void *__this, int href, int vsync, uint8_t *data, int size)
+{
+  // Cycles outside frames do nothing, so that blanking periods are skipped at once
+  if (href || vsync)
+  {
+    for (int i=0; i<size; i++)
+    {
+      Cpi_periph::sync_cycle(__this, href, vsync, data[i]);
+    }
+  }
+}
+
+
 
 
 Cpi_rx_channel::Cpi_rx_channel(udma *top, Cpi_periph *periph, int id, string name) : Udma_rx_channel(top, id, name), periph(periph)
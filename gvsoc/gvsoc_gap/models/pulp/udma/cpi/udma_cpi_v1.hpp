@@ -50,6 +50,7 @@ protected:
 private:
   static void sync(void *__this, int pclk, int href, int vsync, int data);
   static void sync_cycle(void *__this, int href, int vsync, int data);
+  static void burst(void *__this, int href, int vsync, uint8_t *data, int size);
   vp::io_req_status_e handle_global_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_l1_access(bool is_write, uint32_t *data);
   vp::io_req_status_e handle_ur_access(bool is_write, uint32_t *data);
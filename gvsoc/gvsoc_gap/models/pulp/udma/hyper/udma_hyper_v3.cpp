@@ -54,6 +54,10 @@ Hyper_periph::Hyper_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
 
     this->pending_bytes = 0;
     this->next_bit_cycle = -1;
+
+    js::config *burst_config = this->top->get_vp_config()->get("hyper_burst");
+    this->burst_mode = burst_config && burst_config->get_bool();
+
     this->state.set(HYPER_STATE_IDLE);
     this->active.release();
     this->channel_state = HYPER_CHANNEL_STATE_IDLE;
@@ -250,6 +254,27 @@ void Hyper_periph::rx_sync(void *__this, int data)
 }
 
 
+void Hyper_periph::rx_burst(uint8_t *data, int size)
+{
+    // The burst never goes beyond the current word, so it is pushed only once complete,
+    // as it is done byte per byte
+    for (int i=0; i<size; i++)
+    {
+        this->trace.msg(vp::trace::LEVEL_TRACE, "Received byte (value: 0x%x)\n", data[i]);
+        this->pending_word = (this->pending_word & ((1 << (this->pending_word_size * 8)) - 1)) | (data[i] << (this->pending_word_size * 8));
+        this->pending_word_size++;
+    }
+
+    if (this->pending_word_size == 4 || this->transfer_size == 0)
+    {
+        if (!this->push_to_udma())
+        {
+            this->pending_word_ready = true;
+        }
+    }
+}
+
+
 void Hyper_periph::handle_pending_channel(void *__this, vp::clock_event *event)
 {
     Hyper_periph *_this = (Hyper_periph *)__this;
@@ -301,6 +326,10 @@ void Hyper_periph::handle_pending_channel(void *__this, vp::clock_event *event)
 void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
 {
     Hyper_periph *_this = (Hyper_periph *)__this;
+    // Bytes of the data phase sent at once in burst mode. Writes can use all the words which
+    // are ready in the 8 entries FIFO, while reads stop at the end of the current word.
+    uint8_t bytes[32];
+    int nb_bytes = 0;
     uint8_t byte;
     int cs_value;
     bool send_byte = false;
@@ -399,55 +428,68 @@ void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
     }
     else if (_this->state.get() == HYPER_STATE_DATA && _this->pending_bytes > 0)
     {
-        send_byte = true;
-        if (_this->pending_is_write)
-        {
-            byte = _this->pending_word & 0xff;
-            _this->pending_word >>= 8;
-        }
-        else
+        int max_bytes = 1;
+        if (_this->burst_mode)
         {
-            byte = 0;
+            max_bytes = _this->pending_is_write ? sizeof(bytes) : 4 - _this->pending_word_size;
         }
-        _this->pending_bytes--;
-        _this->transfer_size--;
 
-        _this->check_read_req_ready();
+        send_byte = true;
 
-        if (_this->transfer_size == 0)
-        {
-            _this->pending_bytes = 0;
-            _this->state.set(HYPER_STATE_CS_OFF);
-        }
-        else
+        do
         {
-            if (_this->pending_length != 0)
+            if (_this->pending_is_write)
             {
-                _this->pending_length--;
-                if (_this->pending_length == 0)
-                {
-                    _this->ext_addr += _this->stride;
-                    _this->pending_ext_addr = _this->ext_addr;
-                    _this->pending_length = _this->length;
-                    _this->state.set(HYPER_STATE_CS_OFF);
-                    _this->iter_2d = true;
-                }
+                byte = _this->pending_word & 0xff;
+                _this->pending_word >>= 8;
+            }
+            else
+            {
+                byte = 0;
             }
+            _this->pending_bytes--;
+            _this->transfer_size--;
+
+            _this->check_read_req_ready();
 
-            if (_this->state.get() != HYPER_STATE_CS_OFF)
+            if (_this->transfer_size == 0)
+            {
+                _this->pending_bytes = 0;
+                _this->state.set(HYPER_STATE_CS_OFF);
+            }
+            else
             {
-                if (_this->pending_burst > 0)
+                if (_this->pending_length != 0)
                 {
-                    _this->pending_burst--;
-                    if (_this->pending_burst == 0)
+                    _this->pending_length--;
+                    if (_this->pending_length == 0)
                     {
-                        _this->pending_ext_addr += _this->regmap.timing_cfg.cs_max_get();
-                        _this->pending_burst = _this->regmap.timing_cfg.cs_max_get();
+                        _this->ext_addr += _this->stride;
+                        _this->pending_ext_addr = _this->ext_addr;
+                        _this->pending_length = _this->length;
                         _this->state.set(HYPER_STATE_CS_OFF);
+                        _this->iter_2d = true;
+                    }
+                }
+
+                if (_this->state.get() != HYPER_STATE_CS_OFF)
+                {
+                    if (_this->pending_burst > 0)
+                    {
+                        _this->pending_burst--;
+                        if (_this->pending_burst == 0)
+                        {
+                            _this->pending_ext_addr += _this->regmap.timing_cfg.cs_max_get();
+                            _this->pending_burst = _this->regmap.timing_cfg.cs_max_get();
+                            _this->state.set(HYPER_STATE_CS_OFF);
+                        }
                     }
                 }
             }
+
+            bytes[nb_bytes++] = byte;
         }
+        while (nb_bytes < max_bytes && _this->pending_bytes > 0 && _this->state.get() == HYPER_STATE_DATA);
 
         if (_this->pending_bytes == 0)
         {
@@ -496,8 +538,19 @@ void Hyper_periph::handle_pending_word(void *__this, vp::clock_event *event)
         {
             int div = _this->regmap.clk_div.data_get() * 2;
 
-            _this->next_bit_cycle = _this->top->get_periph_clock()->get_cycles() + div;
-            if (send_byte)
+            // A burst takes as long as its bytes sent one by one, but they all reach
+            // the device now
+            _this->next_bit_cycle = _this->top->get_periph_clock()->get_cycles() + div * (nb_bytes > 1 ? nb_bytes : 1);
+            if (nb_bytes > 1)
+            {
+                _this->top->get_trace()->msg(vp::trace::LEVEL_INFO, "Sending burst (size: %d)\n", nb_bytes);
+                _this->hyper_itf.burst(bytes, nb_bytes, _this->pending_is_write);
+                if (!_this->pending_is_write)
+                {
+                    _this->rx_burst(bytes, nb_bytes);
+                }
+            }
+            else if (send_byte)
             {
                 _this->top->get_trace()->msg(vp::trace::LEVEL_INFO, "Sending byte (value: 0x%x)\n", byte);
                 _this->hyper_itf.sync_cycle(byte);
@@ -102,6 +102,7 @@ public:
     Hyper_periph(udma *top, int id, int itf_id);
     vp::io_req_status_e custom_req(vp::io_req *req, uint64_t offset);
     static void rx_sync(void *__this, int data);
+    void rx_burst(uint8_t *data, int size);
     bool push_to_udma();
     void reset(bool active);
     static void refill_req(void *__this, udma_refill_req_t *req);
@@ -135,6 +136,7 @@ private:
     vp::clock_event *pending_channel_event;
     vp::clock_event *push_data_event;
     int64_t next_bit_cycle;
+    bool burst_mode;
     vp::io_req *pending_req;
 
     uint32_t pending_word;
@@ -104,8 +104,12 @@ I2s_periph::I2s_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
         this->tx_channels.push_back(new I2s_tx_channel(top, this, i, itf_name + "tx_slot_" + std::to_string(i)));
     }
 
-    this->rx_fifo = new Udma_fifo<uint32_t>(top, itf_name + "/rx_fifo", 4);
-    this->rx_fifo_slot_id = new Udma_fifo<uint32_t>(top, itf_name + "/rx_fifo_slot_id", 4);
+    this->rx_fifo = new Udma_fifo<uint32_t>(top, itf_name + "/rx_fifo", I2S_RX_FIFO_SIZE);
+    this->rx_fifo_slot_id = new Udma_fifo<uint32_t>(top, itf_name + "/rx_fifo_slot_id", I2S_RX_FIFO_SIZE);
+
+    js::config *frame_config = this->top->get_vp_config()->get("i2s_frame");
+    this->frame_mode = frame_config && frame_config->get_bool();
+    this->in_frame = false;
 }
 
 
@@ -563,46 +567,30 @@ void I2s_periph::handle_clk_edge()
 
                 if (this->frame_active && this->rx_pending_bits > 0)
                 {
-                    this->rx_pending_value = (this->rx_pending_value << 1) | sdi;
                     this->rx_pending_bits--;
 
-                    this->trace.msg(vp::trace::LEVEL_DEBUG, "Appending incoming bit (bit: %d, new_value: 0x%x, remaining_bits: %d)\n", sdi, this->rx_pending_value, this->rx_pending_bits);
+                    // In case the sample sampling is over, switch to next slot
+                    bool last = this->rx_pending_bits == 0;
+                    int channel = (this->slot_en >> this->active_channel) & 1 ? this->active_channel : -1;
 
-                    // In case the sample sampling is over, enqueue the sample and switch to next slot
-                    if (this->rx_pending_bits == 0)
+                    if (last)
                     {
-                        if (this->active_channel < 16 && ((this->slot_en >> this->active_channel) & 1))
-                        {
-                            I2s_rx_channel *channel = this->rx_channels[this->active_channel];
-
-                            // Convert the sample to the specified format
-                            uint32_t sample = this->handle_rx_format(channel, this->rx_pending_value);
-
-                            this->trace.msg(vp::trace::LEVEL_DEBUG, "Received new sample (value: 0x%x, formatted_value: 0x%x)\n", this->rx_pending_value, sample);
-
-                            if (channel->slot_cfg->rx_en_get())
-                            {
-                                // There is an output FIFO for rx samples which takes care of absorbing
-                                // L2 contentions. If the FIFO is full, we just drop the sample and generate an error
-                                if (this->rx_fifo->is_full())
-                                {
-                                    this->regmap.err_status.set(this->regmap.err_status.get() | (1 << this->active_channel));
-                                }
-                                else
-                                {
-                                    this->rx_fifo->push(sample);
-                                    this->rx_fifo_slot_id->push(this->active_channel);
-                                }
-                            }
-                        }
-
                         this->active_channel++;
                         if (this->active_channel == 16)
                         {
                             this->active_channel = 0;
                         }
-                            this->rx_pending_bits = this->slot_width + 1;
-                        this->rx_pending_value = 0;
+                        this->rx_pending_bits = this->slot_width + 1;
+                    }
+
+                    if (this->in_frame)
+                    {
+                        // The data will only be known once the whole frame has been sent
+                        this->frame_rx_bits.push_back({ (int)this->frame_ws.size(), last, channel });
+                    }
+                    else
+                    {
+                        this->handle_rx_bit(sdi, last, channel);
                     }
                 }
 
@@ -654,7 +642,13 @@ void I2s_periph::handle_clk_edge()
 
             }
 
-            if  (this->i2s_itf.is_bound())
+            if (this->in_frame)
+            {
+                // Clock and WS are internal in frame mode, the edge is sent with the whole frame
+                this->frame_ws.push_back(this->ws_value ^ this->regmap.clkcfg_setup.ws_edge_get());
+                this->frame_sd_out.push_back(this->sd);
+            }
+            else if  (this->i2s_itf.is_bound())
             {
                 this->i2s_itf.sync(
                     this->regmap.clkcfg_setup.clk_src_get() || this->regmap.clkcfg_setup.clk_ext_src_get() ? 2 : this->clk_value ^ this->regmap.clkcfg_setup.clk_edge_get(),
@@ -669,10 +663,147 @@ void I2s_periph::handle_clk_edge()
 }
 
 
+void I2s_periph::handle_rx_bit(int sdi, bool last, int channel_id)
+{
+    this->rx_pending_value = (this->rx_pending_value << 1) | sdi;
+
+    this->trace.msg(vp::trace::LEVEL_DEBUG, "Appending incoming bit (bit: %d, new_value: 0x%x)\n", sdi, this->rx_pending_value);
+
+    // In case the sample sampling is over, enqueue the sample
+    if (last)
+    {
+        if (channel_id != -1)
+        {
+            I2s_rx_channel *channel = this->rx_channels[channel_id];
+
+            // Convert the sample to the specified format
+            uint32_t sample = this->handle_rx_format(channel, this->rx_pending_value);
+
+            this->trace.msg(vp::trace::LEVEL_DEBUG, "Received new sample (value: 0x%x, formatted_value: 0x%x)\n", this->rx_pending_value, sample);
+
+            if (channel->slot_cfg->rx_en_get())
+            {
+                // There is an output FIFO for rx samples which takes care of absorbing
+                // L2 contentions. If the FIFO is full, we just drop the sample and generate an error
+                if (this->rx_fifo->is_full())
+                {
+                    this->regmap.err_status.set(this->regmap.err_status.get() | (1 << channel_id));
+                }
+                else
+                {
+                    this->rx_fifo->push(sample);
+                    this->rx_fifo_slot_id->push(channel_id);
+                }
+            }
+        }
+
+        this->rx_pending_value = 0;
+    }
+}
+
+
+bool I2s_periph::can_handle_frame()
+{
+    // Frames are only used when this interface generates both clock and WS, and when
+    // no data has to be sent back as soon as it is received
+    if (!this->frame_mode || !this->i2s_itf.is_bound() || this->regmap.glb_setup.pdm_en_get() ||
+        this->regmap.clkcfg_setup.clk_src_get() || this->regmap.clkcfg_setup.clk_ext_src_get() ||
+        this->regmap.clkcfg_setup.ws_src_get() || this->regmap.clkcfg_setup.ws_ext_src_get())
+    {
+        return false;
+    }
+
+    for (int i=0; i<16; i++)
+    {
+        if (((this->slot_en >> i) & 1) && this->tx_channels[i]->slot_cfg->byp_get())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void I2s_periph::handle_frame()
+{
+    // A frame covers one WS period, limited so that the received samples fit in the RX FIFO
+    int nb_slots = std::min(this->frame_length + 1, I2S_RX_FIFO_SIZE);
+    int nb_edges = 2 * (this->slot_width + 1) * nb_slots;
+    int sck = (this->clk_value ^ 1) ^ this->regmap.clkcfg_setup.clk_edge_get();
+
+    this->frame_ws.clear();
+    this->frame_sd_out.clear();
+    this->frame_rx_bits.clear();
+
+    // Generate all the edges, this stops as soon as the interface gets disabled
+    this->in_frame = true;
+
+    for (int i=0; i<nb_edges; i++)
+    {
+        this->clk_value ^= 1;
+        this->handle_clk_edge();
+
+        if ((int)this->frame_ws.size() != i + 1)
+        {
+            break;
+        }
+    }
+
+    this->in_frame = false;
+
+    int nb_sent_edges = this->frame_ws.size();
+
+    this->trace.msg(vp::trace::LEVEL_TRACE, "Sending frame (nb_edges: %d)\n", nb_sent_edges);
+
+    this->frame_sd_in.assign(nb_sent_edges, 0xA);
+    this->i2s_itf.frame(nb_sent_edges, sck, this->frame_ws.data(), this->frame_sd_out.data(), this->frame_sd_in.data());
+
+    // Data is sampled on raising edge, with the value driven after the previous edge
+    for (auto &bit: this->frame_rx_bits)
+    {
+        int sd = bit.edge > 0 ? this->frame_sd_in[bit.edge - 1] : this->rx_sync_value;
+        this->handle_rx_bit(sd & 1, bit.last, bit.channel);
+    }
+
+    if (nb_sent_edges > 0)
+    {
+        this->rx_sync_value = this->frame_sd_in[nb_sent_edges - 1];
+    }
+
+    // Next frame starts after the last edge of this one
+    if (this->global_en && nb_sent_edges > 0)
+    {
+        this->enqueue_clk(nb_sent_edges);
+    }
+
+    this->check_state();
+}
+
+
+void I2s_periph::enqueue_clk(int nb_edges)
+{
+    if (this->regmap.clk_fast.fast_en_get())
+    {
+        this->top->get_fast_clock()->enqueue(this->clk_event, this->regmap.clkcfg_setup.clk_div_get() * nb_edges);
+    }
+    else
+    {
+        this->top->get_periph_clock_dual_edges()->enqueue(this->clk_event, this->regmap.clkcfg_setup.clk_div_get() * nb_edges);
+    }
+}
+
+
 void I2s_periph::handle_clk(void *__this, vp::clock_event *event)
 {
     I2s_periph *_this = (I2s_periph *)__this;
 
+    if (_this->can_handle_frame())
+    {
+        _this->handle_frame();
+        return;
+    }
+
     _this->clk_value ^= 1;
 
     _this->trace.msg(vp::trace::LEVEL_TRACE, "Updating clock (clk: %d)\n", _this->clk_value);
@@ -684,16 +815,10 @@ void I2s_periph::handle_clk(void *__this, vp::clock_event *event)
 void I2s_periph::check_state()
 {
     // Check if we should generate the next internal clock edge
-    if (this->global_en && this->regmap.clkcfg_setup.clk_src_get() == 0 && !this->clk_event->is_enqueued())
+    // In frame mode, the next edge is enqueued once the whole frame is done
+    if (this->global_en && this->regmap.clkcfg_setup.clk_src_get() == 0 && !this->clk_event->is_enqueued() && !this->in_frame)
     {
-        if (this->regmap.clk_fast.fast_en_get())
-        {
-            this->top->get_fast_clock()->enqueue(this->clk_event, this->regmap.clkcfg_setup.clk_div_get());
-        }
-        else
-        {
-            this->top->get_periph_clock_dual_edges()->enqueue(this->clk_event, this->regmap.clkcfg_setup.clk_div_get());
-        }
+        this->enqueue_clk(1);
     }
 
     // Check if we should propagate a sample from rx fifo to the udma channel
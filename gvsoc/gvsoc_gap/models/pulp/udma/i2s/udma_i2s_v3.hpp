@@ -33,6 +33,7 @@
 
 #define I2S_NB_PDM_IN  4
 #define I2S_NB_PDM_OUT 2
+#define I2S_RX_FIFO_SIZE 4
 
 class I2s_periph;
 
@@ -94,6 +95,10 @@ private:
     uint32_t handle_tx_format(I2s_tx_channel *channel, uint32_t sample);
     uint32_t handle_rx_format(I2s_rx_channel *channel, uint32_t sample);
     static void handle_clk(void *__this, vp::clock_event *event);
+    bool can_handle_frame();
+    void handle_frame();
+    void handle_rx_bit(int sdi, bool last, int channel);
+    void enqueue_clk(int nb_edges);
     static void handle_rx_fifo(void *__this, vp::clock_event *event);
     static void rx_sync(void *, int sck, int ws, int sd);
     void err_status_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write);
@@ -176,6 +181,14 @@ private:
     int current_ws_delay;
     int sd;
     uint32_t tx_wait_data_init;
+    bool frame_mode;                // True if the clock edges can be sent by frames instead of one by one
+    bool in_frame;                  // True while the edges of a frame are generated
+    std::vector<uint8_t> frame_ws;  // WS value of each edge of the current frame
+    std::vector<uint8_t> frame_sd_out;  // Data driven for each edge of the current frame
+    std::vector<uint8_t> frame_sd_in;   // Data received for each edge of the current frame
+    // Incoming bits of the current frame, which are sampled once the frame has been sent
+    struct frame_rx_bit { int edge; bool last; int channel; };
+    std::vector<frame_rx_bit> frame_rx_bits;
 };
 
 #endif
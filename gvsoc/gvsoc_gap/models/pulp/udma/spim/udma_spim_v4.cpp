@@ -26,6 +26,7 @@
 #include "archi/udma/spim/spim_v4.h"
 #include "archi/utils.h"
 #include "vp/itf/qspim.hpp"
+#include <algorithm>
 
 
 
@@ -49,6 +50,9 @@ Spim_periph_v4::Spim_periph_v4(udma *top, int id, int itf_id) : Udma_periph(top,
 
 
   pending_spi_word_event = top->event_new(this, Spim_periph_v4::handle_spi_pending_word);
+
+  js::config *burst_config = this->top->get_vp_config()->get("qspim_burst");
+  this->burst_mode = burst_config && burst_config->get_bool();
 }
 
 void Spim_periph_v4::reset(bool active)
@@ -213,121 +217,206 @@ void Spim_v4_cmd_channel::check_state()
   }
 }
 
-void Spim_periph_v4::handle_spi_pending_word(void *__this, vp::clock_event *event)
+void Spim_periph_v4::handle_rx_edge(unsigned int received_bits)
 {
-  Spim_periph_v4 *_this = (Spim_periph_v4 *)__this;
-  bool raised_edge = false;
+  int nb_bits = this->qpi ? 4 : 1;
 
-  if (_this->spi_rx_pending_bits > 0 && (_this->spi_tx_pending_bits == 0 || _this->is_full_duplex))
+  this->nb_received_bits += nb_bits;
+  this->spi_rx_pending_bits -= nb_bits;
+  if (!this->is_full_duplex)
+    this->cmd_pending_bits -= nb_bits;
+
+  int bit_index;
+  int shift;
+
+  if (this->spi_lsb_first)
+    bit_index = this->rx_bit_offset + this->rx_counter_bits;
+  else
+    bit_index = this->rx_bit_offset + this->spi_bitsword - this->rx_counter_bits;
+
+
+  if (this->spi_qpi)
   {
-    int nb_bits = _this->qpi ? 4 : 1;
-    unsigned int received_bits =  _this->qpi ? _this->rx_received_bits & ((1<<nb_bits)-1) : (_this->rx_received_bits >> 1) & 1;
-    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv*2;
+    shift = this->spi_lsb_first ? bit_index : bit_index - 3;
 
-    _this->nb_received_bits += nb_bits;
-    _this->spi_rx_pending_bits -= nb_bits;
-    if (!_this->is_full_duplex)
-      _this->cmd_pending_bits -= nb_bits;
+    this->rx_pending_word &= ~(0xf << shift);
+    this->rx_pending_word |= (received_bits & 0xf) << shift;
 
-    int bit_index;
-    int shift;
+    this->rx_counter_bits += 4;
+  }
+  else
+  {
+    shift = bit_index;
 
-    if (_this->spi_lsb_first)
-      bit_index = _this->rx_bit_offset + _this->rx_counter_bits;
-    else
-      bit_index = _this->rx_bit_offset + _this->spi_bitsword - _this->rx_counter_bits;
+    this->rx_pending_word &= ~(0x1 << bit_index);
+    this->rx_pending_word |= (received_bits & 0x1) << bit_index;
 
+    this->rx_counter_bits += 1;
+  }
 
-    if (_this->spi_qpi)
-    {
-      shift = _this->spi_lsb_first ? bit_index : bit_index - 3;
 
-      _this->rx_pending_word &= ~(0xf << shift);
-      _this->rx_pending_word |= (received_bits & 0xf) << shift;
+  this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "Sampled bits (nb_bits: %d, shift: %d, value: 0x%x, pending_word: 0x%x, pending_word_bits: %d)\n", nb_bits, shift, received_bits, this->rx_pending_word, this->nb_received_bits);
 
-      _this->rx_counter_bits += 4;
-    }
-    else
+  if (this->rx_counter_bits == this->spi_bitsword + 1)
+  {
+    this->rx_counter_bits = 0;
+    this->rx_bit_offset += this->spi_wordtrans == 0 ? 0 : this->spi_wordtrans == 1 ? 16 : 8;
+    this->rx_counter_transf++;
+    if (this->rx_counter_transf == 1<<this->spi_wordtrans)
     {
-      shift = bit_index;
+      this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "End of word transfer, pushing word (value: 0x%x)\n", this->rx_pending_word);
 
-      _this->rx_pending_word &= ~(0x1 << bit_index);
-      _this->rx_pending_word |= (received_bits & 0x1) << bit_index;
+      (static_cast<Spim_v4_rx_channel *>(this->channel0))->push_data((uint8_t *)&this->rx_pending_word, 4);
 
-      _this->rx_counter_bits += 1;
+      this->rx_counter_transf = 0;
+      this->rx_bit_offset = 0;
+      this->nb_received_bits = 0;
+      this->rx_pending_word = 0x57575757;
     }
+  }
 
+  if (this->spi_rx_pending_bits <= 0)
+  {
+    this->is_full_duplex = false;
+    this->waiting_rx = false;
+    this->channel1->handle_ready_reqs();
+    this->channel2->handle_ready_reqs();
+  }
+}
 
-    _this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "Sampled bits (nb_bits: %d, shift: %d, value: 0x%x, pending_word: 0x%x, pending_word_bits: %d)\n", nb_bits, shift, received_bits, _this->rx_pending_word, _this->nb_received_bits);
+unsigned int Spim_periph_v4::handle_tx_edge(int *nb_bits)
+{
+  int bit_index;
+  int shift;
+  *nb_bits = this->spi_qpi ? 4 : 1;
 
-    if (!_this->qspim_itf.is_bound())
-    {
-      _this->top->warning.force_warning("Trying to receive from SPIM interface while it is not connected\n");
-    }
-    else
+  if (this->spi_lsb_first)
+    bit_index = this->tx_bit_offset + this->tx_counter_bits;
+  else
+    bit_index = this->tx_bit_offset + this->spi_bitsword - this->tx_counter_bits;
+
+  if (this->spi_qpi)
+  {
+    shift = this->spi_lsb_first ? bit_index : bit_index - 3;
+    this->tx_counter_bits += 4;
+  }
+  else
+  {
+    shift = bit_index;
+    this->tx_counter_bits += 1;
+  }
+
+  unsigned int bits = ARCHI_REG_FIELD_GET(this->spi_tx_pending_word, shift, *nb_bits);
+  this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "Sending bits (nb_bits: %d, shift: %d, value: 0x%x)\n", *nb_bits, shift, bits);
+
+  if (this->tx_counter_bits == this->spi_bitsword + 1)
+  {
+    this->tx_counter_bits = 0;
+    this->tx_bit_offset += this->spi_wordtrans == 0 ? 0 : this->spi_wordtrans == 1 ? 16 : 8;
+    this->tx_counter_transf++;
+
+    if (this->tx_counter_transf == 1<<this->spi_wordtrans)
     {
-      if (!_this->is_full_duplex) {
-        _this->qspim_itf.sync(1, 0, 0, 0, 0, 0);
-      }
+      this->tx_counter_transf = 0;
+      this->tx_bit_offset = 0;
     }
+  }
 
 
-    if (_this->rx_counter_bits == _this->spi_bitsword + 1)
-    {
-      _this->rx_counter_bits = 0;
-      _this->rx_bit_offset += _this->spi_wordtrans == 0 ? 0 : _this->spi_wordtrans == 1 ? 16 : 8;
-      _this->rx_counter_transf++;
-      if (_this->rx_counter_transf == 1<<_this->spi_wordtrans)
-      {
-        _this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "End of word transfer, pushing word (value: 0x%x)\n", _this->rx_pending_word);
+  this->spi_tx_pending_bits -= *nb_bits;
 
-        (static_cast<Spim_v4_rx_channel *>(_this->channel0))->push_data((uint8_t *)&_this->rx_pending_word, 4);
+  if (this->waiting_tx_flush && this->spi_tx_pending_bits <= 0)
+  {
+    this->waiting_tx_flush = false;
+  }
 
-        _this->rx_counter_transf = 0;
-        _this->rx_bit_offset = 0;
-        _this->nb_received_bits = 0;
-        _this->rx_pending_word = 0x57575757;
-      }
+  return bits;
+}
+
+void Spim_periph_v4::handle_spi_burst()
+{
+  // Up to a word is transferred in a single burst, and the next one is sent after the
+  // duration of all its edges
+  uint8_t data[4] = { 0 };
+  int nb_edges = 0;
+  int lines;
+
+  if (!this->qspim_itf.is_bound())
+  {
+    this->top->warning.force_warning("Trying to access SPIM interface while it is not connected\n");
+  }
+
+  if (this->spi_rx_pending_bits > 0 && this->spi_tx_pending_bits == 0)
+  {
+    lines = this->qpi ? 4 : 1;
+    int nb_bits = std::min(this->spi_rx_pending_bits, 32);
+    nb_edges = (nb_bits + lines - 1) / lines;
+
+    if (this->qspim_itf.is_bound())
+      this->qspim_itf.burst(data, nb_edges * lines, lines, true);
+
+    for (int i=0; i<nb_edges; i++)
+    {
+      int bit = i * lines;
+      this->handle_rx_edge((data[bit / 8] >> (8 - lines - bit % 8)) & ((1 << lines) - 1));
     }
+  }
+  else if (this->spi_tx_pending_bits > 0)
+  {
+    lines = this->spi_qpi ? 4 : 1;
 
-    if (_this->spi_rx_pending_bits <= 0)
+    while (this->spi_tx_pending_bits > 0)
     {
-      _this->is_full_duplex = false;
-      _this->waiting_rx = false;
-      _this->channel1->handle_ready_reqs();
-      _this->channel2->handle_ready_reqs();
+      int nb_bits;
+      int bit = nb_edges * lines;
+      unsigned int bits = this->handle_tx_edge(&nb_bits);
+      data[bit / 8] |= bits << (8 - lines - bit % 8);
+      nb_edges++;
     }
+
+    if (this->qspim_itf.is_bound())
+      this->qspim_itf.burst(data, nb_edges * lines, lines, false);
   }
 
-  if (_this->spi_tx_pending_bits > 0)
-  {
-    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv*2;
+  this->next_bit_cycle = this->top->get_clock()->get_cycles() + this->clkdiv*2*nb_edges;
+}
+
+void Spim_periph_v4::handle_spi_pending_word(void *__this, vp::clock_event *event)
+{
+  Spim_periph_v4 *_this = (Spim_periph_v4 *)__this;
 
+  if (_this->burst_mode && !_this->is_full_duplex)
+  {
+    _this->handle_spi_burst();
+    _this->check_state();
+    return;
+  }
 
-    int bit_index;
-    int shift;
-    int nb_bits = _this->spi_qpi ? 4 : 1;
+  if (_this->spi_rx_pending_bits > 0 && (_this->spi_tx_pending_bits == 0 || _this->is_full_duplex))
+  {
+    unsigned int received_bits =  _this->qpi ? _this->rx_received_bits & 0xf : (_this->rx_received_bits >> 1) & 1;
+    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv*2;
 
-    if (_this->spi_lsb_first)
-      bit_index = _this->tx_bit_offset + _this->tx_counter_bits;
-    else
-      bit_index = _this->tx_bit_offset + _this->spi_bitsword - _this->tx_counter_bits;
+    _this->handle_rx_edge(received_bits);
 
-    if (_this->spi_qpi)
+    if (!_this->qspim_itf.is_bound())
     {
-      shift = _this->spi_lsb_first ? bit_index : bit_index - 3;
-      _this->tx_counter_bits += 4;
+      _this->top->warning.force_warning("Trying to receive from SPIM interface while it is not connected\n");
     }
     else
     {
-      shift = bit_index;
-      _this->tx_counter_bits += 1;
+      if (!_this->is_full_duplex) {
+        _this->qspim_itf.sync(1, 0, 0, 0, 0, 0);
+      }
     }
+  }
 
-    unsigned int bits = ARCHI_REG_FIELD_GET(_this->spi_tx_pending_word, shift, nb_bits);
-    _this->top->get_trace()->msg(vp::trace::LEVEL_TRACE, "Sending bits (nb_bits: %d, shift: %d, value: 0x%x)\n", nb_bits, shift, bits);
+  if (_this->spi_tx_pending_bits > 0)
+  {
+    _this->next_bit_cycle = _this->top->get_clock()->get_cycles() + _this->clkdiv*2;
 
-    raised_edge = true;
+    int nb_bits;
+    unsigned int bits = _this->handle_tx_edge(&nb_bits);
 
     if (!_this->qspim_itf.is_bound())
     {
@@ -339,27 +428,6 @@ void Spim_periph_v4::handle_spi_pending_word(void *__this, vp::clock_event *even
         1, (bits >> 0) & 1, (bits >> 1) & 1, (bits >> 2) & 1, (bits >> 3) & 1, (1<<nb_bits)-1
       );
     }
-
-    if (_this->tx_counter_bits == _this->spi_bitsword + 1)
-    {
-      _this->tx_counter_bits = 0;
-      _this->tx_bit_offset += _this->spi_wordtrans == 0 ? 0 : _this->spi_wordtrans == 1 ? 16 : 8;
-      _this->tx_counter_transf++;
-
-      if (_this->tx_counter_transf == 1<<_this->spi_wordtrans)
-      {
-        _this->tx_counter_transf = 0;
-        _this->tx_bit_offset = 0;
-      }
-    }
-
-
-    _this->spi_tx_pending_bits -= nb_bits;
-
-    if (_this->waiting_tx_flush && _this->spi_tx_pending_bits <= 0)
-    {
-      _this->waiting_tx_flush = false;
-    }
   }
 
   _this->check_state();
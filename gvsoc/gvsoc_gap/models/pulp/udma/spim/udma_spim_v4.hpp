@@ -129,6 +129,9 @@ public:
   void reset(bool active);
   vp::io_req_status_e custom_req(vp::io_req *req, uint64_t offset);
   static void handle_spi_pending_word(void *__this, vp::clock_event *event);
+  void handle_spi_burst();
+  void handle_rx_edge(unsigned int received_bits);
+  unsigned int handle_tx_edge(int *nb_bits);
   void check_state();
   bool push_tx_to_spi(uint32_t value, int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
   bool push_rx_to_spi(int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
@@ -137,6 +140,7 @@ protected:
   vp::clock_event *pending_spi_word_event;
 
   vp::qspim_master qspim_itf;
+  bool burst_mode;      // Transfer words with bursts instead of edges
   int clkdiv;
   bool waiting_rx;
   bool waiting_tx;
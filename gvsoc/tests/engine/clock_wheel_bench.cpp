@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Compares the clock engine timing wheel with the sorted list it replaced, on a
+// hold model where the engine jumps to the first delayed event, extracts all the
+// events of the circular buffer window and enqueues them again at a random delay.
+// Both must extract the same events at each step.
+//
+// Usage: clock_wheel_bench [nb_steps] [nb_events...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include "vp/vp.hpp"
+#include "vp/clock/clock_wheel.hpp"
+
+#define WINDOW CLOCK_EVENT_QUEUE_SIZE
+#define MAX_DELAY 100000
+
+// Sorted singly linked list, as used by the clock engine before the wheel
+class sorted_list
+{
+public:
+    struct entry
+    {
+        int id;
+        int64_t cycle;
+        entry *next;
+    };
+
+    void insert(entry *event, int64_t cycle)
+    {
+        entry *current = this->first, *prev = NULL;
+        event->cycle = cycle;
+        while (current && current->cycle < cycle)
+        {
+            prev = current;
+            current = current->next;
+        }
+        if (prev)
+            prev->next = event;
+        else
+            this->first = event;
+        event->next = current;
+    }
+
+    void extract(int64_t limit, std::vector<entry *> &events)
+    {
+        events.clear();
+        while (this->first && this->first->cycle < limit)
+        {
+            events.push_back(this->first);
+            this->first = this->first->next;
+        }
+    }
+
+    entry *first = NULL;
+};
+
+static void nop_handler(void *, vp::clock_event *)
+{
+}
+
+// Delay of the specified enqueue of an event, so that both implementations get the
+// same delays whatever the order in which they give back the events
+static int64_t get_delay(int id, int count)
+{
+    uint64_t x = ((uint64_t)id << 32) + count + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x = x ^ (x >> 31);
+    return WINDOW + x % MAX_DELAY;
+}
+
+static bool run(int nb_events, int nb_steps)
+{
+    std::vector<int> wheel_count(nb_events), list_count(nb_events);
+    std::vector<vp::clock_event *> events;
+    std::vector<sorted_list::entry> entries(nb_events);
+    std::vector<vp::clock_event *> wheel_out;
+    std::vector<sorted_list::entry *> list_out;
+    std::vector<int> wheel_ids, list_ids;
+    vp::clock_wheel wheel;
+    sorted_list list;
+
+    for (int i = 0; i < nb_events; i++)
+    {
+        vp::clock_event *event = new vp::clock_event(NULL, NULL, nop_handler);
+        event->get_args()[0] = (void *)(intptr_t)i;
+        events.push_back(event);
+        wheel.insert(event, get_delay(i, wheel_count[i]++));
+
+        entries[i].id = i;
+        list.insert(&entries[i], get_delay(i, list_count[i]++));
+    }
+
+    double wheel_time = 0, list_time = 0;
+    bool ok = true;
+
+    for (int step = 0; step < nb_steps && ok; step++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        int64_t cycle = wheel.get_first()->get_cycle();
+        wheel.extract(cycle, cycle + WINDOW, wheel_out);
+        for (vp::clock_event *event: wheel_out)
+        {
+            int id = (int)(intptr_t)event->get_args()[0];
+            wheel.insert(event, cycle + get_delay(id, wheel_count[id]++));
+        }
+        auto middle = std::chrono::steady_clock::now();
+
+        int64_t list_cycle = list.first->cycle;
+        list.extract(list_cycle + WINDOW, list_out);
+        for (sorted_list::entry *event: list_out)
+        {
+            list.insert(event, list_cycle + get_delay(event->id, list_count[event->id]++));
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        wheel_time += std::chrono::duration<double, std::nano>(middle - start).count();
+        list_time += std::chrono::duration<double, std::nano>(end - middle).count();
+
+        wheel_ids.clear();
+        for (vp::clock_event *event: wheel_out)
+        {
+            wheel_ids.push_back((int)(intptr_t)event->get_args()[0]);
+        }
+        list_ids.clear();
+        for (sorted_list::entry *event: list_out)
+        {
+            list_ids.push_back(event->id);
+        }
+        std::sort(wheel_ids.begin(), wheel_ids.end());
+        std::sort(list_ids.begin(), list_ids.end());
+
+        if (cycle != list_cycle || wheel_ids != list_ids)
+        {
+            fprintf(stderr, "Mismatch at step %d (nb_events: %d, wheel cycle: %ld, list cycle: %ld)\n",
+                step, nb_events, cycle, list_cycle);
+            ok = false;
+        }
+    }
+
+    printf("nb_events %6d: wheel %8.1f ns/step, list %10.1f ns/step\n", nb_events,
+        wheel_time / nb_steps, list_time / nb_steps);
+
+    for (vp::clock_event *event: events)
+    {
+        delete event;
+    }
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int nb_steps = argc > 1 ? atoi(argv[1]) : 10000;
+    std::vector<int> sizes;
+
+    for (int i = 2; i < argc; i++)
+    {
+        sizes.push_back(atoi(argv[i]));
+    }
+
+    if (sizes.size() == 0)
+    {
+        sizes = { 16, 256, 4096 };
+    }
+
+    bool ok = true;
+    for (int nb_events: sizes)
+    {
+        ok &= run(nb_events, nb_steps);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Compares the time engine client heap with the sorted list it replaced, for an
+// increasing number of clients. At each step, the first client is executed and
+// enqueued again at a later time, and another client is moved to an earlier time,
+// as done when a clock domain receives an event from another one.
+// Both must execute the clients in the same order.
+//
+// Usage: time_heap_bench [nb_steps] [nb_clients...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "vp/vp.hpp"
+
+#define MAX_DELAY 100000
+
+class bench_client : public vp::time_engine_client
+{
+public:
+    bench_client(int id) : vp::time_engine_client(NULL), id(id) {}
+
+    int64_t exec() { return 0; }
+
+    int64_t get_next_event_time() { return this->next_event_time; }
+
+    int id;
+    int count = 0;
+};
+
+// Sorted list of clients, as used by the time engine before the heap
+class sorted_list
+{
+public:
+    struct entry
+    {
+        int id;
+        int count;
+        bool is_enqueued;
+        int64_t time;
+        entry *next;
+    };
+
+    void enqueue(entry *client, int64_t time)
+    {
+        if (client->is_enqueued)
+        {
+            if (client->time <= time)
+                return;
+            this->dequeue(client);
+        }
+
+        client->is_enqueued = true;
+        client->time = time;
+
+        entry *current = this->first, *prev = NULL;
+        while (current && current->time < time)
+        {
+            prev = current;
+            current = current->next;
+        }
+        if (prev)
+            prev->next = client;
+        else
+            this->first = client;
+        client->next = current;
+    }
+
+    void dequeue(entry *client)
+    {
+        entry *current = this->first, *prev = NULL;
+        while (current != client)
+        {
+            prev = current;
+            current = current->next;
+        }
+        if (prev)
+            prev->next = client->next;
+        else
+            this->first = client->next;
+        client->is_enqueued = false;
+    }
+
+    entry *first = NULL;
+};
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static bool run(int nb_clients, int nb_steps)
+{
+    std::vector<bench_client *> clients;
+    std::vector<sorted_list::entry> entries(nb_clients);
+    vp::time_client_heap heap;
+    sorted_list list;
+
+    for (int i = 0; i < nb_clients; i++)
+    {
+        int64_t time = mix(i) % MAX_DELAY;
+        bench_client *client = new bench_client(i);
+        clients.push_back(client);
+        heap.enqueue(client, time);
+
+        entries[i] = { i, 0, false, 0, NULL };
+        list.enqueue(&entries[i], time);
+    }
+
+    double heap_time = 0, list_time = 0;
+    bool ok = true;
+
+    for (int step = 0; step < nb_steps && ok; step++)
+    {
+        uint64_t key = mix(step);
+        int other = key % nb_clients;
+
+        auto start = std::chrono::steady_clock::now();
+        bench_client *client = (bench_client *)heap.first();
+        int64_t time = client->get_next_event_time();
+        heap.dequeue(client);
+        heap.enqueue(client, time + 1 + mix(((uint64_t)client->id << 32) + client->count++) % MAX_DELAY);
+        heap.enqueue(clients[other], time + (key >> 32) % MAX_DELAY);
+        auto middle = std::chrono::steady_clock::now();
+
+        sorted_list::entry *entry = list.first;
+        int64_t list_time_value = entry->time;
+        list.dequeue(entry);
+        list.enqueue(entry, list_time_value + 1 + mix(((uint64_t)entry->id << 32) + entry->count++) % MAX_DELAY);
+        list.enqueue(&entries[other], list_time_value + (key >> 32) % MAX_DELAY);
+        auto end = std::chrono::steady_clock::now();
+
+        heap_time += std::chrono::duration<double, std::nano>(middle - start).count();
+        list_time += std::chrono::duration<double, std::nano>(end - middle).count();
+
+        if (client->id != entry->id || time != list_time_value)
+        {
+            fprintf(stderr, "Mismatch at step %d (nb_clients: %d, heap client: %d, list client: %d)\n",
+                step, nb_clients, client->id, entry->id);
+            ok = false;
+        }
+    }
+
+    printf("nb_clients %6d: heap %8.1f ns/step, list %10.1f ns/step\n", nb_clients,
+        heap_time / nb_steps, list_time / nb_steps);
+
+    for (bench_client *client: clients)
+    {
+        delete client;
+    }
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int nb_steps = argc > 1 ? atoi(argv[1]) : 100000;
+    std::vector<int> sizes;
+
+    for (int i = 2; i < argc; i++)
+    {
+        sizes.push_back(atoi(argv[i]));
+    }
+
+    if (sizes.size() == 0)
+    {
+        sizes = { 4, 16, 64, 256, 1024 };
+    }
+
+    bool ok = true;
+    for (int nb_clients: sizes)
+    {
+        ok &= run(nb_clients, nb_steps);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+# Streams raw frames from a Himax camera with edges and with bursts on the cpi interface,
+# to receivers with and without burst support, directly and through relays binding the
+# interface methods in various ways. Checks that all frames have the pixels of the images
+# and start on the same cycles as with edges, give or take the pixel clock edge.
+#
+# Usage: cpi_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare edges and bursts on the cpi interface')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+WIDTH = 64
+HEIGHT = 48
+NB_IMAGES = 3
+# More frames than images, to check that the stream loops
+NB_FRAMES = 5
+
+
+def get_config(stream, burst, rx_bursts, relay, path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('camera', vp_component='devices.camera.himax', **{'color-mode': 'gray', 'width': WIDTH,
+        'height': HEIGHT, 'pixel-size': 1, 'vsync-polarity': 1, 'hsync-polarity': 1,
+        'endianness': 'little', 'image-stream': stream})
+    comp('rx', vp_component='test.cpi_rx', file=path, bursts=rx_bursts, nb_frames=NB_FRAMES)
+
+    if relay is None:
+        bindings.append(['camera->cpi', 'rx->input'])
+    else:
+        comp('relay', vp_component='test.cpi_rx', relay=relay)
+        bindings.append(['camera->cpi', 'relay->input'])
+        bindings.append(['relay->output', 'rx->input'])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    config = gvsoc_test.get_config(comps, bindings)
+    config['gvsoc']['cpi_burst'] = burst
+    return config
+
+
+def checksum(data):
+    result = 0
+    for byte in data:
+        result = (result * 31 + byte) & 0xffffffffffffffff
+    return result
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+# The same images are given as a single raw file and as a directory of raw files
+images = [bytes((x * 3 + y * 5 + i * 41) & 0xff for y in range(HEIGHT) for x in range(WIDTH))
+    for i in range(NB_IMAGES)]
+stream_file = os.path.join(args.workdir, 'images.raw')
+stream_dir = os.path.join(args.workdir, 'images')
+os.makedirs(stream_dir, exist_ok=True)
+with open(stream_file, 'wb') as file:
+    file.write(b''.join(images))
+for i, image in enumerate(images):
+    with open(os.path.join(stream_dir, 'image_%d.raw' % i), 'wb') as file:
+        file.write(image)
+
+runs = [
+    ('edges', stream_file, False, False, None),
+    ('bursts', stream_file, True, True, None),
+    ('bursts_dir', stream_dir, True, True, None),
+    ('bursts_rx_edges', stream_file, True, False, None),
+    ('bursts_relay_edges', stream_file, True, True, 'edges'),
+    ('bursts_relay_muxed', stream_file, True, True, 'muxed'),
+]
+
+logs = {}
+for name, stream, burst, rx_bursts, relay in runs:
+    path = os.path.join(args.workdir, 'rx_%s.txt' % name)
+    config_path = os.path.join(args.workdir, 'config_%s.json' % name)
+
+    if gvsoc_test.run(args.launcher, models_dir, get_config(stream, burst, rx_bursts, relay, path),
+            config_path) != 0:
+        print('Failed to run %s' % name)
+        sys.exit(1)
+
+    with open(path) as file:
+        logs[name] = [line.split() for line in file.readlines()]
+
+# Lines are "frame <index> <start cycle> <pixels> <checksum>", then "end"
+expected = [['frame', str(i), str(WIDTH * HEIGHT), '0x%x' % checksum(images[i % NB_IMAGES])]
+    for i in range(NB_FRAMES)]
+reference = logs['edges']
+
+error = False
+for name, log in logs.items():
+    mismatches = abs(len(log) - len(expected) - 1)
+    if len(log) == 0 or log[-1] != ['end']:
+        mismatches += 1
+
+    for i, (expected_line, line) in enumerate(zip(expected, log[:-1])):
+        if len(line) != 5 or line[0:2] + line[3:5] != expected_line:
+            mismatches += 1
+        # Bursts are received when they start, while edges are sampled on the pixel clock
+        # rising edge, which comes up to one pixel clock cycle later
+        elif i < len(reference) and abs(int(line[2]) - int(reference[i][2])) > 2:
+            mismatches += 1
+
+    print('%-20s %s (%d mismatches)' % (name, 'OK' if mismatches == 0 else 'MISMATCH', mismatches))
+    if mismatches != 0:
+        error = True
+
+sys.exit(1 if error else 0)
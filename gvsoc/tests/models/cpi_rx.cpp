@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// CPI receiver used to compare edges and bursts on the cpi interface. It receives the
+// frames of a camera and logs, for each of them, the cycle where it started, the number
+// of pixel bytes and a checksum of them. The engine is stopped after the configured number
+// of frames, since the camera never stops.
+// The "bursts" property tells if the receiver handles bursts, otherwise the master port
+// converts them into edges.
+// The same module also provides a relay, which forwards the interface from its input
+// to its output, so that bursts can go through a slave binding its methods in various
+// ways:
+//   - "edges": no burst method, bursts are converted into edges by the master port.
+//   - "muxed": muxed sync and burst methods.
+
+#include <vp/vp.hpp>
+#include <vp/itf/cpi.hpp>
+#include <stdio.h>
+
+#define CPI_RX_MUX_ID 1
+
+class cpi_rx : public vp::component
+{
+public:
+    cpi_rx(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void sync(void *__this, int pclk, int href, int vsync, int data);
+    static void burst(void *__this, int href, int vsync, uint8_t *data, int size);
+
+    void cycle(int href, int vsync, int data);
+
+    vp::cpi_slave in_itf;
+    FILE *file;
+    int nb_frames;
+    int frame = -1;
+    int64_t frame_cycle;
+    int last_vsync = 0;
+    int nb_pixels;
+    uint64_t checksum;
+};
+
+class cpi_relay : public vp::component
+{
+public:
+    cpi_relay(js::config *config);
+
+    int build();
+
+private:
+    static void in_sync(void *__this, int pclk, int href, int vsync, int data);
+    static void in_sync_muxed(void *__this, int pclk, int href, int vsync, int data, int id);
+    static void in_burst_muxed(void *__this, int href, int vsync, uint8_t *data, int size, int id);
+
+    void check_id(int id);
+
+    vp::cpi_slave in_itf;
+    vp::cpi_master out_itf;
+};
+
+cpi_rx::cpi_rx(js::config *config)
+    : vp::component(config)
+{
+}
+
+int cpi_rx::build()
+{
+    this->in_itf.set_sync_meth(&cpi_rx::sync);
+    if (this->get_js_config()->get_child_bool("bursts"))
+    {
+        this->in_itf.set_burst_meth(&cpi_rx::burst);
+    }
+    this->new_slave_port("input", &this->in_itf);
+
+    this->nb_frames = this->get_js_config()->get_child_int("nb_frames");
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void cpi_rx::reset(bool active)
+{
+    if (!active)
+    {
+        // Keep the engine alive until the receiver stops it, so that the status does not
+        // depend on when the camera events are executed
+        this->get_clock()->retain();
+    }
+}
+
+// Frames start on the rising edge of vsync, which is active high in the test
+void cpi_rx::cycle(int href, int vsync, int data)
+{
+    if (this->frame == this->nb_frames)
+        return;
+
+    if (vsync && !this->last_vsync)
+    {
+        if (this->frame >= 0)
+        {
+            fprintf(this->file, "frame %d %ld %d 0x%lx\n", this->frame, this->frame_cycle, this->nb_pixels,
+                this->checksum);
+        }
+
+        this->frame++;
+        if (this->frame == this->nb_frames)
+        {
+            fprintf(this->file, "end\n");
+            fclose(this->file);
+            this->get_clock()->stop_engine(0);
+            return;
+        }
+
+        this->frame_cycle = this->get_cycles();
+        this->nb_pixels = 0;
+        this->checksum = 0;
+    }
+
+    this->last_vsync = vsync;
+
+    if (href && this->frame >= 0)
+    {
+        this->checksum = this->checksum * 31 + data;
+        this->nb_pixels++;
+    }
+}
+
+void cpi_rx::sync(void *__this, int pclk, int href, int vsync, int data)
+{
+    cpi_rx *_this = (cpi_rx *)__this;
+    if (pclk)
+    {
+        _this->cycle(href, vsync, data);
+    }
+}
+
+void cpi_rx::burst(void *__this, int href, int vsync, uint8_t *data, int size)
+{
+    cpi_rx *_this = (cpi_rx *)__this;
+    for (int i=0; i<size; i++)
+    {
+        _this->cycle(href, vsync, data[i]);
+    }
+}
+
+cpi_relay::cpi_relay(js::config *config)
+    : vp::component(config)
+{
+}
+
+int cpi_relay::build()
+{
+    std::string relay = this->get_js_config()->get_child_str("relay");
+
+    if (relay == "muxed")
+    {
+        this->in_itf.set_sync_meth_muxed(&cpi_relay::in_sync_muxed, CPI_RX_MUX_ID);
+        this->in_itf.set_burst_meth_muxed(&cpi_relay::in_burst_muxed, CPI_RX_MUX_ID);
+    }
+    else if (relay == "edges")
+    {
+        this->in_itf.set_sync_meth(&cpi_relay::in_sync);
+    }
+    else
+    {
+        this->throw_error("Unknown relay mode (mode: " + relay + ")");
+    }
+
+    this->new_slave_port("input", &this->in_itf);
+    this->new_master_port("output", &this->out_itf);
+
+    return 0;
+}
+
+void cpi_relay::check_id(int id)
+{
+    if (id != CPI_RX_MUX_ID)
+    {
+        this->throw_error("Received wrong mux ID (id: " + std::to_string(id) + ")");
+    }
+}
+
+void cpi_relay::in_sync(void *__this, int pclk, int href, int vsync, int data)
+{
+    cpi_relay *_this = (cpi_relay *)__this;
+    _this->out_itf.sync(pclk, href, vsync, data);
+}
+
+void cpi_relay::in_sync_muxed(void *__this, int pclk, int href, int vsync, int data, int id)
+{
+    cpi_relay *_this = (cpi_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.sync(pclk, href, vsync, data);
+}
+
+void cpi_relay::in_burst_muxed(void *__this, int href, int vsync, uint8_t *data, int size, int id)
+{
+    cpi_relay *_this = (cpi_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.burst(href, vsync, data, size);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    if (config->get("relay") != NULL)
+        return new cpi_relay(config);
+    else
+        return new cpi_rx(config);
+}
@@ -0,0 +1,78 @@
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Helpers for the tests running small platforms with the launcher, without going
+# through the python generators.
+
+import json
+import os
+import subprocess
+
+
+def add_arguments(parser):
+    parser.add_argument('--launcher', required=True, help='GVSOC launcher')
+    parser.add_argument('--workdir', required=True, help='Directory where the models and the results are put')
+    parser.add_argument('--model', action='append', default=[], help='Model module and its library, as <module>=<path>')
+
+
+def link_models(workdir, models):
+    # The launcher finds the models from their module name under GVSOC_PATH
+    models_dir = os.path.join(workdir, 'models')
+    for model in models:
+        module, path = model.split('=')
+        link = os.path.join(models_dir, module.replace('.', '/') + '.so')
+        os.makedirs(os.path.dirname(link), exist_ok=True)
+        if os.path.lexists(link):
+            os.remove(link)
+        os.symlink(path, link)
+
+    return models_dir
+
+
+def get_config(comps, bindings, parallel=False):
+    target = { 'vp_comps': list(comps.keys()), 'vp_bindings': bindings }
+    target.update(comps)
+
+    return {
+        'target': target,
+        'gvsoc': {
+            'sa-mode': True,
+            'parallel': parallel,
+            'proxy': { 'enabled': False },
+            'traces': { 'enabled': False, 'level': 'debug', 'format': 'long', 'include_regex': [],
+                'exclude_regex': [] },
+            'events': { 'enabled': False, 'include_raw': [], 'include_regex': [], 'exclude_regex': [],
+                'format': 'fst', 'active': False, 'all': True, 'gtkw': False, 'gen_gtkw': False, 'files': [],
+                'traces': {}, 'tags': [], 'level': 0 }
+        }
+    }
+
+
+# Run the platform and return the launcher exit status, negative if it was killed by
+# a signal
+def run(launcher, models_dir, config, config_path):
+    with open(config_path, 'w') as file:
+        json.dump(config, file, indent=4)
+
+    env = dict(os.environ)
+    env['GVSOC_PATH'] = models_dir
+
+    return subprocess.run([launcher, '--config=' + config_path], env=env).returncode
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+# Writes and reads a HyperRAM and a HyperFlash with cycles and with bursts on the hyper
+# interface, either directly or through relays binding the interface methods in various
+# ways, and checks that all the reads give the same data as with cycles.
+#
+# Usage: hyper_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare cycles and bursts on the hyper interface')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+
+def get_config(device, burst, relay, path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('gen', vp_component='test.hyper_gen', file=path, burst=burst, device=device)
+    comp('mem', vp_component='devices.hyperbus.hyper%s_impl' % device, size=0x2000)
+
+    if relay is None:
+        bindings.append(['gen->hyper', 'mem->input'])
+        bindings.append(['gen->cs', 'mem->cs'])
+    else:
+        comp('relay', vp_component='test.hyper_gen', relay=relay)
+        bindings.append(['gen->hyper', 'relay->input'])
+        bindings.append(['gen->cs', 'relay->cs'])
+        bindings.append(['relay->output', 'mem->input'])
+        bindings.append(['relay->cs_out', 'mem->cs'])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    return gvsoc_test.get_config(comps, bindings)
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+runs = [('cycles', False, None), ('bursts', True, None)]
+for relay in ['cycles', 'muxed']:
+    runs.append(('bursts_relay_%s' % relay, True, relay))
+
+error = False
+for device in ['ram', 'flash']:
+    logs = {}
+    for name, burst, relay in runs:
+        path = os.path.join(args.workdir, 'gen_%s_%s.txt' % (device, name))
+        config_path = os.path.join(args.workdir, 'config_%s_%s.json' % (device, name))
+
+        # The engine stops with status -1 once it has no more events, so only a crash
+        # is an error here, the logs tell if all reads completed
+        if gvsoc_test.run(args.launcher, models_dir, get_config(device, burst, relay, path), config_path) < 0:
+            print('Failed to run %s with the %s' % (name, device))
+            sys.exit(1)
+
+        with open(path) as file:
+            logs[name] = [line.split() for line in file.readlines()]
+
+    # Lines are "read <address> <size> <checksum>", then "end"
+    reference = logs['cycles']
+    if len(reference) == 0 or reference[-1] != ['end']:
+        print('Reads did not complete with cycles on the %s' % device)
+        error = True
+        continue
+
+    for name, log in logs.items():
+        if name == 'cycles':
+            continue
+
+        mismatches = abs(len(log) - len(reference))
+        for ref_line, line in zip(reference, log):
+            if ref_line != line:
+                mismatches += 1
+
+        print('%-5s %-20s %s (%d mismatches)' % (device, name, 'OK' if mismatches == 0 else 'MISMATCH',
+            mismatches))
+        if mismatches != 0:
+            error = True
+
+sys.exit(1 if error else 0)
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// HyperBus master used to compare cycles and bursts on the hyper interface. It writes
+// and reads a HyperRAM, or programs and reads a HyperFlash, including accesses crossing
+// the end of the memory and flash register accesses, and logs a checksum of each read.
+// The same module also provides a relay, which forwards the interface from its input
+// to its output, so that bursts can go through a slave binding its methods in various
+// ways:
+//   - "cycles": no burst method, bursts are converted into cycles by the slave port.
+//   - "muxed": muxed sync and burst methods.
+
+#include <vp/vp.hpp>
+#include <vp/itf/hyper.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+
+#define HYPER_GEN_MUX_ID 2
+
+class hyper_gen : public vp::component
+{
+public:
+    hyper_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void rx_sync(void *__this, int data);
+
+    void transfer(uint32_t addr, uint8_t *data, int size, bool is_write);
+    void read(uint32_t addr, int size);
+    void flash_command(uint32_t addr, uint8_t cmd);
+    void ram_sequence();
+    void flash_sequence();
+
+    vp::hyper_master hyper_itf;
+    vp::wire_master<bool> cs_itf;
+    FILE *file;
+    bool burst;
+    uint8_t *rx_data;
+    uint8_t buffer[8192];
+};
+
+class hyper_relay : public vp::component
+{
+public:
+    hyper_relay(js::config *config);
+
+    int build();
+
+private:
+    static void in_sync(void *__this, int data);
+    static void in_sync_muxed(void *__this, int data, int id);
+    static void in_burst_muxed(void *__this, uint8_t *data, int size, bool is_write, int id);
+    static void out_sync(void *__this, int data);
+    static void cs_sync(void *__this, bool active);
+
+    void check_id(int id);
+
+    vp::hyper_slave in_itf;
+    vp::hyper_master out_itf;
+    vp::wire_slave<bool> cs_in_itf;
+    vp::wire_master<bool> cs_out_itf;
+};
+
+hyper_gen::hyper_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int hyper_gen::build()
+{
+    this->hyper_itf.set_sync_cycle_meth(&hyper_gen::rx_sync);
+    this->new_master_port("hyper", &this->hyper_itf);
+    this->new_master_port("cs", &this->cs_itf);
+
+    this->burst = this->get_js_config()->get_child_bool("burst");
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void hyper_gen::rx_sync(void *__this, int data)
+{
+    hyper_gen *_this = (hyper_gen *)__this;
+    *_this->rx_data++ = data;
+}
+
+// Sends the command-address header and then the data, either as a burst or cycle per
+// cycle, as the uDMA HyperBus master does
+void hyper_gen::transfer(uint32_t addr, uint8_t *data, int size, bool is_write)
+{
+    uint64_t ca = (uint64_t)(addr & 7) | ((uint64_t)(addr >> 3) << 16) | ((uint64_t)!is_write << 47);
+
+    this->cs_itf.sync(true);
+
+    for (int i=5; i>=0; i--)
+    {
+        this->hyper_itf.sync_cycle((ca >> (i * 8)) & 0xff);
+    }
+
+    if (this->burst)
+    {
+        this->hyper_itf.burst(data, size, is_write);
+    }
+    else
+    {
+        this->rx_data = data;
+        for (int i=0; i<size; i++)
+        {
+            this->hyper_itf.sync_cycle(is_write ? data[i] : 0);
+        }
+    }
+
+    this->cs_itf.sync(false);
+}
+
+void hyper_gen::read(uint32_t addr, int size)
+{
+    uint64_t checksum = 0;
+
+    memset(this->buffer, 0, size);
+    this->transfer(addr, this->buffer, size, false);
+
+    for (int i=0; i<size; i++)
+    {
+        checksum = checksum * 31 + this->buffer[i];
+    }
+
+    fprintf(this->file, "read 0x%x %d 0x%lx\n", addr, size, checksum);
+}
+
+// Flash commands are 16-bit words written at word addresses 0x555 or 0x2AA
+void hyper_gen::flash_command(uint32_t addr, uint8_t cmd)
+{
+    uint8_t data[2] = { cmd, 0 };
+    this->transfer(addr << 1, data, 2, true);
+}
+
+void hyper_gen::ram_sequence()
+{
+    for (int i=0; i<4096; i++)
+    {
+        this->buffer[i] = i * 13;
+    }
+    this->transfer(0x100, this->buffer, 4096, true);
+
+    // The part going past the end of the memory is dropped
+    this->transfer(0x1ffe, this->buffer, 7, true);
+
+    this->read(0x100, 1);
+    this->read(0x101, 3);
+    this->read(0x5ff, 4);
+    this->read(0x200, 32);
+    this->read(0x100, 4096);
+    this->read(0x1ffe, 7);
+    this->read(0x0, 8192);
+}
+
+void hyper_gen::flash_sequence()
+{
+    // Word programming of a buffer, then a read of the status register
+    this->flash_command(0x555, 0xaa);
+    this->flash_command(0x2aa, 0x55);
+    this->flash_command(0x555, 0xa0);
+    for (int i=0; i<256; i++)
+    {
+        this->buffer[i] = i * 13;
+    }
+    this->transfer(0x300, this->buffer, 256, true);
+
+    this->flash_command(0x555, 0x70);
+    this->read(0x0, 2);
+
+    this->read(0x300, 1);
+    this->read(0x301, 3);
+    this->read(0x2ff, 64);
+    this->read(0x300, 256);
+    this->read(0x1ffe, 7);
+    this->read(0x0, 8192);
+}
+
+// The interface has no timing, everything is done as soon as the platform is out of reset
+void hyper_gen::reset(bool active)
+{
+    if (active)
+        return;
+
+    if (this->get_js_config()->get_child_str("device") == "flash")
+        this->flash_sequence();
+    else
+        this->ram_sequence();
+
+    fprintf(this->file, "end\n");
+    fclose(this->file);
+}
+
+hyper_relay::hyper_relay(js::config *config)
+    : vp::component(config)
+{
+}
+
+int hyper_relay::build()
+{
+    std::string relay = this->get_js_config()->get_child_str("relay");
+
+    if (relay == "muxed")
+    {
+        this->in_itf.set_sync_cycle_meth_muxed(&hyper_relay::in_sync_muxed, HYPER_GEN_MUX_ID);
+        this->in_itf.set_burst_meth_muxed(&hyper_relay::in_burst_muxed, HYPER_GEN_MUX_ID);
+    }
+    else if (relay == "cycles")
+    {
+        this->in_itf.set_sync_cycle_meth(&hyper_relay::in_sync);
+    }
+    else
+    {
+        this->throw_error("Unknown relay mode (mode: " + relay + ")");
+    }
+
+    this->new_slave_port("input", &this->in_itf);
+
+    this->out_itf.set_sync_cycle_meth(&hyper_relay::out_sync);
+    this->new_master_port("output", &this->out_itf);
+
+    this->cs_in_itf.set_sync_meth(&hyper_relay::cs_sync);
+    this->new_slave_port("cs", &this->cs_in_itf);
+    this->new_master_port("cs_out", &this->cs_out_itf);
+
+    return 0;
+}
+
+void hyper_relay::check_id(int id)
+{
+    if (id != HYPER_GEN_MUX_ID)
+    {
+        this->throw_error("Received wrong mux ID (id: " + std::to_string(id) + ")");
+    }
+}
+
+void hyper_relay::in_sync(void *__this, int data)
+{
+    hyper_relay *_this = (hyper_relay *)__this;
+    _this->out_itf.sync_cycle(data);
+}
+
+void hyper_relay::in_sync_muxed(void *__this, int data, int id)
+{
+    hyper_relay *_this = (hyper_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.sync_cycle(data);
+}
+
+void hyper_relay::in_burst_muxed(void *__this, uint8_t *data, int size, bool is_write, int id)
+{
+    hyper_relay *_this = (hyper_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.burst(data, size, is_write);
+}
+
+void hyper_relay::out_sync(void *__this, int data)
+{
+    hyper_relay *_this = (hyper_relay *)__this;
+    _this->in_itf.sync_cycle(data);
+}
+
+void hyper_relay::cs_sync(void *__this, bool active)
+{
+    hyper_relay *_this = (hyper_relay *)__this;
+    _this->cs_out_itf.sync(active);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    if (config->get("relay") != NULL)
+        return new hyper_relay(config);
+    else
+        return new hyper_gen(config);
+}
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+# Drives two chained microphones and a speaker with edges and with frames on the i2s
+# interface, either directly or through the padframe, and checks that the received
+# words and the speaker output are the same as with edges. Also checks that the words
+# are the ones of the microphone stimuli, and that 16-bit and 24-bit WAV stimuli give
+# the same words as hex stimuli.
+#
+# Usage: i2s_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import struct
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare edges and frames on the i2s interface')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+NB_PERIODS = 40
+NB_SAMPLES = 16
+
+
+def get_config(frame, padframe, stim, path, speaker_path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    def microphone(name, stim):
+        comp(name, vp_component='devices.sound.i2s_microphone', channel='right', width=16, frequency=0,
+            enabled=True, pdm=0, stim_mode='file', stim=stim, **{'ws-delay': 1})
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('gen', vp_component='test.i2s_gen', file=path, frame=frame, nb_periods=NB_PERIODS)
+    microphone('mic0', stim)
+    microphone('mic1', stim_paths['hex'][1])
+    comp('speaker', vp_component='devices.sound.i2s_speaker', out_mode='file', outfile=speaker_path,
+        width=16, **{'ws-delay': 1, 'sample-rate': 16000})
+
+    if padframe:
+        comp('padframe', vp_component='pulp.padframe.padframe_v1_impl', groups={'i2s0': {'type': 'i2s'}})
+        bindings.append(['padframe->i2s0', 'gen->i2s'])
+        bus = 'padframe->i2s0_pad'
+    else:
+        bus = 'gen->i2s'
+
+    for device in ['mic0', 'mic1', 'speaker']:
+        bindings.append(['%s->i2s' % device, bus])
+
+    # The second microphone starts its slot when the first one is done
+    bindings.append(['mic0->ws_out', 'mic1->ws_in'])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    return gvsoc_test.get_config(comps, bindings)
+
+
+# The sample rate gives one sample per WS period, so that the microphone, which
+# interpolates the samples depending on the time, reads the same samples as from a hex file
+def write_wav(path, samples, bits):
+    rate = 100000000 // (2 * 4 * 16)
+    data = b''.join(struct.pack('<i', sample << (bits - 16))[0:bits // 8] for sample in samples)
+    with open(path, 'wb') as file:
+        file.write(b'RIFF' + struct.pack('<I', 36 + len(data)) + b'WAVE')
+        file.write(b'fmt ' + struct.pack('<IHHIIHH', 16, 1, 1, rate, rate * bits // 8, bits // 8, bits))
+        file.write(b'data' + struct.pack('<I', len(data)) + data)
+
+
+def read_log(path):
+    with open(path) as file:
+        return [line.split() for line in file.readlines()]
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+samples = [[((i * 0x3b1 + mic * 0x1f0f + 0x1234) & 0xffff) for i in range(NB_SAMPLES)] for mic in range(2)]
+stim_paths = {'hex': [], 'wav16': os.path.join(args.workdir, 'stim_16.wav'),
+    'wav24': os.path.join(args.workdir, 'stim_24.wav')}
+for mic in range(2):
+    path = os.path.join(args.workdir, 'stim_%d.hex' % mic)
+    stim_paths['hex'].append(path)
+    with open(path, 'w') as file:
+        file.writelines('0x%04x\n' % sample for sample in samples[mic])
+
+signed_samples = [sample - 0x10000 if sample & 0x8000 else sample for sample in samples[0]]
+write_wav(stim_paths['wav16'], signed_samples, 16)
+write_wav(stim_paths['wav24'], signed_samples, 24)
+
+runs = [
+    ('edges', False, False, 'hex'),
+    ('frames', True, False, 'hex'),
+    ('edges_padframe', False, True, 'hex'),
+    ('frames_padframe', True, True, 'hex'),
+    ('edges_wav16', False, False, 'wav16'),
+    ('edges_wav24', False, False, 'wav24'),
+    ('frames_wav24', True, False, 'wav24'),
+]
+
+logs = {}
+for name, frame, padframe, stim in runs:
+    path = os.path.join(args.workdir, 'gen_%s.txt' % name)
+    speaker_path = os.path.join(args.workdir, 'speaker_%s.hex' % name)
+    config_path = os.path.join(args.workdir, 'config_%s.json' % name)
+    stim_path = stim_paths[stim][0] if stim == 'hex' else stim_paths[stim]
+
+    if gvsoc_test.run(args.launcher, models_dir, get_config(frame, padframe, stim_path, path, speaker_path),
+            config_path) != 0:
+        print('Failed to run %s' % name)
+        sys.exit(1)
+
+    logs[name] = (read_log(path), read_log(speaker_path))
+
+error = False
+
+# Lines are "period <index> <slot words>...", then "end". The microphones send their
+# samples one after the other, the first one only starting with the second period.
+reference, reference_speaker = logs['edges']
+words = [word for line in reference if line[0] == 'period' for word in line[2:] if word != '-']
+expected = ['0x%04x' % samples[1][0]]
+for i in range(1, NB_PERIODS):
+    expected += ['0x%04x' % samples[mic][i % NB_SAMPLES] for mic in range(2)]
+if len(reference) != NB_PERIODS + 1 or reference[-1] != ['end'] or len(reference_speaker) == 0 or \
+        len(words) < NB_PERIODS or words != expected[0:len(words)]:
+    print('Received words do not match the stimuli with edges')
+    error = True
+
+for name, (log, speaker) in logs.items():
+    if name == 'edges':
+        continue
+
+    mismatches = abs(len(log) - len(reference)) + abs(len(speaker) - len(reference_speaker))
+    for ref_line, line in zip(reference + reference_speaker, log + speaker):
+        if ref_line != line:
+            mismatches += 1
+
+    print('%-20s %s (%d mismatches)' % (name, 'OK' if mismatches == 0 else 'MISMATCH', mismatches))
+    if mismatches != 0:
+        error = True
+
+sys.exit(1 if error else 0)
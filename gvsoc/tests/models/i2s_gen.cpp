@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// I2S clock provider used to compare edges and frames on the i2s interface. It generates
+// the clock and a WS pulse at the beginning of each period of 4 slots of 16 bits, drives
+// an incrementing value on the output data line for speakers, and logs the words received
+// on the input data line from microphones. A slot word is made of the 16 bits following
+// the start of the slot, since the devices have a WS delay of one bit, and is logged as
+// "-" if no device drove all of its bits.
+// The "frame" property tells if each period is sent as a single frame, otherwise it is
+// sent edge per edge, one edge per clock cycle. The engine is stopped after the configured
+// number of periods, since the devices never stop.
+
+#include <vp/vp.hpp>
+#include <vp/itf/i2s.hpp>
+#include <stdio.h>
+#include <vector>
+
+#define I2S_GEN_NB_SLOTS   4
+#define I2S_GEN_SLOT_WIDTH 16
+#define I2S_GEN_NB_EDGES   (2 * I2S_GEN_NB_SLOTS * I2S_GEN_SLOT_WIDTH)
+
+class i2s_gen : public vp::component
+{
+public:
+    i2s_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void rx_sync(void *__this, int sck, int ws, int sd);
+    static void handler(void *__this, vp::clock_event *event);
+
+    void drive(int cycle, int *ws, int *sd);
+    void sample(int sd);
+    void end_period();
+
+    vp::i2s_slave i2s_itf;
+    vp::clock_event *event;
+    FILE *file;
+    bool frame_mode;
+    int nb_periods;
+    int period = 0;
+    int edge = 0;
+    int rx_sd = 2;
+    int ws;
+    int sd;
+    uint32_t tx_value = 0x1111;
+    int nb_samples = 0;
+    uint32_t rx_word = 0;
+    bool rx_word_valid = true;
+};
+
+i2s_gen::i2s_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int i2s_gen::build()
+{
+    this->i2s_itf.set_sync_meth(&i2s_gen::rx_sync);
+    this->new_slave_port("i2s", &this->i2s_itf);
+
+    this->event = this->event_new(&i2s_gen::handler);
+
+    this->frame_mode = this->get_js_config()->get_child_bool("frame");
+    this->nb_periods = this->get_js_config()->get_child_int("nb_periods");
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void i2s_gen::reset(bool active)
+{
+    if (!active)
+    {
+        // Keep the engine alive until the generator stops it, so that the status does not
+        // depend on the device events
+        this->get_clock()->retain();
+        this->event_enqueue(this->event, 1);
+        fprintf(this->file, "period 0");
+    }
+}
+
+void i2s_gen::rx_sync(void *__this, int sck, int ws, int sd)
+{
+    i2s_gen *_this = (i2s_gen *)__this;
+    _this->rx_sd = sd;
+}
+
+// Data line 0 is the input from the microphones, left in high-impedance, and data line 1
+// is the output to the speaker
+void i2s_gen::drive(int cycle, int *ws, int *sd)
+{
+    int bit = (this->tx_value >> (I2S_GEN_SLOT_WIDTH - 1 - cycle % I2S_GEN_SLOT_WIDTH)) & 1;
+
+    *ws = cycle == 0;
+    *sd = 2 | (bit << 2);
+
+    if (cycle % I2S_GEN_SLOT_WIDTH == I2S_GEN_SLOT_WIDTH - 1)
+    {
+        this->tx_value += 0x1234;
+    }
+}
+
+void i2s_gen::sample(int sd)
+{
+    int bit = this->nb_samples++ % I2S_GEN_SLOT_WIDTH;
+
+    this->rx_word = (this->rx_word << 1) | (sd & 1);
+    if ((sd & 3) > 1)
+    {
+        this->rx_word_valid = false;
+    }
+
+    // The word of a slot ends with the first bit of the next slot
+    if (bit == 0 && this->nb_samples > 1)
+    {
+        if (this->rx_word_valid)
+            fprintf(this->file, " 0x%04x", this->rx_word & 0xffff);
+        else
+            fprintf(this->file, " -");
+
+        this->rx_word = 0;
+        this->rx_word_valid = true;
+    }
+}
+
+void i2s_gen::end_period()
+{
+    this->period++;
+    if (this->period == this->nb_periods)
+    {
+        fprintf(this->file, "\nend\n");
+        fclose(this->file);
+        this->get_clock()->stop_engine(0);
+        return;
+    }
+
+    fprintf(this->file, "\nperiod %d", this->period);
+    this->event_enqueue(this->event, this->frame_mode ? I2S_GEN_NB_EDGES : 1);
+}
+
+void i2s_gen::handler(void *__this, vp::clock_event *event)
+{
+    i2s_gen *_this = (i2s_gen *)__this;
+
+    if (_this->frame_mode)
+    {
+        std::vector<uint8_t> ws(I2S_GEN_NB_EDGES), sd_out(I2S_GEN_NB_EDGES), sd_in(I2S_GEN_NB_EDGES, 0xA);
+
+        for (int i=0; i<I2S_GEN_NB_EDGES; i+=2)
+        {
+            int edge_ws, edge_sd;
+            _this->drive(i / 2, &edge_ws, &edge_sd);
+            ws[i] = ws[i + 1] = edge_ws;
+            sd_out[i] = sd_out[i + 1] = edge_sd;
+        }
+
+        _this->i2s_itf.frame(I2S_GEN_NB_EDGES, 0, ws.data(), sd_out.data(), sd_in.data());
+
+        // The data is sampled on the rising edge, with the value driven after the falling edge
+        for (int i=0; i<I2S_GEN_NB_EDGES; i+=2)
+        {
+            _this->sample(sd_in[i]);
+        }
+
+        _this->end_period();
+    }
+    else
+    {
+        if ((_this->edge & 1) == 0)
+        {
+            _this->drive(_this->edge / 2, &_this->ws, &_this->sd);
+            _this->i2s_itf.sync(0, _this->ws, _this->sd);
+        }
+        else
+        {
+            _this->sample(_this->rx_sd);
+            _this->i2s_itf.sync(1, _this->ws, _this->sd);
+        }
+
+        _this->edge++;
+        if (_this->edge == I2S_GEN_NB_EDGES)
+        {
+            _this->edge = 0;
+            _this->end_period();
+        }
+        else
+        {
+            _this->event_enqueue(_this->event, 1);
+        }
+    }
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new i2s_gen(config);
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Checks that accesses to an interleaved memory land at the right place in the
+// banks whatever their size and alignment.
+// The memory is first filled word per word, then a pseudo-random sequence of reads
+// and writes of 1 to 64 bytes at any alignment is done, either with normal requests
+// or with debug requests, and checked against a copy of the memory. The memory is
+// finally read back word per word. The engine is stopped with status 0 if everything
+// matched and 1 otherwise.
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+class interleaver_check : public vp::component
+{
+public:
+    interleaver_check(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void check_handler(void *__this, vp::clock_event *event);
+
+    bool access(uint64_t addr, uint8_t *data, uint64_t size, bool is_write, bool is_debug);
+    bool check(uint64_t addr, uint8_t *data, uint64_t size, const char *name);
+
+    vp::io_master out;
+    vp::clock_event *event;
+
+    int nb_accesses;
+    int mem_size;
+    uint64_t seed;
+
+    std::vector<uint8_t> ref;
+};
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+interleaver_check::interleaver_check(js::config *config)
+    : vp::component(config)
+{
+}
+
+int interleaver_check::build()
+{
+    this->new_master_port("out", &this->out);
+
+    this->event = this->event_new(&interleaver_check::check_handler);
+
+    this->nb_accesses = this->get_js_config()->get_child_int("nb_accesses");
+    this->mem_size = this->get_js_config()->get_child_int("mem_size");
+    this->seed = this->get_js_config()->get_child_int("seed");
+
+    return 0;
+}
+
+void interleaver_check::reset(bool active)
+{
+    if (!active)
+    {
+        // Keep the engine alive until the check stops it, otherwise it could also see
+        // that there is no more event and report that instead of the check status
+        this->get_clock()->retain();
+        this->event_enqueue(this->event, 1);
+    }
+}
+
+bool interleaver_check::access(uint64_t addr, uint8_t *data, uint64_t size, bool is_write, bool is_debug)
+{
+    vp::io_req_status_e status;
+
+    if (is_debug)
+    {
+        status = this->out.debug_req(addr, data, size, is_write);
+    }
+    else
+    {
+        vp::io_req req;
+        req.init();
+        req.set_addr(addr);
+        req.set_size(size);
+        req.set_is_write(is_write);
+        req.set_data(data);
+        status = this->out.req(&req);
+    }
+
+    // The banks are synchronous, anything else than a direct reply is an error
+    if (status != vp::IO_REQ_OK)
+    {
+        fprintf(stderr, "Access failed (addr: 0x%lx, size: 0x%lx, is_write: %d, is_debug: %d, status: %d)\n",
+            addr, size, is_write, is_debug, status);
+        return false;
+    }
+
+    return true;
+}
+
+bool interleaver_check::check(uint64_t addr, uint8_t *data, uint64_t size, const char *name)
+{
+    for (uint64_t i = 0; i < size; i++)
+    {
+        if (data[i] != this->ref[addr + i])
+        {
+            fprintf(stderr, "Mismatch on %s (addr: 0x%lx, size: 0x%lx, byte: 0x%lx, expected: 0x%x, got: 0x%x)\n",
+                name, addr, size, addr + i, this->ref[addr + i], data[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void interleaver_check::check_handler(void *__this, vp::clock_event *event)
+{
+    interleaver_check *_this = (interleaver_check *)__this;
+    uint8_t data[64];
+    bool ok = true;
+
+    _this->ref.resize(_this->mem_size);
+
+    for (uint64_t addr = 0; addr < (uint64_t)_this->mem_size && ok; addr += 4)
+    {
+        uint32_t value = mix(addr + (_this->seed << 32));
+        memcpy(&_this->ref[addr], &value, 4);
+        ok = _this->access(addr, (uint8_t *)&value, 4, true, false);
+    }
+
+    for (int i = 0; i < _this->nb_accesses && ok; i++)
+    {
+        uint64_t key = mix((_this->seed << 32) + i + 0x80000000);
+        bool is_write = key & 1;
+        bool is_debug = (key >> 1) & 1;
+        uint64_t size = 1 + (key >> 8) % 64;
+        uint64_t addr = (key >> 16) % (_this->mem_size - size + 1);
+
+        if (is_write)
+        {
+            for (uint64_t j = 0; j < size; j++)
+            {
+                data[j] = mix(key + j);
+            }
+            memcpy(&_this->ref[addr], data, size);
+            ok = _this->access(addr, data, size, true, is_debug);
+        }
+        else
+        {
+            ok = _this->access(addr, data, size, false, is_debug) &&
+                _this->check(addr, data, size, is_debug ? "debug read" : "read");
+        }
+    }
+
+    for (uint64_t addr = 0; addr < (uint64_t)_this->mem_size && ok; addr += 4)
+    {
+        ok = _this->access(addr, data, 4, false, false) && _this->check(addr, data, 4, "final read");
+    }
+
+    printf("Interleaver check %s\n", ok ? "passed" : "failed");
+
+    _this->get_clock()->stop_engine(ok ? 0 : 1);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new interleaver_check(config);
+}
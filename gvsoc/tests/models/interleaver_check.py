@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Runs the interleaver check model on the cluster L1 interleaver, once with banks
+# modeling bandwidth, which never grant direct accesses, and once with banks granting
+# them, so that debug requests go through both the request and the host pointer paths.
+#
+# Usage: interleaver_check.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Check accesses through the L1 interleaver')
+gvsoc_test.add_arguments(parser)
+parser.add_argument('--nb-accesses', type=int, default=20000, help='Number of random accesses')
+parser.add_argument('--nb-banks', type=int, default=16, help='Number of banks')
+args = parser.parse_args()
+
+
+def get_config(width_bits):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    bank_size = 1024
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('check', vp_component='test.interleaver_check', nb_accesses=args.nb_accesses,
+        mem_size=bank_size * args.nb_banks, seed=width_bits)
+    comp('interleaver', vp_component='pulp.cluster.l1_interleaver_impl', nb_slaves=args.nb_banks,
+        nb_masters=0, stage_bits=0)
+
+    bindings.append(['check->out', 'interleaver->in'])
+
+    for i in range(0, args.nb_banks):
+        comp('bank%d' % i, vp_component='memory.memory_impl', size=bank_size, width_bits=width_bits)
+        bindings.append(['interleaver->out_%d' % i, 'bank%d->input' % i])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    return gvsoc_test.get_config(comps, bindings)
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+error = False
+for width_bits in [2, 0]:
+    config_path = os.path.join(args.workdir, 'config_%d.json' % width_bits)
+    status = gvsoc_test.run(args.launcher, models_dir, get_config(width_bits), config_path)
+    if status != 0:
+        print('Check failed with width_bits %d (status: %d)' % (width_bits, status))
+        error = True
+
+sys.exit(1 if error else 0)
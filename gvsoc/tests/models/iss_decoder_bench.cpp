@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Compares the decoding done by the functions generated by isa_gen with the one
+// interpreting the decoder tables, on random 16 and 32 bits opcodes, for all the ISAs
+// of an ISS model. Both must select the same instruction and produce exactly the same
+// instruction state, including the latency set on the next instruction.
+// The decoding throughput of both is then measured, for the first ISA decoding each
+// opcode, as the ISS does.
+//
+// The ISS is loaded from its model library, which must have been built with the same
+// flags as this benchmark, so that the structures have the same layout. The table
+// decoding is a copy of the one from decoder.cpp, which is static there.
+//
+// Usage: iss_decoder_bench <iss library> [nb_opcodes]
+
+#include "iss.hpp"
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+static iss_insn_t *next_insn;
+
+// Replaces the one of the ISS, so that the latency set on the next instruction can be
+// checked
+iss_insn_t *insn_cache_get(iss_t *iss, iss_addr_t pc)
+{
+    return next_insn;
+}
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static iss_opcode_t get_opcode(uint64_t index)
+{
+    iss_opcode_t opcode = (uint32_t)mix(index);
+    // Half of the opcodes are compressed ones
+    return index & 1 ? opcode & 0xffff : opcode;
+}
+
+static uint64_t decode_ranges(iss_opcode_t opcode, iss_decoder_range_set_t *range_set, bool is_signed)
+{
+    uint64_t result = 0;
+    int bits = 0;
+    for (int i = 0; i < range_set->nb_ranges; i++)
+    {
+        iss_decoder_range_t *range = &range_set->ranges[i];
+        result |= iss_get_field(opcode, range->bit, range->width) << range->shift;
+        int last_bit = range->width + range->shift;
+        if (last_bit > bits)
+            bits = last_bit;
+    }
+    if (is_signed)
+        result = iss_get_signed_value(result, bits);
+    return result;
+}
+
+static int decode_info(iss_opcode_t opcode, iss_decoder_arg_info_t *info, bool is_signed)
+{
+    if (info->type == ISS_DECODER_VALUE_TYPE_RANGE)
+        return decode_ranges(opcode, &info->u.range_set, is_signed);
+    else if (info->type == ISS_DECODER_VALUE_TYPE_UIM)
+        return info->u.uim;
+    else if (info->type == ISS_DECODER_VALUE_TYPE_SIM)
+        return info->u.sim;
+    return 0;
+}
+
+static void table_decode_reg(iss_insn_t *insn, int id, int index, bool is_out)
+{
+    if (is_out)
+    {
+        if (id >= insn->nb_out_reg)
+            insn->nb_out_reg = id + 1;
+        insn->out_regs[id] = index;
+    }
+    else
+    {
+        if (id >= insn->nb_in_reg)
+            insn->nb_in_reg = id + 1;
+        insn->in_regs[id] = index;
+    }
+}
+
+static void table_decode_args(iss_insn_t *insn, iss_opcode_t opcode, iss_decoder_item_t *item)
+{
+    insn->nb_out_reg = 0;
+    insn->nb_in_reg = 0;
+
+    for (int i = 0; i < item->u.insn.nb_args; i++)
+    {
+        if (i < ISS_MAX_NB_OUT_REGS)
+            insn->out_regs[i] = -1;
+        if (i < ISS_MAX_NB_IN_REGS)
+            insn->in_regs[i] = -1;
+    }
+
+    for (int i = 0; i < item->u.insn.nb_args; i++)
+    {
+        iss_decoder_arg_t *darg = &item->u.insn.args[i];
+        iss_insn_arg_t *arg = &insn->args[i];
+        arg->type = darg->type;
+        arg->flags = darg->flags;
+
+        switch (darg->type)
+        {
+            case ISS_DECODER_ARG_TYPE_IN_REG:
+            case ISS_DECODER_ARG_TYPE_OUT_REG:
+                arg->u.reg.index = decode_info(opcode, &darg->u.reg.info, false);
+                if (darg->flags & ISS_DECODER_ARG_FLAG_COMPRESSED)
+                    arg->u.reg.index += 8;
+#ifndef ISS_SINGLE_REGFILE
+                if (darg->flags & ISS_DECODER_ARG_FLAG_FREG)
+                    arg->u.reg.index += ISS_NB_REGS;
+#endif
+                table_decode_reg(insn, darg->u.reg.id, arg->u.reg.index,
+                    darg->type == ISS_DECODER_ARG_TYPE_OUT_REG);
+
+                if (darg->type == ISS_DECODER_ARG_TYPE_OUT_REG && darg->u.reg.latency != 0)
+                {
+                    iss_insn_t *next = insn_cache_get(NULL, insn->addr + insn->size);
+                    next->input_latency_reg = arg->u.reg.index;
+                    next->input_latency = darg->u.reg.latency;
+                }
+                break;
+
+            case ISS_DECODER_ARG_TYPE_UIMM:
+                arg->u.uim.value = decode_ranges(opcode, &darg->u.uimm.info.u.range_set, darg->u.uimm.is_signed);
+                insn->uim[darg->u.uimm.id] = arg->u.uim.value;
+                break;
+
+            case ISS_DECODER_ARG_TYPE_SIMM:
+                arg->u.sim.value = decode_ranges(opcode, &darg->u.simm.info.u.range_set, darg->u.simm.is_signed);
+                insn->sim[darg->u.simm.id] = arg->u.sim.value;
+                break;
+
+            case ISS_DECODER_ARG_TYPE_INDIRECT_IMM:
+                arg->u.indirect_imm.reg_index = decode_info(opcode, &darg->u.indirect_imm.reg.info, false);
+                if (darg->u.indirect_imm.reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED)
+                    arg->u.indirect_imm.reg_index += 8;
+                table_decode_reg(insn, darg->u.indirect_imm.reg.id, arg->u.indirect_imm.reg_index, false);
+                arg->u.indirect_imm.imm = decode_info(opcode, &darg->u.indirect_imm.imm.info,
+                    darg->u.indirect_imm.imm.is_signed);
+                insn->sim[darg->u.indirect_imm.imm.id] = arg->u.indirect_imm.imm;
+                break;
+
+            case ISS_DECODER_ARG_TYPE_INDIRECT_REG:
+                arg->u.indirect_reg.base_reg_index = decode_info(opcode, &darg->u.indirect_reg.base_reg.info, false);
+                if (darg->u.indirect_reg.base_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED)
+                    arg->u.indirect_reg.base_reg_index += 8;
+                table_decode_reg(insn, darg->u.indirect_reg.base_reg.id, arg->u.indirect_reg.base_reg_index, false);
+
+                arg->u.indirect_reg.offset_reg_index = decode_info(opcode, &darg->u.indirect_reg.offset_reg.info, false);
+                if (darg->u.indirect_reg.offset_reg.flags & ISS_DECODER_ARG_FLAG_COMPRESSED)
+                    arg->u.indirect_reg.offset_reg_index += 8;
+                table_decode_reg(insn, darg->u.indirect_reg.offset_reg.id, arg->u.indirect_reg.offset_reg_index, false);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static iss_decoder_item_t *table_select(iss_opcode_t opcode, iss_decoder_item_t *item)
+{
+    if (item->is_insn)
+        return item;
+
+    iss_opcode_t group_opcode = (opcode >> item->u.group.bit) & ((1ULL << item->u.group.width) - 1);
+    iss_decoder_item_t *other = NULL;
+
+    for (int i = 0; i < item->u.group.nb_groups; i++)
+    {
+        iss_decoder_item_t *group = item->u.group.groups[i];
+        if (group_opcode == group->opcode && !group->opcode_others)
+            return table_select(opcode, group);
+        if (group->opcode_others)
+            other = group;
+    }
+
+    if (other)
+        return table_select(opcode, other);
+
+    return NULL;
+}
+
+static iss_decoder_item_t *generated_select(iss_opcode_t opcode, iss_decoder_item_t *item)
+{
+    if (item->is_insn)
+        return item;
+    return item->u.group.select(opcode);
+}
+
+static bool check(iss_isa_set_t *isa_set, uint64_t nb_opcodes)
+{
+    static iss_insn_t table_insn, generated_insn, table_next, generated_next;
+    uint64_t nb_decoded = 0, nb_mismatches = 0;
+
+    for (uint64_t i = 0; i < nb_opcodes; i++)
+    {
+        iss_opcode_t opcode = get_opcode(i);
+
+        for (int j = 0; j < isa_set->nb_isa; j++)
+        {
+            iss_isa_t *isa = &isa_set->isa_set[j];
+            iss_decoder_item_t *item = table_select(opcode, isa->tree);
+
+            if (item != generated_select(opcode, isa->tree))
+            {
+                if (nb_mismatches++ < 10)
+                    fprintf(stderr, "Selection mismatch (isa: %s, opcode: 0x%x)\n", isa->name, (unsigned)opcode);
+                continue;
+            }
+
+            if (item == NULL)
+                continue;
+
+            nb_decoded++;
+
+            // Fill the instructions with garbage so that any field set by only one of
+            // the two decodings is caught
+            memset(&table_insn, 0xa5, sizeof(iss_insn_t));
+            memset(&generated_insn, 0xa5, sizeof(iss_insn_t));
+            memset(&table_next, 0x5a, sizeof(iss_insn_t));
+            memset(&generated_next, 0x5a, sizeof(iss_insn_t));
+            table_insn.addr = generated_insn.addr = 0x1000;
+            table_insn.size = generated_insn.size = item->u.insn.size;
+
+            next_insn = &table_next;
+            table_decode_args(&table_insn, opcode, item);
+            next_insn = &generated_next;
+            item->u.insn.decode_args(NULL, &generated_insn, opcode);
+
+            if (memcmp(&table_insn, &generated_insn, sizeof(iss_insn_t)) ||
+                memcmp(&table_next, &generated_next, sizeof(iss_insn_t)))
+            {
+                if (nb_mismatches++ < 10)
+                    fprintf(stderr, "Decoding mismatch (isa: %s, opcode: 0x%x, insn: %s)\n", isa->name,
+                        (unsigned)opcode, item->u.insn.label);
+            }
+        }
+    }
+
+    printf("Checked %ld opcodes, %ld decoded instructions, %ld mismatches\n", nb_opcodes, nb_decoded,
+        nb_mismatches);
+
+    return nb_mismatches == 0;
+}
+
+static double bench(iss_isa_set_t *isa_set, std::vector<iss_opcode_t> &opcodes, bool generated)
+{
+    static iss_insn_t insn, next;
+    next_insn = &next;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (iss_opcode_t opcode: opcodes)
+    {
+        for (int j = 0; j < isa_set->nb_isa; j++)
+        {
+            iss_decoder_item_t *tree = isa_set->isa_set[j].tree;
+            iss_decoder_item_t *item = generated ? generated_select(opcode, tree) : table_select(opcode, tree);
+            if (item == NULL)
+                continue;
+
+            insn.size = item->u.insn.size;
+            if (generated)
+                item->u.insn.decode_args(NULL, &insn, opcode);
+            else
+                table_decode_args(&insn, opcode, item);
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / opcodes.size();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <iss library> [nb_opcodes]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t nb_opcodes = argc > 2 ? atol(argv[2]) : 1000000;
+
+    void *handle = dlopen(argv[1], RTLD_NOW);
+    if (handle == NULL)
+    {
+        fprintf(stderr, "Failed to load ISS (error: %s)\n", dlerror());
+        return 1;
+    }
+
+    iss_isa_set_t *isa_set = (iss_isa_set_t *)dlsym(handle, "__iss_isa_set");
+    if (isa_set == NULL)
+    {
+        fprintf(stderr, "ISS has no ISA set (error: %s)\n", dlerror());
+        return 1;
+    }
+
+    bool ok = check(isa_set, nb_opcodes);
+
+    std::vector<iss_opcode_t> opcodes(nb_opcodes);
+    for (uint64_t i = 0; i < nb_opcodes; i++)
+    {
+        opcodes[i] = get_opcode(i + nb_opcodes);
+    }
+
+    double tables = bench(isa_set, opcodes, false);
+    double generated = bench(isa_set, opcodes, true);
+
+    printf("Decoding: generated %6.1f ns/opcode, tables %6.1f ns/opcode\n", generated, tables);
+
+    return ok ? 0 : 1;
+}
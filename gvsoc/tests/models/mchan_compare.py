@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Runs the same DMA transfers with the cycle-level and the fast modes of the mchan DMA,
+# for several external bandwidths, and checks that the data written back to L2 is the
+# same and that each phase completes at about the same cycle in both modes.
+#
+# Usage: mchan_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare the mchan cycle-level and fast modes')
+gvsoc_test.add_arguments(parser)
+parser.add_argument('--tolerance', type=float, default=0.02, help='Allowed relative difference of the phase cycles')
+args = parser.parse_args()
+
+
+def get_config(fast_mode, bandwidth, path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('gen', vp_component='test.mchan_gen', file=path)
+    comp('dma', vp_component='pulp.mchan.mchan_v7_impl', nb_channels=2, core_queue_depth=2,
+        global_queue_depth=8, is_64=False, max_nb_ext_read_req=8, max_nb_ext_write_req=8,
+        max_burst_length=256, nb_loc_ports=4, tcdm_addr_width=20, fast_mode=fast_mode)
+    comp('ico', vp_component='interco.router_impl', bandwidth=bandwidth, latency=0,
+        mappings={ 'l2': { 'base': 0x1c000000, 'size': 0x100000, 'remove_offset': 0x1c000000, 'latency': 10 } })
+    comp('l2', vp_component='memory.memory_impl', size=0x100000, width_bits=0)
+    comp('l1', vp_component='pulp.cluster.l1_interleaver_impl', nb_slaves=16, nb_masters=4, stage_bits=0)
+
+    for i in range(0, 16):
+        comp('bank%d' % i, vp_component='memory.memory_impl', size=0x1000, width_bits=0)
+        bindings.append(['l1->out_%d' % i, 'bank%d->input' % i])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    bindings.append(['gen->dma', 'dma->in_0'])
+    bindings.append(['gen->l2', 'l2->input'])
+    bindings.append(['dma->ext_itf', 'ico->input'])
+    bindings.append(['ico->l2', 'l2->input'])
+    for i in range(0, 4):
+        bindings.append(['dma->loc_itf_%d' % i, 'l1->in_%d' % i])
+    for itf in ['event_itf_0', 'irq_itf_0', 'event_itf_1', 'irq_itf_1', 'ext_irq_itf']:
+        bindings.append(['dma->%s' % itf, 'gen->event'])
+
+    return gvsoc_test.get_config(comps, bindings)
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+error = False
+for bandwidth in [0, 4, 16]:
+    logs = []
+    for fast_mode in [False, True]:
+        mode = 'fast' if fast_mode else 'cycle'
+        path = os.path.join(args.workdir, 'gen_%s_%d.txt' % (mode, bandwidth))
+        config_path = os.path.join(args.workdir, 'config_%s_%d.json' % (mode, bandwidth))
+
+        # The engine stops with status -1 once it has no more events, so only a crash
+        # is an error here, the logs tell if the generator completed
+        if gvsoc_test.run(args.launcher, models_dir, get_config(fast_mode, bandwidth, path), config_path) < 0:
+            print('Failed to run %s mode with bandwidth %d' % (mode, bandwidth))
+            sys.exit(1)
+
+        with open(path) as file:
+            logs.append([line.split() for line in file.readlines()])
+
+    cycle, fast = logs
+    if len(cycle) == 0 or cycle[-1][0] != 'end' or len(cycle) != len(fast) or fast[-1][0] != 'end':
+        print('Generator did not complete with bandwidth %d' % bandwidth)
+        error = True
+        continue
+
+    if cycle[-1][3] != fast[-1][3]:
+        print('Checksum mismatch with bandwidth %d (cycle: %s, fast: %s)' % (bandwidth, cycle[-1][3], fast[-1][3]))
+        error = True
+
+    # Lines are either "phase <index> <cycles>" or "end <cycles> checksum <checksum>"
+    for cycle_line, fast_line in zip(cycle, fast):
+        label = ' '.join(cycle_line[0:2]) if cycle_line[0] == 'phase' else 'end'
+        cycle_cycles = int(cycle_line[2] if cycle_line[0] == 'phase' else cycle_line[1])
+        fast_cycles = int(fast_line[2] if fast_line[0] == 'phase' else fast_line[1])
+        diff = abs(cycle_cycles - fast_cycles) / cycle_cycles
+        print('Bandwidth %d, %s: cycle %d, fast %d (%.2f%%)' % (bandwidth, label, cycle_cycles, fast_cycles,
+            diff * 100))
+        if diff > args.tolerance:
+            error = True
+
+sys.exit(1 if error else 0)
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Command generator used to compare the cycle-level and fast modes of the mchan DMA.
+// It fills the L2 with a known pattern, then pushes phases of transfers, first from L2
+// to TCDM and then back from TCDM to L2 at other addresses, with 1D, 2D and unaligned
+// transfers. It waits for the end of each phase by polling the DMA status, and logs
+// the cycle at which each phase completed, then a checksum of the L2 area written back.
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <vector>
+#include "archi/dma/mchan_v7.h"
+
+#define L2_BASE      0x1c000000
+#define TCDM_BASE    0x10000000
+
+struct mchan_gen_transfer
+{
+    bool ext2loc;
+    uint32_t loc;
+    uint32_t ext;
+    uint32_t size;
+    bool is_2d;
+    uint32_t length;
+    uint32_t stride;
+};
+
+class mchan_gen : public vp::component
+{
+public:
+    mchan_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void handler(void *__this, vp::clock_event *event);
+    static void response(void *__this, vp::io_req *req);
+    static void wire_sync(void *__this, bool value);
+
+    void step();
+    bool dma_access(uint32_t offset, uint32_t *value, bool is_write);
+    void l2_access(uint32_t addr, uint8_t *data, int size, bool is_write);
+
+    vp::io_master dma_itf;
+    vp::io_master l2_itf;
+    vp::wire_slave<bool> event_itf;
+    vp::clock_event *event;
+    vp::io_req req;
+    FILE *file;
+
+    std::vector<std::vector<mchan_gen_transfer>> phases;
+    int phase = 0;
+    int transfer = 0;
+    int word = 0;
+    bool pending = false;
+    uint32_t data;
+};
+
+mchan_gen::mchan_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int mchan_gen::build()
+{
+    this->dma_itf.set_resp_meth(&mchan_gen::response);
+    this->new_master_port("dma", &this->dma_itf);
+    this->new_master_port("l2", &this->l2_itf);
+
+    // The DMA events and interrupts are not used, the status is polled instead
+    this->event_itf.set_sync_meth(&mchan_gen::wire_sync);
+    this->new_slave_port("event", &this->event_itf);
+
+    this->event = this->event_new(&mchan_gen::handler);
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    this->phases.push_back({
+        { true, 0x0000, 0x00000, 8192, false, 0, 0 },
+        { true, 0x2000, 0x04000, 3000, true, 100, 300 },
+        { true, 0x3001, 0x0a003, 1001, false, 0, 0 },
+        { true, 0x4000, 0x0c000, 0x6000, true, 0x800, 0x1000 },
+    });
+
+    this->phases.push_back({
+        { false, 0x0000, 0x20000, 8192, false, 0, 0 },
+        { false, 0x2000, 0x30000, 3000, true, 100, 200 },
+        { false, 0x3001, 0x40005, 1001, false, 0, 0 },
+        { false, 0x4000, 0x50000, 0x6000, false, 0, 0 },
+    });
+
+    return 0;
+}
+
+void mchan_gen::reset(bool active)
+{
+    if (!active)
+    {
+        for (uint32_t addr = 0; addr < 0x60000; addr += 4)
+        {
+            uint32_t value = addr * 2654435761u;
+            this->l2_access(addr, (uint8_t *)&value, 4, true);
+        }
+
+        this->event_enqueue(this->event, 1);
+    }
+}
+
+void mchan_gen::wire_sync(void *__this, bool value)
+{
+}
+
+void mchan_gen::l2_access(uint32_t addr, uint8_t *data, int size, bool is_write)
+{
+    vp::io_req req(addr, data, size, is_write);
+    if (this->l2_itf.req(&req) != vp::IO_REQ_OK)
+    {
+        this->throw_error("Failed L2 access");
+    }
+}
+
+// Returns true if the access is done, otherwise the handler is called again once the
+// response is received
+bool mchan_gen::dma_access(uint32_t offset, uint32_t *value, bool is_write)
+{
+    vp::io_req *req = &this->req;
+
+    this->data = *value;
+    req->init();
+    req->set_addr(offset);
+    req->set_size(4);
+    req->set_is_write(is_write);
+    req->set_data((uint8_t *)&this->data);
+
+    vp::io_req_status_e status = this->dma_itf.req(req);
+    if (status == vp::IO_REQ_OK)
+    {
+        *value = this->data;
+        return true;
+    }
+    else if (status == vp::IO_REQ_INVALID)
+    {
+        this->throw_error("Invalid DMA access");
+    }
+
+    this->pending = true;
+    return false;
+}
+
+void mchan_gen::response(void *__this, vp::io_req *req)
+{
+    mchan_gen *_this = (mchan_gen *)__this;
+    _this->event_enqueue(_this->event, 1);
+}
+
+void mchan_gen::handler(void *__this, vp::clock_event *event)
+{
+    mchan_gen *_this = (mchan_gen *)__this;
+    _this->step();
+}
+
+// Does one DMA register access per call, like a core would do
+void mchan_gen::step()
+{
+    if (this->phase == (int)this->phases.size())
+    {
+        uint64_t checksum = 0;
+        for (uint32_t addr = 0x20000; addr < 0x60000; addr++)
+        {
+            uint8_t value;
+            this->l2_access(addr, &value, 1, false);
+            checksum = checksum * 31 + value;
+        }
+
+        fprintf(this->file, "end %ld checksum 0x%lx\n", this->get_cycles(), checksum);
+        fclose(this->file);
+        return;
+    }
+
+    std::vector<mchan_gen_transfer> &transfers = this->phases[this->phase];
+
+    if (this->transfer < (int)transfers.size())
+    {
+        mchan_gen_transfer *transfer = &transfers[this->transfer];
+
+        // A command first needs a counter, allocated by reading the command register
+        if (this->word == 0)
+        {
+            uint32_t value = 0;
+            if (!this->pending && !this->dma_access(MCHAN_CMD_OFFSET, &value, false))
+                return;
+
+            this->pending = false;
+            this->word++;
+            this->event_enqueue(this->event, 1);
+            return;
+        }
+
+        uint32_t words[] = {
+            transfer->size | (transfer->ext2loc << MCHAN_CMD_CMD_TYPE_BIT) | (1 << MCHAN_CMD_CMD_INC_BIT) |
+                (transfer->is_2d << MCHAN_CMD_CMD__2D_EXT_BIT) | (1 << MCHAN_CMD_CMD_ELE_BIT),
+            TCDM_BASE + transfer->loc,
+            L2_BASE + transfer->ext,
+            transfer->length,
+            transfer->stride
+        };
+        int nb_words = transfer->is_2d ? 5 : 3;
+
+        if (this->word <= nb_words)
+        {
+            this->pending = false;
+            uint32_t value = words[this->word - 1];
+            this->word++;
+            if (this->dma_access(MCHAN_CMD_OFFSET, &value, true))
+                this->event_enqueue(this->event, 1);
+            return;
+        }
+
+        this->word = 0;
+        this->transfer++;
+        this->event_enqueue(this->event, 1);
+        return;
+    }
+
+    // Once all transfers are pushed, poll the status until all counters are free
+    uint32_t status = 0;
+    this->dma_access(MCHAN_STATUS_OFFSET, &status, false);
+    if ((status & 0xffff) == 0)
+    {
+        fprintf(this->file, "phase %d %ld\n", this->phase, this->get_cycles());
+        status = 0xffff;
+        this->dma_access(MCHAN_STATUS_OFFSET, &status, true);
+        this->phase++;
+        this->transfer = 0;
+    }
+
+    this->event_enqueue(this->event, 50);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new mchan_gen(config);
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Runs the same NE16 jobs with the detailed and the fast modes, with the NE16 accessing
+# a TCDM made of the cluster L1 interleaver and of banks modeling bandwidth, as on the
+# chip, and checks that the memory is the same after each job in both modes.
+#
+# Usage: ne16_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare the NE16 detailed and fast modes')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+
+def get_config(fast_mode, path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('gen', vp_component='test.ne16_gen', file=path)
+    comp('ne16', vp_component='pulp.ne16.ne16')
+    comp('l1', vp_component='pulp.cluster.l1_interleaver_impl', nb_slaves=16, nb_masters=1, stage_bits=0)
+
+    for i in range(0, 16):
+        comp('bank%d' % i, vp_component='memory.memory_impl', size=0x2000, width_bits=2)
+        bindings.append(['l1->out_%d' % i, 'bank%d->input' % i])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    bindings.append(['gen->cfg', 'ne16->input'])
+    bindings.append(['gen->mem', 'l1->in_0'])
+    bindings.append(['ne16->out', 'l1->in'])
+    bindings.append(['ne16->irq', 'gen->irq'])
+
+    config = gvsoc_test.get_config(comps, bindings)
+    config['gvsoc']['ne16_fast_mode'] = fast_mode
+    return config
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+logs = []
+for fast_mode in [False, True]:
+    mode = 'fast' if fast_mode else 'detailed'
+    path = os.path.join(args.workdir, 'gen_%s.txt' % mode)
+    config_path = os.path.join(args.workdir, 'config_%s.json' % mode)
+
+    # The engine stops with status -1 once it has no more events, so only a crash is an
+    # error here, the logs tell if all jobs completed
+    if gvsoc_test.run(args.launcher, models_dir, get_config(fast_mode, path), config_path) < 0:
+        print('Failed to run %s mode' % mode)
+        sys.exit(1)
+
+    with open(path) as file:
+        logs.append([line.split() for line in file.readlines()])
+
+detailed, fast = logs
+error = len(detailed) == 0 or len(detailed) != len(fast)
+if error:
+    print('Jobs did not complete (detailed: %d, fast: %d)' % (len(detailed), len(fast)))
+
+# Lines are "<job> <memory hash> <cycles>", only the memory must be the same, the fast
+# mode does not model the memory latency
+for detailed_job, fast_job in zip(detailed, fast):
+    status = 'OK' if detailed_job[1] == fast_job[1] else 'MISMATCH'
+    print('%-12s %s (detailed: %s cycles, fast: %s cycles)' % (detailed_job[0], status, detailed_job[2],
+        fast_job[2]))
+    if detailed_job[1] != fast_job[1]:
+        error = True
+
+sys.exit(1 if error else 0)
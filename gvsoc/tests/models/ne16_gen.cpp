@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Job generator used to compare the detailed and fast modes of the NE16.
+// It runs a list of jobs covering the main NE16 modes, one after the other. Before each
+// job, the memory is filled with pseudo-random inputs, weights and quantization
+// parameters, and the output area is cleared. Once the job is done, a hash of the whole
+// memory is logged. The memory is accessed through the same interconnect as the NE16.
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+
+#define NE16_GEN_MEM_SIZE     0x20000
+#define NE16_GEN_OUTFEAT      0x10000
+#define NE16_GEN_SCALE        0x1C000
+#define NE16_GEN_SCALE_SHIFT  0x1D000
+#define NE16_GEN_SCALE_BIAS   0x1E000
+
+struct ne16_gen_job
+{
+    const char *name;
+    int kin, kout, hout, wout, qw;
+    int filter_mode, mode16, linear, quant, qbits, nbits, shift, bias, relu, streamin, strided;
+    uint32_t padding, filter_mask;
+    int right_shift;
+};
+
+static ne16_gen_job jobs[] = {
+    //name         kin kout hout wout qw fm m16 lin q qb nb sh bi relu si st padding     fmask       rsh
+    {"conv3x3",     24, 40,  5,  7,  8, 0, 0, 0, 1, 8, 8, 1, 1, 1, 0, 0, 0,          0,          0},
+    {"conv3x3_pad", 32, 32,  6,  6,  4, 0, 0, 0, 1, 8, 16,0, 1, 0, 0, 0, 0x11110000, 0,          12},
+    {"conv3x3_m16", 32, 16,  4,  4,  2, 0, 1, 0, 0, 32,32,1, 0, 1, 0, 0, 0,          0,          0},
+    {"conv1x1",     48, 64,  6,  5,  8, 2, 0, 0, 1, 8, 8, 0, 1, 1, 0, 0, 0,          0,          9},
+    {"conv1x1_32b", 16, 24,  3,  4,  3, 2, 0, 0, 0, 32,8, 0, 0, 0, 0, 0, 0,          0,          0},
+    {"dw3x3",       40, 40,  5,  5,  8, 1, 0, 0, 1, 8, 8, 1, 1, 1, 0, 0, 0,          0,          0},
+    {"dw3x3_mask",  16, 16,  3,  3,  5, 1, 0, 0, 1, 8, 8, 0, 1, 0, 0, 0, 0,          0x01000100, 7},
+    {"streamin",    16, 32,  3,  3,  8, 0, 0, 0, 0, 32,8, 0, 0, 0, 1, 0, 0,          0,          0},
+    {"strided",     16, 32,  6,  6,  8, 0, 0, 0, 1, 8, 8, 1, 1, 1, 0, 1, 0,          0,          0},
+    {"linear",      64, 32,  1,  1,  8, 2, 0, 1, 1, 8, 8, 1, 1, 1, 0, 0, 0,          0,          0},
+    {"linear_m16",  32, 32,  1,  1,  4, 2, 1, 1, 0, 32,8, 0, 0, 0, 0, 0, 0,          0,          0},
+};
+
+class ne16_gen : public vp::component
+{
+public:
+    ne16_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void handler(void *__this, vp::clock_event *event);
+    static void irq_sync(void *__this, bool value);
+
+    void start_job();
+    void mem_access(uint32_t addr, uint32_t *value, bool is_write);
+    void reg_access(int offset, uint32_t *value, bool is_write);
+    void reg_write(int reg, uint32_t value);
+
+    vp::io_master mem_itf;
+    vp::io_master cfg_itf;
+    vp::wire_slave<bool> irq_itf;
+    vp::clock_event *event;
+    FILE *file;
+
+    int job = 0;
+    int64_t job_start;
+};
+
+ne16_gen::ne16_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int ne16_gen::build()
+{
+    this->new_master_port("mem", &this->mem_itf);
+    this->new_master_port("cfg", &this->cfg_itf);
+    this->irq_itf.set_sync_meth(&ne16_gen::irq_sync);
+    this->new_slave_port("irq", &this->irq_itf);
+
+    this->event = this->event_new(&ne16_gen::handler);
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void ne16_gen::reset(bool active)
+{
+    if (!active)
+    {
+        this->event_enqueue(this->event, 1);
+    }
+}
+
+void ne16_gen::mem_access(uint32_t addr, uint32_t *value, bool is_write)
+{
+    vp::io_req req(addr, (uint8_t *)value, 4, is_write);
+    if (this->mem_itf.req(&req) != vp::IO_REQ_OK)
+    {
+        this->throw_error("Failed memory access");
+    }
+}
+
+void ne16_gen::reg_access(int offset, uint32_t *value, bool is_write)
+{
+    vp::io_req req(offset, (uint8_t *)value, 4, is_write);
+    this->cfg_itf.req(&req);
+}
+
+void ne16_gen::reg_write(int reg, uint32_t value)
+{
+    this->reg_access(0x20 + reg * 4, &value, true);
+}
+
+void ne16_gen::start_job()
+{
+    ne16_gen_job *job = &jobs[this->job];
+
+    uint32_t seed = 0x12345678 + this->job;
+    for (uint32_t addr = 0; addr < NE16_GEN_MEM_SIZE; addr += 4)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            value |= ((seed >> 16) & 0xff) << (i * 8);
+        }
+
+        if (addr >= NE16_GEN_OUTFEAT && addr < NE16_GEN_SCALE)
+            value = 0;
+        else if (addr >= NE16_GEN_SCALE_SHIFT && addr < NE16_GEN_SCALE_BIAS)
+            value &= 0x0f0f0f0f;
+
+        this->mem_access(addr, &value, true);
+    }
+
+    // Acquire a job slot
+    uint32_t value;
+    this->reg_access(0x4, &value, false);
+
+    int tp_out = job->filter_mode == 1 ? 16 : 32;
+    int nb_ko = (job->kout + tp_out - 1) / tp_out, rem_ko = job->kout % tp_out ? job->kout % tp_out : tp_out;
+    int nb_ki = (job->kin + 15) / 16, rem_ki = job->kin % 16 ? job->kin % 16 : 16;
+    int nb_ho = (job->hout + 2) / 3, rem_ho = job->hout % 3;
+    int nb_wo = (job->wout + 2) / 3, rem_wo = job->wout % 3;
+    int fs = job->filter_mode == 2 ? 1 : 3;
+    int win = job->wout + fs - 1;
+    int rem_hi = rem_ho ? rem_ho + fs - 1 : 0, rem_wi = rem_wo ? rem_wo + fs - 1 : 0;
+    int wbytes = job->mode16 ? 1 : 2;
+    int kin_bytes = job->kin * (job->linear && job->mode16 ? 2 : 1);
+    int obytes = job->qbits / 8;
+
+    this->reg_write(0, 0x4000);
+    this->reg_write(1, 0x0000);
+    this->reg_write(2, NE16_GEN_OUTFEAT);
+    this->reg_write(3, NE16_GEN_SCALE);
+    this->reg_write(4, NE16_GEN_SCALE_SHIFT);
+    this->reg_write(5, NE16_GEN_SCALE_BIAS);
+    this->reg_write(6, kin_bytes);
+    this->reg_write(7, kin_bytes * win);
+    this->reg_write(8, 0);
+    this->reg_write(9, 32);
+    this->reg_write(10, job->kout * obytes);
+    this->reg_write(11, job->kout * obytes * job->wout);
+    if (fs == 3)
+    {
+        this->reg_write(12, 9 * wbytes);
+        this->reg_write(13, 9 * wbytes * job->qw * nb_ki);
+    }
+    else
+    {
+        this->reg_write(12, wbytes * nb_ki * job->qw);
+        this->reg_write(13, wbytes * nb_ki * job->qw);
+    }
+    this->reg_write(14, 0);
+    this->reg_write(15, (rem_ko << 16) | rem_ki);
+    this->reg_write(16, (rem_ho << 16) | rem_wo);
+    this->reg_write(17, (rem_hi << 16) | rem_wi);
+    this->reg_write(18, (nb_ko << 16) | nb_ki);
+    this->reg_write(19, (nb_ho << 16) | nb_wo);
+    this->reg_write(20, job->padding | 0x5a);
+    this->reg_write(21, -(1 << (job->qw - 1)));
+    this->reg_write(22, job->filter_mask);
+    this->reg_write(23, (job->bias << 25) | (job->shift << 24) | ((!job->relu) << 23) |
+        ((job->qbits == 8 ? 0 : job->qbits == 16 ? 1 : 2) << 21) | (job->right_shift << 16) |
+        (job->streamin << 14) | ((job->nbits == 8 ? 0 : job->nbits == 16 ? 1 : 2) << 12) |
+        (job->strided << 8) | (job->linear << 7) | (job->filter_mode << 5) | (job->quant << 4) |
+        (job->mode16 << 3) | (job->qw - 1));
+
+    // Trigger the job
+    value = 0;
+    this->reg_access(0x0, &value, true);
+    this->job_start = this->get_cycles();
+}
+
+void ne16_gen::handler(void *__this, vp::clock_event *event)
+{
+    ne16_gen *_this = (ne16_gen *)__this;
+    _this->start_job();
+}
+
+void ne16_gen::irq_sync(void *__this, bool value)
+{
+    ne16_gen *_this = (ne16_gen *)__this;
+
+    if (!value)
+        return;
+
+    uint64_t hash = 0;
+    for (uint32_t addr = 0; addr < NE16_GEN_MEM_SIZE; addr += 4)
+    {
+        uint32_t value;
+        _this->mem_access(addr, &value, false);
+        hash = hash * 31 + value;
+    }
+
+    fprintf(_this->file, "%s 0x%016lx %ld\n", jobs[_this->job].name, hash, _this->get_cycles() - _this->job_start);
+
+    _this->job++;
+    if (_this->job == sizeof(jobs) / sizeof(jobs[0]))
+    {
+        fclose(_this->file);
+        return;
+    }
+
+    _this->event_enqueue(_this->event, 1);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new ne16_gen(config);
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Runs the same platform with two clock domain partitions in sequential and in
+# parallel mode, and checks that the generators logged the same accesses at the same
+# cycles in both modes.
+# Each partition has a generator and a memory. Each generator accesses the memory of
+# its partition directly, and the one of the other partition through a sync bridge.
+#
+# Usage: partition_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare sequential and parallel executions')
+gvsoc_test.add_arguments(parser)
+parser.add_argument('--nb-accesses', type=int, default=20000, help='Number of accesses of each generator')
+args = parser.parse_args()
+
+
+def get_config(parallel, mode):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    for i in range(0, 2):
+        other = 1 - i
+        # Different frequencies so that the clock domain crossings are also checked
+        comp('clk%d' % i, vp_component='vp.clock_domain_impl', frequency=100000000 - i * 30000000,
+            partition=i)
+        comp('gen%d' % i, vp_component='test.partition_gen', nb_accesses=args.nb_accesses, mem_size=1024,
+            seed=i, file=os.path.join(args.workdir, 'gen%d_%s.txt' % (i, mode)))
+        comp('mem%d' % i, vp_component='memory.memory_impl', size=1024, width_bits=0)
+        comp('bridge%d' % i, vp_component='interco.sync_bridge_impl', latency=20000 + i * 10000)
+
+        for name in ['gen%d' % i, 'mem%d' % i, 'bridge%d' % i]:
+            bindings.append(['clk%d->out' % i, '%s->clock' % name])
+        bindings.append(['clk%d->out' % other, 'bridge%d->out_clock' % i])
+        bindings.append(['gen%d->local' % i, 'mem%d->input' % i])
+        bindings.append(['gen%d->remote' % i, 'bridge%d->input' % i])
+        bindings.append(['bridge%d->out' % i, 'mem%d->input' % other])
+
+    return gvsoc_test.get_config(comps, bindings, parallel)
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+for parallel, mode in [(False, 'sequential'), (True, 'parallel')]:
+    config_path = os.path.join(args.workdir, 'config_%s.json' % mode)
+
+    # The engine stops with status -1 once it has no more events, so only a crash is
+    # an error here, the logs tell if the generators completed
+    if gvsoc_test.run(args.launcher, models_dir, get_config(parallel, mode), config_path) < 0:
+        print('Failed to run %s mode' % mode)
+        sys.exit(1)
+
+error = False
+for i in range(0, 2):
+    logs = []
+    for mode in ['sequential', 'parallel']:
+        with open(os.path.join(args.workdir, 'gen%d_%s.txt' % (i, mode))) as file:
+            logs.append(file.readlines())
+
+    if len(logs[0]) != args.nb_accesses + 1 or not logs[0][-1].startswith('end'):
+        print('Generator %d did not complete in sequential mode' % i)
+        error = True
+        continue
+
+    for line in range(0, max(len(logs[0]), len(logs[1]))):
+        sequential = logs[0][line] if line < len(logs[0]) else None
+        parallel = logs[1][line] if line < len(logs[1]) else None
+        if sequential != parallel:
+            print('Generator %d mismatch at line %d (sequential: %s, parallel: %s)' % (i, line,
+                str(sequential).strip(), str(parallel).strip()))
+            error = True
+            break
+
+    print('Generator %d: %s' % (i, logs[0][-1].strip()))
+
+sys.exit(1 if error else 0)
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Traffic generator used to compare the sequential and parallel modes.
+// It does a pseudo-random sequence of reads and writes, either to a memory of its
+// own partition through the local port, or to a memory of another partition through
+// the remote one, and logs each access with its completion cycle. The next access
+// starts a pseudo-random number of cycles after the previous one completed, so the
+// log depends on the exact timing and ordering of the accesses of all generators.
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <stdio.h>
+
+class partition_gen : public vp::component
+{
+public:
+    partition_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void access_handler(void *__this, vp::clock_event *event);
+    static void grant(void *__this, vp::io_req *req);
+    static void response(void *__this, vp::io_req *req);
+
+    void access_done();
+
+    vp::io_master remote_itf;
+    vp::io_master local_itf;
+    vp::clock_event *event;
+    vp::io_req req;
+
+    int nb_accesses;
+    int mem_size;
+    uint64_t seed;
+    FILE *file;
+
+    int index = 0;
+    uint64_t key;
+    uint32_t data;
+};
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+partition_gen::partition_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int partition_gen::build()
+{
+    this->remote_itf.set_resp_meth(&partition_gen::response);
+    this->remote_itf.set_grant_meth(&partition_gen::grant);
+    this->new_master_port("remote", &this->remote_itf);
+
+    this->local_itf.set_resp_meth(&partition_gen::response);
+    this->local_itf.set_grant_meth(&partition_gen::grant);
+    this->new_master_port("local", &this->local_itf);
+
+    this->event = this->event_new(&partition_gen::access_handler);
+
+    this->nb_accesses = this->get_js_config()->get_child_int("nb_accesses");
+    this->mem_size = this->get_js_config()->get_child_int("mem_size");
+    this->seed = this->get_js_config()->get_child_int("seed");
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void partition_gen::reset(bool active)
+{
+    if (!active)
+    {
+        this->event_enqueue(this->event, 1);
+    }
+}
+
+void partition_gen::access_handler(void *__this, vp::clock_event *event)
+{
+    partition_gen *_this = (partition_gen *)__this;
+
+    _this->key = mix((_this->seed << 32) + _this->index);
+
+    bool is_remote = _this->key & 1;
+    bool is_write = (_this->key >> 1) & 1;
+    _this->data = _this->key >> 32;
+
+    vp::io_req *req = &_this->req;
+    req->init();
+    req->set_addr(((_this->key >> 8) % (_this->mem_size / 4)) * 4);
+    req->set_size(4);
+    req->set_is_write(is_write);
+    req->set_data((uint8_t *)&_this->data);
+
+    vp::io_master *itf = is_remote ? &_this->remote_itf : &_this->local_itf;
+    vp::io_req_status_e status = itf->req(req);
+
+    if (status == vp::IO_REQ_OK)
+    {
+        _this->access_done();
+    }
+    else if (status == vp::IO_REQ_INVALID)
+    {
+        _this->throw_error("Invalid access");
+    }
+}
+
+void partition_gen::grant(void *__this, vp::io_req *req)
+{
+}
+
+void partition_gen::response(void *__this, vp::io_req *req)
+{
+    partition_gen *_this = (partition_gen *)__this;
+    _this->access_done();
+}
+
+void partition_gen::access_done()
+{
+    vp::io_req *req = &this->req;
+
+    fprintf(this->file, "%ld %d %d 0x%lx 0x%x\n", this->get_cycles(), (int)(this->key & 1),
+        req->get_is_write(), req->get_addr(), this->data);
+
+    this->index++;
+    if (this->index == this->nb_accesses)
+    {
+        fprintf(this->file, "end %ld\n", this->get_cycles());
+        fclose(this->file);
+        return;
+    }
+
+    this->event_enqueue(this->event, 1 + req->get_latency() + (this->key >> 16) % 16);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new partition_gen(config);
+}
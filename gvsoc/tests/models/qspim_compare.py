@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+# Reads an SPI flash with edges and with bursts on the qspim interface, either directly
+# or through relays binding the burst and sync methods in various ways, and checks that
+# all the reads give the same data as with edges.
+#
+# Usage: qspim_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare edges and bursts on the qspim interface')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+
+def get_config(burst, relay, path):
+    comps = {}
+    bindings = []
+
+    def comp(name, **props):
+        comps[name] = props
+
+    comp('clock', vp_component='vp.clock_domain_impl', frequency=100000000)
+    comp('gen', vp_component='test.qspim_gen', file=path, burst=burst)
+    comp('flash', vp_component='devices.spiflash.spiflash_impl', size=0x100000)
+
+    if relay is None:
+        bindings.append(['gen->qspim', 'flash->input'])
+        bindings.append(['gen->cs', 'flash->cs'])
+    else:
+        comp('relay', vp_component='test.qspim_gen', relay=relay)
+        bindings.append(['gen->qspim', 'relay->input'])
+        bindings.append(['gen->cs', 'relay->cs'])
+        bindings.append(['relay->output', 'flash->input'])
+        bindings.append(['relay->cs_out', 'flash->cs'])
+
+    for name in comps.keys():
+        if name != 'clock':
+            bindings.append(['clock->out', '%s->clock' % name])
+
+    return gvsoc_test.get_config(comps, bindings)
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+runs = [('edges', False, None), ('bursts', True, None)]
+for relay in ['edges', 'muxed', 'sync_muxed', 'burst_muxed']:
+    runs.append(('bursts_relay_%s' % relay, True, relay))
+
+logs = {}
+for name, burst, relay in runs:
+    path = os.path.join(args.workdir, 'gen_%s.txt' % name)
+    config_path = os.path.join(args.workdir, 'config_%s.json' % name)
+
+    # The engine stops with status -1 once it has no more events, so only a crash is an
+    # error here, the logs tell if all reads completed
+    if gvsoc_test.run(args.launcher, models_dir, get_config(burst, relay, path), config_path) < 0:
+        print('Failed to run %s' % name)
+        sys.exit(1)
+
+    with open(path) as file:
+        logs[name] = [line.split() for line in file.readlines()]
+
+# Lines are "<read> <bits> <checksum>", then "end"
+reference = logs['edges']
+error = len(reference) == 0 or reference[-1] != ['end']
+if error:
+    print('Reads did not complete with edges')
+
+for name, log in logs.items():
+    if name == 'edges':
+        continue
+
+    mismatches = 0
+    for ref_line, line in zip(reference, log):
+        if ref_line != line:
+            mismatches += 1
+    if len(log) != len(reference):
+        mismatches += abs(len(log) - len(reference))
+
+    print('%-24s %s (%d mismatches)' % (name, 'OK' if mismatches == 0 else 'MISMATCH', mismatches))
+    if mismatches != 0:
+        error = True
+
+sys.exit(1 if error else 0)
@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// QSPI master used to compare edges and bursts on the qspim interface. It programs
+// pages of an SPI flash, then reads them back with single and quad reads of various
+// sizes, including sizes which are not a whole number of bytes, and logs a checksum
+// of each read.
+// The same module also provides a relay, which forwards the interface from its input
+// to its output, so that bursts can go through a slave binding its methods in various
+// ways:
+//   - "edges": no burst method, bursts are converted into edges by the master port.
+//   - "muxed": muxed sync and burst methods.
+//   - "sync_muxed": muxed sync methods and normal burst method.
+//   - "burst_muxed": normal sync methods and muxed burst method.
+
+#include <vp/vp.hpp>
+#include <vp/itf/qspim.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+
+#define QSPIM_GEN_MUX_ID 3
+
+class qspim_gen : public vp::component
+{
+public:
+    qspim_gen(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static void rx_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+
+    void phase(uint8_t *data, int nb_bits, int lines, bool is_rx);
+    void command(uint8_t cmd);
+    void read(const char *name, int nb_bits, int lines);
+
+    vp::qspim_master qspim_itf;
+    vp::wire_master<bool> cs_itf;
+    FILE *file;
+    bool burst;
+    int rx_bits = 0;
+    uint8_t buffer[4096];
+};
+
+class qspim_relay : public vp::component
+{
+public:
+    qspim_relay(js::config *config);
+
+    int build();
+
+private:
+    static void in_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+    static void in_sync_muxed(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id);
+    static void in_cs_sync(void *__this, int cs, int active);
+    static void in_cs_sync_muxed(void *__this, int cs, int active, int id);
+    static void in_burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx);
+    static void in_burst_muxed(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx, int id);
+    static void out_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask);
+    static void cs_sync(void *__this, bool active);
+
+    void check_id(int id);
+
+    vp::qspim_slave in_itf;
+    vp::qspim_master out_itf;
+    vp::wire_slave<bool> cs_in_itf;
+    vp::wire_master<bool> cs_out_itf;
+};
+
+qspim_gen::qspim_gen(js::config *config)
+    : vp::component(config)
+{
+}
+
+int qspim_gen::build()
+{
+    this->qspim_itf.set_sync_meth(&qspim_gen::rx_sync);
+    this->new_master_port("qspim", &this->qspim_itf);
+    this->new_master_port("cs", &this->cs_itf);
+
+    this->burst = this->get_js_config()->get_child_bool("burst");
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void qspim_gen::rx_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+    qspim_gen *_this = (qspim_gen *)__this;
+    _this->rx_bits = (data_3 << 3) | (data_2 << 2) | (data_1 << 1) | (data_0 << 0);
+}
+
+// Transfers a phase either as a burst or edge per edge, sampling what the flash drove
+// during the previous edge, as the uDMA SPI master does
+void qspim_gen::phase(uint8_t *data, int nb_bits, int lines, bool is_rx)
+{
+    if (this->burst)
+    {
+        this->qspim_itf.burst(data, nb_bits, lines, is_rx);
+        return;
+    }
+
+    int lines_mask = (1 << lines) - 1;
+
+    for (int bit=0; bit<nb_bits; bit+=lines)
+    {
+        uint8_t *byte = &data[bit / 8];
+        int shift = 8 - lines - bit % 8;
+
+        if (is_rx)
+        {
+            int value = lines == 1 ? (this->rx_bits >> 1) & 1 : this->rx_bits & lines_mask;
+            *byte = (*byte & ~(lines_mask << shift)) | (value << shift);
+            this->qspim_itf.sync(1, 0, 0, 0, 0, 0);
+        }
+        else
+        {
+            int value = (*byte >> shift) & lines_mask;
+            this->qspim_itf.sync(1, (value >> 0) & 1, (value >> 1) & 1, (value >> 2) & 1, (value >> 3) & 1,
+                lines_mask);
+        }
+    }
+}
+
+// Deactivating the chip select makes the flash wait for a new command
+void qspim_gen::command(uint8_t cmd)
+{
+    this->cs_itf.sync(false);
+    this->cs_itf.sync(true);
+    this->phase(&cmd, 8, 1, false);
+}
+
+void qspim_gen::read(const char *name, int nb_bits, int lines)
+{
+    int size = (nb_bits + 7) / 8;
+    uint64_t checksum = 0;
+
+    memset(this->buffer, 0, size);
+    this->phase(this->buffer, nb_bits, lines, true);
+
+    for (int i=0; i<size; i++)
+    {
+        checksum = checksum * 31 + this->buffer[i];
+    }
+
+    fprintf(this->file, "%s %d 0x%lx\n", name, nb_bits, checksum);
+}
+
+// The interface has no timing, everything is done as soon as the platform is out of reset
+void qspim_gen::reset(bool active)
+{
+    if (active)
+        return;
+
+    // Page programs, on a single line
+    for (int page=0; page<4; page++)
+    {
+        uint8_t addr[3] = { 0, (uint8_t)(page * 3), (uint8_t)(page * 16 + 1) };
+        this->command(0x02);
+        this->phase(addr, 24, 1, false);
+
+        for (int i=0; i<256; i++)
+        {
+            this->buffer[i] = i * 7 + page;
+        }
+        this->phase(this->buffer, 256 * 8, 1, false);
+    }
+
+    // Single read, split into phases of various sizes
+    uint8_t single_addr[3] = { 0, 0, 0x11 };
+    this->command(0x03);
+    this->phase(single_addr, 24, 1, false);
+    for (int nb_bits: { 32, 32, 24, 256, 8, 800, 2048, 12, 20, 32 })
+    {
+        this->read("single", nb_bits, 1);
+    }
+
+    // Quad read, with the 4-bytes address and the mode on 4 lines
+    uint8_t quad_addr[5] = { 0, 0, 3, 0x12, 0xa5 };
+    this->command(0xec);
+    this->phase(quad_addr, 32, 4, false);
+    this->phase(&quad_addr[4], 8, 4, false);
+    for (int nb_bits: { 32, 32, 8, 512, 4096, 24, 4, 32, 4096 * 8 })
+    {
+        this->read("quad", nb_bits, 4);
+    }
+
+    this->cs_itf.sync(false);
+
+    fprintf(this->file, "end\n");
+    fclose(this->file);
+}
+
+qspim_relay::qspim_relay(js::config *config)
+    : vp::component(config)
+{
+}
+
+int qspim_relay::build()
+{
+    std::string relay = this->get_js_config()->get_child_str("relay");
+
+    if (relay == "muxed" || relay == "sync_muxed")
+    {
+        this->in_itf.set_sync_meth_muxed(&qspim_relay::in_sync_muxed, QSPIM_GEN_MUX_ID);
+        this->in_itf.set_cs_sync_meth_muxed(&qspim_relay::in_cs_sync_muxed, QSPIM_GEN_MUX_ID);
+    }
+    else
+    {
+        this->in_itf.set_sync_meth(&qspim_relay::in_sync);
+        this->in_itf.set_cs_sync_meth(&qspim_relay::in_cs_sync);
+    }
+
+    if (relay == "muxed" || relay == "burst_muxed")
+    {
+        this->in_itf.set_burst_meth_muxed(&qspim_relay::in_burst_muxed, QSPIM_GEN_MUX_ID);
+    }
+    else if (relay == "sync_muxed")
+    {
+        this->in_itf.set_burst_meth(&qspim_relay::in_burst);
+    }
+    else if (relay != "edges")
+    {
+        this->throw_error("Unknown relay mode (mode: " + relay + ")");
+    }
+
+    this->new_slave_port("input", &this->in_itf);
+
+    this->out_itf.set_sync_meth(&qspim_relay::out_sync);
+    this->new_master_port("output", &this->out_itf);
+
+    this->cs_in_itf.set_sync_meth(&qspim_relay::cs_sync);
+    this->new_slave_port("cs", &this->cs_in_itf);
+    this->new_master_port("cs_out", &this->cs_out_itf);
+
+    return 0;
+}
+
+void qspim_relay::check_id(int id)
+{
+    if (id != QSPIM_GEN_MUX_ID)
+    {
+        this->throw_error("Received wrong mux ID (id: " + std::to_string(id) + ")");
+    }
+}
+
+void qspim_relay::in_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->out_itf.sync(sck, data_0, data_1, data_2, data_3, mask);
+}
+
+void qspim_relay::in_sync_muxed(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask, int id)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.sync(sck, data_0, data_1, data_2, data_3, mask);
+}
+
+void qspim_relay::in_cs_sync(void *__this, int cs, int active)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->out_itf.cs_sync(cs, active);
+}
+
+void qspim_relay::in_cs_sync_muxed(void *__this, int cs, int active, int id)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.cs_sync(cs, active);
+}
+
+void qspim_relay::in_burst(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->out_itf.burst(data, nb_bits, lines, is_rx);
+}
+
+void qspim_relay::in_burst_muxed(void *__this, uint8_t *data, int nb_bits, int lines, bool is_rx, int id)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->check_id(id);
+    _this->out_itf.burst(data, nb_bits, lines, is_rx);
+}
+
+void qspim_relay::out_sync(void *__this, int sck, int data_0, int data_1, int data_2, int data_3, int mask)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->in_itf.sync(sck, data_0, data_1, data_2, data_3, mask);
+}
+
+void qspim_relay::cs_sync(void *__this, bool active)
+{
+    qspim_relay *_this = (qspim_relay *)__this;
+    _this->cs_out_itf.sync(active);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    if (config->get("relay") != NULL)
+        return new qspim_relay(config);
+    else
+        return new qspim_gen(config);
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Compares the router entry lookup on flattened sorted bases with the binary tree
+// of entries it replaced, for an increasing number of mapping entries. Entries are
+// separated by holes, and addresses are taken both inside entries and in holes.
+// Both must find the same entry, or none, for each address.
+//
+// The router is a model and its lookup cannot be called from here, so both
+// lookups are copies of router::get_entry, before and after the change.
+//
+// Usage: router_lookup_bench [nb_lookups] [nb_entries...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+class map_entry
+{
+public:
+    map_entry() {}
+    map_entry(uint64_t base, map_entry *left, map_entry *right)
+        : base(base), lowest_base(left->lowest_base), left(left), right(right) {}
+
+    int id = -1;
+    uint64_t base = 0;
+    uint64_t lowest_base = 0;
+    uint64_t size = 0;
+    map_entry *next = NULL;
+    map_entry *left = NULL;
+    map_entry *right = NULL;
+};
+
+// Binary tree of entries, as used by the router before the flattened arrays
+class entry_tree
+{
+public:
+    void build(map_entry *first)
+    {
+        map_entry *first_in_level = first;
+        map_entry *current = first;
+
+        while (1)
+        {
+            map_entry *left = NULL;
+            map_entry *current_in_level = NULL;
+
+            while (current)
+            {
+                if (left == NULL)
+                {
+                    left = current;
+                }
+                else
+                {
+                    map_entry *entry = new map_entry(current->lowest_base, left, current);
+                    this->nodes.push_back(entry);
+
+                    left = NULL;
+                    if (current_in_level)
+                        current_in_level->next = entry;
+                    else
+                        first_in_level = entry;
+                    current_in_level = entry;
+                }
+
+                current = current->next;
+            }
+
+            current = first_in_level;
+
+            if (current_in_level == NULL)
+                break;
+
+            if (left != NULL)
+                current_in_level->next = left;
+        }
+
+        this->top = first_in_level;
+    }
+
+    map_entry *get_entry(uint64_t offset)
+    {
+        map_entry *entry = this->top;
+
+        while (entry->left)
+        {
+            if (offset >= entry->base)
+                entry = entry->right;
+            else
+                entry = entry->left;
+        }
+
+        if (offset < entry->base || offset > entry->base + entry->size - 1)
+            return NULL;
+
+        return entry;
+    }
+
+    ~entry_tree()
+    {
+        for (map_entry *node: this->nodes)
+        {
+            delete node;
+        }
+    }
+
+    map_entry *top = NULL;
+    std::vector<map_entry *> nodes;
+};
+
+// Flattened sorted bases, as used by the router now
+class entry_array
+{
+public:
+    void build(map_entry *first)
+    {
+        for (map_entry *current = first; current; current = current->next)
+        {
+            this->entry_bases.push_back(current->base);
+            this->entries.push_back(current);
+        }
+    }
+
+    map_entry *get_entry(uint64_t offset)
+    {
+        int nb_entries = this->entry_bases.size();
+        const uint64_t *bases = this->entry_bases.data();
+        const uint64_t *base = bases;
+
+        while (nb_entries > 1)
+        {
+            int half = nb_entries / 2;
+            base = base[half] <= offset ? base + half : base;
+            nb_entries -= half;
+        }
+
+        if (*base <= offset)
+        {
+            map_entry *entry = this->entries[base - bases];
+            if (offset > entry->base + entry->size - 1)
+                return NULL;
+            return entry;
+        }
+
+        return NULL;
+    }
+
+    std::vector<uint64_t> entry_bases;
+    std::vector<map_entry *> entries;
+};
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static bool run(int nb_entries, int nb_lookups)
+{
+    std::vector<map_entry> map(nb_entries);
+    uint64_t base = 0x1000;
+
+    // Entries of random sizes, each one followed by a hole of the same size
+    for (int i = 0; i < nb_entries; i++)
+    {
+        map[i].id = i;
+        map[i].base = map[i].lowest_base = base;
+        map[i].size = 0x100 + (mix(i) % 0x10000);
+        map[i].next = i < nb_entries - 1 ? &map[i + 1] : NULL;
+        base += map[i].size * 2;
+    }
+
+    entry_tree tree;
+    entry_array array;
+    tree.build(&map[0]);
+    array.build(&map[0]);
+
+    std::vector<uint64_t> addrs(nb_lookups);
+    for (int i = 0; i < nb_lookups; i++)
+    {
+        addrs[i] = mix(i + ((uint64_t)nb_entries << 32)) % (base + 0x1000);
+    }
+
+    std::vector<map_entry *> tree_result(nb_lookups), array_result(nb_lookups);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nb_lookups; i++)
+    {
+        tree_result[i] = tree.get_entry(addrs[i]);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < nb_lookups; i++)
+    {
+        array_result[i] = array.get_entry(addrs[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    bool ok = true;
+    for (int i = 0; i < nb_lookups; i++)
+    {
+        if (tree_result[i] != array_result[i])
+        {
+            fprintf(stderr, "Mismatch at lookup %d (nb_entries: %d, addr: 0x%lx, tree entry: %d, array entry: %d)\n",
+                i, nb_entries, addrs[i], tree_result[i] ? tree_result[i]->id : -1,
+                array_result[i] ? array_result[i]->id : -1);
+            ok = false;
+            break;
+        }
+    }
+
+    printf("nb_entries %6d: array %6.1f ns/lookup, tree %6.1f ns/lookup\n", nb_entries,
+        std::chrono::duration<double, std::nano>(end - middle).count() / nb_lookups,
+        std::chrono::duration<double, std::nano>(middle - start).count() / nb_lookups);
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int nb_lookups = argc > 1 ? atoi(argv[1]) : 1000000;
+    std::vector<int> sizes;
+
+    for (int i = 2; i < argc; i++)
+    {
+        sizes.push_back(atoi(argv[i]));
+    }
+
+    if (sizes.size() == 0)
+    {
+        sizes = { 1, 4, 16, 64, 256, 1024 };
+    }
+
+    bool ok = true;
+    for (int nb_entries: sizes)
+    {
+        ok &= run(nb_entries, nb_lookups);
+    }
+
+    return ok ? 0 : 1;
+}
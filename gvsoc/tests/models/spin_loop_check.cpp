@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+ *                    University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+ */
+
+// Testbench of cores sharing the same clock, used to compare the timing with and without
+// the skipping of spin loops. Each core fetches its own program, given as a list of
+// instruction words, and is enabled at its own cycle. The data accesses go to a memory,
+// except the ones at or above DONE_ADDR, which are logged with the core and the cycle
+// as the result of the core. The testbench can also write the cycle to RESULT_ADDR
+// and then 1 to FLAG_ADDR at a given cycle, and have an event every few cycles, as
+// other components of a platform would. The number of data requests of each core is
+// logged at the end, which shows how many loads were skipped.
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define FLAG_ADDR   0x1000
+#define RESULT_ADDR 0x1200
+#define DONE_ADDR   0x2000
+#define CODE_ADDR   0x100
+
+class spin_loop_core
+{
+public:
+    int id;
+    std::vector<uint32_t> code;
+    int64_t start;
+    bool done = false;
+    int64_t nb_reqs = 0;
+    vp::io_slave data_itf;
+    vp::io_slave fetch_itf;
+    vp::wire_master<bool> fetchen_itf;
+    vp::wire_slave<int> irq_ack_itf;
+};
+
+class spin_loop_check : public vp::component
+{
+public:
+    spin_loop_check(js::config *config);
+
+    int build();
+    void reset(bool active);
+
+private:
+    static vp::io_req_status_e data_req(void *__this, vp::io_req *req, int id);
+    static bool data_dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi);
+    static vp::io_req_status_e fetch_req(void *__this, vp::io_req *req, int id);
+    static void start_handler(void *__this, vp::clock_event *event);
+    static void flag_handler(void *__this, vp::clock_event *event);
+    static void tick_handler(void *__this, vp::clock_event *event);
+
+    void mem_write(uint64_t addr, uint32_t value);
+    void schedule_start();
+
+    vp::io_master mem_itf;
+    vp::clock_event *start_event;
+    vp::clock_event *flag_event;
+    vp::clock_event *tick_event;
+    std::vector<spin_loop_core *> cores;
+    FILE *file;
+    int64_t flag_cycle;
+    int64_t tick;
+    int64_t nb_ticks;
+    int nb_done;
+};
+
+spin_loop_check::spin_loop_check(js::config *config)
+    : vp::component(config)
+{
+}
+
+int spin_loop_check::build()
+{
+    this->new_master_port("mem", &this->mem_itf);
+
+    this->start_event = this->event_new(&spin_loop_check::start_handler);
+    this->flag_event = this->event_new(&spin_loop_check::flag_handler);
+    this->tick_event = this->event_new(&spin_loop_check::tick_handler);
+
+    this->flag_cycle = this->get_js_config()->get_child_int("flag_cycle");
+    this->tick = this->get_js_config()->get_child_int("tick");
+
+    std::vector<js::config *> programs = this->get_js_config()->get("programs")->get_elems();
+    std::vector<js::config *> starts = this->get_js_config()->get("starts")->get_elems();
+
+    for (size_t i=0; i<programs.size(); i++)
+    {
+        spin_loop_core *core = new spin_loop_core();
+        std::string suffix = "_" + std::to_string(i);
+
+        core->id = i;
+        core->start = starts[i]->get_int();
+        for (js::config *word: programs[i]->get_elems())
+        {
+            core->code.push_back(word->get_int());
+        }
+
+        core->data_itf.set_req_meth_muxed(&spin_loop_check::data_req, i);
+        core->data_itf.set_dmi_meth(&spin_loop_check::data_dmi_req);
+        this->new_slave_port("data" + suffix, &core->data_itf);
+        core->fetch_itf.set_req_meth_muxed(&spin_loop_check::fetch_req, i);
+        this->new_slave_port("fetch" + suffix, &core->fetch_itf);
+        this->new_master_port("fetchen" + suffix, &core->fetchen_itf);
+        this->new_slave_port("irq_ack" + suffix, &core->irq_ack_itf);
+
+        this->cores.push_back(core);
+    }
+
+    std::string path = this->get_js_config()->get_child_str("file");
+    this->file = fopen(path.c_str(), "w");
+    if (this->file == NULL)
+    {
+        this->throw_error("Failed to open log file (path: " + path + ")");
+    }
+
+    return 0;
+}
+
+void spin_loop_check::reset(bool active)
+{
+    if (active)
+        return;
+
+    this->nb_ticks = 0;
+    this->nb_done = 0;
+
+    for (spin_loop_core *core: this->cores)
+    {
+        core->done = false;
+        core->nb_reqs = 0;
+    }
+
+    // The flag and the result are cleared before the cores start
+    this->mem_write(FLAG_ADDR, 0);
+    this->mem_write(RESULT_ADDR, 0);
+
+    this->schedule_start();
+
+    if (this->flag_cycle)
+        this->event_enqueue(this->flag_event, this->flag_cycle);
+
+    if (this->tick)
+        this->event_enqueue(this->tick_event, this->tick);
+}
+
+void spin_loop_check::mem_write(uint64_t addr, uint32_t value)
+{
+    vp::io_req req;
+    req.init();
+    req.set_addr(addr);
+    req.set_size(4);
+    req.set_data((uint8_t *)&value);
+    req.set_is_write(true);
+    if (this->mem_itf.req(&req) != vp::IO_REQ_OK)
+    {
+        this->throw_error("Failed to write memory");
+    }
+}
+
+// Enqueue the start event to the next core to be enabled
+void spin_loop_check::schedule_start()
+{
+    int64_t next = -1;
+    for (spin_loop_core *core: this->cores)
+    {
+        if (core->start > this->get_cycles() && (next == -1 || core->start < next))
+        {
+            next = core->start;
+        }
+    }
+
+    if (next != -1)
+    {
+        this->event_enqueue(this->start_event, next - this->get_cycles());
+    }
+}
+
+void spin_loop_check::start_handler(void *__this, vp::clock_event *event)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+
+    for (spin_loop_core *core: _this->cores)
+    {
+        if (core->start == _this->get_cycles())
+        {
+            core->fetchen_itf.sync(true);
+        }
+    }
+
+    _this->schedule_start();
+}
+
+void spin_loop_check::flag_handler(void *__this, vp::clock_event *event)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+    _this->mem_write(RESULT_ADDR, _this->get_cycles());
+    _this->mem_write(FLAG_ADDR, 1);
+}
+
+void spin_loop_check::tick_handler(void *__this, vp::clock_event *event)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+    _this->nb_ticks++;
+    _this->event_enqueue(_this->tick_event, _this->tick);
+}
+
+vp::io_req_status_e spin_loop_check::fetch_req(void *__this, vp::io_req *req, int id)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+    spin_loop_core *core = _this->cores[id];
+    uint8_t *data = req->get_data();
+
+    // Anything outside the program reads as zero, which is an illegal instruction
+    for (uint64_t i=0; i<req->get_size(); i++)
+    {
+        uint64_t offset = req->get_addr() + i - CODE_ADDR;
+        uint64_t word = offset / 4;
+        data[i] = word < core->code.size() ? core->code[word] >> ((offset % 4) * 8) : 0;
+    }
+
+    return vp::IO_REQ_OK;
+}
+
+vp::io_req_status_e spin_loop_check::data_req(void *__this, vp::io_req *req, int id)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+    spin_loop_core *core = _this->cores[id];
+
+    if (req->get_addr() >= DONE_ADDR)
+    {
+        if (!req->get_is_write() || core->done)
+        {
+            _this->throw_error("Unexpected access to the result (core: " + std::to_string(id) + ")");
+        }
+
+        core->done = true;
+        fprintf(_this->file, "core %d value 0x%x cycle %ld\n", id, *(uint32_t *)req->get_data(),
+            _this->get_cycles());
+
+        if (++_this->nb_done == (int)_this->cores.size())
+        {
+            for (spin_loop_core *core: _this->cores)
+            {
+                fprintf(_this->file, "requests %d %ld\n", core->id, core->nb_reqs);
+            }
+            fprintf(_this->file, "ticks %ld\n", _this->nb_ticks);
+            fprintf(_this->file, "end\n");
+            fclose(_this->file);
+            _this->get_clock()->stop_engine(0);
+        }
+
+        return vp::IO_REQ_OK;
+    }
+
+    // Debug requests are the ones checking the loads of a spin loop, they are not part
+    // of the execution
+    if (!req->is_debug())
+    {
+        core->nb_reqs++;
+    }
+
+    return _this->mem_itf.req_forward(req);
+}
+
+bool spin_loop_check::data_dmi_req(void *__this, vp::io_req *req, vp::io_dmi *dmi)
+{
+    spin_loop_check *_this = (spin_loop_check *)__this;
+
+    if (req->get_addr() >= DONE_ADDR)
+    {
+        return false;
+    }
+
+    return _this->mem_itf.dmi_req(req, dmi);
+}
+
+extern "C" vp::component *vp_constructor(js::config *config)
+{
+    return new spin_loop_check(config);
+}
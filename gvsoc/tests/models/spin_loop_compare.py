@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+
+# Runs cores sharing the same clock with and without the skipping of spin loops, and
+# checks that the cores finish at the same cycles with the same results, and that
+# iterations were skipped where nothing else is scheduled while the core is spinning:
+#   - "tick": one core polls a flag written by the testbench, which also has an event
+#     every few cycles.
+#   - "sleeping": one core polls a flag written by a second core, which starts late,
+#     computes a sum, stores it and then sets the flag.
+#   - "spinning": two cores poll the same flag, they keep each other from skipping but
+#     the timing must stay the same.
+# The programs are assembled here as the tests do not need a toolchain.
+#
+# Usage: spin_loop_compare.py --launcher <path> --workdir <path> [--model <name>=<path>...]
+
+import argparse
+import os
+import sys
+import gvsoc_test
+
+
+parser = argparse.ArgumentParser(description='Compare the timing with and without skipping spin loops')
+gvsoc_test.add_arguments(parser)
+args = parser.parse_args()
+
+
+T0, T1, T2, A1, A2 = 5, 6, 7, 11, 12
+
+def lui(rd, imm):
+    return (imm << 12) | (rd << 7) | 0x37
+
+def addi(rd, rs1, imm):
+    return ((imm & 0xfff) << 20) | (rs1 << 15) | (rd << 7) | 0x13
+
+def add(rd, rs1, rs2):
+    return (rs2 << 20) | (rs1 << 15) | (rd << 7) | 0x33
+
+def lw(rd, imm, rs1):
+    return (imm << 20) | (rs1 << 15) | (2 << 12) | (rd << 7) | 0x03
+
+def sw(rs2, imm, rs1):
+    return ((imm >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (2 << 12) | ((imm & 0x1f) << 7) | 0x23
+
+def branch(funct3, rs1, rs2, offset):
+    imm = offset & 0x1fff
+    return (((imm >> 12) & 1) << 31) | (((imm >> 5) & 0x3f) << 25) | (rs2 << 20) | (rs1 << 15) | \
+        (funct3 << 12) | (((imm >> 1) & 0xf) << 8) | (((imm >> 11) & 1) << 7) | 0x63
+
+def beqz(rs1, offset):
+    return branch(0, rs1, 0, offset)
+
+def bnez(rs1, offset):
+    return branch(1, rs1, 0, offset)
+
+def jal(rd, offset):
+    imm = offset & 0x1fffff
+    return (((imm >> 20) & 1) << 31) | (((imm >> 1) & 0x3ff) << 21) | (((imm >> 11) & 1) << 20) | \
+        (((imm >> 12) & 0xff) << 12) | (rd << 7) | 0x6f
+
+
+# Waits for the flag at 0x1000 and stores the result at 0x1200 to the done address
+POLL = [
+    lui(A1, 0x1),
+    lw(T1, 0, A1),         # 1: poll the flag
+    beqz(T1, -4),          #    until it is set
+    lw(T0, 0x200, A1),
+    lui(A2, 0x2),
+    sw(T0, 0, A2),
+    jal(0, 0),             # 2: j 2b
+]
+
+# Computes the sum of 1 to 300, storing the partial sums to 0x1200, then sets the flag
+# and stores the sum to the done address
+COMPUTE = [
+    lui(A1, 0x1),
+    addi(T0, 0, 0),
+    addi(T1, 0, 300),
+    add(T0, T0, T1),       # 1: accumulate
+    sw(T0, 0x200, A1),
+    addi(T1, T1, -1),
+    bnez(T1, -12),         #    bnez t1, 1b
+    addi(T2, 0, 1),
+    sw(T2, 0, A1),
+    lui(A2, 0x2),
+    sw(T0, 0, A2),
+    jal(0, 0),             # 2: j 2b
+]
+
+SUM = 300 * 301 // 2
+
+FLAG_CYCLE = 20000
+
+# Name, programs, start cycles, flag cycle, tick, expected results and whether the first
+# core must skip iterations
+scenarios = [
+    ('tick', [POLL], [1], FLAG_CYCLE, 50, [FLAG_CYCLE], True),
+    ('sleeping', [POLL, COMPUTE], [1, 10000], 0, 0, [SUM, SUM], True),
+    ('spinning', [POLL, POLL], [1, 7], FLAG_CYCLE, 0, [FLAG_CYCLE, FLAG_CYCLE], False),
+]
+
+modes = [
+    ('reference', {}),
+    ('spin', { 'iss_spin_loop': True }),
+    ('spin_superblock', { 'iss_spin_loop': True, 'iss_superblock_size': 16 }),
+    ('spin_dmi', { 'iss_spin_loop': True, 'iss_dmi': True }),
+]
+
+
+def get_config(scenario, options, path):
+    name, programs, starts, flag_cycle, tick, results, skip = scenario
+    cluster = { 'vp_comps': [], 'vp_bindings': [] }
+    bindings = cluster['vp_bindings']
+
+    def comp(name, **props):
+        cluster[name] = props
+        cluster['vp_comps'].append(name)
+
+    # The cores get their clock from the composite, as they have their own clock port
+    # The instruction words are given as strings, as numbers are read as 32-bit signed
+    # integers
+    programs = [['0x%08x' % word for word in program] for program in programs]
+
+    comp('check', vp_component='test.spin_loop_check', file=path, programs=programs, starts=starts,
+        flag_cycle=flag_cycle, tick=tick)
+    comp('mem', vp_component='memory.memory_impl', size=0x2000, width_bits=0)
+
+    bindings.append(['check->mem', 'mem->input'])
+
+    for i in range(0, len(programs)):
+        comp('core%d' % i, vp_component='gap9.cpu.iss.iss_gap9_cluster', isa='rv32imfcXpulpv2', misa=0,
+            cluster_id=0, core_id=i, boot_addr=0x100, bootaddr_offset=0, fetch_enable=False,
+            debug_handler=0, riscv_dbg_unit=False, debug_binaries=[])
+        bindings.append(['core%d->data' % i, 'check->data_%d' % i])
+        bindings.append(['core%d->fetch' % i, 'check->fetch_%d' % i])
+        bindings.append(['core%d->irq_ack' % i, 'check->irq_ack_%d' % i])
+        bindings.append(['check->fetchen_%d' % i, 'core%d->fetchen' % i])
+
+    comps = {
+        'clock': { 'vp_component': 'vp.clock_domain_impl', 'frequency': 100000000 },
+        'cluster': cluster
+    }
+
+    config = gvsoc_test.get_config(comps, [['clock->out', 'cluster->clock']])
+    config['gvsoc'].update(options)
+    return config
+
+
+os.makedirs(args.workdir, exist_ok=True)
+models_dir = gvsoc_test.link_models(args.workdir, args.model)
+
+error = False
+for scenario in scenarios:
+    name, programs, starts, flag_cycle, tick, results, skip = scenario
+    logs = {}
+    for mode, options in modes:
+        path = os.path.join(args.workdir, 'check_%s_%s.txt' % (name, mode))
+        config_path = os.path.join(args.workdir, 'config_%s_%s.json' % (name, mode))
+
+        if os.path.exists(path):
+            os.remove(path)
+
+        status = gvsoc_test.run(args.launcher, models_dir, get_config(scenario, options, path), config_path)
+        if status != 0 or not os.path.exists(path):
+            print('Failed to run %s in mode %s (status: %d)' % (name, mode, status))
+            sys.exit(1)
+
+        with open(path) as file:
+            logs[mode] = [line.split() for line in file.readlines()]
+
+    # Lines are "core <id> value <value> cycle <cycle>", then "requests <id> <count>" and
+    # "ticks <count>", then "end"
+    reference = logs['reference']
+    values = [int(line[3], 0) for line in reference if line[0] == 'core']
+    if len(reference) == 0 or reference[-1] != ['end'] or sorted(values) != sorted(results):
+        print('%-10s wrong results in the reference run (%s)' % (name, values))
+        error = True
+        continue
+
+    requests = {}
+    for mode, log in logs.items():
+        requests[mode] = int([line for line in log if line[:2] == ['requests', '0']][0][2])
+
+        if mode == 'reference':
+            continue
+
+        # Everything but the number of requests must be the same
+        timing = [line for line in log if line[0] != 'requests']
+        ref_timing = [line for line in reference if line[0] != 'requests']
+        mismatches = abs(len(timing) - len(ref_timing))
+        for ref_line, line in zip(ref_timing, timing):
+            if ref_line != line:
+                mismatches += 1
+
+        print('%-10s %-20s %s (%d mismatches, %d requests instead of %d)' % (name, mode,
+            'OK' if mismatches == 0 else 'MISMATCH', mismatches, requests[mode], requests['reference']))
+        if mismatches != 0:
+            error = True
+
+    # The skipped iterations do not send any request, only the first and last ones do
+    # with direct accesses
+    if skip:
+        for mode in ['spin', 'spin_superblock']:
+            if requests[mode] * 4 > requests['reference']:
+                print('%-10s %-20s no iteration skipped' % (name, mode))
+                error = True
+
+sys.exit(1 if error else 0)
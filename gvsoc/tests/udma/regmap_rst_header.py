@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2020 GreenWaves Technologies, SAS, ETH Zurich and
+#                    University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+#
+# Authors: Germain Haugou, GreenWaves Technologies (germain.haugou@greenwaves-technologies.com)
+#
+
+# Generates the C headers of a register map from its rst documentation, with the C
+# header generator of the regmap tool.
+# The uDMA models include headers generated from the IP specifications, which are not
+# part of this tree, while the rst documentation generated from the same specifications
+# is. The rest of the regmap tool needs packages which are not always installed, so
+# only the C header generator is used, with minimal register map classes.
+#
+# Usage: regmap_rst_header.py --regmap-bin <dir> --input <rst> --header <path prefix>
+
+import argparse
+import collections
+import re
+import sys
+
+
+parser = argparse.ArgumentParser(description='Generate register map headers from rst')
+parser.add_argument('--regmap-bin', required=True, help='Directory of the regmap tool')
+parser.add_argument('--input', required=True, help='Register map rst file')
+parser.add_argument('--header', required=True, help='Path of the headers, without the suffixes')
+args = parser.parse_args()
+
+sys.path.insert(0, args.regmap_bin)
+import regmap_c_header
+
+
+class Regfield(regmap_c_header.Regfield):
+
+    def __init__(self, name, bit, width, access, reset, desc):
+        self.name = name
+        self.bit = bit
+        self.width = width
+        self.access = access
+        self.reset = reset
+        self.reg_reset = None
+        self.desc = desc
+
+    def get_write_mask(self):
+        if self.access == 'R':
+            return 0
+        return ((1 << self.width) - 1) << self.bit
+
+
+class Register(regmap_c_header.Register):
+
+    def __init__(self, name, offset, width, desc):
+        self.name = name
+        self.offset = offset
+        self.width = width
+        self.desc = desc
+        self.reset = None
+        self.do_reset = True
+        self.fields = collections.OrderedDict()
+
+    def get_fields(self):
+        return self.fields.values()
+
+    def get_write_mask(self):
+        if len(self.fields) == 0:
+            return (1 << self.width) - 1
+
+        result = 0
+        for field in self.fields.values():
+            result |= field.get_write_mask()
+        return result
+
+
+class Regmap(regmap_c_header.Regmap):
+
+    def __init__(self, name):
+        self.name = name
+        self.registers = collections.OrderedDict()
+        self.regmaps = collections.OrderedDict()
+        self.cmdmaps = collections.OrderedDict()
+        self.constants = collections.OrderedDict()
+
+
+# Returns the rows of the grid table starting at the given line, and the index of the
+# line after it. Cells spanning several lines are joined.
+def parse_table(lines, index):
+    while not lines[index].strip().startswith('+'):
+        index += 1
+
+    separator = lines[index].strip()
+    columns = [i for i, c in enumerate(separator) if c == '+']
+    rows = []
+    cells = None
+
+    while index < len(lines) and lines[index].strip()[0:1] in ['+', '|']:
+        line = lines[index].strip()
+        if line.startswith('+'):
+            if cells is not None:
+                rows.append([' '.join(cell.split()) for cell in cells])
+            cells = None
+        else:
+            if cells is None:
+                cells = [''] * (len(columns) - 1)
+            for i in range(0, len(columns) - 1):
+                cells[i] += ' ' + line[columns[i] + 1:columns[i + 1]]
+        index += 1
+
+    # The first row is the header
+    return rows[1:], index
+
+
+def parse_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        return None
+
+
+with open(args.input) as file:
+    lines = file.read().splitlines()
+
+# The register map name is the prefix of the register links
+name = None
+for line in lines:
+    match = re.search(r':ref:`[^<]*<([a-z0-9_]+)__', line)
+    if match is not None:
+        name = match.group(1)
+        break
+
+if name is None:
+    print('No register found in ' + args.input)
+    sys.exit(1)
+
+regmap = Regmap(name)
+
+index = 0
+while not lines[index].startswith('.. table::'):
+    index += 1
+
+rows, index = parse_table(lines, index)
+for reg_name, offset, width, desc in rows:
+    reg_name = re.sub(r':ref:`([^<]*)<.*', r'\1', reg_name).strip()
+    regmap.registers[reg_name] = Register(reg_name, int(offset, 0), int(width), desc)
+
+for index in range(index, len(lines)):
+    match = re.match(r'\.\. _%s__([A-Za-z0-9_]+):' % name, lines[index])
+    if match is None:
+        continue
+
+    register = regmap.registers[match.group(1)]
+    reset = 0
+    while not lines[index].startswith('.. table::'):
+        index += 1
+
+    fields, index = parse_table(lines, index)
+    for bits, access, field_name, field_reset, desc in fields:
+        msb, lsb = (bits.split(':') + [bits])[0:2]
+        field = Regfield(field_name, int(lsb), int(msb) - int(lsb) + 1, access, parse_int(field_reset), desc)
+        register.fields[field_name] = field
+        if field.reset is not None:
+            reset |= field.reset << field.bit
+
+    register.reset = reset
+
+regmap_c_header.dump_to_header(regmap=regmap, name=name, header_path=args.header)
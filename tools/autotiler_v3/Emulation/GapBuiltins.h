@@ -472,6 +472,11 @@ static int _VitT0_Flag, _VitT1_Flag;
 #define gap_f32rdn(a)		floorf((a))
 #define gap_f32rup(a)		ceilf((a))
 
+/* Host vector implementation of the hot builtins, see GapBuiltinsHost.h */
+#if defined(AT_EMUL_HOST_SIMD)
+#include "GapBuiltinsHost.h"
+#endif
+
 
 #endif
 
@@ -0,0 +1,194 @@
+#ifndef __GAP_BUILTINS_HOST_H__
+#define __GAP_BUILTINS_HOST_H__
+
+/* Host implementation of the most used vector builtins for emulation, selected with
+   AT_EMUL_HOST_SIMD. The per-lane macros of GapBuiltins.h evaluate their operands once
+   per lane, which dominates the emulation time of the CNN kernels, while these versions
+   evaluate them once. Optimized builds with SSE4.1 enabled (-O2 -msse4.1) map the vector
+   operations to SSE instructions, unoptimized builds are faster with the scalar lanes.
+   Results are the same as the per-lane macros when they are called with the operand types
+   of the target builtins. */
+
+#if defined(__SSE4_1__) && defined(__OPTIMIZE__)
+#define __GAP_HOST_SSE
+#include <smmintrin.h>
+#endif
+
+/* Max */
+#undef gap_max
+#undef gap_max2
+#undef gap_max4
+#undef gap_maxu2
+#undef gap_maxu4
+
+#define gap_max(x, y)			({ __typeof__((x)>(y)?(x):(y)) __x = (x), __y = (y); (__x>__y)?__x:__y; })
+#define gap_max2(x, y)			__gap_host_max2((v2s)(x), (v2s)(y))
+#define gap_max4(x, y)			__gap_host_max4((v4s)(x), (v4s)(y))
+#define gap_maxu2(x, y)			__gap_host_maxu2((v2u)(x), (v2u)(y))
+#define gap_maxu4(x, y)			__gap_host_maxu4((v4u)(x), (v4u)(y))
+
+/* Min */
+#undef gap_min
+#undef gap_min2
+#undef gap_min4
+#undef gap_minu2
+#undef gap_minu4
+
+#define gap_min(x, y)			({ __typeof__((x)<(y)?(x):(y)) __x = (x), __y = (y); (__x<__y)?__x:__y; })
+#define gap_min2(x, y)			__gap_host_min2((v2s)(x), (v2s)(y))
+#define gap_min4(x, y)			__gap_host_min4((v4s)(x), (v4s)(y))
+#define gap_minu2(x, y)			__gap_host_minu2((v2u)(x), (v2u)(y))
+#define gap_minu4(x, y)			__gap_host_minu4((v4u)(x), (v4u)(y))
+
+/* Add, Sub, lanes are wrapping as on the target */
+#undef gap_add2
+#undef gap_add4
+#undef gap_sub2
+#undef gap_sub4
+
+#define gap_add2(x, y)			((v2s)(x) + (v2s)(y))
+#define gap_add4(x, y)			((v4s)(x) + (v4s)(y))
+#define gap_sub2(x, y)			((v2s)(x) - (v2s)(y))
+#define gap_sub4(x, y)			((v4s)(x) - (v4s)(y))
+
+/* Abs */
+#undef gap_abs
+#undef gap_abs2
+#undef gap_abs4
+
+#define gap_abs(x)			({ __typeof__(x) __x = (x); (__x<0)?-__x:__x; })
+#define gap_abs2(x)			__gap_host_abs2((v2s)(x))
+#define gap_abs4(x)			__gap_host_abs4((v4s)(x))
+
+/* Clip */
+#undef gap_clip
+#undef gap_clipu
+#undef gap_clipr
+#undef gap_clipur
+
+#define gap_clip(x, precision)		({ __typeof__(x) __x = (x); int __p = (precision); \
+					   (__x<-(1<<__p))?-(1<<__p):((__x>(1<<__p)-1)?(1<<__p)-1:__x); })
+#define gap_clipu(x, precision)		({ __typeof__(x) __x = (x); int __p = (precision); \
+					   (__x<0)?0:((__x>(1<<__p)-1)?(1<<__p)-1:__x); })
+#define gap_clipr(x, bound)		({ __typeof__(x) __x = (x); __typeof__(bound) __b = (bound); \
+					   (__x<=-(__b+1))?-(__b+1):((__x>=__b)?__b:__x); })
+#define gap_clipur(x, bound)		({ __typeof__(x) __x = (x); __typeof__(bound) __b = (bound); \
+					   (__x<0)?0:((__x>=__b)?__b:__x); })
+
+/* Vectorial product and sum of products */
+#undef gap_dotp2
+#undef gap_dotpu2
+#undef gap_dotpus2
+#undef gap_sumdotp2
+#undef gap_sumdotpu2
+#undef gap_sumdotpus2
+#undef gap_dotp4
+#undef gap_dotpu4
+#undef gap_dotpus4
+#undef gap_sumdotp4
+#undef gap_sumdotpu4
+#undef gap_sumdotpus4
+
+#define gap_dotp2(x, y)			__gap_host_sumdotp2((v2s)(x), (v2s)(y), 0)
+#define gap_dotpu2(x, y)		__gap_host_sumdotpu2((v2u)(x), (v2u)(y), 0)
+#define gap_dotpus2(x, y)		__gap_host_sumdotpus2((v2u)(x), (v2s)(y), 0)
+
+#define gap_sumdotp2(x, y, z)		__gap_host_sumdotp2((v2s)(x), (v2s)(y), (z))
+#define gap_sumdotpu2(x, y, z)		__gap_host_sumdotpu2((v2u)(x), (v2u)(y), (z))
+#define gap_sumdotpus2(x, y, z)		__gap_host_sumdotpus2((v2u)(x), (v2s)(y), (z))
+
+#define gap_dotp4(x, y)			__gap_host_sumdotp4((v4s)(x), (v4s)(y), 0)
+#define gap_dotpu4(x, y)		__gap_host_sumdotpu4((v4u)(x), (v4u)(y), 0)
+#define gap_dotpus4(x, y)		__gap_host_sumdotpus4((v4u)(x), (v4s)(y), 0)
+
+#define gap_sumdotp4(x, y, z)		__gap_host_sumdotp4((v4s)(x), (v4s)(y), (z))
+#define gap_sumdotpu4(x, y, z)		__gap_host_sumdotpu4((v4u)(x), (v4u)(y), (z))
+#define gap_sumdotpus4(x, y, z)		__gap_host_sumdotpus4((v4u)(x), (v4s)(y), (z))
+
+
+#if defined(__GAP_HOST_SSE)
+
+/* 4 and 2 lanes vectors are moved into the low 32 bits of a SSE register */
+#define __GAP_HOST_LOAD(x)		_mm_cvtsi32_si128((int)(x))
+#define __GAP_HOST_STORE(type, x)	((type)_mm_cvtsi128_si32((x)))
+
+static inline __attribute__((always_inline)) v2s __gap_host_max2(v2s x, v2s y)   { return __GAP_HOST_STORE(v2s, _mm_max_epi16(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v4s __gap_host_max4(v4s x, v4s y)   { return __GAP_HOST_STORE(v4s, _mm_max_epi8(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v2u __gap_host_maxu2(v2u x, v2u y)  { return __GAP_HOST_STORE(v2u, _mm_max_epu16(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v4u __gap_host_maxu4(v4u x, v4u y)  { return __GAP_HOST_STORE(v4u, _mm_max_epu8(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+
+static inline __attribute__((always_inline)) v2s __gap_host_min2(v2s x, v2s y)   { return __GAP_HOST_STORE(v2s, _mm_min_epi16(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v4s __gap_host_min4(v4s x, v4s y)   { return __GAP_HOST_STORE(v4s, _mm_min_epi8(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v2u __gap_host_minu2(v2u x, v2u y)  { return __GAP_HOST_STORE(v2u, _mm_min_epu16(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+static inline __attribute__((always_inline)) v4u __gap_host_minu4(v4u x, v4u y)  { return __GAP_HOST_STORE(v4u, _mm_min_epu8(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y))); }
+
+static inline __attribute__((always_inline)) v2s __gap_host_abs2(v2s x)          { return __GAP_HOST_STORE(v2s, _mm_abs_epi16(__GAP_HOST_LOAD(x))); }
+static inline __attribute__((always_inline)) v4s __gap_host_abs4(v4s x)          { return __GAP_HOST_STORE(v4s, _mm_abs_epi8(__GAP_HOST_LOAD(x))); }
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotp2(v2s x, v2s y, int Acc)
+{
+  /* pmaddwd adds the 2 products of the low lane into a single 32 bits word */
+  return Acc + _mm_cvtsi128_si32(_mm_madd_epi16(__GAP_HOST_LOAD(x), __GAP_HOST_LOAD(y)));
+}
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotpus2(v2u x, v2s y, int Acc)
+{
+  __m128i P = _mm_mullo_epi32(_mm_cvtepu16_epi32(__GAP_HOST_LOAD(x)), _mm_cvtepi16_epi32(__GAP_HOST_LOAD(y)));
+  return Acc + _mm_cvtsi128_si32(P) + _mm_extract_epi32(P, 1);
+}
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotpu2(v2u x, v2u y, int Acc)
+{
+  __m128i P = _mm_mullo_epi32(_mm_cvtepu16_epi32(__GAP_HOST_LOAD(x)), _mm_cvtepu16_epi32(__GAP_HOST_LOAD(y)));
+  return Acc + _mm_cvtsi128_si32(P) + _mm_extract_epi32(P, 1);
+}
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotp4(v4s x, v4s y, int Acc)
+{
+  __m128i P = _mm_madd_epi16(_mm_cvtepi8_epi16(__GAP_HOST_LOAD(x)), _mm_cvtepi8_epi16(__GAP_HOST_LOAD(y)));
+  return Acc + _mm_cvtsi128_si32(P) + _mm_extract_epi32(P, 1);
+}
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotpu4(v4u x, v4u y, int Acc)
+{
+  __m128i P = _mm_madd_epi16(_mm_cvtepu8_epi16(__GAP_HOST_LOAD(x)), _mm_cvtepu8_epi16(__GAP_HOST_LOAD(y)));
+  return Acc + _mm_cvtsi128_si32(P) + _mm_extract_epi32(P, 1);
+}
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotpus4(v4u x, v4s y, int Acc)
+{
+  __m128i P = _mm_madd_epi16(_mm_cvtepu8_epi16(__GAP_HOST_LOAD(x)), _mm_cvtepi8_epi16(__GAP_HOST_LOAD(y)));
+  return Acc + _mm_cvtsi128_si32(P) + _mm_extract_epi32(P, 1);
+}
+
+#else
+
+/* Lanes are processed one by one, on operands evaluated only once */
+#define __GAP_HOST_MAX(x, y)		(((x)>(y))?(x):(y))
+#define __GAP_HOST_MIN(x, y)		(((x)<(y))?(x):(y))
+#define __GAP_HOST_ABS(x)		(((x)<0)?-(x):(x))
+
+static inline __attribute__((always_inline)) v2s __gap_host_max2(v2s x, v2s y)   { return (v2s) {__GAP_HOST_MAX(x[0], y[0]), __GAP_HOST_MAX(x[1], y[1])}; }
+static inline __attribute__((always_inline)) v4s __gap_host_max4(v4s x, v4s y)   { return (v4s) {__GAP_HOST_MAX(x[0], y[0]), __GAP_HOST_MAX(x[1], y[1]), __GAP_HOST_MAX(x[2], y[2]), __GAP_HOST_MAX(x[3], y[3])}; }
+static inline __attribute__((always_inline)) v2u __gap_host_maxu2(v2u x, v2u y)  { return (v2u) {__GAP_HOST_MAX(x[0], y[0]), __GAP_HOST_MAX(x[1], y[1])}; }
+static inline __attribute__((always_inline)) v4u __gap_host_maxu4(v4u x, v4u y)  { return (v4u) {__GAP_HOST_MAX(x[0], y[0]), __GAP_HOST_MAX(x[1], y[1]), __GAP_HOST_MAX(x[2], y[2]), __GAP_HOST_MAX(x[3], y[3])}; }
+
+static inline __attribute__((always_inline)) v2s __gap_host_min2(v2s x, v2s y)   { return (v2s) {__GAP_HOST_MIN(x[0], y[0]), __GAP_HOST_MIN(x[1], y[1])}; }
+static inline __attribute__((always_inline)) v4s __gap_host_min4(v4s x, v4s y)   { return (v4s) {__GAP_HOST_MIN(x[0], y[0]), __GAP_HOST_MIN(x[1], y[1]), __GAP_HOST_MIN(x[2], y[2]), __GAP_HOST_MIN(x[3], y[3])}; }
+static inline __attribute__((always_inline)) v2u __gap_host_minu2(v2u x, v2u y)  { return (v2u) {__GAP_HOST_MIN(x[0], y[0]), __GAP_HOST_MIN(x[1], y[1])}; }
+static inline __attribute__((always_inline)) v4u __gap_host_minu4(v4u x, v4u y)  { return (v4u) {__GAP_HOST_MIN(x[0], y[0]), __GAP_HOST_MIN(x[1], y[1]), __GAP_HOST_MIN(x[2], y[2]), __GAP_HOST_MIN(x[3], y[3])}; }
+
+static inline __attribute__((always_inline)) v2s __gap_host_abs2(v2s x)          { return (v2s) {__GAP_HOST_ABS(x[0]), __GAP_HOST_ABS(x[1])}; }
+static inline __attribute__((always_inline)) v4s __gap_host_abs4(v4s x)          { return (v4s) {__GAP_HOST_ABS(x[0]), __GAP_HOST_ABS(x[1]), __GAP_HOST_ABS(x[2]), __GAP_HOST_ABS(x[3])}; }
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotp2(v2s x, v2s y, int Acc)    { return Acc + x[0]*y[0] + x[1]*y[1]; }
+static inline __attribute__((always_inline)) int __gap_host_sumdotpus2(v2u x, v2s y, int Acc)  { return Acc + x[0]*y[0] + x[1]*y[1]; }
+static inline __attribute__((always_inline)) int __gap_host_sumdotpu2(v2u x, v2u y, int Acc)   { return Acc + x[0]*y[0] + x[1]*y[1]; }
+
+static inline __attribute__((always_inline)) int __gap_host_sumdotp4(v4s x, v4s y, int Acc)    { return Acc + x[0]*y[0] + x[1]*y[1] + x[2]*y[2] + x[3]*y[3]; }
+static inline __attribute__((always_inline)) int __gap_host_sumdotpu4(v4u x, v4u y, int Acc)   { return Acc + x[0]*y[0] + x[1]*y[1] + x[2]*y[2] + x[3]*y[3]; }
+static inline __attribute__((always_inline)) int __gap_host_sumdotpus4(v4u x, v4s y, int Acc)  { return Acc + x[0]*y[0] + x[1]*y[1] + x[2]*y[2] + x[3]*y[3]; }
+
+#endif
+
+#endif
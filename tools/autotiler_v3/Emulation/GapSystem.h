@@ -47,10 +47,17 @@ typedef unsigned int rt_pointerT;
 /* Cluster id, Core Id */
 #ifdef __EMUL__
 
+#if AT_EMUL_NB_CORES > 1
+#define gap_coreid()                    (__at_emul_core_id)
+#define gap_clusterid()                 0
+#define gap_ncore()                     AT_EMUL_NB_CORES
+#define gap_ncorem1()                   (AT_EMUL_NB_CORES-1)
+#else
 #define gap_coreid()                    0
 #define gap_clusterid()                 0
 #define gap_ncore()                     1
 #define gap_ncorem1()                   1
+#endif
 
 #else
 
@@ -88,11 +95,28 @@ static int Private_call(void (*fn)(void *), void * arg, __event_cb * event)
     return 1;
 }
 
-#define rt_team_fork(__cores, __fn, __arg)
 #define rt_cluster_call(a,b,__fn,__arg,c,d,e,f,g) Private_call(__fn, __arg, g)
 #define rt_event_get(a,b,c) event_get(b,c)
 #define rt_event_t __event_cb
 
+#if AT_EMUL_NB_CORES > 1
+/* Forks are executed by the emulation team from at_api_emul.h, which already runs the
+   entry on the calling core */
+#define rt_team_fork(__cores, __fn, __arg) AT_FORK((__cores), (__fn), (__arg))
+
+#define __CALL(Entry, Arg)
+
+#define gap_setupbarrier(BarN, CoreM)
+#define gap_waitbarrier(BarN)           __at_emul_team_barrier(0)
+#define gap_waitbarrier_cc(BarN)        __at_emul_team_barrier(1)
+#define gap_cl_critical_enter()         pthread_mutex_lock(&__at_emul_team.critical)
+#define gap_cl_critical_exit()          pthread_mutex_unlock(&__at_emul_team.critical)
+
+#define rt_nb_pe() AT_EMUL_NB_CORES
+#define rt_team_barrier() __at_emul_team_barrier(0)
+#else
+#define rt_team_fork(__cores, __fn, __arg)
+
 #define __CALL(Entry, Arg)	Entry((Arg))
 
 #define gap_setupbarrier(BarN, CoreM)
@@ -101,12 +125,14 @@ static int Private_call(void (*fn)(void *), void * arg, __event_cb * event)
 #define gap_cl_critical_enter()
 #define gap_cl_critical_exit()
 
+#define rt_nb_pe() 1
+#define rt_team_barrier()
+#endif
+
 #define rt_event_sched_init(x)
 #define rt_event_alloc(x,y) 0
-#define rt_nb_pe() 1
 #define rt_cluster_mount(a,b,c,d)
 #define rt_event_execute(a,b)
-#define rt_team_barrier()
 
 static inline void rt_hyperram_conf_init(rt_hyperram_conf_t *conf)
 {
@@ -0,0 +1,69 @@
+/* Differential test of the host vector builtins of GapBuiltinsHost.h, selected with
+   AT_EMUL_HOST_SIMD, against the per-lane builtins of GapBuiltins.h.
+   Each builtin is called with random operands, mixed with saturating ones (lanes at their
+   minimum, maximum, -1), and both versions must give the same result. The host versions
+   must also evaluate their operands only once.
+
+   Usage: GapBuiltinsTest [NbIterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "GapBuiltinsTest.h"
+
+#define V(Name, Type, Expr)	S(Name, Expr)
+#define S(Name, Expr)		{ #Name, TEST_NAME(Ref, Name), TEST_NAME(Host, Name) },
+static struct {
+	const char *Name;
+	TestBuiltin_T Ref;
+	TestBuiltin_T Host;
+} Builtins[] = { TEST_BUILTINS };
+#undef S
+#undef V
+
+static unsigned long long Seed = 88172645463325252ULL;
+
+static unsigned int Random()
+{
+	Seed ^= Seed << 13; Seed ^= Seed >> 7; Seed ^= Seed << 17;
+	switch (Seed >> 60) {
+		case 0: return 0x80808080;
+		case 1: return 0x7f7f7f7f;
+		case 2: return 0x80007fff;
+		case 3: return 0xffffffff;
+		default: return (unsigned int) Seed;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int NbIterations = argc > 1 ? atoi(argv[1]) : 1000000;
+	int NbBuiltins = sizeof(Builtins) / sizeof(Builtins[0]);
+	int Errors = 0;
+
+	for (int b=0; b<NbBuiltins; b++) {
+		for (int It=0; It<NbIterations; It++) {
+			unsigned int W0 = Random(), W1 = Random();
+			/* Scalars of any magnitude, and clip bounds which are positive as on the target */
+			int I = (int) Random() >> (Random() & 31), J = (int) Random() >> (Random() & 31);
+			int P = Random() % 31, K = (int) (Random() & 0x7fffffff) >> (Random() & 31);
+			unsigned int Ref = Builtins[b].Ref(W0, W1, I, J, P, K), Host = Builtins[b].Host(W0, W1, I, J, P, K);
+
+			if (Ref != Host) {
+				if (Errors < 10)
+					printf("Mismatch on gap_%s (W0: 0x%08x, W1: 0x%08x, I: %d, J: %d, P: %d, K: %d, ref: 0x%08x, host: 0x%08x)\n",
+						Builtins[b].Name, W0, W1, I, J, P, K, Ref, Host);
+				Errors++;
+			}
+		}
+	}
+
+	int EvalCount = Host_EvalCount(0x01020304, 0x05060708, 3);
+	if (EvalCount != 4) {
+		printf("Host builtins evaluated their operands %d times instead of 4\n", EvalCount);
+		Errors++;
+	}
+
+	printf("%d builtins, %d iterations, %d errors\n", NbBuiltins, NbIterations, Errors);
+
+	return Errors != 0;
+}
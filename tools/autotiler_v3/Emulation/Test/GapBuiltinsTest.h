@@ -0,0 +1,35 @@
+#ifndef __GAP_BUILTINS_TEST_H__
+#define __GAP_BUILTINS_TEST_H__
+
+/* Builtins redefined by GapBuiltinsHost.h, each one is turned into a function taking the
+   operands as raw words so that the per-lane version and the host version can be compared.
+   V is for builtins returning a vector, S for the ones returning a scalar. */
+#define TEST_BUILTINS \
+	V(max4, v4s, gap_max4(A4, B4)) V(min4, v4s, gap_min4(A4, B4)) V(maxu4, v4u, gap_maxu4(UA4, UB4)) V(minu4, v4u, gap_minu4(UA4, UB4)) \
+	V(max2, v2s, gap_max2(A2, B2)) V(min2, v2s, gap_min2(A2, B2)) V(maxu2, v2u, gap_maxu2(UA2, UB2)) V(minu2, v2u, gap_minu2(UA2, UB2)) \
+	V(add4, v4s, gap_add4(A4, B4)) V(sub4, v4s, gap_sub4(A4, B4)) V(add2, v2s, gap_add2(A2, B2)) V(sub2, v2s, gap_sub2(A2, B2)) \
+	V(abs4, v4s, gap_abs4(A4)) V(abs2, v2s, gap_abs2(A2)) \
+	S(max, gap_max(I, J)) S(min, gap_min(I, J)) S(abs, gap_abs(I)) \
+	S(clip, gap_clip(I, P)) S(clipu, gap_clipu(I, P)) S(clipr, gap_clipr(I, K)) S(clipur, gap_clipur(I, K)) \
+	S(dotp4, gap_dotp4(A4, B4)) S(dotpu4, gap_dotpu4(UA4, UB4)) S(dotpus4, gap_dotpus4(UA4, B4)) \
+	S(sumdotp4, gap_sumdotp4(A4, B4, I)) S(sumdotpu4, gap_sumdotpu4(UA4, UB4, I)) S(sumdotpus4, gap_sumdotpus4(UA4, B4, I)) \
+	S(dotp2, gap_dotp2(A2, B2)) S(dotpu2, gap_dotpu2(UA2, UB2)) S(dotpus2, gap_dotpus2(UA2, B2)) \
+	S(sumdotp2, gap_sumdotp2(A2, B2, I)) S(sumdotpu2, gap_sumdotpu2(UA2, UB2, I)) S(sumdotpus2, gap_sumdotpus2(UA2, B2, I))
+
+/* W0 and W1 are the vector operands, I and J the scalar ones, P a clip precision and K a clip bound */
+typedef unsigned int (*TestBuiltin_T)(unsigned int W0, unsigned int W1, int I, int J, int P, int K);
+
+#define TEST_NAME(Prefix, Name)		TEST_NAME_(Prefix, Name)
+#define TEST_NAME_(Prefix, Name)	Prefix##_##Name
+
+#define V(Name, Type, Expr)		S(Name, Expr)
+#define S(Name, Expr)			unsigned int TEST_NAME(Ref, Name)(unsigned int, unsigned int, int, int, int, int); \
+					unsigned int TEST_NAME(Host, Name)(unsigned int, unsigned int, int, int, int, int);
+TEST_BUILTINS
+#undef S
+#undef V
+
+/* Counts the evaluations of its operands by the host version */
+int Host_EvalCount(unsigned int W0, unsigned int W1, int I);
+
+#endif
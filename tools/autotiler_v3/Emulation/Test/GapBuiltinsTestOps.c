@@ -0,0 +1,36 @@
+/* Compiled once as is, with the per-lane builtins, and once with AT_EMUL_HOST_SIMD, with
+   the host ones. TEST_PREFIX gives the prefix of the functions of each version. */
+
+#include "Gap.h"
+#include "GapBuiltinsTest.h"
+
+#define UNPACK \
+	v4s A4 = (v4s) W0, B4 = (v4s) W1; v4u UA4 = (v4u) W0, UB4 = (v4u) W1; \
+	v2s A2 = (v2s) W0, B2 = (v2s) W1; v2u UA2 = (v2u) W0, UB2 = (v2u) W1; \
+	(void) A4; (void) B4; (void) UA4; (void) UB4; (void) A2; (void) B2; (void) UA2; (void) UB2; \
+	(void) J; (void) P; (void) K;
+
+#define V(Name, Type, Expr) \
+	unsigned int TEST_NAME(TEST_PREFIX, Name)(unsigned int W0, unsigned int W1, int I, int J, int P, int K) \
+	{ UNPACK; Type R = Expr; return (unsigned int) R; }
+#define S(Name, Expr) \
+	unsigned int TEST_NAME(TEST_PREFIX, Name)(unsigned int W0, unsigned int W1, int I, int J, int P, int K) \
+	{ UNPACK; return (unsigned int) (Expr); }
+
+TEST_BUILTINS
+
+#if defined(AT_EMUL_HOST_SIMD)
+int Host_EvalCount(unsigned int W0, unsigned int W1, int I)
+{
+	v4s In[2] = { (v4s) W0, (v4s) W1 };
+	v4s *Ptr = In;
+	int Count = 0;
+
+	Count += (I = gap_sumdotp4(*Ptr++, In[1], I), Ptr - In); Ptr = In;
+	Count += (I = gap_clip(*(int *) Ptr++ + I, 7), Ptr - In); Ptr = In;
+	Count += ((void) gap_max4(*Ptr++, In[1]), Ptr - In); Ptr = In;
+	Count += ((void) gap_abs(*(int *) Ptr++), Ptr - In);
+
+	return Count;
+}
+#endif
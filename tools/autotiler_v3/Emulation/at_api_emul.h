@@ -28,9 +28,21 @@ extern unsigned int __L3_Read, __L3_Write, __L2_Read, __L2_Write;
  * Utils
  */
 
+/* Number of cluster cores emulated with host threads, AT_FORK runs on the calling
+   thread only when it is 1 */
+#ifndef AT_EMUL_NB_CORES
+#define AT_EMUL_NB_CORES   1
+#endif
+
+#if AT_EMUL_NB_CORES > 1
+#define AT_COREID()        (__at_emul_core_id)
+#define AT_CLUSTERID()     0
+#define AT_NCORE()         AT_EMUL_NB_CORES
+#else
 #define AT_COREID()        0
 #define AT_CLUSTERID()     0
 #define AT_NCORE()         1
+#endif
  
  
 #define gap_fc_starttimer()
@@ -914,6 +926,152 @@ do { \
 typedef void (*AT_FORK_FUN_TYPE)(void *); 
 typedef void *AT_FORK_ARG_TYPE;
 
+#if AT_EMUL_NB_CORES > 1
+
+#include <pthread.h>
+#include <stdint.h>
+
+/* The cluster cores are emulated by a pool of host threads, one per core, created on
+   the first fork. The caller of a fork executes core 0 (or the cluster controller for
+   AT_FORK_CC) and the pool threads the other cores, so that kernels see their real core
+   id and can synchronize through the team barrier. The state is defined weak as this
+   runtime only lives in headers and must be shared by all compilation units. */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_mutex_t critical;
+  pthread_cond_t fork_cond;
+  pthread_cond_t done_cond;
+  pthread_cond_t barrier_cond;
+  int nb_threads;             /* Number of pool threads already created */
+  unsigned int fork_id;       /* Incremented on each fork to wake up the pool */
+  AT_FORK_FUN_TYPE entry;
+  AT_FORK_ARG_TYPE arg;
+  int first_core;             /* First core executed by the pool in the current fork */
+  int nb_cores;               /* Number of cores in the team, 1 outside forks */
+  int has_cc;                 /* The cluster controller is part of the team */
+  int nb_running;             /* Number of pool threads still executing the fork */
+  int barrier_count[2];       /* Barrier among the cores, and among cores and controller */
+  unsigned int barrier_gen[2];
+} __at_emul_team_t;
+
+__attribute__((weak)) __at_emul_team_t __at_emul_team = {
+  PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+  0, 0, 0, 0, 0, 1, 0, 0, {0, 0}, {0, 0}
+};
+
+__attribute__((weak)) __thread int __at_emul_core_id = 0;
+
+static void *__at_emul_team_thread(void *arg)
+{
+  __at_emul_team_t *team = &__at_emul_team;
+  unsigned int fork_id = 0;
+
+  __at_emul_core_id = (int)(intptr_t)arg;
+
+  pthread_mutex_lock(&team->lock);
+  while (1)
+  {
+    while (team->fork_id == fork_id)
+      pthread_cond_wait(&team->fork_cond, &team->lock);
+    fork_id = team->fork_id;
+
+    if (__at_emul_core_id >= team->first_core && __at_emul_core_id < team->nb_cores)
+    {
+      AT_FORK_FUN_TYPE entry = team->entry;
+      AT_FORK_ARG_TYPE entry_arg = team->arg;
+
+      pthread_mutex_unlock(&team->lock);
+      entry(entry_arg);
+      pthread_mutex_lock(&team->lock);
+
+      if (--team->nb_running == 0)
+        pthread_cond_signal(&team->done_cond);
+    }
+  }
+  return NULL;
+}
+
+static inline void __at_emul_team_fork(int nb_cores, AT_FORK_FUN_TYPE entry, AT_FORK_ARG_TYPE arg, int has_cc)
+{
+  __at_emul_team_t *team = &__at_emul_team;
+  int core_id = __at_emul_core_id;
+
+  if (nb_cores <= 0 || nb_cores > AT_EMUL_NB_CORES) nb_cores = AT_EMUL_NB_CORES;
+
+  pthread_mutex_lock(&team->lock);
+
+  if (team->nb_threads == 0)
+  {
+    for (int i=0; i<AT_EMUL_NB_CORES; i++)
+    {
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, __at_emul_team_thread, (void *)(intptr_t)i))
+      {
+        fprintf(stderr, "AT_FORK: failed to create emulation thread for core %d\n", i);
+        exit(1);
+      }
+      pthread_detach(thread);
+    }
+    team->nb_threads = AT_EMUL_NB_CORES;
+  }
+
+  team->entry = entry;
+  team->arg = arg;
+  team->nb_cores = nb_cores;
+  team->has_cc = has_cc;
+  team->first_core = has_cc ? 0 : 1;
+  team->nb_running = nb_cores - team->first_core;
+  team->fork_id++;
+  pthread_cond_broadcast(&team->fork_cond);
+  pthread_mutex_unlock(&team->lock);
+
+  /* The cluster controller takes the id following the last core, as on the hardware */
+  __at_emul_core_id = has_cc ? AT_EMUL_NB_CORES : 0;
+  entry(arg);
+  __at_emul_core_id = core_id;
+
+  pthread_mutex_lock(&team->lock);
+  while (team->nb_running)
+    pthread_cond_wait(&team->done_cond, &team->lock);
+  team->nb_cores = 1;
+  team->has_cc = 0;
+  pthread_mutex_unlock(&team->lock);
+}
+
+static inline void __at_emul_team_barrier(int with_cc)
+{
+  __at_emul_team_t *team = &__at_emul_team;
+
+  pthread_mutex_lock(&team->lock);
+  int nb_cores = team->nb_cores + (with_cc ? team->has_cc : 0);
+  if (nb_cores > 1)
+  {
+    unsigned int gen = team->barrier_gen[with_cc];
+    if (++team->barrier_count[with_cc] == nb_cores)
+    {
+      team->barrier_count[with_cc] = 0;
+      team->barrier_gen[with_cc]++;
+      pthread_cond_broadcast(&team->barrier_cond);
+    }
+    else
+    {
+      while (gen == team->barrier_gen[with_cc])
+        pthread_cond_wait(&team->barrier_cond, &team->lock);
+    }
+  }
+  pthread_mutex_unlock(&team->lock);
+}
+
+#define AT_FORK(nb_cores,entry,arg)     __at_emul_team_fork((nb_cores), (AT_FORK_FUN_TYPE)(entry), (AT_FORK_ARG_TYPE)(arg), 0)
+#define AT_FORK_CC(nb_cores,entry,arg)  __at_emul_team_fork((nb_cores), (AT_FORK_FUN_TYPE)(entry), (AT_FORK_ARG_TYPE)(arg), 1)
+#define AT_FORK_WAIT()                  __at_emul_team_barrier(0)
+
+#define AT_FORK_ASYNC(nb_cores,entry,arg) AT_FORK((nb_cores),(entry),(arg))
+#define AT_FORK_ASYNC_WAIT()
+
+#else
+
 #define AT_FORK(nb_cores,entry,arg)
 #define AT_FORK_CC(nb_cores,entry,arg)
 #define AT_FORK_WAIT()
@@ -921,6 +1079,8 @@ typedef void *AT_FORK_ARG_TYPE;
 #define AT_FORK_ASYNC(nb_cores,entry,arg)
 #define AT_FORK_ASYNC_WAIT()
 
+#endif
+
 #define AT_YIELD()	(0)
 
 /*
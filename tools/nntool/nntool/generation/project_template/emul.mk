@@ -18,6 +18,16 @@ CFLAGS += -g -m32 -O0 -D__EMUL__ -DAT_MODEL_PREFIX=$(MODEL_PREFIX) $(MODEL_SIZE_
 INCLUDES = -I. -I$(MODEL_COMMON_INC) -I$(TILER_EMU_INC) -I$(TILER_INC) $(CNN_LIB_INCLUDE) -I$(MODEL_BUILD)
 LFLAGS =
 LIBS = -lm
+# Run the cluster kernels on EMUL_NB_CORES host threads instead of sequentially
+ifdef EMUL_NB_CORES
+  CFLAGS += -DAT_EMUL_NB_CORES=$(EMUL_NB_CORES)
+  LIBS += -lpthread
+endif
+# Use host vector instructions for the GAP builtins, see GapBuiltinsHost.h. They are
+# only used in optimized builds, so this also overrides the -O0 above.
+ifdef EMUL_HOST_SIMD
+  CFLAGS += -DAT_EMUL_HOST_SIMD -O2 -msse4.1
+endif
 SRCS = $(MODEL_PREFIX).c $(MODEL_GEN_C) $(MODEL_EXPRESSIONS) $(MODEL_COMMON_SRCS) $(CNN_LIB)
 $(info CNN_LIB++ $(CNN_LIB))
 $(info SRCS++ $(SRCS))
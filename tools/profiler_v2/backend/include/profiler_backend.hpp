@@ -40,15 +40,9 @@
 #include <queue>
 
 #include "profiler_backend_hotspot.hpp"
-
-#define PROFILER_TRACE_PAGE_SIZE (128)
-#define PROFILER_INTERVAL_PAGE_SIZE (128)
-
+#include "profiler_trace_store.hpp"
 
 class Profiler_backend;
-class Profiler_trace_page;
-class Profiler_interval_page;
-class Profiler_event;
 class Profiler_trace;
 
 typedef union {
@@ -71,9 +65,11 @@ typedef struct
 class Profiler_binary
 {
 public:
-    Profiler_binary(std::string path);
-    inline Profiler_binary_info *get(uint64_t pc) { return &this->infos[pc]; }
+    Profiler_binary(Profiler_symbolizer *symbolizer);
+    Profiler_binary_info *get(uint64_t pc);
 private:
+    Profiler_symbolizer *symbolizer;
+    // Debug information of the PCs which have been looked up
     std::unordered_map<uint64_t, Profiler_binary_info> infos;
 };
 
@@ -105,13 +101,9 @@ private:
 class Profiler_trace : public Profiler_trace_gen
 {
 public:
-	Profiler_trace(Profiler_backend *top, std::string path, int id, gv::Vcd_event_type type, int width, Profiler_event_value no_value);
-
-    void handle_data(uint8_t *data, int size);
-    Profiler_event *alloc_event(int size);
+	Profiler_trace(Profiler_backend *top, std::string path, int id, gv::Vcd_event_type type, int width, Profiler_event_value no_value,
+        Profiler_store_trace *store_trace=NULL);
 
-    void register_trace_page(Profiler_trace_page *trace_page);
-    void add_interval_page();
     void dump(std::string indent="");
 
     void event_update_logical(int64_t timestamp, Profiler_event_value value, int flags, Profiler_event_value no_value);
@@ -141,9 +133,11 @@ public:
     std::mutex mutex;
 
 private:
-    Profiler_trace_page *current_page;
-    std::vector<std::vector<Profiler_interval_page *>> interval_pages;
-    int last_level;
+    // String traces contain pointers, which are stored as string IDs
+    uint64_t to_store(Profiler_event_value value);
+    Profiler_event_value from_store(uint64_t value);
+
+    Profiler_store_trace *store_trace;
     bool hotspot_enabled;
     bool binary_info;
     Profiler_trace_hotspot hotspot;
@@ -152,90 +146,6 @@ private:
     Profiler_event_value no_value;
 };
 
-class Profiler_event
-{
-public:
-	uint64_t timestamp;
-    Profiler_event *next;
-    void dump(std::string indent="");
-    
-    Profiler_event_value value;
-
-    Profiler_trace_page *parent;
-
-    void set_value(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value);
-};
-
-class Profiler_interval
-{
-    friend class Profiler_interval_page;
-
-public:
-    Profiler_interval();
-    void set_interval_page(Profiler_interval_page *interval_page);
-    void set_trace_page(Profiler_trace_page *trace_page);
-    void dump(std::string indent="");
-    void add_value_logical(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value);
-    Profiler_event_value get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value);
-
-    int64_t start_timestamp;
-    int64_t end_timestamp;
-    Profiler_event_value value;
-    Profiler_interval *prev;
-
-protected:
-    Profiler_interval_page *parent;
-
-private:
-    Profiler_trace_page *trace_page;
-    Profiler_interval_page *interval_page;
-};
-
-class Profiler_interval_page
-{
-    friend class Profiler_interval;
-
-public:
-    Profiler_interval_page(int level);
-    bool is_full() { return current == PROFILER_INTERVAL_PAGE_SIZE; }
-    void register_trace_page(Profiler_trace_page *trace_page);
-    void register_interval_page(Profiler_interval_page *interval_page);
-    void dump(std::string indent="");
-    Profiler_event_value get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value);
-    void set_parent(Profiler_interval *interval) { this->parent = interval; }
-    void add_value_logical(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value) { if (this->parent) this->parent->add_value_logical(timestamp, value, no_value); }
-
-    Profiler_interval intervals[PROFILER_INTERVAL_PAGE_SIZE];
-    
-protected:
-    int level;
-
-private:
-    int current;
-    Profiler_interval *parent;
-};
-
-class Profiler_trace_page
-{
-public:
-    Profiler_trace_page(Profiler_trace *trace);
-    bool has_size(int size) { return this->current_data_size >= size; }
-    Profiler_event *alloc_event(int size);
-    void dump(std::string indent="");
-    int current_data_size;
-    void set_parent(Profiler_interval *interval) { this->parent = interval; }
-    void add_value_logical(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value) { this->parent->add_value_logical(timestamp, value, no_value); }
-    Profiler_event_value get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value);
-
-private:
-    Profiler_trace *trace;
-    uint8_t *current_data;
-    Profiler_event *last_alloc_event;
-    Profiler_event *first_event;
-    Profiler_interval *parent;
-};
-
-
 class Getview_req
 {
 public:
@@ -260,6 +170,7 @@ class Profiler_backend: public Profiler_backend_interface, public gv::Vcd_user
 public:
     Profiler_backend();
     void open(Profiler_backend_user_interface *user_interface, std::string gvsoc_config_path, js::config *json);
+    void open_store(Profiler_backend_user_interface *user_interface, std::string path);
     void trace_setup(std::string trace_path, bool enabled);
     void hotspot_enable(std::string trace_path);
     void hotspot_disable(std::string trace_path);
@@ -284,9 +195,11 @@ public:
 
     Profiler_binary *add_static_binary(std::string path);
     Profiler_trace *get_trace(std::string path);
+    Profiler_trace_store *get_store() { return this->store; }
 
 private:
     int handle_packet();
+    void start_workers();
     void viewer_routine();
     void worker_routine();
     void hotspot_bynary_trace(std::string trace_path);
@@ -330,6 +243,8 @@ private:
 
     std::unordered_map<std::string, Profiler_binary *> binaries;
 
+    Profiler_trace_store *store;
+
     bool abort_get_view;
     bool started;
 };
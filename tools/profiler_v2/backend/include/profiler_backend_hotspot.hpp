@@ -22,6 +22,7 @@
 #include <vector>
 #include <stdint.h>
 #include <string>
+#include "profiler_symbolizer.hpp"
 
 
 #define HOTSPOT_PAGE_SIZE      (16)
@@ -166,9 +167,11 @@ class Hotspot
 {
 public:
     Hotspot();
-    void add_static_binary(std::string elf_file);
-    inline Hotspot_debug *get(uint64_t pc) { return &this->infos[pc]; }
+    void add_static_binary(Profiler_symbolizer *symbolizer);
+    Hotspot_debug *get(uint64_t pc);
 
 private:
+    std::vector<Profiler_symbolizer *> symbolizers;
+    // Debug information of the PCs which have been looked up
     std::unordered_map<uint64_t, Hotspot_debug> infos;
 };
\ No newline at end of file
@@ -147,6 +147,8 @@ class Profiler_backend_interface
 public:
     virtual void open(  Profiler_backend_user_interface *user_interface, 
                         std::string gvsoc_config_path, js::config *json) = 0;
+    // Open the traces stored by a previous run, without running the simulation
+    virtual void open_store(Profiler_backend_user_interface *user_interface, std::string path) = 0;
     virtual void trace_setup(std::string trace_path, bool enabled) = 0;
     virtual void hotspot_enable(std::string trace_path) = 0;
     virtual void hotspot_disable(std::string trace_path) = 0;
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+
+// Gives the function, file and line of an address of an ELF binary, from its symbol
+// table and its DWARF line table.
+// The binary is only parsed on the first lookup, into tables sorted by address, so that
+// each lookup is a binary search.
+// This only depends on the ELF and DWARF formats, so that it can also be used by other
+// tools like gen-debug-info.
+class Profiler_symbolizer
+{
+public:
+    Profiler_symbolizer(std::string path);
+    ~Profiler_symbolizer();
+
+    // Returns false if the address is neither covered by a function nor by the line table
+    bool lookup(uint64_t addr, const char **function, const char **file, int *line);
+
+private:
+    typedef struct
+    {
+        uint64_t addr;
+        uint64_t size;
+        const char *name;
+    } Symbol;
+
+    typedef struct
+    {
+        uint64_t addr;
+        const char *file;
+        int line;
+        bool end_sequence;
+    } Line;
+
+    typedef struct
+    {
+        const uint8_t *data;
+        uint64_t size;
+        uint64_t addr;
+        uint32_t type;
+        uint64_t flags;
+    } Section;
+
+    void load();
+    void load_symbols();
+    void load_lines();
+    uint64_t parse_line_unit(const uint8_t *unit, const uint8_t *end);
+    bool get_section(std::string name, Section *section);
+    const char *get_file_name(std::string dir, std::string name);
+
+    std::string path;
+    uint8_t *data;
+    size_t size;
+    bool is_64;
+    std::once_flag load_flag;
+
+    std::vector<Section> sections;
+    std::unordered_map<std::string, int> section_ids;
+
+    std::vector<Symbol> symbols;
+    std::vector<Line> lines;
+
+    // File names are built from the directory and file tables, they are kept here
+    // so that returned pointers stay valid
+    std::deque<std::string> file_names;
+    std::unordered_map<std::string, const char *> file_names_map;
+};
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+// Events are stored by pages of timestamps followed by values, so that looking for
+// a timestamp only touches the timestamps
+#define PROFILER_STORE_PAGE_EVENTS (512)
+// Number of entries of a level summarized by one entry of the next level
+#define PROFILER_STORE_FANOUT_LOG2 (6)
+#define PROFILER_STORE_FANOUT (1 << PROFILER_STORE_FANOUT_LOG2)
+
+#define PROFILER_STORE_MAGIC 0x45524f5453465250 // "PRFSTORE"
+#define PROFILER_STORE_VERSION 1
+#define PROFILER_STORE_HEADER_SIZE 4096
+
+
+typedef struct
+{
+    uint64_t magic;
+    uint64_t version;
+    uint64_t nb_events;
+} Profiler_store_header;
+
+typedef struct
+{
+    int64_t timestamps[PROFILER_STORE_PAGE_EVENTS];
+    uint64_t values[PROFILER_STORE_PAGE_EVENTS];
+} Profiler_store_page;
+
+// Summary of a group of consecutive events
+typedef struct
+{
+    int64_t start_timestamp;
+    int64_t end_timestamp;
+    // Value of all the events if they have the same, otherwise the trace no_value
+    uint64_t value;
+    double min;
+    double max;
+    // Sum of value * duration of the events of the group whose duration is known,
+    // i.e. which are followed by another event
+    double area;
+} Profiler_store_summary;
+
+typedef struct
+{
+    double min;
+    double max;
+    double average;
+} Profiler_store_stats;
+
+
+// File mapped in memory, which grows on demand.
+// The mapping may move when it grows, so pointers to it must not be kept across
+// an append.
+class Profiler_mapped_file
+{
+public:
+    Profiler_mapped_file(std::string path, bool create, bool persistent);
+    ~Profiler_mapped_file();
+    void reserve(size_t size);
+    inline uint8_t *get_data() { return this->data; }
+    inline size_t get_size() { return this->size; }
+
+private:
+    int fd;
+    uint8_t *data;
+    size_t size;
+};
+
+
+// Columnar storage of the events of a trace, with a pyramid of summaries so that
+// any time window can be summarized in a logarithmic number of accesses
+class Profiler_store_trace
+{
+public:
+    Profiler_store_trace(std::string path, bool create, bool persistent, uint64_t no_value);
+    ~Profiler_store_trace();
+
+    void append(int64_t timestamp, uint64_t value);
+
+    inline uint64_t get_nb_events() { return this->header()->nb_events; }
+    int64_t get_last_timestamp();
+
+    // Returns the value if it is the same during the whole window, otherwise the no_value
+    uint64_t get_value(int64_t start_timestamp, int64_t end_timestamp);
+
+    void get_stats(int64_t start_timestamp, int64_t end_timestamp, Profiler_store_stats *stats);
+
+    void dump(std::string indent="");
+
+private:
+    inline Profiler_store_header *header() { return (Profiler_store_header *)this->events->get_data(); }
+    inline Profiler_store_page *page(uint64_t index)
+    {
+        return &((Profiler_store_page *)(this->events->get_data() + PROFILER_STORE_HEADER_SIZE))[index / PROFILER_STORE_PAGE_EVENTS];
+    }
+    inline int64_t timestamp(uint64_t index) { return this->page(index)->timestamps[index % PROFILER_STORE_PAGE_EVENTS]; }
+    inline uint64_t value(uint64_t index) { return this->page(index)->values[index % PROFILER_STORE_PAGE_EVENTS]; }
+    inline Profiler_store_summary *summary(int level, uint64_t index) { return &((Profiler_store_summary *)this->levels[level - 1]->get_data())[index]; }
+
+    // Index of the last event at or before the timestamp, or 0 if there is none
+    uint64_t find_event(int64_t timestamp);
+    void get_summary(int level, uint64_t index, Profiler_store_summary *summary);
+    void merge(Profiler_store_summary *summary, Profiler_store_summary *other);
+    void merge_range(uint64_t first, uint64_t last, Profiler_store_summary *summary);
+    void add_level();
+
+    std::string path;
+    bool persistent;
+    uint64_t no_value;
+    Profiler_mapped_file *events;
+    // Level N summarizes PROFILER_STORE_FANOUT entries of level N-1, level 0 being the events
+    std::vector<Profiler_mapped_file *> levels;
+};
+
+
+typedef struct
+{
+    int id;
+    std::string path;
+    int type;
+    int width;
+    uint64_t no_value;
+    Profiler_store_trace *trace;
+} Profiler_store_trace_info;
+
+
+// Directory containing the traces of a run.
+// It is filled while the simulation is running, and can be opened again later on
+// to look at the traces without running the simulation.
+// When no path is given, the traces are kept in unlinked files which disappear
+// when the backend exits.
+class Profiler_trace_store
+{
+public:
+    Profiler_trace_store(std::string path="", bool create=true);
+    ~Profiler_trace_store();
+
+    Profiler_store_trace *new_trace(int id, std::string path, int type, int width, uint64_t no_value);
+    std::vector<Profiler_store_trace_info> &get_traces() { return this->traces; }
+
+    // Strings can not be stored as pointers, they are stored as an index in the string table
+    uint64_t get_string_id(const char *str);
+    const char *get_string(uint64_t id);
+
+private:
+    std::string path;
+    bool persistent;
+    FILE *index_file;
+    FILE *strings_file;
+    std::vector<Profiler_store_trace_info> traces;
+    // Strings are added by the simulation while the view workers are reading them
+    std::mutex strings_mutex;
+    std::unordered_map<const char *, uint64_t> string_ids;
+    std::vector<const char *> strings;
+};
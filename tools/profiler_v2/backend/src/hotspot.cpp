@@ -21,7 +21,7 @@
 #include <sstream>
 #include <string>
 #include <string.h>
-#include <regex>
+#include <algorithm>
 
 
 Hospot_results_implem::Hospot_results_implem(Hotspot &hotspot)
@@ -613,57 +613,37 @@ Hotspot::Hotspot()
 }
 
 
-void Hotspot::add_static_binary(std::string elf_file)
+void Hotspot::add_static_binary(Profiler_symbolizer *symbolizer)
 {
-    std::string command = "gen-debug-info " + elf_file;
+    this->symbolizers.push_back(symbolizer);
+}
 
-    std::shared_ptr<FILE> pipe(popen(command.c_str(), "r"), pclose);
-    if (!pipe)
-    {
-        throw std::invalid_argument("Unable to open binary: " + elf_file + "\n");
-    }
-    char buffer[128];
-    std::string result = "";
 
-    while (!feof(pipe.get())) {
-        if (fgets(buffer, 128, pipe.get()) != NULL)
-            result += buffer;
+Hotspot_debug *Hotspot::get(uint64_t pc)
+{
+    auto it = this->infos.find(pc);
+    if (it != this->infos.end())
+    {
+        return &it->second;
     }
 
-    std::unordered_map<std::string, const char *> files;
-    std::unordered_map<std::string, const char *> functions;
-    std::stringstream ss(result);
-    std::string line;
-    std::regex regex{R"([\s]+)"};
-    while(std::getline(ss, line,'\n'))
+    for (Profiler_symbolizer *symbolizer: this->symbolizers)
     {
-        char functionname[256], inlined_function[256], filename[256];
-        uint64_t addr;
-        int lineno;
-        int nb_item = sscanf(line.c_str(), "%lx %s %s %s %d", &addr, functionname, inlined_function, filename, &lineno);
-
-        if (nb_item == 5)
+        const char *function, *file;
+        int line;
+        if (symbolizer->lookup(pc, &function, &file, &line))
         {
-            const char *file = files[filename];
-            if (file == NULL)
-            {
-                file = strdup(filename);
-                files[file] = file;
-            }
-            const char *function = functions[functionname];
-            if (function == NULL)
-            {
-                function = strdup(functionname);
-                functions[function] = function;
-            }
-
-            this->infos[addr] = (Hotspot_debug) {
-                .pc = addr,
+            Hotspot_debug *debug = &this->infos[pc];
+            *debug = (Hotspot_debug) {
+                .pc = pc,
                 .function = function,
                 .inlined_function = function,
                 .file = file,
-                .line = lineno
+                .line = line
             };
+            return debug;
         }
     }
+
+    return NULL;
 }
@@ -0,0 +1,592 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler_symbolizer.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <string.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define DW_LNS_copy               1
+#define DW_LNS_advance_pc         2
+#define DW_LNS_advance_line       3
+#define DW_LNS_set_file           4
+#define DW_LNS_const_add_pc       8
+#define DW_LNS_fixed_advance_pc   9
+
+#define DW_LNE_end_sequence       1
+#define DW_LNE_set_address        2
+#define DW_LNE_define_file        3
+
+#define DW_LNCT_path              1
+#define DW_LNCT_directory_index   2
+
+#define DW_FORM_block2            0x03
+#define DW_FORM_block4            0x04
+#define DW_FORM_data2             0x05
+#define DW_FORM_data4             0x06
+#define DW_FORM_data8             0x07
+#define DW_FORM_string            0x08
+#define DW_FORM_block             0x09
+#define DW_FORM_block1            0x0a
+#define DW_FORM_data1             0x0b
+#define DW_FORM_strp              0x0e
+#define DW_FORM_udata             0x0f
+#define DW_FORM_data16            0x1e
+#define DW_FORM_line_strp         0x1f
+
+
+static uint64_t read_uleb(const uint8_t *&data)
+{
+    uint64_t result = 0;
+    int shift = 0;
+    uint8_t byte;
+    do
+    {
+        byte = *data++;
+        if (shift < 64)
+        {
+            result |= (uint64_t)(byte & 0x7f) << shift;
+        }
+        shift += 7;
+    } while (byte & 0x80);
+    return result;
+}
+
+static int64_t read_sleb(const uint8_t *&data)
+{
+    int64_t result = 0;
+    int shift = 0;
+    uint8_t byte;
+    do
+    {
+        byte = *data++;
+        if (shift < 64)
+        {
+            result |= (int64_t)(byte & 0x7f) << shift;
+        }
+        shift += 7;
+    } while (byte & 0x80);
+
+    if (shift < 64 && (byte & 0x40))
+    {
+        result |= -((int64_t)1 << shift);
+    }
+    return result;
+}
+
+static uint64_t read_uint(const uint8_t *&data, int size)
+{
+    uint64_t result = 0;
+    memcpy(&result, data, size);
+    data += size;
+    return result;
+}
+
+
+Profiler_symbolizer::Profiler_symbolizer(std::string path)
+    : path(path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat file_stat;
+
+    if (fd == -1 || fstat(fd, &file_stat) != 0)
+    {
+        throw std::invalid_argument("Unable to open binary: " + path + "\n");
+    }
+
+    this->size = file_stat.st_size;
+    this->data = (uint8_t *)mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (this->data == MAP_FAILED || this->size < sizeof(Elf32_Ehdr) || memcmp(this->data, ELFMAG, SELFMAG) != 0 ||
+        this->data[EI_DATA] != ELFDATA2LSB)
+    {
+        throw std::invalid_argument("Unsupported binary: " + path + "\n");
+    }
+
+    this->is_64 = this->data[EI_CLASS] == ELFCLASS64;
+
+    // Sections are extracted now since it is cheap, everything else is parsed on
+    // the first lookup
+    uint64_t shoff, shnum, shstrndx, shentsize;
+    if (this->is_64)
+    {
+        Elf64_Ehdr *header = (Elf64_Ehdr *)this->data;
+        shoff = header->e_shoff; shnum = header->e_shnum; shstrndx = header->e_shstrndx; shentsize = header->e_shentsize;
+    }
+    else
+    {
+        Elf32_Ehdr *header = (Elf32_Ehdr *)this->data;
+        shoff = header->e_shoff; shnum = header->e_shnum; shstrndx = header->e_shstrndx; shentsize = header->e_shentsize;
+    }
+
+    if (shoff + shnum * shentsize > this->size || (shnum > 0 && shstrndx >= shnum))
+    {
+        throw std::invalid_argument("Corrupted binary: " + path + "\n");
+    }
+
+    std::vector<uint64_t> names;
+    for (uint64_t i=0; i<shnum; i++)
+    {
+        const uint8_t *entry = this->data + shoff + i * shentsize;
+        Section section;
+        uint64_t offset;
+
+        if (this->is_64)
+        {
+            Elf64_Shdr *shdr = (Elf64_Shdr *)entry;
+            offset = shdr->sh_offset; section.size = shdr->sh_size; section.addr = shdr->sh_addr;
+            section.type = shdr->sh_type; section.flags = shdr->sh_flags;
+            names.push_back(shdr->sh_name);
+        }
+        else
+        {
+            Elf32_Shdr *shdr = (Elf32_Shdr *)entry;
+            offset = shdr->sh_offset; section.size = shdr->sh_size; section.addr = shdr->sh_addr;
+            section.type = shdr->sh_type; section.flags = shdr->sh_flags;
+            names.push_back(shdr->sh_name);
+        }
+
+        if (section.type == SHT_NOBITS || offset + section.size > this->size)
+        {
+            section.size = 0;
+        }
+        section.data = this->data + offset;
+        this->sections.push_back(section);
+    }
+
+    if (shnum > 0)
+    {
+        Section &strtab = this->sections[shstrndx];
+        for (uint64_t i=0; i<shnum; i++)
+        {
+            if (names[i] < strtab.size)
+            {
+                this->section_ids[(const char *)strtab.data + names[i]] = i;
+            }
+        }
+    }
+}
+
+
+Profiler_symbolizer::~Profiler_symbolizer()
+{
+    munmap(this->data, this->size);
+}
+
+
+bool Profiler_symbolizer::get_section(std::string name, Section *section)
+{
+    auto it = this->section_ids.find(name);
+    if (it == this->section_ids.end() || this->sections[it->second].size == 0)
+    {
+        return false;
+    }
+    *section = this->sections[it->second];
+    return true;
+}
+
+
+void Profiler_symbolizer::load()
+{
+    this->load_symbols();
+    this->load_lines();
+}
+
+
+void Profiler_symbolizer::load_symbols()
+{
+    Section symtab, strtab;
+    if (!this->get_section(".symtab", &symtab) || !this->get_section(".strtab", &strtab))
+    {
+        return;
+    }
+
+    uint64_t entry_size = this->is_64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+    for (uint64_t offset=0; offset + entry_size <= symtab.size; offset += entry_size)
+    {
+        uint64_t name, value, size;
+        int type;
+
+        if (this->is_64)
+        {
+            Elf64_Sym *sym = (Elf64_Sym *)(symtab.data + offset);
+            name = sym->st_name; value = sym->st_value; size = sym->st_size; type = ELF64_ST_TYPE(sym->st_info);
+        }
+        else
+        {
+            Elf32_Sym *sym = (Elf32_Sym *)(symtab.data + offset);
+            name = sym->st_name; value = sym->st_value; size = sym->st_size; type = ELF32_ST_TYPE(sym->st_info);
+        }
+
+        if (type == STT_FUNC && name < strtab.size)
+        {
+            this->symbols.push_back((Symbol){ .addr=value, .size=size, .name=(const char *)strtab.data + name });
+        }
+    }
+
+    std::stable_sort(this->symbols.begin(), this->symbols.end(),
+        [](const Symbol &a, const Symbol &b) { return a.addr < b.addr; });
+}
+
+
+const char *Profiler_symbolizer::get_file_name(std::string dir, std::string name)
+{
+    std::string path = name[0] == '/' || dir == "" ? name : dir + "/" + name;
+
+    auto it = this->file_names_map.find(path);
+    if (it != this->file_names_map.end())
+    {
+        return it->second;
+    }
+
+    this->file_names.push_back(path);
+    const char *result = this->file_names.back().c_str();
+    this->file_names_map[path] = result;
+    return result;
+}
+
+
+void Profiler_symbolizer::load_lines()
+{
+    Section debug_line;
+    if (!this->get_section(".debug_line", &debug_line))
+    {
+        return;
+    }
+
+    const uint8_t *unit = debug_line.data;
+    const uint8_t *end = debug_line.data + debug_line.size;
+    while (unit < end)
+    {
+        uint64_t unit_size = this->parse_line_unit(unit, end);
+        if (unit_size == 0)
+        {
+            break;
+        }
+        unit += unit_size;
+    }
+
+    // Sequences of different compilation units are not ordered. An end of sequence
+    // must come before a row starting at the same address.
+    std::stable_sort(this->lines.begin(), this->lines.end(),
+        [](const Line &a, const Line &b) { return a.addr < b.addr || (a.addr == b.addr && a.end_sequence && !b.end_sequence); });
+}
+
+
+// Parse one line table unit and returns its size, or 0 if it can not be parsed
+uint64_t Profiler_symbolizer::parse_line_unit(const uint8_t *unit, const uint8_t *end)
+{
+    const uint8_t *data = unit;
+    int offset_size = 4;
+
+    if (data + 4 > end)
+    {
+        return 0;
+    }
+
+    uint64_t unit_length = read_uint(data, 4);
+    if (unit_length == 0xffffffff)
+    {
+        offset_size = 8;
+        unit_length = read_uint(data, 8);
+    }
+
+    const uint8_t *unit_end = data + unit_length;
+    if (unit_end > end)
+    {
+        return 0;
+    }
+
+    uint64_t unit_size = unit_end - unit;
+
+    int version = read_uint(data, 2);
+    if (version < 2 || version > 5)
+    {
+        return unit_size;
+    }
+
+    int address_size = this->is_64 ? 8 : 4;
+    if (version >= 5)
+    {
+        address_size = read_uint(data, 1);
+        data++; // segment_selector_size
+    }
+
+    uint64_t header_length = read_uint(data, offset_size);
+    const uint8_t *program = data + header_length;
+
+    int min_inst_length = read_uint(data, 1);
+    if (version >= 4)
+    {
+        data++; // maximum_operations_per_instruction
+    }
+    bool default_is_stmt = read_uint(data, 1);
+    int line_base = (int8_t)read_uint(data, 1);
+    int line_range = read_uint(data, 1);
+    int opcode_base = read_uint(data, 1);
+    const uint8_t *opcode_lengths = data;
+    data += opcode_base - 1;
+
+    (void)default_is_stmt;
+
+    if (line_range == 0)
+    {
+        return unit_size;
+    }
+
+    std::vector<std::string> dirs;
+    std::vector<const char *> files;
+
+    if (version < 5)
+    {
+        // The directory 0 is the compilation directory, which is not in the table
+        dirs.push_back("");
+        while (data < program && *data)
+        {
+            dirs.push_back((const char *)data);
+            data += strlen((const char *)data) + 1;
+        }
+        data++;
+
+        // Files are numbered from 1
+        files.push_back(NULL);
+        while (data < program && *data)
+        {
+            std::string name = (const char *)data;
+            data += name.size() + 1;
+            uint64_t dir = read_uleb(data);
+            read_uleb(data); // modification time
+            read_uleb(data); // length
+            files.push_back(this->get_file_name(dir < dirs.size() ? dirs[dir] : "", name));
+        }
+    }
+    else
+    {
+        Section debug_str, debug_line_str;
+        bool has_str = this->get_section(".debug_str", &debug_str);
+        bool has_line_str = this->get_section(".debug_line_str", &debug_line_str);
+
+        for (int table=0; table<2; table++)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> formats;
+            int nb_formats = read_uint(data, 1);
+            for (int i=0; i<nb_formats; i++)
+            {
+                uint64_t content = read_uleb(data);
+                uint64_t form = read_uleb(data);
+                formats.push_back(std::make_pair(content, form));
+            }
+
+            uint64_t nb_entries = read_uleb(data);
+            for (uint64_t i=0; i<nb_entries && data < program; i++)
+            {
+                const char *name = "";
+                uint64_t dir = 0;
+
+                for (auto &format: formats)
+                {
+                    uint64_t value = 0;
+                    const char *str = NULL;
+
+                    switch (format.second)
+                    {
+                        case DW_FORM_string:
+                            str = (const char *)data;
+                            data += strlen(str) + 1;
+                            break;
+                        case DW_FORM_line_strp:
+                            value = read_uint(data, offset_size);
+                            if (has_line_str && value < debug_line_str.size)
+                                str = (const char *)debug_line_str.data + value;
+                            break;
+                        case DW_FORM_strp:
+                            value = read_uint(data, offset_size);
+                            if (has_str && value < debug_str.size)
+                                str = (const char *)debug_str.data + value;
+                            break;
+                        case DW_FORM_udata: value = read_uleb(data); break;
+                        case DW_FORM_data1: value = read_uint(data, 1); break;
+                        case DW_FORM_data2: value = read_uint(data, 2); break;
+                        case DW_FORM_data4: value = read_uint(data, 4); break;
+                        case DW_FORM_data8: value = read_uint(data, 8); break;
+                        case DW_FORM_data16: data += 16; break;
+                        case DW_FORM_block: data += read_uleb(data); break;
+                        case DW_FORM_block1: data += read_uint(data, 1); break;
+                        case DW_FORM_block2: data += read_uint(data, 2); break;
+                        case DW_FORM_block4: data += read_uint(data, 4); break;
+                        default:
+                            // Unknown form, the rest of the header can not be decoded
+                            return unit_size;
+                    }
+
+                    if (format.first == DW_LNCT_path && str)
+                    {
+                        name = str;
+                    }
+                    else if (format.first == DW_LNCT_directory_index)
+                    {
+                        dir = value;
+                    }
+                }
+
+                if (table == 0)
+                {
+                    dirs.push_back(name);
+                }
+                else
+                {
+                    files.push_back(this->get_file_name(dir < dirs.size() ? dirs[dir] : "", name));
+                }
+            }
+        }
+    }
+
+    // Now execute the line number program
+    data = program;
+
+    uint64_t address = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+
+    auto emit = [&](bool end_sequence) {
+        this->lines.push_back((Line){
+            .addr=address, .file=file < files.size() ? files[file] : NULL, .line=(int)line, .end_sequence=end_sequence
+        });
+    };
+
+    while (data < unit_end)
+    {
+        int opcode = *data++;
+
+        if (opcode >= opcode_base)
+        {
+            int adjusted = opcode - opcode_base;
+            address += (adjusted / line_range) * min_inst_length;
+            line += line_base + adjusted % line_range;
+            emit(false);
+        }
+        else if (opcode == 0)
+        {
+            uint64_t length = read_uleb(data);
+            const uint8_t *next = data + length;
+            if (length == 0 || next > unit_end)
+            {
+                break;
+            }
+
+            int extended = *data++;
+            if (extended == DW_LNE_end_sequence)
+            {
+                emit(true);
+                address = 0;
+                file = 1;
+                line = 1;
+            }
+            else if (extended == DW_LNE_set_address)
+            {
+                address = read_uint(data, std::min((int)length - 1, address_size));
+            }
+            else if (extended == DW_LNE_define_file)
+            {
+                std::string name = (const char *)data;
+                data += name.size() + 1;
+                uint64_t dir = read_uleb(data);
+                files.push_back(this->get_file_name(dir < dirs.size() ? dirs[dir] : "", name));
+            }
+            data = next;
+        }
+        else if (opcode == DW_LNS_copy)
+        {
+            emit(false);
+        }
+        else if (opcode == DW_LNS_advance_pc)
+        {
+            address += read_uleb(data) * min_inst_length;
+        }
+        else if (opcode == DW_LNS_advance_line)
+        {
+            line += read_sleb(data);
+        }
+        else if (opcode == DW_LNS_set_file)
+        {
+            file = read_uleb(data);
+        }
+        else if (opcode == DW_LNS_const_add_pc)
+        {
+            address += ((255 - opcode_base) / line_range) * min_inst_length;
+        }
+        else if (opcode == DW_LNS_fixed_advance_pc)
+        {
+            address += read_uint(data, 2);
+        }
+        else
+        {
+            // Other standard opcodes do not change the address nor the line, just skip
+            // their operands
+            for (int i=0; i<opcode_lengths[opcode - 1]; i++)
+            {
+                read_uleb(data);
+            }
+        }
+    }
+
+    return unit_size;
+}
+
+
+bool Profiler_symbolizer::lookup(uint64_t addr, const char **function, const char **file, int *line)
+{
+    std::call_once(this->load_flag, &Profiler_symbolizer::load, this);
+
+    *function = NULL;
+    *file = NULL;
+    *line = 0;
+
+    auto symbol = std::upper_bound(this->symbols.begin(), this->symbols.end(), addr,
+        [](uint64_t addr, const Symbol &symbol) { return addr < symbol.addr; });
+    if (symbol != this->symbols.begin())
+    {
+        symbol--;
+        // Symbols without size are assumed to extend until the next one
+        if (addr < symbol->addr + symbol->size || symbol->size == 0)
+        {
+            *function = symbol->name;
+        }
+    }
+
+    auto row = std::upper_bound(this->lines.begin(), this->lines.end(), addr,
+        [](uint64_t addr, const Line &line) { return addr < line.addr; });
+    if (row != this->lines.begin())
+    {
+        row--;
+        if (!row->end_sequence)
+        {
+            *file = row->file;
+            *line = row->line;
+        }
+    }
+
+    return *function != NULL || *file != NULL;
+}
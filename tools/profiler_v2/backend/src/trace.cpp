@@ -22,18 +22,43 @@
 //#define TRACE 1
 
 
-Profiler_trace::Profiler_trace(Profiler_backend *top, std::string path, int id, gv::Vcd_event_type type, int width, Profiler_event_value no_value)
-: top(top), path(path), id(id), type(type), width(width), current_page(NULL), last_level(-1), no_value(no_value)
+Profiler_trace::Profiler_trace(Profiler_backend *top, std::string path, int id, gv::Vcd_event_type type, int width, Profiler_event_value no_value,
+    Profiler_store_trace *store_trace)
+: top(top), path(path), id(id), type(type), width(width), store_trace(store_trace), no_value(no_value)
 {
-    this->interval_pages.push_back({});
     this->hotspot_enabled = false;
     this->binary_info = false;
+
+    if (this->store_trace == NULL)
+    {
+        this->store_trace = top->get_store()->new_trace(id, path, type, width, this->to_store(no_value));
+    }
+}
+
+
+uint64_t Profiler_trace::to_store(Profiler_event_value value)
+{
+    if (this->type == gv::Vcd_event_type_string)
+    {
+        return this->top->get_store()->get_string_id((const char *)value.value_p);
+    }
+    return value.value_r;
+}
+
+
+Profiler_event_value Profiler_trace::from_store(uint64_t value)
+{
+    if (this->type == gv::Vcd_event_type_string)
+    {
+        return (Profiler_event_value){ .value_p=(void *)this->top->get_store()->get_string(value) };
+    }
+    return (Profiler_event_value){ .value_r=value };
 }
 
 
 Profiler_event_value Profiler_trace::get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value)
 {
-    return this->interval_pages[this->last_level][0]->get_average_logical(start_timestamp, end_timestamp, no_value);
+    return this->from_store(this->store_trace->get_value(start_timestamp, end_timestamp));
 }
 
 
@@ -45,7 +70,7 @@ void Profiler_trace::get_view(std::vector<Profiler_backend_slot_info> &slots, in
 #ifdef TRACE
         printf("[SLOT] %ld -> %ld\n", start_timestamp, start_timestamp + slot_duration);
 #endif
-        if (slot_duration == 0 || this->last_level == -1)
+        if (slot_duration == 0 || this->store_trace->get_nb_events() == 0)
         {
             slot->value = 0;
         }
@@ -67,110 +92,13 @@ void Profiler_trace::get_view(std::vector<Profiler_backend_slot_info> &slots, in
 
 void Profiler_trace::dump(std::string indent)
 {
-    this->interval_pages.back()[0]->dump(indent);
-}
-
-
-void Profiler_trace::add_interval_page()
-{
-    int level = 0;
-    Profiler_interval_page *interval_page = NULL;
-
-    while (1)
-    {
-        bool new_page = false;
-        if (this->interval_pages.size() <= level)
-        {
-            this->interval_pages.push_back({});
-        }
-
-        if (this->interval_pages[level].size() == 0 || this->interval_pages[level].back()->is_full())
-        {
-            if (level > this->last_level)
-            {
-                this->last_level = level;
-            }
-            Profiler_interval_page *page = new Profiler_interval_page(level);
-            if (this->interval_pages[level].size() > 0)
-            {
-                page->intervals[0].prev = &this->interval_pages[level].back()->intervals[PROFILER_INTERVAL_PAGE_SIZE - 1];
-            }
-            else if (this->interval_pages[level].size() == 0 && level > 0)
-            {
-                page->intervals[0].start_timestamp = this->interval_pages[level - 1].front()->intervals[0].start_timestamp;
-            }
-            this->interval_pages[level].push_back(page);
-            new_page = true;
-        }
-
-        if (level >= 1 && this->interval_pages[level-1].size() == 2)
-        {
-            this->interval_pages[level].back()->register_interval_page(this->interval_pages[level-1].front());
-        }
-
-        if (interval_page)
-        {
-            this->interval_pages[level].back()->register_interval_page(interval_page);
-        }
-
-        if (!new_page || this->interval_pages[level].size() == 1)
-        {
-            break;
-        }
-
-        interval_page = this->interval_pages[level].back();
-
-        level++;
-    }
-}
-
-
-void Profiler_trace::register_trace_page(Profiler_trace_page *trace_page)
-{
-    Profiler_interval_page *interval_page = NULL;
-
-    if (this->interval_pages[0].size() == 0 || this->interval_pages[0].back()->is_full())
-    {
-        this->add_interval_page();
-    }
-
-    this->interval_pages[0].back()->register_trace_page(trace_page);
-}
-
-
-Profiler_event *Profiler_trace::alloc_event(int size)
-{
-    static int nb_event = 0;
-
-    nb_event++;
-
-    if (nb_event >= 100*1000*1000)
-    {
-        if (nb_event == 100*1000*1000)
-        {
-            fprintf(stderr, "Profiler has reached maximum number of events\n");
-        }
-        return NULL;
-    }
-
-    if (this->current_page == NULL || !this->current_page->has_size(size))
-    {
-        this->current_page = new Profiler_trace_page(this);
-    }
-
-    return this->current_page->alloc_event(size);
+    this->store_trace->dump(indent);
 }
 
 
 void Profiler_trace::event_update_logical(int64_t timestamp, Profiler_event_value value, int flags, Profiler_event_value no_value)
 {
-    Profiler_event *event = this->alloc_event(sizeof(Profiler_event));
-    if (event == NULL)
-    {
-        return;
-    }
-
-    event->set_value(timestamp, value, no_value);
+    this->store_trace->append(timestamp, this->to_store(value));
 
     if (this->hotspot_enabled)
     {
@@ -291,6 +219,8 @@ void Profiler_trace_binary_infos::event_update_logical(int64_t timestamp, Profil
 
     if (function && function != this->last_function)
     {
+        // The generated trace may be read by the view workers, which only take its lock
+        std::unique_lock<std::mutex> lock(this->trace->mutex);
         this->last_function = function;
         this->trace->event_update_logical(timestamp, (Profiler_event_value) { .value_p=(void *)function }, 0, (Profiler_event_value){.value_p=NULL});
     }
@@ -19,7 +19,6 @@
 #include "profiler_backend.hpp"
 #include <iostream>
 #include <time.h>
-#include <regex>
 #include <unistd.h>
 
 
@@ -36,7 +35,7 @@ Getview_req::Getview_req()
 
 Profiler_backend::Profiler_backend()
 : hotspot(), max_timestamp(0), pending_request(NULL), getview_request(NULL), abort_request(false),
-    nb_internal_signals(0), current_internal_signal_id(0), abort_get_view(false),started(false)
+    nb_internal_signals(0), current_internal_signal_id(0), store(NULL), abort_get_view(false),started(false)
 {
 }
 
@@ -223,23 +222,77 @@ void Profiler_backend::open(Profiler_backend_user_interface *user_interface, std
         }
     }
 
+    // Traces are only kept once the backend exits if a store path is given
+    const char *store_path = std::getenv("PROFILER_TRACE_STORE");
+    this->store = new Profiler_trace_store(store_path ? store_path : "");
+
+    this->start_workers();
+
+    this->user_interface = user_interface;
+    this->gvsoc = gv::gvsoc_new();
+
+    this->gvsoc->open(gvsoc_config_path);
+    this->gvsoc->vcd_bind(this);
+
+    if (const char *verbose_level = std::getenv("PROFILER_BACKEND_VERBOSE"))
+    {
+        this->verbose_level = atoi(verbose_level);
+    }
+}
+
+
+void Profiler_backend::start_workers()
+{
     this->viewer_thread = new std::thread(&Profiler_backend::viewer_routine, this);
 
     for (int i=0; i<NB_WORKERS; i++)
     {
         this->worker_threads.push_back(new std::thread(&Profiler_backend::worker_routine, this));
     }
+}
 
-    this->user_interface = user_interface;
-    this->gvsoc = gv::gvsoc_new();
 
-    this->gvsoc->open(gvsoc_config_path);
-    this->gvsoc->vcd_bind(this);
+void Profiler_backend::open_store(Profiler_backend_user_interface *user_interface, std::string path)
+{
+    this->verbose_level = 0;
 
     if (const char *verbose_level = std::getenv("PROFILER_BACKEND_VERBOSE"))
     {
         this->verbose_level = atoi(verbose_level);
     }
+
+    this->user_interface = user_interface;
+    this->gvsoc = NULL;
+    this->store = new Profiler_trace_store(path, false);
+
+    for (Profiler_store_trace_info &info: this->store->get_traces())
+    {
+        if (this->traces_array.size() <= info.id)
+        {
+            this->traces_array.resize(info.id + 1);
+        }
+
+        Profiler_event_value no_value = (Profiler_event_value){ .value_r=info.no_value };
+        if (info.type == gv::Vcd_event_type_string)
+        {
+            no_value.value_p = (void *)this->store->get_string(info.no_value);
+        }
+
+        Profiler_trace *trace = new Profiler_trace(this, info.path, info.id, (gv::Vcd_event_type)info.type,
+            info.width, no_value, info.trace);
+        this->traces_array[info.id] = trace;
+        this->traces_map[info.path] = trace;
+
+        if (info.trace->get_last_timestamp() > this->max_timestamp)
+        {
+            this->max_timestamp = info.trace->get_last_timestamp();
+        }
+
+        Profiler_backend_trace user_trace = { .id=info.id, .path=info.path, .type=PROFILER_BACKEND_TRACE_LOGICAL, .width=info.width};
+        this->user_interface->new_trace(user_trace);
+    }
+
+    this->start_workers();
 }
 
 
@@ -316,6 +369,12 @@ void Profiler_backend::hotspot_disable(std::string trace_path)
 
 void Profiler_backend::start(int64_t time)
 {
+    // Nothing to run when the traces come from a store
+    if (this->gvsoc == NULL)
+    {
+        return;
+    }
+
     if (!this->started)
     {
         this->started = true;
@@ -334,6 +393,11 @@ void Profiler_backend::start(int64_t time)
 
 void Profiler_backend::stop()
 {
+    if (this->gvsoc == NULL)
+    {
+        return;
+    }
+
     this->gvsoc->stop();
 }
 
@@ -401,318 +465,11 @@ void Profiler_backend::get_view(Profiler_view_results *results)
     this->push_request(req);
 }
 
-Profiler_event_value Profiler_trace_page::get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value)
-{
-    Profiler_event *event = this->first_event;
-
-#ifdef TRACE
-    printf("[TRACE PAGE] Get average on %ld -> %ld\n", start_timestamp, end_timestamp);
-#endif
-
-    // Find the event right before the period
-    while (event->next && event->next->timestamp <= start_timestamp)
-    {
-        event = event->next;
-    }
-
-    // And checks that all events after this one overlapping the period have same value
-    uint64_t value = event->value.value_r;
-#ifdef TRACE
-    printf("[TRACE PAGE] Accounting event %ld value %f\n", event->timestamp, event->value);
-#endif
-
-    event = event->next;
-
-    while (event && event->timestamp < end_timestamp)
-    {
-#ifdef TRACE
-        printf("[TRACE PAGE] Accounting event %ld value %f\n", event->timestamp, event->value);
-#endif
-
-        if (event->value.value_r != value)
-        {
-            return no_value;
-        }
-
-        event = event->next;
-    }
-
-#ifdef TRACE
-    printf("[TRACE PAGE] Average is %f\n", value);
-#endif
-
-    return (Profiler_event_value){.value_r=value};
-}
-
-Profiler_event_value Profiler_interval::get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value)
-{
-    if (this->trace_page)
-    {
-        return this->trace_page->get_average_logical(start_timestamp, end_timestamp, no_value);
-    }
-    else
-    {
-        return this->interval_page->get_average_logical(start_timestamp, end_timestamp, no_value);
-    }
-}
-
-Profiler_event_value Profiler_interval_page::get_average_logical(int64_t start_timestamp, int64_t end_timestamp, Profiler_event_value no_value)
-{
-    Profiler_interval *interval = &this->intervals[0];
-    Profiler_interval *last_interval = &this->intervals[this->current];
-    Profiler_interval *partial_start_interval = NULL;
-    Profiler_interval *partial_end_interval = NULL;
-    Profiler_event_value current_value = no_value;
-
-#ifdef TRACE
-    printf("[PAGE L%d] GET start %ld end %ld\n", this->level, start_timestamp, end_timestamp);
-#endif
-
-    // Special case where the period is after the last event
-    if (this->intervals[this->current - 1].end_timestamp < start_timestamp)
-    {
-        return this->intervals[this->current - 1].get_average_logical(start_timestamp, end_timestamp, no_value);
-    }
-
-    // First look for the first interval covering 
-    while (interval != last_interval)
-    {
-        if  (interval->end_timestamp <= start_timestamp)
-        {
-            interval++;
-            continue;
-        }
-
-        if (interval->start_timestamp < start_timestamp)
-        {
-            if (end_timestamp <= interval->end_timestamp)
-            {
-                return interval->get_average_logical(start_timestamp, end_timestamp, no_value);
-            }
-            else
-            {
-                partial_start_interval = interval;
-                interval++;
-            }
-        }
-        break;
-    }
-
-
-    // Now look for entire intervals
-    while (interval != last_interval)
-    {
-        if (interval->end_timestamp <= end_timestamp)
-        {
-#ifdef TRACE
-            printf("[PAGE L%d] get value %f from interval %ld -> %ld\n", this->level, interval->value, interval->start_timestamp, interval->end_timestamp);
-#endif
-
-            // Case where the period entirely covers the interval
-            if (current_value.value_r == no_value.value_r)
-            {
-                // In case we still not have any current value, just take the interval one and continue
-                current_value = interval->value;
-                if (current_value.value_r == no_value.value_r)
-                {
-                    return no_value;
-                }
-            }
-            else
-            {
-                // Otherwise, if it is different return -1 since we cannot distinguish
-                if (current_value.value_r != interval->value.value_r)
-                {
-                    return no_value;
-                }
-            }
-
-            interval++;
-        }
-        else
-        {
-            // Case we reached the end of the period, remember to enter this partial interval and leave
-            partial_end_interval = interval;
-            break;
-        }
-    }
-
-    if (partial_end_interval)
-    {
-        Profiler_event_value value = partial_end_interval->get_average_logical(start_timestamp, end_timestamp, no_value);
-#ifdef TRACE
-        printf("[PAGE L%d] get value %f from partial end interval %ld -> %ld\n", this->level, value, partial_end_interval->start_timestamp, partial_end_interval->end_timestamp);
-#endif
-
-        if (value.value_r == no_value.value_r)
-        {
-            return no_value;
-        }
-
-        if (current_value.value_r != no_value.value_r && value.value_r != current_value.value_r)
-        {
-            return no_value;
-        }
-
-        current_value = value;
-    }
-
-    if (partial_start_interval)
-    {
-        Profiler_event_value value = partial_start_interval->get_average_logical(start_timestamp, end_timestamp, no_value);
-#ifdef TRACE
-        printf("[PAGE L%d] get value %f from partial start interval %ld -> %ld\n", this->level, value, partial_start_interval->start_timestamp, partial_start_interval->end_timestamp);
-#endif
-        if (value.value_r == no_value.value_r)
-        {
-            return no_value;
-        }
-
-        if (current_value.value_r != no_value.value_r && value.value_r != current_value.value_r)
-        {
-            return no_value;
-        }
-
-        current_value = value;
-    }
-
-#ifdef TRACE
-    printf("[PAGE L%d] returns %f\n", this->level, current_value);
-#endif
-
-    return current_value;
-}
-
-
 void Profiler_backend::close()
 {
 }
 
 
-void Profiler_event::dump(std::string indent)
-{
-    printf("%s[%ld] event value %f\n", indent.c_str(), this->timestamp, this->value.value_d);
-}
-
-
-
-
-
-void Profiler_interval::dump(std::string indent)
-{
-    printf("%sInterval TS: %ld->%ld vaue: %f\n", indent.c_str(), this->start_timestamp, this->end_timestamp, this->value.value_d);
-    if (this->trace_page)
-    {
-        this->trace_page->dump(indent + "  ");
-    }
-    else
-    {
-        this->interval_page->dump(indent + "  ");
-    }
-}
-
-
-void Profiler_interval_page::dump(std::string indent)
-{
-    printf("%sPage (level=%d)\n", indent.c_str(), this->level);
-
-    for (int i=0; i<this->current; i++)
-    {
-        this->intervals[i].dump(indent + "  ");
-    }
-}
-
-
-void Profiler_interval_page::register_trace_page(Profiler_trace_page *trace_page)
-{
-    trace_page->set_parent(&this->intervals[this->current]);
-    this->intervals[this->current++].set_trace_page(trace_page);
-}
-
-void Profiler_interval_page::register_interval_page(Profiler_interval_page *interval_page)
-{
-    interval_page->set_parent(&this->intervals[this->current]);
-    this->intervals[this->current++].set_interval_page(interval_page);
-}
-
-
-Profiler_interval::Profiler_interval()
-    : trace_page(NULL), interval_page(NULL)
-{
-    this->start_timestamp = -1;
-}
-
-void Profiler_interval::set_interval_page(Profiler_interval_page *interval_page)
-{
-    this->interval_page = interval_page;
-}
-
-void Profiler_interval::set_trace_page(Profiler_trace_page *trace_page)
-{
-    this->trace_page = trace_page;
-}
-
-Profiler_interval_page::Profiler_interval_page(int level)
-    : level(level), current(0), parent(NULL)
-{
-    Profiler_interval *prev = NULL;
-    for (int i=0; i<PROFILER_INTERVAL_PAGE_SIZE; i++)
-    {
-        Profiler_interval *interval = &this->intervals[i];
-        interval->parent = this;
-        interval->start_timestamp = -1;
-        interval->prev = prev;
-        prev = interval;
-    }
-}
-
-
-Profiler_event *Profiler_trace_page::alloc_event(int size)
-{
-    uint8_t *data = this->current_data;
-    this->current_data += size;
-    this->current_data_size -= size;
-
-    Profiler_event *event = (Profiler_event *)data;
-    if (this->last_alloc_event)
-    {
-        this->last_alloc_event->next = event;
-    }
-
-    event->next = NULL;
-    event->parent = this;
-    this->last_alloc_event = event;
-
-    if (this->first_event == NULL)
-    {
-        this->first_event = this->last_alloc_event;
-    }
-
-    return event;
-}
-
-Profiler_trace_page::Profiler_trace_page(Profiler_trace *trace)
-    : trace(trace), current_data(NULL), current_data_size(0), last_alloc_event(NULL), first_event(NULL)
-{
-    this->current_data = new uint8_t[PROFILER_TRACE_PAGE_SIZE];
-    this->current_data_size = PROFILER_TRACE_PAGE_SIZE;
-
-    trace->register_trace_page(this);
-}
-
-
-void Profiler_trace_page::dump(std::string indent)
-{
-    Profiler_event *event = this->first_event;
-
-    while(event)
-    {
-        event->dump(indent);
-        event = event->next;
-    }
-}
-
-
 void Profiler_backend::event_register(int id, std::string path, gv::Vcd_event_type type, int width)
 {
     this->event_register_internal(id + this->nb_internal_signals, path, type, width, (Profiler_event_value){.value_d=-1});
@@ -810,33 +567,6 @@ void Profiler_backend::event_update_value(int64_t timestamp, int id, Profiler_ev
     lock.unlock();
 }
 
-void Profiler_event::set_value(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value)
-{
-    this->timestamp = timestamp;
-    this->value = value;
-    this->parent->add_value_logical(timestamp, value, no_value);
-}
-
-void Profiler_interval::add_value_logical(int64_t timestamp, Profiler_event_value value, Profiler_event_value no_value)
-{
-    if (this->start_timestamp == -1)
-    {
-        this->start_timestamp = timestamp;
-        this->value = value;
-        if (this->prev)
-        {
-            this->prev->end_timestamp = timestamp;
-        }
-    }
-    else if (value.value_r != this->value.value_r)
-    {
-        this->value = no_value;
-    }
-
-    this->end_timestamp = timestamp;
-    this->parent->add_value_logical(timestamp, value, no_value);
-}
-
 void Profiler_backend::event_update_bitfield(int64_t timestamp, int id, uint8_t *value, uint8_t *flags)
 {
     printf("%s %d\n", __FILE__, __LINE__);
@@ -895,11 +625,22 @@ void Profiler_backend::get_hotspots(void *tag, int trace_id, int64_t start_times
 
 Profiler_binary *Profiler_backend::add_static_binary(std::string path)
 {
-    this->hotspot.add_static_binary(path);
-
     if (this->binaries[path] == NULL)
     {
-        Profiler_binary *binary = new Profiler_binary(path);
+        // The same symbolizer is used for the hotspots and the function traces, so that
+        // the binary is parsed only once
+        Profiler_symbolizer *symbolizer = NULL;
+        try
+        {
+            symbolizer = new Profiler_symbolizer(path);
+            this->hotspot.add_static_binary(symbolizer);
+        }
+        catch (std::invalid_argument &e)
+        {
+            fprintf(stderr, "%s", e.what());
+        }
+
+        Profiler_binary *binary = new Profiler_binary(symbolizer);
         this->binaries[path] = binary;
     }
 
@@ -914,59 +655,36 @@ Profiler_trace *Profiler_backend::get_trace(std::string path)
 
 
 
-Profiler_binary::Profiler_binary(std::string elf_file)
+Profiler_binary::Profiler_binary(Profiler_symbolizer *symbolizer)
+    : symbolizer(symbolizer)
 {
-    std::string command = "gen-debug-info " + elf_file;
+}
 
-    std::shared_ptr<FILE> pipe(popen(command.c_str(), "r"), pclose);
-    if (!pipe)
-    {
-        throw std::invalid_argument("Unable to open binary: " + elf_file + "\n");
-    }
-    char buffer[128];
-    std::string result = "";
 
-    while (!feof(pipe.get())) {
-        if (fgets(buffer, 128, pipe.get()) != NULL)
-            result += buffer;
+Profiler_binary_info *Profiler_binary::get(uint64_t pc)
+{
+    auto it = this->infos.find(pc);
+    if (it != this->infos.end())
+    {
+        return &it->second;
     }
 
-    std::unordered_map<std::string, const char *> files;
-    std::unordered_map<std::string, const char *> functions;
-    std::stringstream ss(result);
-    std::string line;
-    std::regex regex{R"([\s]+)"};
-    while(std::getline(ss, line,'\n'))
+    const char *function, *file;
+    int line;
+    if (this->symbolizer == NULL || !this->symbolizer->lookup(pc, &function, &file, &line))
     {
-        char functionname[256], inlined_function[256], filename[256];
-        uint64_t addr;
-        int lineno;
-        int nb_item = sscanf(line.c_str(), "%lx %s %s %s %d", &addr, functionname, inlined_function, filename, &lineno);
-
-        if (nb_item == 5)
-        {
-            const char *file = files[filename];
-            if (file == NULL)
-            {
-                file = strdup(filename);
-                files[file] = file;
-            }
-            const char *function = functions[functionname];
-            if (function == NULL)
-            {
-                function = strdup(functionname);
-                functions[function] = function;
-            }
-
-            this->infos[addr] = (Profiler_binary_info) {
-                .pc = addr,
-                .function = function,
-                .inlined_function = function,
-                .file = file,
-                .line = lineno
-            };
-        }
+        return NULL;
     }
+
+    Profiler_binary_info *info = &this->infos[pc];
+    *info = (Profiler_binary_info) {
+        .pc = pc,
+        .function = function,
+        .inlined_function = function,
+        .file = file,
+        .line = line
+    };
+    return info;
 }
 
 Profiler_view_results::Profiler_view_results(void *tag, std::vector<int> &trace_ids, int64_t start_timestamp,
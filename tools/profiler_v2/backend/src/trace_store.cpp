@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler_trace_store.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define PROFILER_MAPPED_FILE_MIN_SIZE (64*1024)
+
+
+static inline double value_to_double(uint64_t value)
+{
+    double result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+
+Profiler_mapped_file::Profiler_mapped_file(std::string path, bool create, bool persistent)
+    : data(NULL), size(0)
+{
+    if (!persistent)
+    {
+        // The file is unlinked as soon as it is created, its content stays available
+        // through the mapping until the backend exits
+        std::string tmp_path = path + "_XXXXXX";
+        this->fd = mkstemp((char *)tmp_path.c_str());
+        if (this->fd != -1)
+        {
+            unlink(tmp_path.c_str());
+        }
+    }
+    else if (create)
+    {
+        this->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    else
+    {
+        this->fd = ::open(path.c_str(), O_RDWR);
+    }
+
+    if (this->fd == -1)
+    {
+        throw std::runtime_error("Unable to open trace store file (path: " + path + ", error: " + strerror(errno) + ")");
+    }
+
+    struct stat file_stat;
+    if (fstat(this->fd, &file_stat) == 0 && file_stat.st_size > 0)
+    {
+        this->data = (uint8_t *)mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+        if (this->data == MAP_FAILED)
+        {
+            throw std::runtime_error("Unable to map trace store file (path: " + path + ", error: " + strerror(errno) + ")");
+        }
+        this->size = file_stat.st_size;
+    }
+    else
+    {
+        this->reserve(PROFILER_MAPPED_FILE_MIN_SIZE);
+    }
+}
+
+
+Profiler_mapped_file::~Profiler_mapped_file()
+{
+    if (this->data)
+    {
+        munmap(this->data, this->size);
+    }
+    ::close(this->fd);
+}
+
+
+void Profiler_mapped_file::reserve(size_t size)
+{
+    if (size <= this->size)
+    {
+        return;
+    }
+
+    // Grow exponentially to keep the number of remappings low
+    size_t new_size = this->size < PROFILER_MAPPED_FILE_MIN_SIZE ? PROFILER_MAPPED_FILE_MIN_SIZE : this->size;
+    while (new_size < size)
+    {
+        new_size *= 2;
+    }
+
+    if (ftruncate(this->fd, new_size) != 0)
+    {
+        throw std::runtime_error(std::string("Unable to grow trace store file (error: ") + strerror(errno) + ")");
+    }
+
+    uint8_t *data;
+    if (this->data)
+    {
+        data = (uint8_t *)mremap(this->data, this->size, new_size, MREMAP_MAYMOVE);
+    }
+    else
+    {
+        data = (uint8_t *)mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+    }
+
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error(std::string("Unable to map trace store file (error: ") + strerror(errno) + ")");
+    }
+
+    this->data = data;
+    this->size = new_size;
+}
+
+
+
+Profiler_store_trace::Profiler_store_trace(std::string path, bool create, bool persistent, uint64_t no_value)
+    : path(path), persistent(persistent), no_value(no_value)
+{
+    this->events = new Profiler_mapped_file(path, create, persistent);
+
+    if (create)
+    {
+        Profiler_store_header *header = this->header();
+        header->magic = PROFILER_STORE_MAGIC;
+        header->version = PROFILER_STORE_VERSION;
+        header->nb_events = 0;
+    }
+    else
+    {
+        Profiler_store_header *header = this->header();
+        if (header->magic != PROFILER_STORE_MAGIC || header->version != PROFILER_STORE_VERSION)
+        {
+            throw std::runtime_error("Invalid trace store file (path: " + path + ")");
+        }
+
+        // The number of levels is deduced from the number of events, a level is there
+        // as soon as the previous one has more than one entry
+        uint64_t nb_events = header->nb_events;
+        int level = 0;
+        while (nb_events > 0 && ((nb_events - 1) >> (level * PROFILER_STORE_FANOUT_LOG2)) > 0)
+        {
+            level++;
+            this->levels.push_back(new Profiler_mapped_file(path + ".L" + std::to_string(level), false, true));
+        }
+    }
+}
+
+
+Profiler_store_trace::~Profiler_store_trace()
+{
+    for (Profiler_mapped_file *level: this->levels)
+    {
+        delete level;
+    }
+    delete this->events;
+}
+
+
+int64_t Profiler_store_trace::get_last_timestamp()
+{
+    uint64_t nb_events = this->get_nb_events();
+    return nb_events == 0 ? 0 : this->timestamp(nb_events - 1);
+}
+
+
+void Profiler_store_trace::get_summary(int level, uint64_t index, Profiler_store_summary *summary)
+{
+    if (level > 0)
+    {
+        *summary = *this->summary(level, index);
+    }
+    else
+    {
+        double value = value_to_double(this->value(index));
+        summary->start_timestamp = this->timestamp(index);
+        summary->end_timestamp = summary->start_timestamp;
+        summary->value = this->value(index);
+        summary->min = value;
+        summary->max = value;
+        summary->area = index + 1 < this->get_nb_events() ?
+            value * (this->timestamp(index + 1) - summary->start_timestamp) : 0;
+    }
+}
+
+
+void Profiler_store_trace::merge(Profiler_store_summary *summary, Profiler_store_summary *other)
+{
+    if (summary->start_timestamp == -1)
+    {
+        *summary = *other;
+        return;
+    }
+
+    if (other->start_timestamp < summary->start_timestamp)
+    {
+        summary->start_timestamp = other->start_timestamp;
+    }
+    if (other->end_timestamp > summary->end_timestamp)
+    {
+        summary->end_timestamp = other->end_timestamp;
+    }
+    if (other->value != summary->value)
+    {
+        summary->value = this->no_value;
+    }
+    if (other->min < summary->min)
+    {
+        summary->min = other->min;
+    }
+    if (other->max > summary->max)
+    {
+        summary->max = other->max;
+    }
+    summary->area += other->area;
+}
+
+
+void Profiler_store_trace::add_level()
+{
+    int level = this->levels.size();
+
+    Profiler_mapped_file *file = new Profiler_mapped_file(this->path + ".L" + std::to_string(level + 1), true, this->persistent);
+    this->levels.push_back(file);
+
+    // The first entry of the new level summarizes all the entries of the previous top level
+    Profiler_store_summary *summary = this->summary(level + 1, 0);
+    uint64_t nb_entries = ((this->get_nb_events() - 1) >> (level * PROFILER_STORE_FANOUT_LOG2)) + 1;
+
+    summary->start_timestamp = -1;
+    for (uint64_t i=0; i<nb_entries; i++)
+    {
+        Profiler_store_summary entry;
+        this->get_summary(level, i, &entry);
+        this->merge(summary, &entry);
+    }
+}
+
+
+void Profiler_store_trace::append(int64_t timestamp, uint64_t value)
+{
+    uint64_t index = this->get_nb_events();
+
+    this->events->reserve(PROFILER_STORE_HEADER_SIZE + (index / PROFILER_STORE_PAGE_EVENTS + 1) * sizeof(Profiler_store_page));
+    Profiler_store_page *page = this->page(index);
+    page->timestamps[index % PROFILER_STORE_PAGE_EVENTS] = timestamp;
+    page->values[index % PROFILER_STORE_PAGE_EVENTS] = value;
+
+    // The duration of the previous event is now known
+    if (index > 0)
+    {
+        double area = value_to_double(this->value(index - 1)) * (timestamp - this->timestamp(index - 1));
+        for (int level=1; level<=this->levels.size(); level++)
+        {
+            this->summary(level, (index - 1) >> (level * PROFILER_STORE_FANOUT_LOG2))->area += area;
+        }
+    }
+
+    Profiler_store_summary event;
+    this->header()->nb_events = index + 1;
+    this->get_summary(0, index, &event);
+
+    for (int level=1; level<=this->levels.size(); level++)
+    {
+        int shift = level * PROFILER_STORE_FANOUT_LOG2;
+        uint64_t entry_index = index >> shift;
+        this->levels[level - 1]->reserve((entry_index + 1) * sizeof(Profiler_store_summary));
+
+        Profiler_store_summary *summary = this->summary(level, entry_index);
+        if ((index & ((1ULL << shift) - 1)) == 0)
+        {
+            *summary = event;
+        }
+        else
+        {
+            this->merge(summary, &event);
+        }
+    }
+
+    if ((index >> (this->levels.size() * PROFILER_STORE_FANOUT_LOG2)) > 0)
+    {
+        this->add_level();
+    }
+}
+
+
+void Profiler_store_trace::dump(std::string indent)
+{
+    for (uint64_t i=0; i<this->get_nb_events(); i++)
+    {
+        printf("%s[%ld] event value %f\n", indent.c_str(), this->timestamp(i), value_to_double(this->value(i)));
+    }
+}
+
+
+uint64_t Profiler_store_trace::find_event(int64_t timestamp)
+{
+    uint64_t first = 0, last = this->get_nb_events();
+
+    while (last - first > 1)
+    {
+        uint64_t middle = (first + last) / 2;
+        if (this->timestamp(middle) <= timestamp)
+        {
+            first = middle;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+
+void Profiler_store_trace::merge_range(uint64_t first, uint64_t last, Profiler_store_summary *summary)
+{
+    uint64_t start = first, end = last + 1;
+    int level = 0;
+
+    summary->start_timestamp = -1;
+
+    // Go up in the pyramid, using at each level only the entries which are not entirely
+    // covered by an entry of the next level
+    while (start < end)
+    {
+        Profiler_store_summary entry;
+
+        if (level == this->levels.size())
+        {
+            for (uint64_t i=start; i<end; i++)
+            {
+                this->get_summary(level, i, &entry);
+                this->merge(summary, &entry);
+            }
+            break;
+        }
+
+        while (start < end && (start & (PROFILER_STORE_FANOUT - 1)))
+        {
+            this->get_summary(level, start++, &entry);
+            this->merge(summary, &entry);
+        }
+
+        while (end > start && (end & (PROFILER_STORE_FANOUT - 1)))
+        {
+            this->get_summary(level, --end, &entry);
+            this->merge(summary, &entry);
+        }
+
+        start >>= PROFILER_STORE_FANOUT_LOG2;
+        end >>= PROFILER_STORE_FANOUT_LOG2;
+        level++;
+    }
+}
+
+
+uint64_t Profiler_store_trace::get_value(int64_t start_timestamp, int64_t end_timestamp)
+{
+    if (this->get_nb_events() == 0)
+    {
+        return this->no_value;
+    }
+
+    // The window starts with the event active at the start timestamp and contains
+    // all the events before the end timestamp
+    uint64_t first = this->find_event(start_timestamp);
+    uint64_t last = this->find_event(end_timestamp - 1);
+    if (last < first)
+    {
+        last = first;
+    }
+
+    Profiler_store_summary summary;
+    this->merge_range(first, last, &summary);
+
+    return summary.value;
+}
+
+
+void Profiler_store_trace::get_stats(int64_t start_timestamp, int64_t end_timestamp, Profiler_store_stats *stats)
+{
+    if (this->get_nb_events() == 0)
+    {
+        stats->min = stats->max = stats->average = 0;
+        return;
+    }
+
+    uint64_t first = this->find_event(start_timestamp);
+    uint64_t last = this->find_event(end_timestamp - 1);
+    if (last < first)
+    {
+        last = first;
+    }
+
+    Profiler_store_summary summary;
+    this->merge_range(first, last, &summary);
+    stats->min = summary.min;
+    stats->max = summary.max;
+
+    if (first == last)
+    {
+        stats->average = value_to_double(this->value(first));
+        return;
+    }
+
+    // The first and last events are only partially covered by the window, their
+    // contribution is computed here, while the ones in between come from the pyramid
+    int64_t window_start = std::max(start_timestamp, this->timestamp(first));
+    double area = value_to_double(this->value(first)) * (this->timestamp(first + 1) - window_start);
+    area += value_to_double(this->value(last)) * (end_timestamp - this->timestamp(last));
+
+    if (first + 1 < last)
+    {
+        this->merge_range(first + 1, last - 1, &summary);
+        area += summary.area;
+    }
+
+    stats->average = end_timestamp > window_start ? area / (end_timestamp - window_start) : 0;
+}
+
+
+
+Profiler_trace_store::Profiler_trace_store(std::string path, bool create)
+    : path(path), persistent(path != ""), index_file(NULL), strings_file(NULL)
+{
+    if (!this->persistent)
+    {
+        return;
+    }
+
+    if (create)
+    {
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            throw std::runtime_error("Unable to create trace store (path: " + path + ", error: " + strerror(errno) + ")");
+        }
+
+        this->index_file = fopen((path + "/index").c_str(), "w");
+        this->strings_file = fopen((path + "/strings").c_str(), "wb");
+        if (this->index_file == NULL || this->strings_file == NULL)
+        {
+            throw std::runtime_error("Unable to create trace store (path: " + path + ", error: " + strerror(errno) + ")");
+        }
+    }
+    else
+    {
+        FILE *index_file = fopen((path + "/index").c_str(), "r");
+        if (index_file == NULL)
+        {
+            throw std::runtime_error("Unable to open trace store (path: " + path + ", error: " + strerror(errno) + ")");
+        }
+
+        int id, type, width;
+        uint64_t no_value;
+        char trace_path[1024];
+        while (fscanf(index_file, "%d %d %d %lx %1023s", &id, &type, &width, &no_value, trace_path) == 5)
+        {
+            Profiler_store_trace *trace = new Profiler_store_trace(path + "/" + std::to_string(id), false, true, no_value);
+            this->traces.push_back((Profiler_store_trace_info){
+                .id=id, .path=trace_path, .type=type, .width=width, .no_value=no_value, .trace=trace
+            });
+        }
+        fclose(index_file);
+
+        FILE *strings_file = fopen((path + "/strings").c_str(), "rb");
+        if (strings_file)
+        {
+            std::string str;
+            int c;
+            while ((c = fgetc(strings_file)) != EOF)
+            {
+                if (c == 0)
+                {
+                    this->strings.push_back(strdup(str.c_str()));
+                    str.clear();
+                }
+                else
+                {
+                    str += (char)c;
+                }
+            }
+            fclose(strings_file);
+        }
+    }
+}
+
+
+Profiler_trace_store::~Profiler_trace_store()
+{
+    for (Profiler_store_trace_info &info: this->traces)
+    {
+        delete info.trace;
+    }
+    if (this->index_file)
+    {
+        fclose(this->index_file);
+    }
+    if (this->strings_file)
+    {
+        fclose(this->strings_file);
+    }
+}
+
+
+Profiler_store_trace *Profiler_trace_store::new_trace(int id, std::string path, int type, int width, uint64_t no_value)
+{
+    std::string trace_path = this->persistent ? this->path + "/" + std::to_string(id) : "/tmp/profiler_trace_" + std::to_string(id);
+    Profiler_store_trace *trace = new Profiler_store_trace(trace_path, true, this->persistent, no_value);
+
+    this->traces.push_back((Profiler_store_trace_info){
+        .id=id, .path=path, .type=type, .width=width, .no_value=no_value, .trace=trace
+    });
+
+    if (this->index_file)
+    {
+        fprintf(this->index_file, "%d %d %d %lx %s\n", id, type, width, no_value, path.c_str());
+        fflush(this->index_file);
+    }
+
+    return trace;
+}
+
+
+uint64_t Profiler_trace_store::get_string_id(const char *str)
+{
+    // NULL and 1 are special values used by the function traces
+    if (str == NULL || str == (const char *)1)
+    {
+        return (uint64_t)str;
+    }
+
+    std::unique_lock<std::mutex> lock(this->strings_mutex);
+
+    auto it = this->string_ids.find(str);
+    if (it != this->string_ids.end())
+    {
+        return it->second;
+    }
+
+    uint64_t id = this->strings.size() + 2;
+    this->strings.push_back(str);
+    this->string_ids[str] = id;
+
+    if (this->strings_file)
+    {
+        fwrite(str, 1, strlen(str) + 1, this->strings_file);
+        fflush(this->strings_file);
+    }
+
+    return id;
+}
+
+
+const char *Profiler_trace_store::get_string(uint64_t id)
+{
+    std::unique_lock<std::mutex> lock(this->strings_mutex);
+
+    if (id < 2 || id - 2 >= this->strings.size())
+    {
+        return id == 1 ? (const char *)1 : NULL;
+    }
+
+    return this->strings[id - 2];
+}
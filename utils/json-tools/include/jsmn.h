@@ -25,6 +25,10 @@
 
 #include <stddef.h>
 
+/* Keep the parent of each token, otherwise closing an object scans back over all its
+ * previous siblings, which is quadratic on the large platform configurations */
+#define JSMN_PARENT_LINKS
+
 #ifdef __cplusplus
 extern "C" {
 #endif